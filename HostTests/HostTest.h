@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _HOSTTEST_H
+#define	_HOSTTEST_H
+
+//  HostTest.h is the little that the host tests share - a check that counts failures
+//  and a reader for the .dta files written by the calibration sketches. Every test is
+//  a single main() that returns hostTestResult(), so run.sh only has to look at the
+//  exit status.
+//
+//  Data files are found relative to the HostTests directory, where run.sh runs the tests.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <vector>
+
+#define HOSTTEST_DATA                   "../RTEllipsoidFit/"
+
+static int hostTestFailures = 0;
+
+//  HOSTTEST_CHECK prints the message either way so that the output shows the margins
+
+#define HOSTTEST_CHECK(cond, ...)                                               \
+    do {                                                                        \
+        bool ok_ = (cond);                                                      \
+        printf("%s: ", ok_ ? "ok  " : "FAIL");                                  \
+        printf(__VA_ARGS__);                                                    \
+        printf("\n");                                                           \
+        if (!ok_)                                                               \
+            hostTestFailures++;                                                 \
+    } while (0)
+
+static inline int hostTestResult()
+{
+    if (hostTestFailures == 0)
+        printf("passed\n");
+    else
+        printf("%d check(s) failed\n", hostTestFailures);
+    return hostTestFailures == 0 ? 0 : 1;
+}
+
+//  hostTestLoad() reads a whitespace separated file of numbers, one row per line, and
+//  returns false if it cannot be opened
+
+static inline bool hostTestLoad(const char *name, std::vector<std::vector<double> >& rows)
+{
+    FILE *file = fopen(name, "r");
+
+    rows.clear();
+    if (file == NULL) {
+        printf("FAIL: can't open %s\n", name);
+        hostTestFailures++;
+        return false;
+    }
+
+    char line[1024];
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        std::vector<double> row;
+        char *pos = line;
+        char *end;
+
+        while (true) {
+            double value = strtod(pos, &end);
+            if (end == pos)
+                break;
+            row.push_back(value);
+            pos = end;
+        }
+        if (row.size() > 0)
+            rows.push_back(row);
+    }
+    fclose(file);
+    return true;
+}
+
+#endif // _HOSTTEST_H
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestAccelPoseFit puts a simulated sensor down in fourteen poses - the six faces and
+//  eight corners of a cube - and feeds RTAccelPoseFit at 100Hz. Each pose is reached by a
+//  noisy 0.8 second move and held for 0.7 seconds with 4mg of noise.
+//
+//  The sensor is the one recorded in accelRaw.dta: each pose reads the raw value that the
+//  offline fit in accelCorr.dta maps onto the cube direction, so the poses carry its
+//  offset, scale and misalignment - the recorded samples themselves are too noisy to
+//  stand in for a still pose. The fit must be valid within half a minute, recover the
+//  accelCorr.dta offset and correct every sample of accelRaw.dta as well as it does.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestAccelPoseFit TestAccelPoseFit.cpp
+//      ../libraries/RTIMULib/RTAccelPoseFit.cpp ../libraries/RTIMULib/RTEllipsoidFit.cpp
+//      ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTAccelPoseFit.h"
+
+#include <random>
+
+#define SAMPLE_INTERVAL                 10000               // uS
+#define MOVE_SAMPLES                    80
+#define HOLD_SAMPLES                    70
+#define HOLD_NOISE                      0.004               // g
+#define MOVE_NOISE                      0.02                // g
+#define OFFSET_LIMIT                    0.003               // g from accelCorr.dta
+#define RMS_LIMIT                       1.05                // rms |a| error against that of accelCorr.dta
+
+typedef std::vector<std::vector<double> > Rows;
+
+static const int cube[14][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
+        {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1}};
+
+//  rmsError() returns the rms of |corr * (a - offset)| - 1 over the raw samples
+
+static double rmsError(const Rows& raw, const double *offset, const double corr[3][3])
+{
+    double sumSq = 0;
+
+    for (size_t i = 0; i < raw.size(); i++) {
+        double a[3];
+        double lengthSq = 0;
+
+        for (int row = 0; row < 3; row++) {
+            a[row] = 0;
+            for (int col = 0; col < 3; col++)
+                a[row] += corr[row][col] * (raw[i][col] - offset[col]);
+            lengthSq += a[row] * a[row];
+        }
+        sumSq += (sqrt(lengthSq) - 1) * (sqrt(lengthSq) - 1);
+    }
+    return sqrt(sumSq / raw.size());
+}
+
+int main()
+{
+    Rows raw;
+    Rows ref;
+
+    if (!hostTestLoad(HOSTTEST_DATA "accelRaw.dta", raw) || !hostTestLoad(HOSTTEST_DATA "accelCorr.dta", ref))
+        return hostTestResult();
+
+    //  the pose readings are offset + inverse(corr) * direction, the inverse by cofactors
+
+    const std::vector<double>& c = ref[0];
+    double m[3][3];
+    double inverse[3][3];
+    RTVector3 poses[14];
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            m[row][col] = c[3 + row * 3 + col];
+    }
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            inverse[col][row] = m[(row + 1) % 3][(col + 1) % 3] * m[(row + 2) % 3][(col + 2) % 3] -
+                    m[(row + 1) % 3][(col + 2) % 3] * m[(row + 2) % 3][(col + 1) % 3];
+    }
+
+    double determinant = m[0][0] * inverse[0][0] + m[0][1] * inverse[1][0] + m[0][2] * inverse[2][0];
+
+    for (int pose = 0; pose < 14; pose++) {
+        RTVector3 direction(cube[pose][0], cube[pose][1], cube[pose][2]);
+
+        direction.normalize();
+        for (int row = 0; row < 3; row++) {
+            double value = c[row];
+
+            for (int col = 0; col < 3; col++)
+                value += inverse[row][col] / determinant * direction.data(col);
+            poses[pose].setData(row, value);
+        }
+    }
+
+    RTAccelPoseFit fit;
+    std::mt19937 rng(8);
+    std::normal_distribution<double> noise(0, 1);
+    uint64_t timestamp = 0;
+    RTVector3 current = poses[5];
+    int validPose = -1;
+
+    for (int pose = 0; pose < 14; pose++) {
+        for (int k = 0; k < MOVE_SAMPLES; k++) {
+            RTVector3 v = current * (1 - (RTFLOAT)k / MOVE_SAMPLES) + poses[pose] * ((RTFLOAT)k / MOVE_SAMPLES);
+
+            fit.addSample(RTVector3(v.x() + MOVE_NOISE * noise(rng), v.y() + MOVE_NOISE * noise(rng),
+                                    v.z() + MOVE_NOISE * noise(rng)), timestamp += SAMPLE_INTERVAL);
+        }
+        for (int k = 0; k < HOLD_SAMPLES; k++) {
+            RTVector3 v = poses[pose];
+
+            fit.addSample(RTVector3(v.x() + HOLD_NOISE * noise(rng), v.y() + HOLD_NOISE * noise(rng),
+                                    v.z() + HOLD_NOISE * noise(rng)), timestamp += SAMPLE_INTERVAL);
+        }
+        current = poses[pose];
+        if ((validPose < 0) && fit.isValid())
+            validPose = pose;
+    }
+
+    HOSTTEST_CHECK(fit.getPoseCount() == 14, "%d distinct poses found", fit.getPoseCount());
+    HOSTTEST_CHECK(validPose >= 0 && (validPose + 1) * (MOVE_SAMPLES + HOLD_SAMPLES) * SAMPLE_INTERVAL < 30000000,
+                   "valid after %d poses, %.1f seconds - final conditioning %.3f, residual %.4f", validPose + 1,
+                   (validPose + 1) * (MOVE_SAMPLES + HOLD_SAMPLES) * SAMPLE_INTERVAL / 1e6,
+                   fit.getConditioning(), fit.getResidual());
+    if (validPose < 0)
+        return hostTestResult();
+
+    double offset[3];
+    double corr[3][3];
+    double refOffset[3];
+    double refCorr[3][3];
+    float floatCorr[3][3];
+    double offsetError = 0;
+
+    fit.getCorr(floatCorr);
+    for (int row = 0; row < 3; row++) {
+        offset[row] = fit.getOffset().data(row);
+        refOffset[row] = ref[0][row];
+        offsetError = fmax(offsetError, fabs(offset[row] - refOffset[row]));
+        for (int col = 0; col < 3; col++) {
+            corr[row][col] = floatCorr[row][col];
+            refCorr[row][col] = ref[0][3 + row * 3 + col];
+        }
+    }
+
+    double rms = rmsError(raw, offset, corr);
+    double refRms = rmsError(raw, refOffset, refCorr);
+
+    HOSTTEST_CHECK(offsetError < OFFSET_LIMIT, "offset within %.4fg of accelCorr.dta", offsetError);
+    HOSTTEST_CHECK(rms < RMS_LIMIT * refRms, "accelRaw.dta corrected: rms |a| error %.4fg, accelCorr.dta %.4fg",
+                   rms, refRms);
+    return hostTestResult();
+}
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestAltitude sweeps RTAltitude::height() over 300 to 1100hPa in 0.01hPa steps against
+//  the barometric formula in double and checks the 7mm bound given in RTAltitude.h, for
+//  the standard sea level pressure and for low and high reference pressures. Outside the
+//  table it must give exactly what RTMath::convertPressureToHeight() gives, and depth()
+//  must match RTMath::convertPressureLatitudeToDepth().
+//
+//  The time per conversion of the table and of RTMath::convertPressureToHeight() (float
+//  pow()) is printed but not checked.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestAltitude TestAltitude.cpp
+//      ../libraries/RTIMULib/RTAltitude.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTAltitude.h"
+
+#include <chrono>
+
+#define PRESSURE_MIN                    300.0               // hPa
+#define PRESSURE_MAX                    1100.0
+#define PRESSURE_STEP                   0.01
+#define HEIGHT_LIMIT                    0.007               // m
+#define DEPTH_LIMIT                     1.0e-5              // relative
+#define LATITUDE                        32.13
+#define TIMING_CONVERSIONS              1000000
+#define TIMING_RUNS                     5
+
+static double heightError(RTAltitude& altitude, double staticPressure, double& powError)
+{
+    double worst = 0;
+
+    powError = 0;
+    altitude.setStaticPressure(staticPressure);
+    for (double p = PRESSURE_MIN; p <= PRESSURE_MAX; p += PRESSURE_STEP) {
+        double reference = RTALTITUDE_SCALE * (1 - pow(p / staticPressure, (double)RTALTITUDE_EXPONENT));
+
+        worst = fmax(worst, fabs(altitude.height(p) - reference));
+        powError = fmax(powError, fabs(RTMath::convertPressureToHeight(p, staticPressure) - reference));
+    }
+    return worst;
+}
+
+//  the fastest of a few runs, in ns per conversion
+
+template <typename F>
+static double timeConversions(F convert)
+{
+    volatile RTFLOAT sink = 0;
+    double best = 0;
+
+    for (int run = 0; run < TIMING_RUNS; run++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < TIMING_CONVERSIONS; i++)
+            sink = sink + convert(900.0f + (i & 1023) * 0.1f);
+
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                TIMING_CONVERSIONS;
+
+        if ((run == 0) || (ns < best))
+            best = ns;
+    }
+    return best;
+}
+
+int main()
+{
+    RTAltitude altitude(1013.25, LATITUDE);
+    static const double staticPressures[] = {1013.25, 950.0, 1050.0};
+
+    for (int i = 0; i < 3; i++) {
+        double powError;
+        double error = heightError(altitude, staticPressures[i], powError);
+
+        HOSTTEST_CHECK(error < HEIGHT_LIMIT, "P0 %.2fhPa: height within %.1fmm (float pow() %.1fmm)",
+                       staticPressures[i], error * 1000, powError * 1000);
+    }
+
+    //  outside the table (0.25 to 1.25 of P0) pow() is used
+
+    altitude.setStaticPressure(1013.25);
+
+    bool same = true;
+
+    for (RTFLOAT p = 50; p < 250; p += 1)
+        same &= altitude.height(p) == RTMath::convertPressureToHeight(p, 1013.25);
+    for (RTFLOAT p = 1270; p < 1500; p += 1)
+        same &= altitude.height(p) == RTMath::convertPressureToHeight(p, 1013.25);
+    HOSTTEST_CHECK(same, "outside the table: same as convertPressureToHeight()");
+
+    double depthError = 0;
+
+    for (double p = 1013.25; p < 50000; p += 0.5) {
+        double reference = RTMath::convertPressureLatitudeToDepth(p, 1013.25, LATITUDE);
+
+        depthError = fmax(depthError, fabs(altitude.depth(p) - reference) / fmax(1.0, fabs(reference)));
+    }
+    HOSTTEST_CHECK(depthError < DEPTH_LIMIT, "depth within %.2g of convertPressureLatitudeToDepth()", depthError);
+
+    double tableNs = timeConversions([&](RTFLOAT p) { return altitude.height(p); });
+    double powNs = timeConversions([](RTFLOAT p) { return RTMath::convertPressureToHeight(p, 1013.25f); });
+
+    printf("      height() %.1fns, convertPressureToHeight() %.1fns per conversion\n", tableNs, powNs);
+
+    return hostTestResult();
+}
@@ -0,0 +1,314 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestCalStore checks the RTIMULIB_CAL_STORE calibration record in the EEPROM stub, with
+//  no SD card so that RTIMUSettings saves to and loads from EEPROM. Each calibration is
+//  filled from a seed and identified by it when loaded again.
+//
+//  - a save and load must round trip, exactly apart from the Q13 matrices
+//  - a corrupted copy A or B must fall back to the other copy, and with both corrupted
+//    nothing is loaded
+//  - a save that changes nothing must not write the EEPROM
+//  - a save cut short after any number of writes must load the old calibration, and the
+//    new one once the last byte is written
+//  - the newest copy must still be found when the sequence number wraps from 0xffff to 0
+//
+//  The record size and the load time are printed. HAL_QUIET keeps the message from every
+//  load out of the output.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -DHAL_QUIET -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestCalStore
+//      TestCalStore.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+
+#include <EEPROM.h>
+#include <chrono>
+#include <random>
+
+#define COPY_A                          RTIMULIB_CAL_STORE_BASE
+#define COPY_B                          (RTIMULIB_CAL_STORE_BASE + sizeof(RTIMULIB_CAL_STORE))
+#define Q13_LIMIT                       (0.5f / RTIMULIB_CAL_STORE_MATRIX_SCALE)
+#define TEENSY4_EEPROM                  1080                // smallest EEPROM the store must fit
+#define TIMING_LOADS                    1000
+#define TIMING_RUNS                     5
+
+static void fillCal(RTIMUSettings& settings, int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> value(-1, 1);
+
+    settings.m_axisRotation = seed % 24;
+    settings.m_compassCalValid = settings.m_compassCalEllipsoidValid = true;
+    settings.m_accelCalValid = settings.m_accelCalEllipsoidValid = true;
+    settings.m_temperatureCalValid = settings.m_gyroBiasValid = settings.m_gyroCalCorrValid = true;
+
+    settings.m_compassCalMin = RTVector3(-50 + value(rng), -50 + value(rng), -50 + value(rng));
+    settings.m_compassCalMax = RTVector3(50 + value(rng), 50 + value(rng), 50 + value(rng));
+    settings.m_compassCalEllipsoidOffset = RTVector3(value(rng), value(rng), value(rng));
+    settings.m_accelCalMin = RTVector3(-1 + value(rng) / 20, -1 + value(rng) / 20, -1 + value(rng) / 20);
+    settings.m_accelCalMax = RTVector3(1 + value(rng) / 20, 1 + value(rng) / 20, 1 + value(rng) / 20);
+    settings.m_accelCalEllipsoidOffset = RTVector3(value(rng) / 20, value(rng) / 20, value(rng) / 20);
+    settings.m_gyroBias = RTVector3(value(rng) / 50, value(rng) / 50, value(rng) / 50);
+
+    for (int i = 0; i < 9; i++) {
+        settings.m_c0[i] = value(rng);
+        settings.m_c1[i] = value(rng) / 10;
+        settings.m_c2[i] = value(rng) / 100;
+        settings.m_c3[i] = value(rng) / 1000;
+    }
+    settings.m_senTemp_break = 20 + value(rng);
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            settings.m_compassCalEllipsoidCorr[i][j] = ((i == j) ? 1 : 0) + value(rng) / 10;
+            settings.m_accelCalEllipsoidCorr[i][j] = ((i == j) ? 1 : 0) + value(rng) / 10;
+            settings.m_gyroCalCorr[i][j] = ((i == j) ? 1 : 0) + value(rng) / 10;
+        }
+    }
+}
+
+//  calMatches() returns true if settings hold the calibration filled from seed
+
+static bool calMatches(RTIMUSettings& settings, int seed)
+{
+    RTIMUSettings expected;
+    bool same = true;
+
+    fillCal(expected, seed);
+
+    same &= settings.m_axisRotation == expected.m_axisRotation;
+    same &= settings.m_compassCalValid && settings.m_compassCalEllipsoidValid;
+    same &= settings.m_accelCalValid && settings.m_accelCalEllipsoidValid;
+    same &= settings.m_temperatureCalValid && settings.m_gyroBiasValid && settings.m_gyroCalCorrValid;
+
+    for (int i = 0; i < 3; i++) {
+        same &= settings.m_compassCalMin.data(i) == expected.m_compassCalMin.data(i);
+        same &= settings.m_compassCalMax.data(i) == expected.m_compassCalMax.data(i);
+        same &= settings.m_compassCalEllipsoidOffset.data(i) == expected.m_compassCalEllipsoidOffset.data(i);
+        same &= settings.m_accelCalMin.data(i) == expected.m_accelCalMin.data(i);
+        same &= settings.m_accelCalMax.data(i) == expected.m_accelCalMax.data(i);
+        same &= settings.m_accelCalEllipsoidOffset.data(i) == expected.m_accelCalEllipsoidOffset.data(i);
+        same &= settings.m_gyroBias.data(i) == expected.m_gyroBias.data(i);
+        for (int j = 0; j < 3; j++) {
+            same &= fabs(settings.m_compassCalEllipsoidCorr[i][j] - expected.m_compassCalEllipsoidCorr[i][j]) <= Q13_LIMIT;
+            same &= fabs(settings.m_accelCalEllipsoidCorr[i][j] - expected.m_accelCalEllipsoidCorr[i][j]) <= Q13_LIMIT;
+            same &= fabs(settings.m_gyroCalCorr[i][j] - expected.m_gyroCalCorr[i][j]) <= Q13_LIMIT;
+        }
+    }
+
+    for (int i = 0; i < 9; i++) {
+        same &= settings.m_c0[i] == expected.m_c0[i];
+        same &= settings.m_c1[i] == expected.m_c1[i];
+        same &= settings.m_c2[i] == expected.m_c2[i];
+        same &= settings.m_c3[i] == expected.m_c3[i];
+    }
+    same &= settings.m_senTemp_break == expected.m_senTemp_break;
+    return same;
+}
+
+//  loadedCal() loads the settings from EEPROM and returns the seed they were filled from,
+//  0 if nothing was loaded and -1 if they match none of the seeds
+
+static int loadedCal(int maxSeed)
+{
+    RTIMUSettings settings;
+
+    if (!settings.m_gyroCalCorrValid)
+        return 0;
+    for (int seed = 1; seed <= maxSeed; seed++) {
+        if (calMatches(settings, seed))
+            return seed;
+    }
+    return -1;
+}
+
+static void saveCal(int seed)
+{
+    RTIMUSettings settings;
+
+    fillCal(settings, seed);
+    settings.saveSettings();
+}
+
+static RTIMULIB_CAL_STORE readCopy(int address)
+{
+    RTIMULIB_CAL_STORE store;
+
+    memcpy(&store, EEPROM.m_data + address, sizeof(store));
+    return store;
+}
+
+//  writeCopy() replaces a copy with a good CRC, computed here as CRC-16/CCITT
+
+static void writeCopy(int address, RTIMULIB_CAL_STORE& store)
+{
+    const uint8_t *ptr = (const uint8_t *)&store;
+    uint16_t crc = 0xffff;
+
+    for (unsigned int i = 0; i < offsetof(RTIMULIB_CAL_STORE, crc); i++) {
+        crc ^= (uint16_t)ptr[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    store.crc = crc;
+    memcpy(EEPROM.m_data + address, &store, sizeof(store));
+}
+
+static void erase()
+{
+    memset(EEPROM.m_data, 0xff, sizeof(EEPROM.m_data));
+}
+
+int main()
+{
+    //  round trip, then a second save to copy B
+
+    erase();
+    saveCal(1);
+    HOSTTEST_CHECK(loadedCal(3) == 1, "round trip to copy A");
+    saveCal(2);
+    HOSTTEST_CHECK((loadedCal(3) == 2) && (readCopy(COPY_B).sequence == readCopy(COPY_A).sequence + 1),
+                   "round trip to copy B, sequence %d after %d", readCopy(COPY_B).sequence,
+                   readCopy(COPY_A).sequence);
+
+    uint8_t saved[E2END + 1];
+
+    memcpy(saved, EEPROM.m_data, sizeof(saved));
+
+    //  corrupted copies
+
+    EEPROM.m_data[COPY_B + 100] ^= 0x04;
+    HOSTTEST_CHECK(loadedCal(3) == 1, "copy B corrupted: copy A loaded");
+    EEPROM.m_data[COPY_A + 100] ^= 0x04;
+    HOSTTEST_CHECK(loadedCal(3) == 0, "both copies corrupted: nothing loaded");
+    memcpy(EEPROM.m_data, saved, sizeof(saved));
+    EEPROM.m_data[COPY_A + offsetof(RTIMULIB_CAL_STORE, crc)] ^= 0x80;
+    HOSTTEST_CHECK(loadedCal(3) == 2, "copy A corrupted: copy B loaded");
+    memcpy(EEPROM.m_data, saved, sizeof(saved));
+
+    //  saving an unchanged calibration
+
+    {
+        RTIMUSettings settings;
+
+        EEPROM.m_writes = 0;
+        settings.saveSettings();
+        HOSTTEST_CHECK((EEPROM.m_writes == 0) && (memcmp(saved, EEPROM.m_data, sizeof(saved)) == 0),
+                       "unchanged save: %d writes", EEPROM.m_writes);
+    }
+
+    //  a save of calibration 3 over copy A, cut short after every possible number of writes
+
+    int writes;
+
+    {
+        RTIMUSettings settings;
+
+        fillCal(settings, 3);
+        EEPROM.m_writes = 0;
+        settings.saveSettings();
+        writes = EEPROM.m_writes;
+    }
+
+    bool interrupted = true;
+    bool complete = false;
+
+    for (int limit = 0; limit <= writes; limit++) {
+        memcpy(EEPROM.m_data, saved, sizeof(saved));
+
+        RTIMUSettings settings;
+
+        fillCal(settings, 3);
+        EEPROM.m_writes = 0;
+        EEPROM.m_writeLimit = limit;
+        settings.saveSettings();
+        EEPROM.m_writeLimit = -1;
+
+        int loaded = loadedCal(3);
+
+        if (limit < writes)
+            interrupted &= loaded == 2;
+        else
+            complete = loaded == 3;
+    }
+    HOSTTEST_CHECK(interrupted, "save cut after 0 to %d of %d writes: old calibration loaded", writes - 1, writes);
+    HOSTTEST_CHECK(complete, "save completed: new calibration loaded");
+
+    //  sequence wraparound - copy A at 0xffff, the next save to copy B is 0
+
+    erase();
+    saveCal(1);
+
+    RTIMULIB_CAL_STORE store = readCopy(COPY_A);
+
+    store.sequence = 0xffff;
+    writeCopy(COPY_A, store);
+    HOSTTEST_CHECK(loadedCal(3) == 1, "copy A at sequence 0xffff loaded");
+
+    {
+        RTIMUSettings settings;
+
+        fillCal(settings, 2);
+        settings.saveSettings();
+    }
+    HOSTTEST_CHECK((readCopy(COPY_B).sequence == 0) && (loadedCal(3) == 2), "copy B at sequence %d loaded",
+                   readCopy(COPY_B).sequence);
+
+    {
+        RTIMUSettings settings;
+
+        fillCal(settings, 3);
+        settings.saveSettings();
+    }
+    HOSTTEST_CHECK((readCopy(COPY_A).sequence == 1) && (loadedCal(3) == 3), "copy A at sequence %d loaded",
+                   readCopy(COPY_A).sequence);
+
+    //  size and load time
+
+    int end = COPY_B + sizeof(RTIMULIB_CAL_STORE);
+
+    HOSTTEST_CHECK(end <= TEENSY4_EEPROM, "record %d bytes, copies A and B at %d and %d, end at %d of %d",
+                   (int)sizeof(RTIMULIB_CAL_STORE), (int)COPY_A, (int)COPY_B, end, TEENSY4_EEPROM);
+
+    RTIMUSettings settings;
+    double best = 0;
+
+    for (int run = 0; run < TIMING_RUNS; run++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < TIMING_LOADS; i++)
+            settings.loadSettings();
+
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+                TIMING_LOADS;
+
+        if ((run == 0) || (us < best))
+            best = us;
+    }
+    printf("      loadSettings() from EEPROM %.1fus\n", best);
+
+    return hostTestResult();
+}
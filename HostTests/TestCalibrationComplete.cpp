@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestCalibrationComplete checks when RTIMUMagCal and RTIMUAccCal say that enough data
+//  has been collected.
+//
+//  magRaw.dta is replayed through the ellipsoid station, and through the min/max station
+//  with a 40uT hard iron offset added. Both must complete before the end of the file but
+//  not within its first eighth, and the fit at completion must agree with magCorr.dta.
+//
+//  The accel min/max station is given six synthetic poses of 300 samples each, with a
+//  scale and offset error, a few degrees of wobble and noise. Clean holds must complete
+//  in the last pose, holds that wobble too much or are too short must not. The shipped
+//  accelRaw.dta is spacing filtered and has no held poses, so it must never complete.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestCalibrationComplete
+//      TestCalibrationComplete.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+#include "RTIMUMagCal.h"
+#include "RTIMUAccCal.h"
+
+#include <random>
+
+#define MAG_OFFSET_LIMIT                0.5                 // uT from magCorr.dta at completion
+#define MINMAX_CENTRE_LIMIT             2.0                 // uT, min/max box centre against magCorr.dta
+#define POSE_SAMPLES                    300                 // 3 seconds at 100Hz
+
+typedef std::vector<std::vector<double> > Rows;
+
+static void testMag(const Rows& raw, const Rows& corr, bool ellipsoid)
+{
+    const char *name = ellipsoid ? "mag ellipsoid" : "mag min/max";
+    RTVector3 hardIron = ellipsoid ? RTVector3(0, 0, 0) : RTVector3(20, -35, 12);
+    RTIMUSettings settings;
+
+    //  a symmetric min/max calibration passes the data to the ellipsoid fit unchanged
+
+    settings.m_compassCalValid = ellipsoid;
+    settings.m_compassCalMin = RTVector3(-50, -50, -50);
+    settings.m_compassCalMax = RTVector3(50, 50, 50);
+
+    RTIMUMagCal cal(&settings);
+    int complete = -1;
+
+    cal.magCalInit();
+    for (size_t i = 0; i < raw.size(); i++) {
+        RTVector3 sample = RTVector3(raw[i][0], raw[i][1], raw[i][2]) + hardIron;
+
+        if (ellipsoid)
+            cal.newEllipsoidData(sample);
+        else
+            cal.newMinMaxData(sample);
+        if (cal.calibrationComplete()) {
+            complete = i;
+            break;
+        }
+    }
+
+    HOSTTEST_CHECK(complete >= (int)raw.size() / 8,
+                   "%s: complete at sample %d of %d - coverage %.1f%%, conditioning %.3f, residual %.4f, change %.4f",
+                   name, complete, (int)raw.size(), cal.m_coverage.getCoverage(), cal.getConditioning(),
+                   cal.getResidual(), cal.getFitChange());
+    if (complete < 0)
+        return;
+
+    double error = 0;
+
+    if (ellipsoid) {
+        if (!cal.magCalSaveEllipsoid()) {
+            HOSTTEST_CHECK(false, "%s: save failed", name);
+            return;
+        }
+        for (int axis = 0; axis < 3; axis++)
+            error = fmax(error, fabs(settings.m_compassCalEllipsoidOffset.data(axis) - corr[0][axis]));
+        HOSTTEST_CHECK(error < MAG_OFFSET_LIMIT, "%s: offset at completion within %.3fuT of magCorr.dta", name, error);
+    } else {
+        RTVector3 centre = (cal.getMin() + cal.getMax()) * 0.5f - hardIron;
+
+        for (int axis = 0; axis < 3; axis++)
+            error = fmax(error, fabs(centre.data(axis) - corr[0][axis]));
+        HOSTTEST_CHECK(error < MINMAX_CENTRE_LIMIT, "%s: min/max centre at completion within %.3fuT of magCorr.dta",
+                       name, error);
+    }
+}
+
+//  synthPoses() holds each axis down then up for hold samples and returns the sample at
+//  which the station completed, or -1
+
+static int synthPoses(double noise, double wobbleDegrees, int hold, int& settled)
+{
+    RTIMUSettings settings;
+    RTIMUAccCal cal(&settings);
+    std::mt19937 rng(7);
+    std::normal_distribution<double> n(0, noise);
+    double wobble = wobbleDegrees * M_PI / 180;
+    int complete = -1;
+    int sample = 0;
+
+    cal.m_averageValue = RTVector3(0, 0, 0);
+    cal.accelCalReset();
+    for (int axis = 0; axis < 3; axis++)
+        cal.accelCalEnable(axis, true);
+
+    for (int pose = 0; pose < 6; pose++) {
+        int axis = pose / 2;
+        double sign = (pose & 1) ? 1 : -1;
+
+        for (int k = 0; k < hold; k++, sample++) {
+            double a = wobble * sin(k * 0.05);
+            double b = wobble * cos(k * 0.031);
+            double g[3];
+
+            g[axis] = sign * cos(a) * cos(b);
+            g[(axis + 1) % 3] = sin(a);
+            g[(axis + 2) % 3] = sin(b) * cos(a);
+            cal.newMinMaxData(RTVector3(g[0] * 1.01 + 0.01 + n(rng), g[1] * 0.99 - 0.02 + n(rng), g[2] + n(rng)));
+            if ((complete < 0) && cal.calibrationComplete())
+                complete = sample;
+        }
+    }
+    settled = cal.getSettledExtremes();
+    return complete;
+}
+
+static void testAccel(const Rows& raw)
+{
+    const double noises[3] = {0.002, 0.005, 0.01};
+    int settled;
+    int complete;
+
+    for (int i = 0; i < 3; i++) {
+        complete = synthPoses(noises[i], 3, POSE_SAMPLES, settled);
+        HOSTTEST_CHECK(complete >= 5 * POSE_SAMPLES, "accel, %.0fmg noise: complete at sample %d of %d",
+                       noises[i] * 1000, complete, 6 * POSE_SAMPLES);
+    }
+
+    complete = synthPoses(0.002, 10, POSE_SAMPLES, settled);
+    HOSTTEST_CHECK(complete < 0, "accel, 10 degree wobble: not complete, %d extremes settled", settled);
+    complete = synthPoses(0.002, 3, 40, settled);
+    HOSTTEST_CHECK(complete < 0, "accel, 0.4 second holds: not complete, %d extremes settled", settled);
+
+    RTIMUSettings settings;
+    RTIMUAccCal cal(&settings);
+
+    cal.m_averageValue = RTVector3(0, 0, 0);
+    cal.accelCalReset();
+    for (int axis = 0; axis < 3; axis++)
+        cal.accelCalEnable(axis, true);
+    complete = -1;
+    for (size_t i = 0; i < raw.size(); i++) {
+        cal.newMinMaxData(RTVector3(raw[i][0], raw[i][1], raw[i][2]));
+        if ((complete < 0) && cal.calibrationComplete())
+            complete = i;
+    }
+    HOSTTEST_CHECK(complete < 0, "accelRaw.dta: not complete, %d extremes settled", cal.getSettledExtremes());
+}
+
+int main()
+{
+    Rows magRaw;
+    Rows magCorr;
+    Rows accelRaw;
+
+    //  the ellipsoid test saves a calibration that later RTIMUSettings would load, so it
+    //  goes last
+
+    if (hostTestLoad(HOSTTEST_DATA "accelRaw.dta", accelRaw))
+        testAccel(accelRaw);
+    if (hostTestLoad(HOSTTEST_DATA "magRaw.dta", magRaw) && hostTestLoad(HOSTTEST_DATA "magCorr.dta", magCorr)) {
+        testMag(magRaw, magCorr, false);
+        testMag(magRaw, magCorr, true);
+    }
+    return hostTestResult();
+}
@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestCompassSmoother is the benchmark of the compass smoothing options at 100Hz, each
+//  with its default settings:
+//
+//  - noise is the rms output error at rest as a fraction of COMPASS_NOISE on the input
+//  - lag is the heading lag while the sensor turns at 90 and 10 degrees/s, no noise
+//  - cycles is the time stamp counter per update(), or ns where there is none
+//
+//  The boxcar must lag (N - 1) / 2 samples and the exponential its time constant, with the
+//  noise of an N sample mean and a first order low pass. The one euro filter must keep
+//  the noise of the boxcar within NOISE_MARGIN at rest and lag less than a quarter of it
+//  at 90 degrees/s.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestCompassSmoother TestCompassSmoother.cpp
+//      ../libraries/RTIMULib/RTCompassSmoother.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTCompassSmoother.h"
+
+#include <chrono>
+#include <random>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define SAMPLE_INTERVAL                 10000               // uS
+#define SETTLE_SAMPLES                  200
+#define NOISE_SAMPLES                   6000
+#define TURN_SAMPLES                    400
+#define COMPASS_NOISE                   0.5                 // uT rms on each axis
+#define HORIZONTAL_FIELD                20.0                // uT
+#define VERTICAL_FIELD                  -40.0
+#define LAG_LIMIT                       0.002               // seconds from the expected lag
+#define NOISE_LIMIT                     0.05                // from the expected noise
+#define NOISE_MARGIN                    1.3                 // one euro noise against the boxcar
+#define TIMING_UPDATES                  100000
+#define TIMING_RUNS                     5
+
+//  noise() returns the rms error of the output at rest, over the rms input noise
+
+static double noise(int type)
+{
+    RTCompassSmoother smoother;
+    std::mt19937 rng(48);
+    std::normal_distribution<double> n(0, COMPASS_NOISE);
+    RTVector3 field(HORIZONTAL_FIELD, 0, VERTICAL_FIELD);
+    uint64_t timestamp = 0;
+    double sumSq = 0;
+
+    smoother.setType(type);
+    for (int k = 0; k < SETTLE_SAMPLES + NOISE_SAMPLES; k++) {
+        RTVector3 mag(field.x() + n(rng), field.y() + n(rng), field.z() + n(rng));
+        RTVector3 error = smoother.update(mag, timestamp += SAMPLE_INTERVAL) - field;
+
+        if (k >= SETTLE_SAMPLES)
+            sumSq += error.squareLength() / 3;
+    }
+    return sqrt(sumSq / NOISE_SAMPLES) / COMPASS_NOISE;
+}
+
+//  lag() returns the mean heading lag in seconds while turning at rate degrees/s
+
+static double lag(int type, double rate)
+{
+    RTCompassSmoother smoother;
+    uint64_t timestamp = 0;
+    double sum = 0;
+
+    smoother.setType(type);
+    for (int k = 0; k < SETTLE_SAMPLES + TURN_SAMPLES; k++) {
+        double heading = rate * RTMATH_DEGREE_TO_RAD * k * SAMPLE_INTERVAL / 1e6;
+        RTVector3 mag(HORIZONTAL_FIELD * cos(heading), HORIZONTAL_FIELD * sin(heading), VERTICAL_FIELD);
+        const RTVector3& out = smoother.update(mag, timestamp += SAMPLE_INTERVAL);
+
+        if (k >= SETTLE_SAMPLES)
+            sum += remainder(heading - atan2(out.y(), out.x()), 2 * RTMATH_PI);
+    }
+    return sum / TURN_SAMPLES / (rate * RTMATH_DEGREE_TO_RAD);
+}
+
+//  cycles() returns the fastest of a few runs per update()
+
+static double cycles(int type)
+{
+    RTCompassSmoother smoother;
+    std::mt19937 rng(48);
+    std::normal_distribution<double> n(0, COMPASS_NOISE);
+    RTVector3 input[64];
+    volatile RTFLOAT sink = 0;
+    uint64_t timestamp = 0;
+    double best = 0;
+
+    for (int i = 0; i < 64; i++)
+        input[i] = RTVector3(HORIZONTAL_FIELD + n(rng), n(rng), VERTICAL_FIELD + n(rng));
+
+    smoother.setType(type);
+    for (int run = 0; run < TIMING_RUNS; run++) {
+#if defined(__i386__) || defined(__x86_64__)
+        uint64_t start = __rdtsc();
+#else
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+
+        for (int i = 0; i < TIMING_UPDATES; i++)
+            sink = sink + smoother.update(input[i & 63], timestamp += SAMPLE_INTERVAL).x();
+
+#if defined(__i386__) || defined(__x86_64__)
+        double perUpdate = (double)(__rdtsc() - start) / TIMING_UPDATES;
+#else
+        double perUpdate = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                TIMING_UPDATES;
+#endif
+
+        if ((run == 0) || (perUpdate < best))
+            best = perUpdate;
+    }
+    return best;
+}
+
+int main()
+{
+    double noiseRatio[RTCOMPASSSMOOTH_TYPE_COUNT];
+    double fastLag[RTCOMPASSSMOOTH_TYPE_COUNT];
+
+    printf("      %-12s %6s %9s %9s %7s\n", "", "noise", "lag 90/s", "lag 10/s", "cycles");
+    for (int type = 0; type < RTCOMPASSSMOOTH_TYPE_COUNT; type++) {
+        noiseRatio[type] = noise(type);
+        fastLag[type] = lag(type, 90);
+        printf("      %-12s %6.2f %7.0fmS %7.0fmS %7.0f\n", RTCompassSmoother::smootherName(type), noiseRatio[type],
+               fastLag[type] * 1000, lag(type, 10) * 1000, cycles(type));
+    }
+
+    double boxcarLag = (RTCOMPASSSMOOTH_LENGTH - 1) / 2.0 * SAMPLE_INTERVAL / 1e6;
+    double boxcarNoise = 1 / sqrt((double)RTCOMPASSSMOOTH_LENGTH);
+    double alpha = SAMPLE_INTERVAL / 1e6 / (SAMPLE_INTERVAL / 1e6 + RTCOMPASSSMOOTH_TIME_CONSTANT);
+    double exponentialNoise = sqrt(alpha / (2 - alpha));
+
+    HOSTTEST_CHECK((fabs(fastLag[RTCOMPASSSMOOTH_NONE]) < LAG_LIMIT) &&
+                   (fabs(noiseRatio[RTCOMPASSSMOOTH_NONE] - 1) < NOISE_LIMIT), "none: no lag, no smoothing");
+    HOSTTEST_CHECK((fabs(fastLag[RTCOMPASSSMOOTH_BOXCAR] - boxcarLag) < LAG_LIMIT) &&
+                   (fabs(noiseRatio[RTCOMPASSSMOOTH_BOXCAR] - boxcarNoise) < NOISE_LIMIT),
+                   "boxcar: lag %.0fmS and noise %.2f expected", boxcarLag * 1000, boxcarNoise);
+    HOSTTEST_CHECK((fabs(fastLag[RTCOMPASSSMOOTH_EXPONENTIAL] - RTCOMPASSSMOOTH_TIME_CONSTANT) < LAG_LIMIT) &&
+                   (fabs(noiseRatio[RTCOMPASSSMOOTH_EXPONENTIAL] - exponentialNoise) < NOISE_LIMIT),
+                   "exponential: lag %.0fmS and noise %.2f expected", RTCOMPASSSMOOTH_TIME_CONSTANT * 1000,
+                   exponentialNoise);
+    HOSTTEST_CHECK((noiseRatio[RTCOMPASSSMOOTH_ONE_EURO] < NOISE_MARGIN * noiseRatio[RTCOMPASSSMOOTH_BOXCAR]) &&
+                   (fastLag[RTCOMPASSSMOOTH_ONE_EURO] < fastLag[RTCOMPASSSMOOTH_BOXCAR] / 4),
+                   "one euro: noise within %.1f times and lag under a quarter of the boxcar", NOISE_MARGIN);
+    return hostTestResult();
+}
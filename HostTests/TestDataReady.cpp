@@ -0,0 +1,306 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestDataReady checks interrupt driven sampling.
+//
+//  RTIMUSampleRing - a producer thread stands in for the data ready interrupt and pushes
+//  numbered samples while the main thread pops them. Every sample that
+//  comes out must be whole and in order, and every sample pushed must either come out or
+//  be counted as an overflow.
+//
+//  RTIMU - a fake IMU with samples waiting is driven through IMUEnableDataReady(). One
+//  interrupt must empty the IMU, keep the ring depth of raw samples and count the rest as
+//  overflows, IMUGetSample() must run the processing for each of them outside the
+//  interrupt, and an interrupt landing in the middle of that processing must not disturb
+//  the sample being processed.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestDataReady
+//      TestDataReady.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+#include "RTIMUSampleRing.h"
+
+#include <thread>
+
+#define RING_SAMPLES                    200000              // samples pushed through the ring
+#define RING_DEPTH                      16
+#define IMU_DEPTH                       16
+#define IMU_PERIOD                      10000               // fake IMU sample period in uS
+
+extern void (*hostTestInterrupt)(void);
+
+//  the values of sample n, exact in float
+
+static void makeSample(int n, RTIMU_DATA& data)
+{
+    data.timestamp = (uint64_t)n * IMU_PERIOD;
+    data.gyroValid = true;
+    data.gyro = RTVector3(0.001f * (n % 1000), -0.002f * (n % 500), 0);
+    data.accelValid = true;
+    data.accel = RTVector3(0, 0, 1.0f + 0.0001f * (n % 100));
+    data.compassValid = true;
+    data.compassNew = true;
+    data.compass = RTVector3(20.0f + (n % 10), 5, -40);
+    data.temperatureValid = false;
+    data.temperature = 0;
+}
+
+static bool sameSample(int n, const RTIMU_DATA& data)
+{
+    RTIMU_DATA expected;
+
+    makeSample(n, expected);
+    return (data.timestamp == expected.timestamp) &&
+            (data.gyro.x() == expected.gyro.x()) && (data.gyro.y() == expected.gyro.y()) &&
+            (data.accel.z() == expected.accel.z()) && (data.compass.x() == expected.compass.x());
+}
+
+//  after processing gyro bias and compass smoothing have changed those fields but the
+//  uncalibrated accel is passed through
+
+static bool sameProcessedSample(int n, const RTIMU_DATA& data)
+{
+    RTIMU_DATA expected;
+
+    makeSample(n, expected);
+    return (data.timestamp == expected.timestamp) && (data.accel.z() == expected.accel.z());
+}
+
+static void testRing()
+{
+    RTIMUSampleRing ring(RING_DEPTH);
+    volatile bool done = false;
+
+    std::thread producer([&]() {
+        RTIMU_DATA data;
+
+        //  most samples wait for room so that plenty get through, every fourth is pushed
+        //  regardless to exercise the overflow path
+
+        for (int n = 0; n < RING_SAMPLES; n++) {
+            makeSample(n, data);
+            while (((n % 4) != 0) && (ring.count() >= RING_DEPTH))
+                std::this_thread::yield();
+            ring.push(data);
+        }
+        done = true;
+    });
+
+    RTIMU_DATA data;
+    long popped = 0;
+    long broken = 0;
+    long outOfOrder = 0;
+    int last = -1;
+    int passes = 0;
+
+    while (true) {
+        bool finished = done;
+
+        while (ring.pop(data)) {
+            int n = (int)(data.timestamp / IMU_PERIOD);
+
+            if (!sameSample(n, data))
+                broken++;
+            if (n <= last)
+                outOfOrder++;
+            last = n;
+            popped++;
+        }
+        if (finished)
+            break;
+
+        //  now and then fall behind, as loop() does when it is busy
+
+        if ((++passes % 256) == 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+
+    HOSTTEST_CHECK(broken == 0, "ring: %ld torn samples", broken);
+    HOSTTEST_CHECK(outOfOrder == 0, "ring: %ld samples out of order", outOfOrder);
+    HOSTTEST_CHECK(popped + (long)ring.overflows() == RING_SAMPLES, "ring: %ld popped + %lu overflows of %d",
+                   popped, ring.overflows(), RING_SAMPLES);
+    HOSTTEST_CHECK(ring.overflows() > 0 && ring.count() == 0, "ring: overflowed and drained");
+}
+
+//  FakeIMU has m_pending samples waiting in its "FIFO"
+
+class FakeIMU : public RTIMU
+{
+public:
+    FakeIMU(RTIMUSettings *settings) : RTIMU(settings)
+    {
+        m_pending = 0;
+        m_produced = 0;
+        m_processed = 0;
+        m_processedInInterrupt = 0;
+        m_interruptWhileProcessing = false;
+    }
+
+    virtual const char *IMUName() { return "Fake"; }
+    virtual int IMUType() { return RTIMU_TYPE_NULL; }
+    virtual int IMUGetPollInterval() { return IMU_PERIOD / 1000; }
+
+    virtual bool IMUInit()
+    {
+        m_sampleRate = 1000000 / IMU_PERIOD;
+        m_sampleInterval = IMU_PERIOD;
+        m_imuData.motion = true;
+        setCalibrationData();
+        gyroBiasInit();
+        return true;
+    }
+
+    virtual bool IMURead()
+    {
+        if (m_pending == 0)
+            return false;
+        m_pending--;
+
+        RTIMU_DATA raw;
+
+        makeSample(m_produced++, raw);
+        m_imuData.timestamp = raw.timestamp;
+        m_imuData.gyroValid = raw.gyroValid;
+        m_imuData.gyro = raw.gyro;
+        m_imuData.accelValid = raw.accelValid;
+        m_imuData.accel = raw.accel;
+        m_imuData.compassValid = raw.compassValid;
+        m_imuData.compassNew = raw.compassNew;
+        m_imuData.compass = raw.compass;
+        m_imuData.temperatureValid = raw.temperatureValid;
+        m_imuData.temperature = raw.temperature;
+
+        if (!m_readRawOnly)
+            IMUProcess();
+        return true;
+    }
+
+    int m_pending;
+    int m_produced;
+    int m_processed;
+    int m_processedInInterrupt;
+    bool m_interruptWhileProcessing;
+    int m_processingTimestampErrors;
+
+protected:
+    virtual bool IMUDataReadyInit() { return true; }
+
+    virtual void IMUProcess()
+    {
+        uint64_t timestamp = m_imuData.timestamp;
+
+        if (HALInInterrupt)
+            m_processedInInterrupt++;
+
+        //  two new samples arrive half way through the processing
+
+        if (m_interruptWhileProcessing && (hostTestInterrupt != NULL)) {
+            m_pending += 2;
+            hostTestInterrupt();
+        }
+        RTIMU::IMUProcess();
+        if (m_imuData.timestamp != timestamp)
+            m_processingTimestampErrors++;
+        m_processed++;
+    }
+};
+
+static void testIMU()
+{
+    RTIMUSettings settings;
+    FakeIMU imu(&settings);
+    RTIMU_DATA data;
+
+    imu.IMUInit();
+    imu.m_processingTimestampErrors = 0;
+
+    //  100 samples are already waiting when the interrupt is enabled
+
+    imu.m_pending = 100;
+    HOSTTEST_CHECK(imu.IMUEnableDataReady(2, IMU_DEPTH), "IMU: data ready enabled");
+    HOSTTEST_CHECK(imu.m_pending == 0, "IMU: %d samples left in the IMU", imu.m_pending);
+    HOSTTEST_CHECK(imu.IMUSamplesWaiting() == IMU_DEPTH && imu.IMUSampleOverflows() == 100 - IMU_DEPTH,
+                   "IMU: one interrupt moved %d samples into a ring of %d, %lu overflows",
+                   imu.IMUSamplesWaiting(), IMU_DEPTH, imu.IMUSampleOverflows());
+    HOSTTEST_CHECK(imu.m_processed == 0, "IMU: %d samples processed in the interrupt", imu.m_processed);
+
+    int next = 0;
+    int wrong = 0;
+
+    while (imu.IMUGetSample(data)) {
+        if (!sameProcessedSample(next++, data))
+            wrong++;
+    }
+    HOSTTEST_CHECK(next == IMU_DEPTH && wrong == 0 && imu.m_processed == IMU_DEPTH,
+                   "IMU: %d samples out, %d wrong, %d processed", next, wrong, imu.m_processed);
+    HOSTTEST_CHECK(data.fusionQPoseValid, "IMU: fusion ran on the samples");
+
+    //  interrupts now keep landing in the middle of IMUGetSample()'s processing, each with
+    //  two new samples so the ring fills and then overflows by one sample per pass
+
+    unsigned long overflows = imu.IMUSampleOverflows();
+    int popped = 0;
+    int outOfOrder = 0;
+    int last = -1;
+
+    imu.m_interruptWhileProcessing = true;
+    imu.m_pending = IMU_DEPTH / 2;
+    hostTestInterrupt();
+    for (int i = 0; (i < 500) && imu.IMUGetSample(data); i++) {
+        int n = (int)(data.timestamp / IMU_PERIOD);
+
+        if (!sameProcessedSample(n, data))
+            wrong++;
+        if (n <= last)
+            outOfOrder++;
+        last = n;
+        popped++;
+    }
+    HOSTTEST_CHECK(wrong == 0 && outOfOrder == 0 && imu.m_processingTimestampErrors == 0,
+                   "IMU: interrupt during processing - %d samples out, %d wrong, %d out of order, %d changed under processing",
+                   popped, wrong, outOfOrder, imu.m_processingTimestampErrors);
+    HOSTTEST_CHECK(imu.m_processedInInterrupt == 0, "IMU: %d samples processed in the interrupt",
+                   imu.m_processedInInterrupt);
+
+    overflows = imu.IMUSampleOverflows() - overflows;
+    HOSTTEST_CHECK(overflows > 0 && imu.m_pending == 0, "IMU: %lu overflows while behind, %d left in the IMU",
+                   overflows, imu.m_pending);
+    HOSTTEST_CHECK(next + popped + imu.IMUSamplesWaiting() + (int)imu.IMUSampleOverflows() == imu.m_produced,
+                   "IMU: %d out + %d waiting + %lu overflows of %d read from the IMU", next + popped,
+                   imu.IMUSamplesWaiting(), imu.IMUSampleOverflows(), imu.m_produced);
+
+    imu.IMUDisableDataReady();
+}
+
+int main()
+{
+    testRing();
+    testIMU();
+    return hostTestResult();
+}
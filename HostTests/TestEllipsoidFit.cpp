@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestEllipsoidFit checks RTEllipsoidFit against the Octave scripts: fitting
+//  magRaw.dta and accelRaw.dta must give the offset and correction matrix in
+//  magCorr.dta and accelCorr.dta (written by RTEllipsoidFitMag.m and
+//  RTEllipsoidFitAccel.m to six decimals). The double fit used by RTCalFit must match
+//  to the printed precision and the float fit used on the device to 1e-3 of the radius.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestEllipsoidFit TestEllipsoidFit.cpp
+//      ../libraries/RTIMULib/RTEllipsoidFit.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTEllipsoidFit.h"
+
+static void checkFit(const char *rawName, const char *corrName)
+{
+    std::vector<std::vector<double> > raw;
+    std::vector<std::vector<double> > corr;
+
+    if (!hostTestLoad(rawName, raw) || !hostTestLoad(corrName, corr))
+        return;
+
+    RTEllipsoidFit fit;
+    double offset[3];
+    double matrix[3][3];
+    RTVector3 floatOffset;
+    float floatMatrix[3][3];
+
+    for (size_t i = 0; i < raw.size(); i++)
+        fit.addSample(RTVector3(raw[i][0], raw[i][1], raw[i][2]));
+
+    HOSTTEST_CHECK(fit.fit(offset, matrix), "%s: double fit of %d samples", rawName, fit.getSampleCount());
+    HOSTTEST_CHECK(fit.fit(floatOffset, floatMatrix), "%s: float fit", rawName);
+
+    const std::vector<double>& ref = corr[0];
+    double radius = fit.getRadii().x();
+    double offsetError = 0;
+    double matrixError = 0;
+    double floatOffsetError = 0;
+    double floatMatrixError = 0;
+
+    for (int i = 1; i < 3; i++)
+        radius = fmin(radius, fit.getRadii().data(i));
+
+    for (int i = 0; i < 3; i++) {
+        offsetError = fmax(offsetError, fabs(offset[i] - ref[i]));
+        floatOffsetError = fmax(floatOffsetError, fabs(floatOffset.data(i) - ref[i]));
+        for (int j = 0; j < 3; j++) {
+            matrixError = fmax(matrixError, fabs(matrix[i][j] - ref[3 + i * 3 + j]));
+            floatMatrixError = fmax(floatMatrixError, fabs(floatMatrix[i][j] - ref[3 + i * 3 + j]));
+        }
+    }
+
+    //  the reference is rounded to 6 decimals, allow for that plus a last digit
+
+    HOSTTEST_CHECK(offsetError < 2e-6, "%s: double offset error %g", corrName, offsetError);
+    HOSTTEST_CHECK(matrixError < 2e-6, "%s: double matrix error %g", corrName, matrixError);
+    HOSTTEST_CHECK(floatOffsetError < 1e-3 * radius, "%s: float offset error %g (radius %g)",
+                   corrName, floatOffsetError, radius);
+    HOSTTEST_CHECK(floatMatrixError < 1e-3, "%s: float matrix error %g", corrName, floatMatrixError);
+}
+
+int main()
+{
+    checkFit(HOSTTEST_DATA "magRaw.dta", HOSTTEST_DATA "magCorr.dta");
+    checkFit(HOSTTEST_DATA "accelRaw.dta", HOSTTEST_DATA "accelCorr.dta");
+    return hostTestResult();
+}
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestFastMath sweeps the RTMath fast approximations against libm in double and checks
+//  the worst case errors documented in RTMath.h.
+//
+//  sin and cos are swept over RTMATH_FAST_TRIG_RANGE, where the polynomials are used, and
+//  then at arguments far beyond it, including ones too large for an int, where they must
+//  give the libm value.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestFastMath TestFastMath.cpp
+//      ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTMath.h"
+
+#define TRIG_LIMIT                      1.9e-7
+#define ATAN_LIMIT                      2.0e-6              // rad
+#define ASIN_LIMIT                      1.4e-6              // rad
+#define INVSQRT_LIMIT                   4.8e-6              // relative
+#define SWEEP_STEPS                     2000000
+
+static void testTrig()
+{
+    double sinError = 0;
+    double cosError = 0;
+    float sinWorst = 0;
+    float cosWorst = 0;
+
+    for (int i = -SWEEP_STEPS; i <= SWEEP_STEPS; i++) {
+        float x = RTMATH_FAST_TRIG_RANGE * i / SWEEP_STEPS;
+        float y = 8.0f * i / SWEEP_STEPS;
+
+        for (int k = 0; k < 2; k++) {
+            float v = k ? y : x;
+            double e = fabs(RTMath::fastSin(v) - sin((double)v));
+            double c = fabs(RTMath::fastCos(v) - cos((double)v));
+
+            if (e > sinError) {
+                sinError = e;
+                sinWorst = v;
+            }
+            if (c > cosError) {
+                cosError = c;
+                cosWorst = v;
+            }
+        }
+    }
+    HOSTTEST_CHECK(sinError < TRIG_LIMIT, "sin: worst error %.3g at %g", sinError, sinWorst);
+    HOSTTEST_CHECK(cosError < TRIG_LIMIT, "cos: worst error %.3g at %g", cosError, cosWorst);
+
+    const RTFLOAT large[] = {8193.0f, -10000.5f, 1.0e6f, -3.0e9f, 1.0e10f, 3.0e38f};
+    int mismatches = 0;
+
+    for (size_t i = 0; i < sizeof(large) / sizeof(large[0]); i++) {
+        if ((RTMath::fastSin(large[i]) != (RTFLOAT)sin((RTFLOAT)large[i])) ||
+                (RTMath::fastCos(large[i]) != (RTFLOAT)cos((RTFLOAT)large[i])))
+            mismatches++;
+    }
+    HOSTTEST_CHECK(mismatches == 0, "sin, cos beyond %.0f rad: %d differ from libm", RTMATH_FAST_TRIG_RANGE,
+                   mismatches);
+}
+
+static void testInverseTrig()
+{
+    double atanError = 0;
+    double asinError = 0;
+    double invSqrtError = 0;
+
+    for (int i = 0; i < SWEEP_STEPS; i++) {
+        double angle = 2 * M_PI * i / SWEEP_STEPS;
+        float y = 3.0f * sin(angle);
+        float x = 3.0f * cos(angle);
+        float v = -1.0f + 2.0f * i / SWEEP_STEPS;
+        float w = ldexp(1.0 + (double)i / SWEEP_STEPS, (i % 40) - 20);
+
+        atanError = fmax(atanError, fabs(RTMath::fastAtan2(y, x) - atan2((double)y, (double)x)));
+        asinError = fmax(asinError, fabs(RTMath::fastAsin(v) - asin((double)v)));
+        asinError = fmax(asinError, fabs(RTMath::fastAcos(v) - acos((double)v)));
+        invSqrtError = fmax(invSqrtError, fabs(RTMath::fastInvSqrt(w) * sqrt((double)w) - 1));
+    }
+    HOSTTEST_CHECK(atanError < ATAN_LIMIT, "atan2: worst error %.2g rad", atanError);
+    HOSTTEST_CHECK(asinError < ASIN_LIMIT, "asin, acos: worst error %.2g rad", asinError);
+    HOSTTEST_CHECK(invSqrtError < INVSQRT_LIMIT, "1/sqrt: worst error %.2g relative", invSqrtError);
+}
+
+int main()
+{
+    testTrig();
+    testInverseTrig();
+    return hostTestResult();
+}
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestFusionStaleCompass runs each fusion filter on a level, still sensor heading 0.
+//  The compass then swings 90 degrees but every sample is flagged stale, as a driver
+//  does when the magnetometer has not updated since its last read. The heading must
+//  hold. Once the same samples are flagged fresh the heading must move towards 90
+//  degrees.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestFusionStaleCompass
+//      TestFusionStaleCompass.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+#include "RTFusionKalman4.h"
+#include "RTFusionRTQF.h"
+#include "RTFusionAHRS.h"
+
+#define SAMPLE_INTERVAL                 10000               // uS
+#define SAMPLES                         500
+#define STALE_LIMIT                     0.5                 // degrees of heading change while stale
+#define FRESH_MOVE                      10.0                // degrees of heading change once fresh
+
+//  run() feeds samples with the compass at the given heading and returns the fused heading
+
+static double run(RTFusion& fusion, RTIMUSettings& settings, uint64_t& timestamp, double heading, bool fresh,
+                  int samples)
+{
+    RTIMU_DATA data = RTIMU_DATA();
+
+    data.gyroValid = data.accelValid = data.compassValid = true;
+    data.gyro = RTVector3(0, 0, 0);
+    data.accel = RTVector3(0, 0, 1);
+    data.compassNew = fresh;
+    data.compass = RTVector3(30 * cos(-heading * RTMATH_DEGREE_TO_RAD), 30 * sin(-heading * RTMATH_DEGREE_TO_RAD), 0);
+
+    for (int i = 0; i < samples; i++) {
+        data.timestamp = timestamp += SAMPLE_INTERVAL;
+        fusion.newIMUData(data, &settings);
+    }
+    return data.fusionPose.z() * RTMATH_RAD_TO_DEGREE;
+}
+
+static void testFusion(RTFusion& fusion)
+{
+    RTIMUSettings settings;
+    uint64_t timestamp = 0;
+
+    settings.m_compassAdjDeclination = 0;
+    double start = run(fusion, settings, timestamp, 0, true, SAMPLES);
+    double stale = run(fusion, settings, timestamp, 90, false, SAMPLES);
+    double fresh = run(fusion, settings, timestamp, 90, true, SAMPLES);
+    const char *name = RTFusion::fusionName(fusion.fusionType());
+
+    HOSTTEST_CHECK(fabs(stale - start) < STALE_LIMIT, "%s: heading %.2f after stale samples, %.2f before",
+                   name, stale, start);
+    HOSTTEST_CHECK(fabs(fresh - start) > FRESH_MOVE, "%s: heading %.2f after fresh samples", name, fresh);
+}
+
+int main()
+{
+    RTFusionKalman4 kalman;
+    RTFusionRTQF rtqf;
+    RTFusionAHRS ahrs;
+
+    testFusion(kalman);
+    testFusion(rtqf);
+    testFusion(ahrs);
+    return hostTestResult();
+}
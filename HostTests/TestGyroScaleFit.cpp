@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestGyroScaleFit puts a simulated sensor on a rotation table and feeds RTIMUGyroCal
+//  at 200Hz. The gyro reads M * w + bias + noise for a known scale and misalignment
+//  matrix M, the accel and compass read gravity and the field in body axes with noise.
+//  The table turns 90 degrees about each axis and back, then about four oblique axes,
+//  each turn a 1 second raised cosine rate profile followed by a 1 second hold.
+//
+//  Every turn must be accepted, the fit saved to the settings must recover inverse(M) to
+//  within CORR_LIMIT and the corrected gyro must integrate a fresh turn to within
+//  ANGLE_LIMIT. Turns about the z axis alone must not be enough for a fit.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestGyroScaleFit
+//      TestGyroScaleFit.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+#include "RTIMUGyroCal.h"
+
+#include <random>
+
+#define SAMPLE_INTERVAL                 5000                // uS
+#define TURN_SAMPLES                    200
+#define HOLD_SAMPLES                    200
+#define GYRO_NOISE                      0.002               // rad/s
+#define ACCEL_NOISE                     0.002               // g
+#define COMPASS_NOISE                   0.3                 // uT
+#define CORR_LIMIT                      0.003               // largest element error of the fit
+#define ANGLE_LIMIT                     0.002               // rad after a corrected 90 degree turn
+
+//  the gyro scale and misalignment
+
+static const double M[3][3] = {{1.030, 0.012, -0.008}, {-0.015, 0.970, 0.010}, {0.006, 0.018, 1.015}};
+static const float identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+static const double gravity[3] = {0, 0, 1};
+static const double field[3] = {22, 0, -40};
+
+class Table
+{
+public:
+    Table() : m_rng(46), m_noise(0, 1), m_timestamp(0)
+    {
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 3; col++)
+                m_pose[row][col] = (row == col) ? 1 : 0;
+        }
+    }
+
+    //  turn() rotates the table by angle about the body axis, then holds it still
+
+    void turn(RTIMUGyroCal& cal, const RTVector3& bias, double x, double y, double z, double angle)
+    {
+        double length = sqrt(x * x + y * y + z * z);
+        double axis[3] = {x / length, y / length, z / length};
+
+        for (int k = 0; k < TURN_SAMPLES; k++) {
+            double rate = angle * (1 - cos(2 * M_PI * (k + 0.5) / TURN_SAMPLES)) / (TURN_SAMPLES * SAMPLE_INTERVAL / 1e6);
+
+            sample(cal, bias, axis, rate);
+        }
+        for (int k = 0; k < HOLD_SAMPLES; k++)
+            sample(cal, bias, axis, 0);
+    }
+
+    //  corrected() turns the table once more and returns the error of the integrated
+    //  rate through corr along the axis
+
+    double corrected(const float corr[3][3], double x, double y, double z, double angle)
+    {
+        double length = sqrt(x * x + y * y + z * z);
+        double axis[3] = {x / length, y / length, z / length};
+        double integrated[3] = {0, 0, 0};
+
+        for (int k = 0; k < TURN_SAMPLES; k++) {
+            double rate = angle * (1 - cos(2 * M_PI * (k + 0.5) / TURN_SAMPLES)) / (TURN_SAMPLES * SAMPLE_INTERVAL / 1e6);
+            double gyro[3];
+
+            for (int row = 0; row < 3; row++) {
+                gyro[row] = 0;
+                for (int col = 0; col < 3; col++)
+                    gyro[row] += M[row][col] * axis[col] * rate;
+            }
+            for (int row = 0; row < 3; row++) {
+                for (int col = 0; col < 3; col++)
+                    integrated[row] += corr[row][col] * gyro[col] * SAMPLE_INTERVAL / 1e6;
+            }
+        }
+
+        double error = 0;
+
+        for (int row = 0; row < 3; row++)
+            error += (integrated[row] - axis[row] * angle) * (integrated[row] - axis[row] * angle);
+        return sqrt(error);
+    }
+
+private:
+    void sample(RTIMUGyroCal& cal, const RTVector3& bias, const double *axis, double rate)
+    {
+        double step = rate * SAMPLE_INTERVAL / 1e6;
+        double c = cos(step);
+        double s = sin(step);
+        double rotation[3][3];
+        double pose[3][3];
+
+        //  the table pose is body to world, turned about the body axis by Rodrigues
+
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 3; col++)
+                rotation[row][col] = ((row == col) ? c : 0) + (1 - c) * axis[row] * axis[col];
+        }
+        rotation[0][1] -= s * axis[2]; rotation[1][0] += s * axis[2];
+        rotation[0][2] += s * axis[1]; rotation[2][0] -= s * axis[1];
+        rotation[1][2] -= s * axis[0]; rotation[2][1] += s * axis[0];
+
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 3; col++) {
+                pose[row][col] = 0;
+                for (int k = 0; k < 3; k++)
+                    pose[row][col] += m_pose[row][k] * rotation[k][col];
+            }
+        }
+        memcpy(m_pose, pose, sizeof(pose));
+
+        RTVector3 gyro, accel, compass;
+
+        for (int row = 0; row < 3; row++) {
+            double g = bias.data(row) + GYRO_NOISE * m_noise(m_rng);
+            double a = ACCEL_NOISE * m_noise(m_rng);
+            double m = COMPASS_NOISE * m_noise(m_rng);
+
+            for (int col = 0; col < 3; col++) {
+                g += M[row][col] * axis[col] * rate;
+                a += m_pose[col][row] * gravity[col];
+                m += m_pose[col][row] * field[col];
+            }
+            gyro.setData(row, g);
+            accel.setData(row, a);
+            compass.setData(row, m);
+        }
+        cal.newRotationData(gyro, accel, compass, m_timestamp += SAMPLE_INTERVAL);
+    }
+
+    std::mt19937 m_rng;
+    std::normal_distribution<double> m_noise;
+    uint64_t m_timestamp;
+    double m_pose[3][3];
+};
+
+int main()
+{
+    RTIMUSettings settings;
+    RTVector3 bias(0.02, -0.015, 0.01);
+    double inverse[3][3];
+
+    settings.m_gyroBias = bias;
+    settings.m_gyroBiasValid = true;
+
+    //  the fit should recover inverse(M), by cofactors
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            inverse[col][row] = M[(row + 1) % 3][(col + 1) % 3] * M[(row + 2) % 3][(col + 2) % 3] -
+                    M[(row + 1) % 3][(col + 2) % 3] * M[(row + 2) % 3][(col + 1) % 3];
+    }
+
+    double determinant = M[0][0] * inverse[0][0] + M[0][1] * inverse[1][0] + M[0][2] * inverse[2][0];
+
+    //  turns about one axis leave the other two unexcited
+
+    {
+        RTIMUGyroCal cal(&settings);
+        Table table;
+
+        cal.gyroCalInit();
+        for (int i = 0; i < 8; i++)
+            table.turn(cal, bias, 0, 0, 1, (i & 1) ? -M_PI / 2 : M_PI / 2);
+        HOSTTEST_CHECK(!cal.gyroCalCorrValid(), "z turns only: %d rotations, excitation %.2frad, not valid",
+                       cal.m_scaleFit.getRotationCount(), cal.m_scaleFit.getExcitation());
+    }
+
+    RTIMUGyroCal cal(&settings);
+    Table table;
+    static const double axes[][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}, {0, 1, -1}, {-1, 0, 1}, {1, 1, 1}};
+    int turns = 0;
+
+    cal.gyroCalInit();
+    table.turn(cal, bias, 1, 0, 0, 0);
+    for (int i = 0; i < 7; i++) {
+        table.turn(cal, bias, axes[i][0], axes[i][1], axes[i][2], M_PI / 2);
+        table.turn(cal, bias, axes[i][0], axes[i][1], axes[i][2], -M_PI / 2);
+        turns += 2;
+    }
+
+    HOSTTEST_CHECK((cal.m_scaleFit.getRotationCount() == turns) && (cal.m_scaleFit.getRejectedCount() == 0),
+                   "%d of %d turns accepted, %d rejected", cal.m_scaleFit.getRotationCount(), turns,
+                   cal.m_scaleFit.getRejectedCount());
+    HOSTTEST_CHECK(cal.gyroCalCorrValid(), "valid, excitation %.2frad", cal.m_scaleFit.getExcitation());
+    HOSTTEST_CHECK(cal.gyroCalSaveCorr() && settings.m_gyroCalCorrValid, "correction saved");
+
+    double corrError = 0;
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            corrError = fmax(corrError, fabs(settings.m_gyroCalCorr[row][col] - inverse[row][col] / determinant));
+    }
+    HOSTTEST_CHECK(corrError < CORR_LIMIT, "correction within %.4f of inverse(M)", corrError);
+
+    double angleError = table.corrected(settings.m_gyroCalCorr, 1, -2, 0.5, M_PI / 2);
+
+    double rawError = table.corrected(identity, 1, -2, 0.5, M_PI / 2);
+
+    HOSTTEST_CHECK(angleError < ANGLE_LIMIT, "corrected 90 degree turn within %.3f degrees (uncorrected %.2f)",
+                   angleError * RTMATH_RAD_TO_DEGREE, rawError * RTMATH_RAD_TO_DEGREE);
+    return hostTestResult();
+}
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestI2CBlock measures a 352 byte MPU9250 cache block (16 samples of 22 bytes) read
+//  through the FIFO port on the simulated I2C bus, as I2Cdev::readBytes() BUFFER_LENGTH
+//  chunks and as one I2Cdev::readBlock(). Each readBytes() chunk selects the register
+//  again, readBlock() selects it once and then only reads, in I2CDEV_BLOCK_LENGTH
+//  chunks. The transactions, bytes and bus time of both are reported and the data
+//  must come out in order either way.
+//
+//  run.sh builds it twice, with the stock Wire block length and with the 259 byte
+//  i2c_t3 receive buffer (-DI2CDEV_BLOCK_LENGTH=259).
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestI2CBlock
+//      TestI2CBlock.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "I2Cdev.h"
+
+#include <Wire.h>
+
+#define DEVICE_ADDRESS                  0x68
+#define FIFO_PORT                       0x74                // MPU9250_FIFO_R_W
+#define BLOCK_LENGTH                    352                 // MPU9250_CACHE_SIZE * MPU9250_FIFO_CHUNK_SIZE
+#define BUS_CLOCK                       400000
+
+//  FifoModel returns a byte counter from its FIFO port, so a chunk that is lost,
+//  repeated or re-addressed wrongly shows up in the data
+
+class FifoModel : public HostTestI2CDevice
+{
+public:
+    FifoModel() : m_pointer(0), m_next(0) {}
+
+    virtual void i2cWrite(const uint8_t *data, int length)
+    {
+        if (length > 0)
+            m_pointer = data[0];
+    }
+
+    virtual void i2cRead(uint8_t *data, int length)
+    {
+        for (int i = 0; i < length; i++)
+            data[i] = (m_pointer == FIFO_PORT) ? m_next++ : 0;
+    }
+
+    void reset() { m_next = 0; }
+
+private:
+    uint8_t m_pointer;
+    uint8_t m_next;
+};
+
+static bool inOrder(const uint8_t *data, int length)
+{
+    for (int i = 0; i < length; i++) {
+        if (data[i] != (uint8_t)i)
+            return false;
+    }
+    return true;
+}
+
+static void report(const char *name)
+{
+    printf("%-20s %3lu transactions %4lu bytes %6.0f uS %6.1f kB/s\n", name, Wire.transactions,
+           Wire.bytes, (double)Wire.busMicros, BLOCK_LENGTH * 1000.0 / (double)Wire.busMicros);
+}
+
+int main()
+{
+    FifoModel fifo;
+    uint8_t data[BLOCK_LENGTH];
+
+    Wire.attach(DEVICE_ADDRESS, &fifo);
+    Wire.setClock(BUS_CLOCK);
+
+    printf("%d byte block at %dkHz, I2CDEV_BLOCK_LENGTH %d\n", BLOCK_LENGTH, BUS_CLOCK / 1000, I2CDEV_BLOCK_LENGTH);
+
+    //  before - BUFFER_LENGTH readBytes() chunks, each a register write and a read
+
+    int count = 0;
+
+    fifo.reset();
+    memset(data, 0, sizeof(data));
+    Wire.resetStats();
+    while (count < BLOCK_LENGTH) {
+        int chunk = BLOCK_LENGTH - count;
+        if (chunk > BUFFER_LENGTH)
+            chunk = BUFFER_LENGTH;
+        if (I2Cdev::readBytes(DEVICE_ADDRESS, FIFO_PORT, chunk, data + count) != chunk)
+            break;
+        count += chunk;
+    }
+    report("readBytes chunks");
+
+    unsigned long chunks = (BLOCK_LENGTH + BUFFER_LENGTH - 1) / BUFFER_LENGTH;
+    uint64_t beforeMicros = Wire.busMicros;
+
+    HOSTTEST_CHECK(count == BLOCK_LENGTH && inOrder(data, BLOCK_LENGTH), "readBytes: %d bytes read in order", count);
+    HOSTTEST_CHECK(Wire.transactions == 2 * chunks, "readBytes: %lu transactions for %lu chunks",
+                   Wire.transactions, chunks);
+
+    //  after - one register write, then I2CDEV_BLOCK_LENGTH reads
+
+    fifo.reset();
+    memset(data, 0, sizeof(data));
+    Wire.resetStats();
+    count = I2Cdev::readBlock(DEVICE_ADDRESS, FIFO_PORT, BLOCK_LENGTH, data);
+    report("readBlock");
+
+    chunks = (BLOCK_LENGTH + I2CDEV_BLOCK_LENGTH - 1) / I2CDEV_BLOCK_LENGTH;
+
+    HOSTTEST_CHECK(count == BLOCK_LENGTH && inOrder(data, BLOCK_LENGTH), "readBlock: %d bytes read in order", count);
+    HOSTTEST_CHECK(Wire.transactions == 1 + chunks, "readBlock: %lu transactions for %lu chunks",
+                   Wire.transactions, chunks);
+    HOSTTEST_CHECK(Wire.busMicros < beforeMicros, "readBlock: %.0f%% of the readBytes bus time",
+                   100.0 * (double)Wire.busMicros / (double)beforeMicros);
+
+    //  a device that doesn't answer fails the read rather than returning stale data
+
+    HOSTTEST_CHECK(I2Cdev::readBlock(DEVICE_ADDRESS + 1, FIFO_PORT, BLOCK_LENGTH, data) == -1,
+                   "readBlock: missing device fails");
+
+    return hostTestResult();
+}
@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestInertialNav walks a synthetic foot mounted sensor round a 5m square through
+//  RTInertialNav. Each side is five 1m strides, each stride a 0.6s swing with a 0.1m
+//  foot lift followed by 0.6s flat on the ground, and each corner a 90 degree turn on the
+//  spot. The walk starts and ends with the sensor at rest.
+//
+//  The accel has a bias in every axis plus noise. The fusion pose is given the tilt a
+//  real accel based pose settles to, one that puts the biased accel exactly on gravity,
+//  so only the bias along gravity can be learnt. That component must be recovered, no
+//  bias across gravity may be invented, every corner must be found and the walk must
+//  close on its start. The tilt left in the pose turns some of each stride's forward
+//  movement into height, so the height may drift by up to the tilt times the distance
+//  walked but no more.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestInertialNav TestInertialNav.cpp
+//      ../libraries/RTIMULib/RTInertialNav.cpp ../libraries/RTIMULib/RTIMUStillDetector.cpp
+//      ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTInertialNav.h"
+
+#include <random>
+
+#define SAMPLE_RATE                     200                 // Hz
+#define SIDE_STRIDES                    5
+#define STRIDE_LENGTH                   1.0                 // m
+#define STRIDE_TIME                     0.6                 // s in the air
+#define FOOT_LIFT                       0.1                 // m
+#define REST_TIME                       0.6                 // s on the ground after each stride or turn
+#define START_REST                      3.0                 // s at rest before the walk
+
+#define ACCEL_NOISE                     0.002               // g
+#define GYRO_NOISE                      0.002               // rad/s
+#define BIAS_X                          0.003               // g
+#define BIAS_Y                          -0.002
+#define BIAS_Z                          0.004
+
+#define BIAS_LIMIT                      0.0005              // g
+#define CORNER_LIMIT                    0.15                // m
+#define CLOSURE_LIMIT                   0.2                 // m, 1% of the walk
+#define HEIGHT_LIMIT                    0.01                // m on top of the drift from the tilt
+
+class Walk
+{
+public:
+    Walk() : m_rng(1), m_accelNoise(0, ACCEL_NOISE), m_gyroNoise(0, GYRO_NOISE), m_time(0), m_heading(0)
+    {
+        RTVector3 measured(BIAS_X, BIAS_Y, 1 + BIAS_Z);
+
+        //  the tilt that turns the body's gravity (0, 0, 1) onto the biased accel at rest
+
+        measured.normalize();
+        RTVector3 axis;
+        RTVector3::crossProduct(measured, RTVector3(0, 0, 1), axis);
+        RTFLOAT angle = asin(axis.length());
+        axis.normalize();
+        m_tilt.fromAngleVector(angle, axis);
+    }
+
+    //  rest, stride and turn feed the navigator sample by sample and return false if it
+    //  never saw the sensor at rest during a rest period
+
+    bool rest(RTInertialNav& nav, double duration)
+    {
+        bool stationary = false;
+
+        for (int i = 0; i < (int)(duration * SAMPLE_RATE); i++) {
+            sample(nav, RTVector3(0, 0, 0), 0);
+            stationary |= nav.isStationary();
+        }
+        return stationary;
+    }
+
+    void stride(RTInertialNav& nav)
+    {
+        double w = 2 * M_PI / STRIDE_TIME;
+
+        for (int i = 0; i < (int)(STRIDE_TIME * SAMPLE_RATE); i++) {
+            double t = (i + 0.5) / SAMPLE_RATE;
+            double forward = STRIDE_LENGTH / STRIDE_TIME * w * sin(w * t);
+            double up = FOOT_LIFT / 2 * w * w * cos(w * t);
+
+            sample(nav, RTVector3(forward * cos(m_heading), forward * sin(m_heading), up), 0);
+        }
+    }
+
+    void turn(RTInertialNav& nav, double angle)
+    {
+        double w = 2 * M_PI / STRIDE_TIME;
+
+        for (int i = 0; i < (int)(STRIDE_TIME * SAMPLE_RATE); i++) {
+            double rate = angle / STRIDE_TIME * (1 - cos(w * (i + 0.5) / SAMPLE_RATE));
+
+            m_heading += rate / SAMPLE_RATE;
+            sample(nav, RTVector3(0, 0, 0), rate);
+        }
+    }
+
+private:
+    //  world acceleration in m/s/s and yaw rate in rad/s to a biased, noisy sample with the
+    //  accel aligned pose
+
+    void sample(RTInertialNav& nav, const RTVector3& worldAccel, double yawRate)
+    {
+        RTQuaternion yaw;
+        RTIMU_DATA data;
+
+        yaw.fromAngleVector(m_heading, RTVector3(0, 0, 1));
+
+        RTVector3 specificForce = worldAccel * (1 / RTINS_GRAVITY);
+
+        specificForce.setZ(specificForce.z() + 1);
+        data.accel = RTMath::toWorld(specificForce, yaw.conjugate());
+        data.accel += RTVector3(BIAS_X + m_accelNoise(m_rng), BIAS_Y + m_accelNoise(m_rng), BIAS_Z + m_accelNoise(m_rng));
+        data.gyro = RTVector3(m_gyroNoise(m_rng), m_gyroNoise(m_rng), yawRate + m_gyroNoise(m_rng));
+        data.fusionQPose = yaw * m_tilt;
+
+        m_time += 1.0 / SAMPLE_RATE;
+        data.timestamp = (uint64_t)(m_time * 1000000);
+        nav.newIMUData(data);
+    }
+
+    std::mt19937 m_rng;
+    std::normal_distribution<double> m_accelNoise;
+    std::normal_distribution<double> m_gyroNoise;
+    RTQuaternion m_tilt;
+    double m_time;
+    double m_heading;
+};
+
+int main()
+{
+    RTInertialNav nav;
+    Walk walk;
+    bool stationary = walk.rest(nav, START_REST);
+    double cornerError = 0;
+
+    //  the pose's gravity - the only direction the bias can be seen in
+
+    RTVector3 gravity(BIAS_X, BIAS_Y, 1 + BIAS_Z);
+    RTFLOAT along = gravity.length() - 1;
+
+    gravity.normalize();
+
+    RTVector3 bias = nav.getAccelBias();
+    RTFLOAT biasAlong = RTVector3::dotProduct(bias, gravity);
+    RTVector3 biasAcross = bias - gravity * biasAlong;
+
+    HOSTTEST_CHECK(stationary && fabs(biasAlong - along) < BIAS_LIMIT && biasAcross.length() < BIAS_LIMIT,
+                   "at rest: bias along gravity %.4fg of %.4fg, across %.4fg", biasAlong, along, biasAcross.length());
+
+    static const double corners[4][2] = {{5, 0}, {5, 5}, {0, 5}, {0, 0}};
+
+    nav.resetPosition();
+    for (int side = 0; side < 4; side++) {
+        for (int stride = 0; stride < SIDE_STRIDES; stride++) {
+            walk.stride(nav);
+            stationary &= walk.rest(nav, REST_TIME);
+        }
+
+        RTVector3 position = nav.getPosition();
+        double error = hypot(position.x() - corners[side][0], position.y() - corners[side][1]);
+
+        printf("      corner %d at (%6.3f, %6.3f, %6.3f), %.3fm out\n", side, position.x(), position.y(),
+               position.z(), error);
+        cornerError = fmax(cornerError, error);
+        walk.turn(nav, M_PI / 2);
+        stationary &= walk.rest(nav, REST_TIME);
+    }
+
+    RTVector3 position = nav.getPosition();
+
+    bias = nav.getAccelBias();
+    biasAlong = RTVector3::dotProduct(bias, gravity);
+    biasAcross = bias - gravity * biasAlong;
+
+    HOSTTEST_CHECK(stationary, "walk: at rest after every stride and turn");
+    HOSTTEST_CHECK(cornerError < CORNER_LIMIT, "walk: corners within %.3fm", cornerError);
+    double tiltDrift = hypot(BIAS_X, BIAS_Y) * 4 * SIDE_STRIDES * STRIDE_LENGTH;
+
+    HOSTTEST_CHECK(hypot(position.x(), position.y()) < CLOSURE_LIMIT, "walk: closed %.3fm from the start",
+                   hypot(position.x(), position.y()));
+    HOSTTEST_CHECK(fabs(position.z()) < tiltDrift + HEIGHT_LIMIT, "walk: %.3fm high, %.3fm from the tilt",
+                   position.z(), tiltDrift);
+    HOSTTEST_CHECK(fabs(biasAlong - along) < BIAS_LIMIT && biasAcross.length() < BIAS_LIMIT,
+                   "walk: bias along gravity %.4fg of %.4fg, across %.4fg", biasAlong, along, biasAcross.length());
+
+    return hostTestResult();
+}
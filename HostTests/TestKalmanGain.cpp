@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestKalmanGain checks and times the RTFusionKalman4 gain Kk = Pkk_1 * Sk^-1, with
+//  Sk = Pkk_1 + Rk, three ways:
+//
+//  cofactor    the 4x4 cofactor inverse RTMatrix4x4 had before it became RTMatrix<4, 4>
+//  inverted    RTMatrix inverted() (Gauss-Jordan) and a multiply
+//  cholesky    choleskySolve() of Sk * Kk' = Pkk_1', which the filter uses
+//
+//  The covariances are random symmetric positive definite matrices with eigenvalues
+//  spread over the range the filter sees. Each gain is compared with one worked out in
+//  double. The times are printed, only the accuracy of the two the library can use is
+//  checked - the cofactor inverse is there for comparison.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestKalmanGain TestKalmanGain.cpp
+//      ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTMath.h"
+
+#include <chrono>
+
+#define COVARIANCES                     1000
+#define TIMING_RUNS                     50                  // times through the covariances
+#define RVALUE                          0.0005f             // KALMAN_RVALUE
+#define EIGEN_MIN                       1.0e-6
+#define EIGEN_MAX                       1.0e-2
+#define GAIN_LIMIT                      1.0e-5              // worst error, relative to the largest gain
+
+typedef RTMatrix<4, 4, double> Matrix4d;
+
+static RTFLOAT cofactorMinor(const RTMatrix4x4& m, int row, int col)
+{
+    static const int map[] = {1, 2, 3, 0, 2, 3, 0, 1, 3, 0, 1, 2};
+
+    const int *rc = map + row * 3;
+    const int *cc = map + col * 3;
+    RTFLOAT res = 0;
+
+    res += m.val(rc[0], cc[0]) * m.val(rc[1], cc[1]) * m.val(rc[2], cc[2]);
+    res -= m.val(rc[0], cc[0]) * m.val(rc[1], cc[2]) * m.val(rc[2], cc[1]);
+    res -= m.val(rc[0], cc[1]) * m.val(rc[1], cc[0]) * m.val(rc[2], cc[2]);
+    res += m.val(rc[0], cc[1]) * m.val(rc[1], cc[2]) * m.val(rc[2], cc[0]);
+    res += m.val(rc[0], cc[2]) * m.val(rc[1], cc[0]) * m.val(rc[2], cc[1]);
+    res -= m.val(rc[0], cc[2]) * m.val(rc[1], cc[1]) * m.val(rc[2], cc[0]);
+    return res;
+}
+
+static RTMatrix4x4 cofactorInverse(const RTMatrix4x4& m)
+{
+    RTMatrix4x4 res;
+    RTFLOAT det = m.val(0, 0) * cofactorMinor(m, 0, 0) - m.val(0, 1) * cofactorMinor(m, 0, 1) +
+            m.val(0, 2) * cofactorMinor(m, 0, 2) - m.val(0, 3) * cofactorMinor(m, 0, 3);
+
+    if (det == 0) {
+        res.setToIdentity();
+        return res;
+    }
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            RTFLOAT minor = cofactorMinor(m, row, col) / det;
+            res.setVal(col, row, ((row + col) & 1) ? -minor : minor);
+        }
+    }
+    return res;
+}
+
+static RTMatrix4x4 gainCofactor(const RTMatrix4x4& P, const RTMatrix4x4& Sk)
+{
+    return P * cofactorInverse(Sk);
+}
+
+static RTMatrix4x4 gainInverted(const RTMatrix4x4& P, const RTMatrix4x4& Sk)
+{
+    return P * Sk.inverted();
+}
+
+static RTMatrix4x4 gainCholesky(const RTMatrix4x4& P, const RTMatrix4x4& Sk)
+{
+    RTMatrix4x4 KkTranspose;
+
+    if (Sk.choleskySolve(P.transposed(), KkTranspose))
+        return KkTranspose.transposed();
+    return P * Sk.inverted();
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * rand() / (double)RAND_MAX;
+}
+
+//  P = V * D * V' for a random rotation V (from a random symmetric matrix's eigenvectors)
+//  and eigenvalues spread log uniformly
+
+static RTMatrix4x4 randomCovariance()
+{
+    Matrix4d A, V, D;
+    RTMatrix<4, 1, double> values;
+
+    for (int row = 0; row < 4; row++) {
+        for (int col = row; col < 4; col++) {
+            A(row, col) = A(col, row) = uniform(-1, 1);
+        }
+    }
+    A.symmetricEigen(V, values);
+    for (int i = 0; i < 4; i++)
+        D(i, i) = EIGEN_MIN * pow(EIGEN_MAX / EIGEN_MIN, uniform(0, 1));
+
+    Matrix4d Pd = V * D * V.transposed();
+    RTMatrix4x4 P;
+
+    for (int row = 0; row < 4; row++)
+        for (int col = 0; col < 4; col++)
+            P(row, col) = (RTFLOAT)Pd(row, col);
+    return P;
+}
+
+static double gainError(const RTMatrix4x4& K, const Matrix4d& reference)
+{
+    double worst = 0;
+    double largest = 0;
+
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            worst = fmax(worst, fabs(K(row, col) - reference(row, col)));
+            largest = fmax(largest, fabs(reference(row, col)));
+        }
+    }
+    return worst / largest;
+}
+
+typedef RTMatrix4x4 (*GainFunction)(const RTMatrix4x4& P, const RTMatrix4x4& Sk);
+
+static void runGain(const char *name, GainFunction gain, bool checked, const std::vector<RTMatrix4x4>& P,
+                    const std::vector<RTMatrix4x4>& Sk, const std::vector<Matrix4d>& reference)
+{
+    double worst = 0;
+
+    for (int i = 0; i < COVARIANCES; i++)
+        worst = fmax(worst, gainError(gain(P[i], Sk[i]), reference[i]));
+
+    //  the fastest of several timing runs, so that other work on the host doesn't count
+
+    volatile RTFLOAT sink = 0;
+    double ns = 0;
+
+    for (int run = 0; run < TIMING_RUNS; run++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < COVARIANCES; i++)
+            sink = sink + gain(P[i], Sk[i])(0, 0);
+
+        double runNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                COVARIANCES;
+
+        if ((run == 0) || (runNs < ns))
+            ns = runNs;
+    }
+
+    if (checked)
+        HOSTTEST_CHECK(worst < GAIN_LIMIT, "%-8s worst gain error %.2e, %.1f ns per gain", name, worst, ns);
+    else
+        printf("      %-8s worst gain error %.2e, %.1f ns per gain\n", name, worst, ns);
+}
+
+int main()
+{
+    std::vector<RTMatrix4x4> P, Sk;
+    std::vector<Matrix4d> reference;
+
+    srand(1);
+    for (int i = 0; i < COVARIANCES; i++) {
+        RTMatrix4x4 Rk;
+
+        for (int j = 0; j < 4; j++)
+            Rk(j, j) = RVALUE;
+        P.push_back(randomCovariance());
+        Sk.push_back(P[i] + Rk);
+
+        Matrix4d Pd, Skd;
+
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                Pd(row, col) = P[i](row, col);
+                Skd(row, col) = Sk[i](row, col);
+            }
+        }
+        reference.push_back(Pd * Skd.inverted());
+    }
+
+    runGain("cofactor", gainCofactor, false, P, Sk, reference);
+    runGain("inverted", gainInverted, true, P, Sk, reference);
+    runGain("cholesky", gainCholesky, true, P, Sk, reference);
+
+    return hostTestResult();
+}
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestMPU9250Compass runs the MPU9250 driver against a model of the chip on the
+//  simulated I2C bus. The driver is built with MPU9250_FIFO_WITH_COMPASS 0, so the
+//  compass registers are read once for each cache block of FIFO samples instead of
+//  coming through the FIFO with every sample.
+//
+//  The model samples at 1kHz and its magnetometer at 100Hz. ST1 DRDY is set in the
+//  compass registers when there has been a measurement since the driver last read
+//  them. Every sample of a block is built from the same compass read, so at most one
+//  of them may be flagged fresh - the others repeat it.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -DMPU9250_FIFO_WITH_COMPASS=0 -Istubs
+//      -I../libraries/RTIMULib -I../libraries/RTIMULib/utility -I../libraries/I2CDev
+//      -o TestMPU9250Compass TestMPU9250Compass.cpp stubs/ArduinoStubs.cpp
+//      ../libraries/RTIMULib/*.cpp ../libraries/RTIMULib/utility/*.cpp
+//      ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+#include "RTIMUMPU9250.h"
+
+#include <Wire.h>
+#include <deque>
+
+#define SAMPLE_RATE                     1000                // Hz
+#define MAG_PERIOD                      10000               // uS between magnetometer measurements
+#define RUN_TIME                        2000000             // uS
+#define POLL_INTERVAL                   20000               // uS between polls, 20 samples wait each time
+
+#if MPU9250_FIFO_WITH_COMPASS != 0
+#error TestMPU9250Compass must be built with MPU9250_FIFO_WITH_COMPASS=0
+#endif
+
+//  MPU9250Model keeps the registers the driver writes, fills the FIFO at the rate set by
+//  SMPRT_DIV with accel, temperature and gyro, and answers the id and compass reads
+
+class MPU9250Model : public HostTestI2CDevice
+{
+public:
+    MPU9250Model() : compassReads(0), m_pointer(0), m_fifoStart(0), m_samples(0), m_magSeen(-1)
+    {
+        memset(m_regs, 0, sizeof(m_regs));
+    }
+
+    virtual void i2cWrite(const uint8_t *data, int length)
+    {
+        if (length == 0)
+            return;
+        m_pointer = data[0];
+        for (int i = 1; i < length; i++)
+            writeReg(m_pointer++, data[i]);
+    }
+
+    virtual void i2cRead(uint8_t *data, int length)
+    {
+        update();
+        for (int i = 0; i < length; i++) {
+            data[i] = readReg(m_pointer);
+            if (m_pointer != MPU9250_FIFO_R_W)
+                m_pointer++;
+        }
+    }
+
+    int compassReads;                                       // reads of EXT_SENS_DATA_00
+
+private:
+    void writeReg(uint8_t reg, uint8_t value)
+    {
+        m_regs[reg] = value;
+        if ((reg == MPU9250_USER_CTRL) && (value & 0x04)) {
+            m_fifo.clear();
+            m_fifoStart = micros();
+            m_samples = 0;
+        }
+    }
+
+    uint8_t readReg(uint8_t reg)
+    {
+        uint8_t value;
+
+        switch (reg) {
+        case MPU9250_WHO_AM_I:
+            return MPU9250_ID;
+
+        case MPU9250_FIFO_COUNT_H:
+            return m_fifo.size() >> 8;
+
+        case MPU9250_FIFO_COUNT_H + 1:
+            return m_fifo.size() & 0xff;
+
+        case MPU9250_FIFO_R_W:
+            if (m_fifo.empty())
+                return 0;
+            value = m_fifo.front();
+            m_fifo.pop_front();
+            return value;
+
+        case MPU9250_EXT_SENS_DATA_00: {
+            //  ST1, then a field along x, then ST2 - the AK8963 is little endian
+
+            int measurement = micros() / MAG_PERIOD;
+
+            compassReads++;
+            value = measurement != m_magSeen ? 0x01 : 0x00;
+            m_magSeen = measurement;
+            return value;
+        }
+
+        case MPU9250_EXT_SENS_DATA_00 + 1:
+            return 0x20;
+
+        case MPU9250_EXT_SENS_DATA_00 + 2:
+            return 0x00;
+
+        default:
+            return (reg > MPU9250_EXT_SENS_DATA_00) && (reg <= MPU9250_EXT_SENS_DATA_00 + 7) ? 0 : m_regs[reg];
+        }
+    }
+
+    //  update() adds the samples due since the last access, as long as the FIFO is enabled
+
+    void update()
+    {
+        if (!(m_regs[MPU9250_USER_CTRL] & 0x40))
+            return;
+
+        uint64_t period = 1000 * (m_regs[MPU9250_SMPRT_DIV] + 1);
+        const uint8_t sample[14] = {0, 0, 0, 0, 0x40, 0, 0, 0, 0, 0, 0, 0, 0, 0};    // 1g on z, still
+
+        while (m_fifoStart + (m_samples + 1) * period <= micros()) {
+            m_samples++;
+            if (m_fifo.size() + sizeof(sample) <= 512)
+                m_fifo.insert(m_fifo.end(), sample, sample + sizeof(sample));
+        }
+    }
+
+    uint8_t m_regs[256];
+    uint8_t m_pointer;
+    std::deque<uint8_t> m_fifo;
+    uint64_t m_fifoStart;
+    uint64_t m_samples;
+    int m_magSeen;
+};
+
+//  AK8963Model only has to answer the fuse ROM read made through bypass mode
+
+class AK8963Model : public HostTestI2CDevice
+{
+public:
+    virtual void i2cWrite(const uint8_t *data, int length) { (void)data; (void)length; }
+    virtual void i2cRead(uint8_t *data, int length) { memset(data, 128, length); }
+};
+
+int main()
+{
+    MPU9250Model mpu;
+    AK8963Model ak;
+
+    hostTestVirtualClock(true);
+    Wire.setClock(400000);
+    Wire.attach(MPU9250_ADDRESS0, &mpu);
+    Wire.attach(AK8963_ADDRESS, &ak);
+
+    RTIMUSettings settings;
+
+    settings.m_I2CSlaveAddress = MPU9250_ADDRESS0;
+    settings.m_busIsI2C = true;
+    settings.m_MPU9250GyroAccelSampleRate = SAMPLE_RATE;
+    settings.m_MPU9250CompassSampleRate = 1000000 / MAG_PERIOD;
+
+    RTIMUMPU9250 imu(&settings);
+
+    if (!imu.IMUInit()) {
+        HOSTTEST_CHECK(false, "MPU9250 init failed");
+        return hostTestResult();
+    }
+
+    uint64_t start = micros();
+    int samples = 0;
+    int fresh = 0;
+    int compassReads = mpu.compassReads;
+
+    while (micros() - start < RUN_TIME) {
+        while (imu.IMURead()) {
+            samples++;
+            if (imu.getIMUData().compassNew)
+                fresh++;
+        }
+        hostTestAdvanceClock(POLL_INTERVAL);
+    }
+    compassReads = mpu.compassReads - compassReads;
+
+    int measurements = RUN_TIME / MAG_PERIOD;
+
+    HOSTTEST_CHECK(samples > RUN_TIME / 1000000.0 * SAMPLE_RATE * 0.95, "%d samples in %.1fs", samples,
+                   RUN_TIME / 1e6);
+    HOSTTEST_CHECK(compassReads < samples * 3 / 4, "%d compass register reads, the rest came from cache blocks",
+                   compassReads);
+    HOSTTEST_CHECK(fresh > 0 && fresh <= compassReads && fresh <= measurements,
+                   "%d samples flagged fresh - %d compass reads, %d magnetometer measurements",
+                   fresh, compassReads, measurements);
+    return hostTestResult();
+}
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestMagTracker replays a tumbling sensor through RTMagTracker. The compass sees a 48uT
+//  field plus a hard iron offset and noise, at 100 samples per second. Two minutes in the
+//  offset steps, as it would when a payload is fitted. The tracker must lock on to the
+//  first offset, follow the step within a few time constants and report how long it took.
+//
+//  A forgetting factor of 1 asks for a filter that never forgets. It must be held below
+//  1 so that the coverage window stays finite and the tracker still locks.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestMagTracker TestMagTracker.cpp
+//      ../libraries/RTIMULib/RTMagTracker.cpp ../libraries/RTIMULib/RTSphereCoverage.cpp
+//      ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTMagTracker.h"
+
+#include <random>
+
+#define FIELD                           48.0                // uT
+#define NOISE                           0.3                 // uT
+#define SAMPLE_INTERVAL                 10000               // uS
+#define WALK_STEP                       0.04                // rad per sample of the random walk
+#define STEP_TIME                       120.0               // seconds before the offset steps
+#define RUN_TIME                        300.0               // seconds
+#define LOCKED                          1.0                 // uT from the true offset
+
+//  replay() gives the seconds taken to lock on to the first offset and to follow the
+//  step, -1 if that never happened
+
+static void replay(RTMagTracker& tracker, double& firstLock, double& stepLock, double& finalError)
+{
+    std::mt19937 rng(6);
+    std::normal_distribution<double> step(0, WALK_STEP);
+    std::normal_distribution<double> noise(0, NOISE);
+    const double before[3] = {10, -5, 20};
+    const double after[3] = {25, 5, 10};
+    double v[3] = {0.6, 0.0, 0.8};
+
+    firstLock = stepLock = -1;
+    finalError = 1e30;
+
+    for (int i = 0; i * SAMPLE_INTERVAL / 1e6 < RUN_TIME; i++) {
+        double t = i * SAMPLE_INTERVAL / 1e6;
+        double w[3] = {step(rng), step(rng), step(rng)};
+        double c[3] = {w[1] * v[2] - w[2] * v[1], w[2] * v[0] - w[0] * v[2], w[0] * v[1] - w[1] * v[0]};
+        double length = 0;
+
+        for (int axis = 0; axis < 3; axis++) {
+            v[axis] += c[axis];
+            length += v[axis] * v[axis];
+        }
+        length = sqrt(length);
+        for (int axis = 0; axis < 3; axis++)
+            v[axis] /= length;
+
+        const double *offset = (t < STEP_TIME) ? before : after;
+        RTVector3 mag;
+
+        for (int axis = 0; axis < 3; axis++)
+            mag.setData(axis, FIELD * v[axis] + offset[axis] + noise(rng));
+        tracker.newSample(mag, (uint64_t)(i + 1) * SAMPLE_INTERVAL);
+
+        if (!tracker.isValid())
+            continue;
+
+        double error = 0;
+
+        for (int axis = 0; axis < 3; axis++)
+            error = fmax(error, fabs(tracker.getOffset().data(axis) - offset[axis]));
+
+        if ((t < STEP_TIME) && (firstLock < 0) && (error < LOCKED))
+            firstLock = t;
+        if ((t >= STEP_TIME) && (stepLock < 0) && (error < LOCKED))
+            stepLock = t - STEP_TIME;
+        finalError = error;
+    }
+}
+
+int main()
+{
+    RTMagTracker tracker;
+    double firstLock;
+    double stepLock;
+    double finalError;
+
+    //  the default 0.995 at 10Hz is a 20 second time constant
+
+    replay(tracker, firstLock, stepLock, finalError);
+    HOSTTEST_CHECK(firstLock >= 0 && firstLock < 60, "default lambda: locked after %.1fs", firstLock);
+    HOSTTEST_CHECK(stepLock >= 0 && stepLock < 100, "default lambda: followed the offset step in %.1fs", stepLock);
+    HOSTTEST_CHECK(finalError < LOCKED, "default lambda: final offset error %.2fuT", finalError);
+
+    tracker.setForgettingFactor(1.0f);
+    replay(tracker, firstLock, stepLock, finalError);
+    HOSTTEST_CHECK(firstLock >= 0 && firstLock < 60, "lambda 1: locked after %.1fs, coverage %.0f%%",
+                   firstLock, tracker.getCoverage());
+    return hostTestResult();
+}
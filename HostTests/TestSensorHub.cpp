@@ -0,0 +1,322 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestSensorHub runs RTIMUSensorHub on the virtual clock with a fake IMU, an MS5611
+//  like pressure sensor and an HTU21D like humidity sensor. Each fake advances the clock
+//  by the bus time of its transfers and a polling loop stands in for loop().
+//
+//  With a 1kHz IMU, whose clock runs 1% fast, the hub must keep the requested pressure
+//  and humidity rates and the true IMU rate, read every IMU sample within the latency
+//  bound and never start a pressure or humidity transfer while an IMU sample is waiting
+//  or within RTIMU_HUB_BUS_GUARD of the next one.
+//
+//  With a 4kHz IMU the next sample is always closer than RTIMU_HUB_BUS_GUARD, so the slow
+//  sensors only get the bus once they have been held back RTIMU_HUB_MAX_DEFER. They must
+//  not be held back longer than that, so humidity keeps its rate and pressure, which
+//  waits once for each of its two conversions, still gets one sample per two
+//  conversions and deferrals.
+//
+//  g++ -O2 -std=gnu++11 -pthread -DARDUINO=105 -Istubs -I../libraries/RTIMULib
+//      -I../libraries/RTIMULib/utility -I../libraries/I2CDev -o TestSensorHub
+//      TestSensorHub.cpp stubs/ArduinoStubs.cpp ../libraries/RTIMULib/*.cpp
+//      ../libraries/RTIMULib/utility/*.cpp ../libraries/I2CDev/I2Cdev.cpp
+
+#include "HostTest.h"
+#include "RTIMULib.h"
+#include "RTIMUSensorHub.h"
+
+#define RUN_TIME                        5000000             // uS of virtual time for each case
+#define SETTLE_TIME                     1000000             // uS before the checks start
+#define POLL_STEP                       7                   // uS taken by the rest of loop()
+
+#define IMU_EMPTY_TIME                  30                  // uS bus time of an IMU poll with nothing ready
+#define IMU_SAMPLE_TIME                 150                 // uS bus time to read one IMU sample
+#define IMU_LATENCY_LIMIT               200                 // uS from IMU data ready to read
+
+#define PRESSURE_RATE                   40                  // Hz
+#define PRESSURE_CONVERSION             9040                // uS, MS5611 at OSR 4096
+#define PRESSURE_TRANSFER               150                 // uS to read the ADC and start the next conversion
+
+#define HUMIDITY_RATE                   10                  // Hz
+#define HUMIDITY_CONVERSION             16000               // uS, HTU21D 12 bit humidity
+#define HUMIDITY_START                  60                  // uS to start a measurement
+#define HUMIDITY_TRANSFER               100                 // uS to read a measurement
+
+#define SLOW_LATENCY_LIMIT              1000                // uS from ready to read, nothing in the way
+#define RATE_TOLERANCE                  0.005f              // relative
+
+extern void hostTestVirtualClock(bool enable);
+extern void hostTestAdvanceClock(uint64_t us);
+
+static uint64_t now() { return RTMath::currentUSecsSinceEpoch(); }
+
+//  HubIMU produces a sample every period uS and keeps them in a FIFO until read
+
+class HubIMU : public RTIMU
+{
+public:
+    HubIMU(RTIMUSettings *settings, int rate, uint64_t period) : RTIMU(settings)
+    {
+        m_sampleRate = rate;
+        m_period = period;
+        m_next = now() + period;
+        read = 0;
+        latencyMax = 0;
+    }
+
+    virtual const char *IMUName() { return "HubIMU"; }
+    virtual int IMUType() { return RTIMU_TYPE_NULL; }
+    virtual bool IMUInit() { return true; }
+    virtual int IMUGetPollInterval() { return 1; }
+
+    virtual bool IMURead()
+    {
+        uint64_t start = now();
+
+        if (m_next > start) {
+            hostTestAdvanceClock(IMU_EMPTY_TIME);
+            return false;
+        }
+        if (start >= SETTLE_TIME + m_startTime && start - m_next > latencyMax)
+            latencyMax = start - m_next;
+        m_imuData.timestamp = m_next;
+        m_next += m_period;
+        read++;
+        hostTestAdvanceClock(IMU_SAMPLE_TIME);
+        return true;
+    }
+
+    //  samples made by now, read or not
+
+    unsigned long samplesBy(uint64_t time) { return read + (m_next <= time ? (time - m_next) / m_period + 1 : 0); }
+
+    uint64_t nextSample() { return m_next; }
+    bool waiting(uint64_t time) { return m_next <= time; }
+
+    unsigned long read;
+    uint64_t latencyMax;
+    uint64_t m_startTime;
+
+private:
+    uint64_t m_period;
+    uint64_t m_next;
+};
+
+static HubIMU *hubIMU;
+
+//  SlowTransfers checks each pressure and humidity transfer against the IMU
+
+struct SlowTransfers
+{
+    unsigned long count;
+    unsigned long imuWaiting;                               // started with an IMU sample unread
+    unsigned long inGuard;                                  // started inside the guard time
+    uint64_t closest;                                       // least uS left to the next IMU sample
+    uint64_t checkFrom;
+
+    void reset(uint64_t from)
+    {
+        count = imuWaiting = inGuard = 0;
+        closest = ~(uint64_t)0;
+        checkFrom = from;
+    }
+
+    void start(uint64_t time)
+    {
+        if (time < checkFrom)
+            return;
+        count++;
+        if (hubIMU->waiting(time)) {
+            imuWaiting++;
+            return;
+        }
+        uint64_t gap = hubIMU->nextSample() - time;
+        if (gap < RTIMU_HUB_BUS_GUARD)
+            inGuard++;
+        if (gap < closest)
+            closest = gap;
+    }
+};
+
+static SlowTransfers slowTransfers;
+
+//  HubPressure converts continuously, alternating temperature and pressure. Only a
+//  pressure result counts as a sample.
+
+class HubPressure : public RTPressure
+{
+public:
+    HubPressure(RTIMUSettings *settings) : RTPressure(settings), m_converting(false), m_pressureNext(false) { m_readyTime = 0; }
+
+    virtual const char *pressureName() { return "HubPressure"; }
+    virtual int pressureType() { return RTPRESSURE_TYPE_AUTODISCOVER; }
+    virtual bool pressureInit() { return true; }
+    virtual int pressureGetPollInterval() { return 5; }
+
+    virtual bool pressureRead()
+    {
+        uint64_t start = now();
+
+        if (m_converting && (start < m_readyTime))
+            return false;
+
+        bool result = m_converting && m_pressureNext;
+
+        slowTransfers.start(start);
+        hostTestAdvanceClock(PRESSURE_TRANSFER);
+        m_pressureNext = m_converting ? !m_pressureNext : false;
+        m_converting = true;
+        m_readyTime = now() + PRESSURE_CONVERSION;
+        return result;
+    }
+
+private:
+    bool m_converting;
+    bool m_pressureNext;                                    // the running conversion is pressure
+};
+
+//  HubHumidity is started for each measurement and idles once it has been read
+
+class HubHumidity : public RTHumidity
+{
+public:
+    HubHumidity(RTIMUSettings *settings) : RTHumidity(settings), m_converting(false) { m_readyTime = 0; }
+
+    virtual const char *humidityName() { return "HubHumidity"; }
+    virtual int humidityType() { return RTHUMIDITY_TYPE_AUTODISCOVER; }
+    virtual bool humidityInit() { return true; }
+    virtual int humidityGetPollInterval() { return 10; }
+
+    virtual bool humidityRead()
+    {
+        uint64_t start = now();
+
+        if (!m_converting) {
+            slowTransfers.start(start);
+            hostTestAdvanceClock(HUMIDITY_START);
+            m_converting = true;
+            m_readyTime = now() + HUMIDITY_CONVERSION;
+            return false;
+        }
+        if (start < m_readyTime)
+            return false;
+        slowTransfers.start(start);
+        hostTestAdvanceClock(HUMIDITY_TRANSFER);
+        m_converting = false;
+        return true;
+    }
+
+private:
+    bool m_converting;
+};
+
+static bool nearRate(RTFLOAT rate, RTFLOAT expected)
+{
+    return fabs(rate - expected) <= RATE_TOLERANCE * expected;
+}
+
+static void runHub(const char *name, int imuRate, uint64_t imuPeriod, bool guarded)
+{
+    RTIMUSettings settings;
+    RTIMUSensorHub hub;
+    uint64_t start = now();
+
+    hubIMU = new HubIMU(&settings, imuRate, imuPeriod);
+    hubIMU->m_startTime = start;
+    hub.setIMU(hubIMU);
+    hub.setPressure(new HubPressure(&settings), PRESSURE_RATE);
+    hub.setHumidity(new HubHumidity(&settings), HUMIDITY_RATE);
+    slowTransfers.reset(start + SETTLE_TIME);
+
+    int pressureSamples = 0;
+    int humiditySamples = 0;
+
+    while (now() < start + RUN_TIME) {
+        int result = hub.poll();
+
+        if (result & RTIMU_HUB_NEW(RTIMU_HUB_PRESSURE))
+            pressureSamples++;
+        if (result & RTIMU_HUB_NEW(RTIMU_HUB_HUMIDITY))
+            humiditySamples++;
+        hostTestAdvanceClock(POLL_STEP);
+    }
+
+    const RTIMU_HUB_STATS& imu = hub.getStats(RTIMU_HUB_IMU);
+    const RTIMU_HUB_STATS& pressure = hub.getStats(RTIMU_HUB_PRESSURE);
+    const RTIMU_HUB_STATS& humidity = hub.getStats(RTIMU_HUB_HUMIDITY);
+    RTFLOAT imuTrueRate = 1000000.0f / imuPeriod;
+    unsigned long unread = hubIMU->samplesBy(now()) - hubIMU->read;
+
+    printf("%s: IMU %.1fHz latency mean %.0fuS max %luuS, pressure %.2fHz max %luuS deferred %lu, "
+           "humidity %.2fHz max %luuS deferred %lu\n", name, imu.rate, imu.latencyMean, imu.latencyMax,
+           pressure.rate, pressure.latencyMax, pressure.deferred, humidity.rate, humidity.latencyMax,
+           humidity.deferred);
+
+    HOSTTEST_CHECK(nearRate(imu.rate, imuTrueRate) && (unread <= 1), "%s: IMU at %.1fHz of %.1fHz, %lu unread",
+                   name, imu.rate, imuTrueRate, unread);
+    HOSTTEST_CHECK(nearRate(humidity.rate, HUMIDITY_RATE), "%s: humidity at %.2fHz", name, humidity.rate);
+    HOSTTEST_CHECK((pressure.samples == (unsigned long)pressureSamples) &&
+                   (humidity.samples == (unsigned long)humiditySamples),
+                   "%s: poll() reported %d pressure and %d humidity samples", name, pressureSamples, humiditySamples);
+
+    if (guarded) {
+        HOSTTEST_CHECK(nearRate(pressure.rate, PRESSURE_RATE), "%s: pressure at %.2fHz", name, pressure.rate);
+        HOSTTEST_CHECK(hubIMU->latencyMax <= IMU_LATENCY_LIMIT, "%s: IMU latency %luuS, limit %duS", name,
+                       (unsigned long)hubIMU->latencyMax, IMU_LATENCY_LIMIT);
+        HOSTTEST_CHECK((pressure.latencyMax <= SLOW_LATENCY_LIMIT) && (humidity.latencyMax <= SLOW_LATENCY_LIMIT),
+                       "%s: pressure latency %luuS, humidity latency %luuS, limit %duS", name,
+                       pressure.latencyMax, humidity.latencyMax, SLOW_LATENCY_LIMIT);
+        HOSTTEST_CHECK((slowTransfers.count > 0) && (slowTransfers.imuWaiting == 0) && (slowTransfers.inGuard == 0),
+                       "%s: %lu slow transfers, %lu with an IMU sample waiting, %lu inside the guard, closest %luuS",
+                       name, slowTransfers.count, slowTransfers.imuWaiting, slowTransfers.inGuard,
+                       (unsigned long)slowTransfers.closest);
+    } else {
+        //  after the deferral the IMU and the other slow sensor can each still go first
+
+        unsigned long limit = RTIMU_HUB_MAX_DEFER + IMU_SAMPLE_TIME + IMU_EMPTY_TIME + PRESSURE_TRANSFER + 2 * POLL_STEP;
+        RTFLOAT pressureRate = 1000000.0f / (2 * (PRESSURE_CONVERSION + PRESSURE_TRANSFER + limit));
+
+        HOSTTEST_CHECK(pressure.rate >= pressureRate * (1 - RATE_TOLERANCE), "%s: pressure at %.2fHz, at least %.2fHz",
+                       name, pressure.rate, pressureRate);
+        HOSTTEST_CHECK((pressure.deferred > 0) && (humidity.deferred > 0) &&
+                       (pressure.latencyMax <= limit) && (humidity.latencyMax <= limit),
+                       "%s: pressure latency %luuS, humidity latency %luuS, limit %luuS", name,
+                       pressure.latencyMax, humidity.latencyMax, limit);
+    }
+}
+
+int main()
+{
+    hostTestVirtualClock(true);
+    hostTestAdvanceClock(1000);
+
+    //  1kHz nominal, 1% fast
+
+    runHub("1kHz", 1000, 990, true);
+
+    //  4kHz, samples 250uS apart are always inside the guard
+
+    runHub("4kHz", 4000, 250, false);
+
+    return hostTestResult();
+}
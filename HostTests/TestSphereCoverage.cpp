@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestSphereCoverage checks the direction bins of RTSphereCoverage with synthetic
+//  rotations and magRaw.dta.
+//
+//  - uniformly random directions must land evenly in every bin (equal areas)
+//  - a fixed field seen by a sensor tumbling in a random walk must reach 100% coverage
+//    with no bin over its limit
+//  - a sensor that only ever points up must cover half the sphere
+//  - fitting only the samples the bins let through must give the same offset from
+//    magRaw.dta as fitting all of them
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestSphereCoverage TestSphereCoverage.cpp
+//      ../libraries/RTIMULib/RTSphereCoverage.cpp ../libraries/RTIMULib/RTEllipsoidFit.cpp
+//      ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTSphereCoverage.h"
+#include "RTEllipsoidFit.h"
+
+#include <random>
+
+#define UNIFORM_SAMPLES                 1000000
+#define WALK_STEP                       0.05                // rad per step of the random walk
+#define WALK_STEPS                      200000
+#define MAG_OFFSET_LIMIT                0.25                // uT between the binned and the full fit
+
+//  randomDirection() is uniform on the sphere, z > 0 only if upper is set
+
+static RTVector3 randomDirection(std::mt19937& rng, bool upper)
+{
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    double z = uniform(rng);
+    double phi = angle(rng);
+
+    if (upper)
+        z = fabs(z);
+    double r = sqrt(1 - z * z);
+    return RTVector3(r * cos(phi), r * sin(phi), z);
+}
+
+static void testEqualAreas()
+{
+    RTSphereCoverage coverage;
+    std::vector<int> counts(coverage.getBinCount(), 0);
+    std::mt19937 rng(3);
+
+    for (int i = 0; i < UNIFORM_SAMPLES; i++)
+        counts[coverage.getBin(randomDirection(rng, false))]++;
+
+    double expected = (double)UNIFORM_SAMPLES / coverage.getBinCount();
+    double worst = 0;
+
+    for (int bin = 0; bin < coverage.getBinCount(); bin++)
+        worst = fmax(worst, fabs(counts[bin] - expected) / expected);
+
+    //  the count in a bin has a standard deviation of 1.1% of expected
+
+    HOSTTEST_CHECK(worst < 0.06, "%d bins, worst bin area error %.1f%%", coverage.getBinCount(), 100 * worst);
+}
+
+//  the field direction in the sensor frame does a random walk as the sensor tumbles
+
+static void testRandomWalk()
+{
+    RTSphereCoverage coverage;
+    std::mt19937 rng(4);
+    std::normal_distribution<double> step(0, WALK_STEP);
+    double v[3] = {0.3, -0.5, 0.81};
+    int full = -1;
+    int overLimit = 0;
+
+    for (int i = 0; i < WALK_STEPS; i++) {
+        double w[3] = {step(rng), step(rng), step(rng)};
+        double c[3] = {w[1] * v[2] - w[2] * v[1], w[2] * v[0] - w[0] * v[2], w[0] * v[1] - w[1] * v[0]};
+        double length = 0;
+
+        for (int axis = 0; axis < 3; axis++) {
+            v[axis] += c[axis];
+            length += v[axis] * v[axis];
+        }
+        length = sqrt(length);
+        for (int axis = 0; axis < 3; axis++)
+            v[axis] /= length;
+
+        coverage.addSample(RTVector3(v[0] * 48, v[1] * 48, v[2] * 48));
+        if ((full < 0) && (coverage.getCoverage() >= 100))
+            full = i;
+    }
+    for (int bin = 0; bin < coverage.getBinCount(); bin++) {
+        if (coverage.getBinSamples(bin) > RTSPHERECOVERAGE_BIN_LIMIT)
+            overLimit++;
+    }
+
+    HOSTTEST_CHECK(full >= 0, "random walk: 100%% coverage after %d steps", full);
+    HOSTTEST_CHECK(overLimit == 0 && coverage.getFullBins() == coverage.getBinCount() &&
+                   coverage.getSampleCount() == RTSPHERECOVERAGE_BIN_LIMIT * coverage.getBinCount(),
+                   "random walk: %d samples kept, %d bins full, %d over the limit",
+                   coverage.getSampleCount(), coverage.getFullBins(), overLimit);
+}
+
+static void testHemisphere()
+{
+    RTSphereCoverage coverage;
+    std::mt19937 rng(5);
+
+    for (int i = 0; i < UNIFORM_SAMPLES / 10; i++)
+        coverage.addSample(randomDirection(rng, true));
+
+    //  the zone boundaries move slightly from the equal latitude steps so one zone may
+    //  straddle the equator
+
+    HOSTTEST_CHECK(fabs(coverage.getCoverage() - 50) < 5, "upper hemisphere: %.1f%% coverage",
+                   coverage.getCoverage());
+}
+
+//  magRaw.dta binned about its min/max centre, as RTIMUMagCal does
+
+static void testMagRaw()
+{
+    std::vector<std::vector<double> > raw;
+
+    if (!hostTestLoad(HOSTTEST_DATA "magRaw.dta", raw))
+        return;
+
+    double minimum[3] = {1e30, 1e30, 1e30};
+    double maximum[3] = {-1e30, -1e30, -1e30};
+
+    for (size_t i = 0; i < raw.size(); i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            minimum[axis] = fmin(minimum[axis], raw[i][axis]);
+            maximum[axis] = fmax(maximum[axis], raw[i][axis]);
+        }
+    }
+
+    RTSphereCoverage coverage;
+    RTEllipsoidFit all;
+    RTEllipsoidFit binned;
+
+    for (size_t i = 0; i < raw.size(); i++) {
+        RTVector3 sample(raw[i][0], raw[i][1], raw[i][2]);
+        RTVector3 direction;
+
+        for (int axis = 0; axis < 3; axis++)
+            direction.setData(axis, raw[i][axis] - (minimum[axis] + maximum[axis]) / 2);
+        all.addSample(sample);
+        if (coverage.addSample(direction))
+            binned.addSample(sample);
+    }
+
+    double allOffset[3];
+    double binnedOffset[3];
+    double matrix[3][3];
+
+    if (!all.fit(allOffset, matrix) || !binned.fit(binnedOffset, matrix)) {
+        HOSTTEST_CHECK(false, "magRaw.dta: fit failed");
+        return;
+    }
+
+    double difference = 0;
+
+    for (int axis = 0; axis < 3; axis++)
+        difference = fmax(difference, fabs(allOffset[axis] - binnedOffset[axis]));
+
+    HOSTTEST_CHECK(coverage.getCoverage() >= 75, "magRaw.dta: %.1f%% coverage", coverage.getCoverage());
+    HOSTTEST_CHECK(difference < MAG_OFFSET_LIMIT, "magRaw.dta: %d of %d samples kept, offset within %.3fuT of the full fit",
+                   binned.getSampleCount(), all.getSampleCount(), difference);
+}
+
+int main()
+{
+    testEqualAreas();
+    testRandomWalk();
+    testHemisphere();
+    testMagRaw();
+    return hostTestResult();
+}
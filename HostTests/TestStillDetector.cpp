@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestStillDetector replays 2000 synthetic samples through RTIMUStillDetector.
+//
+//  A resting sensor must read as still when its raw accel is off by a 2% scale error and
+//  its gyro has a small bias, as it does where RTIMU learns the gyro bias. The gravity
+//  term must catch the same scale error once it is enabled. With the gyro limit off a
+//  constant gyro offset must not stop it. Rotation and vibration must never read as still.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestStillDetector TestStillDetector.cpp
+//      ../libraries/RTIMULib/RTIMUStillDetector.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTIMUStillDetector.h"
+
+#include <random>
+
+#define SAMPLES                         2000
+
+//  stillFraction() returns the fraction of samples after the first window that read still.
+//  The sensor sits with gravity along (1, 1, 1) scaled by accelScale, rotating at rate
+//  rad/s about z and vibrating with the given amplitude in g at 20 samples per cycle.
+
+static double stillFraction(RTIMUStillDetector& detector, double accelScale, double rate, double vibration)
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<double> accelNoise(0, 0.003);
+    std::normal_distribution<double> gyroNoise(0, 0.003);
+    double g = accelScale / sqrt(3.0);
+    int still = 0;
+
+    detector.reset();
+    for (int i = 0; i < SAMPLES; i++) {
+        double shake = vibration * sin(i * 2 * M_PI / 20);
+        RTVector3 accel(g + shake + accelNoise(rng), g + accelNoise(rng), g + accelNoise(rng));
+        RTVector3 gyro(0.01 + gyroNoise(rng), -0.005 + gyroNoise(rng), rate + gyroNoise(rng));
+
+        if (detector.update(accel, gyro) && i >= RTIMU_STILL_WINDOW)
+            still++;
+    }
+    return (double)still / (SAMPLES - RTIMU_STILL_WINDOW);
+}
+
+int main()
+{
+    RTIMUStillDetector detector;
+    double fraction;
+
+    fraction = stillFraction(detector, 1.0, 0, 0);
+    HOSTTEST_CHECK(fraction > 0.99, "at rest: %.3f still", fraction);
+    fraction = stillFraction(detector, 1.02, 0, 0);
+    HOSTTEST_CHECK(fraction > 0.99, "at rest with 2%% accel scale error: %.3f still (score %.1f)",
+                   fraction, detector.getScore());
+    fraction = stillFraction(detector, 1.0, 0.5, 0);
+    HOSTTEST_CHECK(fraction == 0, "rotating at 0.5rad/s: %.3f still", fraction);
+    fraction = stillFraction(detector, 1.0, 0, 0.05);
+    HOSTTEST_CHECK(fraction == 0, "vibrating at 0.05g: %.3f still", fraction);
+
+    //  variance only, as in RTIMUTemperatureCal, a constant rate is the gyro offset drifting
+
+    detector.setGyroLimit(0);
+    fraction = stillFraction(detector, 1.02, 0.5, 0);
+    HOSTTEST_CHECK(fraction > 0.99, "gyro limit off, 0.5rad/s offset: %.3f still", fraction);
+    fraction = stillFraction(detector, 1.0, 0, 0.05);
+    HOSTTEST_CHECK(fraction == 0, "gyro limit off, vibrating at 0.05g: %.3f still", fraction);
+    detector.setGyroLimit(RTIMU_STILL_GYRO_LIMIT);
+
+    //  with calibrated accel, as in RTInertialNav, a wrong magnitude means motion
+
+    detector.setGravityWeight(1.0f);
+    fraction = stillFraction(detector, 1.0, 0, 0);
+    HOSTTEST_CHECK(fraction > 0.99, "gravity term, at rest: %.3f still", fraction);
+    fraction = stillFraction(detector, 1.02, 0, 0);
+    HOSTTEST_CHECK(fraction == 0, "gravity term, 2%% magnitude error: %.3f still (score %.1f)",
+                   fraction, detector.getScore());
+
+    return hostTestResult();
+}
@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestTemperatureFit runs the recorded temperatureRaw.dta files in measurements2 and
+//  measurements3 through RTTemperatureFit and compares the curves with a batch fit done
+//  here the way RTFitTemperature.m does it - polyfit, drop residuals outside 2 sigma,
+//  refit and remove the offset at 32.5C.
+//
+//  Without outlier rejection the running sums must give the batch polyfit. With it the
+//  sample by sample test can't be identical to the script's test against the final fit,
+//  so the curves must agree to within a fraction of the residual standard deviation over
+//  the measured temperature range.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestTemperatureFit TestTemperatureFit.cpp
+//      ../libraries/RTIMULib/RTTemperatureFit.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTTemperatureFit.h"
+
+#define POLYFIT_SCALE                   0.05                // keeps the batch normal equations conditioned
+#define REJECT_OFF_LIMIT                1e-4                // curve difference / residual sigma, no rejection
+#define REJECT_ON_LIMIT                 1.0                 // curve difference / residual sigma, with rejection
+
+typedef std::vector<std::vector<double> > Rows;
+
+static double polyval(const double *p, double t)
+{
+    return ((p[3] * t + p[2]) * t + p[1]) * t + p[0];
+}
+
+//  polyfit() fits y = p0 + p1 t + p2 t^2 + p3 t^3 to the selected rows, in scaled t and
+//  with partial pivoting so that it shares nothing with the code under test
+
+static void polyfit(const Rows& rows, int channel, const std::vector<bool>& use, double *p)
+{
+    double a[4][5] = {{0}};
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!use[i])
+            continue;
+        double u = rows[i][9] * POLYFIT_SCALE;
+        double powers[4] = {1, u, u * u, u * u * u};
+
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++)
+                a[row][col] += powers[row] * powers[col];
+            a[row][4] += powers[row] * rows[i][channel];
+        }
+    }
+
+    for (int col = 0; col < 4; col++) {
+        int pivot = col;
+
+        for (int row = col + 1; row < 4; row++) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col]))
+                pivot = row;
+        }
+        for (int k = 0; k < 5; k++) {
+            double swap = a[col][k];
+            a[col][k] = a[pivot][k];
+            a[pivot][k] = swap;
+        }
+        for (int row = 0; row < 4; row++) {
+            if (row == col)
+                continue;
+            double factor = a[row][col] / a[col][col];
+            for (int k = 0; k < 5; k++)
+                a[row][k] -= factor * a[col][k];
+        }
+    }
+
+    double scale = 1;
+
+    for (int k = 0; k < 4; k++) {
+        p[k] = a[k][4] / a[k][k] * scale;
+        scale *= POLYFIT_SCALE;
+    }
+}
+
+//  batchFit() is RTFitTemperature.m for one channel. It returns the residual standard
+//  deviation of the first fit, the one the outliers are tested against.
+
+static double batchFit(const Rows& rows, int channel, bool reject, double *p)
+{
+    std::vector<bool> use(rows.size(), true);
+    double mean = 0;
+    double sigma = 0;
+
+    polyfit(rows, channel, use, p);
+    for (size_t i = 0; i < rows.size(); i++)
+        mean += rows[i][channel] - polyval(p, rows[i][9]);
+    mean /= rows.size();
+    for (size_t i = 0; i < rows.size(); i++) {
+        double r = rows[i][channel] - polyval(p, rows[i][9]) - mean;
+        sigma += r * r;
+    }
+    sigma = sqrt(sigma / (rows.size() - 1));
+
+    if (reject) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            double r = rows[i][channel] - polyval(p, rows[i][9]);
+            use[i] = (r < mean + 2 * sigma) && (r > mean - 2 * sigma);
+        }
+        polyfit(rows, channel, use, p);
+    }
+
+    double tMin = 1e30;
+    double tMax = -1e30;
+    double tMean = 0;
+    int count = 0;
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!use[i])
+            continue;
+        tMin = fmin(tMin, rows[i][9]);
+        tMax = fmax(tMax, rows[i][9]);
+        tMean += rows[i][9];
+        count++;
+    }
+    tMean /= count;
+    p[0] -= polyval(p, ((32.5 > tMax) || (32.5 < tMin)) ? tMean : 32.5);
+    return sigma;
+}
+
+//  worstDifference() returns the largest difference between the curves over the data's
+//  temperature range, in residual standard deviations
+
+static double worstDifference(const Rows& rows, double c[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_CHANNELS],
+                              int channel, bool reject, int& worstChannel, double worst)
+{
+    double p[4];
+    double sigma = batchFit(rows, channel, reject, p);
+    double tMin = 1e30;
+    double tMax = -1e30;
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        tMin = fmin(tMin, rows[i][9]);
+        tMax = fmax(tMax, rows[i][9]);
+    }
+    for (int step = 0; step <= 100; step++) {
+        double t = tMin + (tMax - tMin) * step / 100;
+        double device = ((c[3][channel] * t + c[2][channel]) * t + c[1][channel]) * t + c[0][channel];
+        double difference = fabs(device - polyval(p, t)) / sigma;
+
+        if (difference > worst) {
+            worst = difference;
+            worstChannel = channel;
+        }
+    }
+    return worst;
+}
+
+static void testFile(const char *name)
+{
+    Rows rows;
+    char path[256];
+
+    snprintf(path, sizeof(path), HOSTTEST_DATA "%s/temperatureRaw.dta", name);
+    if (!hostTestLoad(path, rows))
+        return;
+
+    for (int reject = 0; reject < 2; reject++) {
+        RTTemperatureFit fit;
+        double c[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_CHANNELS];
+        RTFLOAT values[RTTEMPERATUREFIT_CHANNELS];
+
+        fit.setOutlierRejection(reject != 0);
+        for (size_t i = 0; i < rows.size(); i++) {
+            for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++)
+                values[channel] = rows[i][channel];
+            fit.addSample(values, rows[i][9]);
+        }
+        if (!fit.fit(c)) {
+            HOSTTEST_CHECK(false, "%s: fit failed", name);
+            continue;
+        }
+
+        double worst = 0;
+        int worstChannel = 0;
+
+        for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++)
+            worst = worstDifference(rows, c, channel, reject != 0, worstChannel, worst);
+
+        if (reject)
+            HOSTTEST_CHECK(worst < REJECT_ON_LIMIT,
+                           "%s, outlier rejection: %d samples, %d rejected, worst difference %.3f sigma (channel %d)",
+                           name, fit.getSampleCount(), fit.getRejectedCount(), worst, worstChannel);
+        else
+            HOSTTEST_CHECK(worst < REJECT_OFF_LIMIT,
+                           "%s, no outlier rejection: %d samples, worst difference %.2g sigma (channel %d)",
+                           name, fit.getSampleCount(), worst, worstChannel);
+    }
+}
+
+int main()
+{
+    testFile("measurements2");
+    testFile("measurements3");
+    return hostTestResult();
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestTimestamp replays a FIFO IMU through RTIMUTimestamp. The IMU clock runs 2% fast
+//  and the host polls it every 5 to 10mS with a 32 bit micros() that wraps 20 seconds
+//  into the run, as it does on a Teensy after 71.6 minutes. The timestamps must stay
+//  monotonic, keep the true sample period and track the true sample times across the
+//  wrap. A 64 bit host clock that steps back a second must not stop them either.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestTimestamp TestTimestamp.cpp
+//      ../libraries/RTIMULib/RTIMUTimestamp.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTIMUTimestamp.h"
+
+#include <random>
+
+#define RATE                            100                 // nominal sample rate
+#define PERIOD                          (1000000.0 / (RATE * 1.02))
+#define START                           (4294967296.0 - 20000000.0)
+#define DURATION                        60000000.0          // run length in uS
+#define SETTLE                          5000000.0           // time allowed for the fit to lock
+
+//  replay() runs the IMU and returns the worst error of the timestamps against the true
+//  sample times after SETTLE. wrap32 passes the host time as micros() would, stepBack
+//  moves the host clock back that many uS half way through.
+
+static double replay(bool wrap32, double stepBack, double& period, bool& monotonic)
+{
+    RTIMUTimestamp timestamp;
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> poll(5000, 10000);
+    double host = START;
+    double phase = 1234.0;                                  // first sample time after START
+    int64_t produced = 0;
+    int64_t read = 0;
+    uint64_t last = 0;
+    uint64_t first = 0;
+    int64_t firstIndex = -1;
+    double offset = 0;                                      // timestamp minus host time at the first check
+    double worst = 0;
+    bool stepped = false;
+
+    timestamp.reset(RATE);
+    monotonic = true;
+
+    while (host < START + DURATION) {
+        host += poll(rng);
+        while (START + phase + PERIOD * produced <= host)
+            produced++;
+
+        double hostNow = host;
+
+        if (stepped)
+            hostNow -= stepBack;
+        else if (stepBack > 0 && host > START + DURATION / 2) {
+            stepped = true;
+            hostNow -= stepBack;
+        }
+
+        uint64_t now = wrap32 ? (uint64_t)(uint32_t)(uint64_t)hostNow : (uint64_t)hostNow;
+        int count = produced - read;
+
+        timestamp.fifoCount(now, count);
+        timestamp.samplesRead(count);
+        for (int i = 0; i < count; i++, read++) {
+            uint64_t t = timestamp.next();
+            double trueTime = START + phase + PERIOD * read;
+
+            if (last != 0 && t <= last)
+                monotonic = false;
+            last = t;
+            if (trueTime < START + SETTLE)
+                continue;
+            if (firstIndex < 0) {
+                firstIndex = read;
+                first = t;
+                offset = (double)t - trueTime;
+            }
+            worst = fmax(worst, fabs((double)t - trueTime - offset));
+        }
+    }
+    period = (double)(last - first) / (double)(read - 1 - firstIndex);
+    return worst;
+}
+
+int main()
+{
+    double period;
+    bool monotonic;
+    double worst;
+
+    worst = replay(true, 0, period, monotonic);
+    HOSTTEST_CHECK(monotonic, "micros() wrap: timestamps monotonic");
+    HOSTTEST_CHECK(fabs(period / PERIOD - 1) < 1e-4, "micros() wrap: period %.2fuS, true %.2fuS", period, PERIOD);
+    HOSTTEST_CHECK(worst < 0.5 * PERIOD, "micros() wrap: worst tracking error %.0fuS", worst);
+
+    worst = replay(false, 1000000.0, period, monotonic);
+    HOSTTEST_CHECK(monotonic, "clock stepped back 1s: timestamps monotonic");
+    HOSTTEST_CHECK(fabs(period / PERIOD - 1) < 1e-3, "clock stepped back 1s: period %.2fuS, true %.2fuS",
+                   period, PERIOD);
+
+    return hostTestResult();
+}
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  TestVerticalFilter replays the synthetic trajectory the RTVerticalFilter figures were
+//  quoted for and checks them: height rms 0.35m against 0.46m for a 10 sample average of
+//  the barometer heights, speed rms 0.31m/s and the accel bias found at 0.196m/s/s.
+//
+//  The height swings 5m at 0.5rad/s for 120s and at 60s a steady 2m/s climb starts as a
+//  step in speed that is not in the accel data, so the barometer has to pull the speed
+//  over on its own. The accel runs at 1kHz with 0.3m/s/s noise and a 0.2m/s/s bias and is
+//  seen through a tilted pose, so verticalAccel() has to take the tilt out. The barometer
+//  gives heights at 25Hz with 0.5m noise. Errors are measured after the first 10s.
+//
+//  g++ -O2 -std=gnu++11 -I../libraries/RTIMULib -o TestVerticalFilter TestVerticalFilter.cpp
+//      ../libraries/RTIMULib/RTVerticalFilter.cpp ../libraries/RTIMULib/RTMath.cpp
+
+#include "HostTest.h"
+#include "RTVerticalFilter.h"
+
+#include <random>
+
+#define RUN_TIME                        120.0               // s
+#define SETTLE_TIME                     10.0                // s before the errors are measured
+#define CLIMB_TIME                      60.0                // s when the climb starts
+#define CLIMB_RATE                      2.0                 // m/s
+#define IMU_RATE                        1000                // Hz
+#define BARO_RATE                       25                  // Hz
+#define BARO_AVERAGE                    10                  // samples in the comparison average
+
+#define ACCEL_NOISE                     0.3                 // m/s/s
+#define ACCEL_BIAS                      0.2                 // m/s/s
+#define HEIGHT_NOISE                    0.5                 // m
+
+#define HEIGHT_LIMIT                    0.35                // m rms
+#define AVERAGE_LIMIT                   0.46                // m rms of the baro average, no better than
+#define SPEED_LIMIT                     0.315               // m/s rms
+#define BIAS_LIMIT                      0.005               // m/s/s
+#define STILL_LIMIT                     1.0e-5              // m/s/s from verticalAccel() at rest
+
+//  the trajectory - height, speed and acceleration at time t
+
+static void trajectory(double t, double& height, double& speed, double& accel)
+{
+    height = 5 * sin(0.5 * t);
+    speed = 2.5 * cos(0.5 * t);
+    accel = -1.25 * sin(0.5 * t);
+    if (t > CLIMB_TIME) {
+        height += CLIMB_RATE * (t - CLIMB_TIME);
+        speed += CLIMB_RATE;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0, 1);
+    RTVerticalFilter filter;
+    RTQuaternion pose;
+    RTVector3 euler(0.3f, -0.2f, 1.0f);
+
+    pose.fromEuler(euler);
+
+    //  at rest the accel reads 1g along the pose's gravity
+
+    RTVector3 gravity;
+
+    pose.toGravity(gravity);
+    RTFLOAT still = RTVerticalFilter::verticalAccel(gravity, pose);
+
+    HOSTTEST_CHECK(fabs(still) < STILL_LIMIT, "at rest in a tilted pose %.2em/s/s", still);
+
+    double heightSq = 0, speedSq = 0, averageSq = 0;
+    long imuSamples = 0, baroSamples = 0;
+    double baro[BARO_AVERAGE] = {0};
+    int baroCount = 0;
+
+    for (long i = 1; i <= (long)(RUN_TIME * IMU_RATE); i++) {
+        double t = (double)i / IMU_RATE;
+        double height, speed, accel;
+
+        trajectory(t, height, speed, accel);
+
+        //  the specific force in the world frame seen through the tilted pose
+
+        RTVector3 world(0, 0, 1 + (accel + ACCEL_BIAS + ACCEL_NOISE * noise(rng)) / RTVERTICAL_GRAVITY);
+        RTVector3 body = RTMath::toWorld(world, pose.conjugate());
+
+        filter.newAccel(RTVerticalFilter::verticalAccel(body, pose), (uint64_t)(t * 1000000) + 1000000);
+
+        if ((i % (IMU_RATE / BARO_RATE)) == 0) {
+            double measured = height + HEIGHT_NOISE * noise(rng);
+
+            filter.newHeight(measured);
+            baro[baroCount++ % BARO_AVERAGE] = measured;
+            if (t > SETTLE_TIME) {
+                double average = 0;
+
+                for (int k = 0; k < BARO_AVERAGE; k++)
+                    average += baro[k] / BARO_AVERAGE;
+                averageSq += (average - height) * (average - height);
+                baroSamples++;
+            }
+        }
+
+        if (t > SETTLE_TIME) {
+            heightSq += (filter.getHeight() - height) * (filter.getHeight() - height);
+            speedSq += (filter.getVelocity() - speed) * (filter.getVelocity() - speed);
+            imuSamples++;
+        }
+    }
+
+    double heightRms = sqrt(heightSq / imuSamples);
+    double speedRms = sqrt(speedSq / imuSamples);
+    double averageRms = sqrt(averageSq / baroSamples);
+
+    HOSTTEST_CHECK(heightRms < HEIGHT_LIMIT && averageRms > AVERAGE_LIMIT,
+                   "height rms %.3fm, %d sample baro average %.3fm", heightRms, BARO_AVERAGE, averageRms);
+    HOSTTEST_CHECK(speedRms < SPEED_LIMIT, "speed rms %.3fm/s", speedRms);
+    HOSTTEST_CHECK(fabs(filter.getAccelBias() - ACCEL_BIAS) < BIAS_LIMIT, "bias %.3fm/s/s of %.3fm/s/s",
+                   filter.getAccelBias(), ACCEL_BIAS);
+
+    return hostTestResult();
+}
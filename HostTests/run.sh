@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+#  run.sh builds and runs the host tests with the system compiler and reports the ones
+#  that fail. The tests build straight from the library sources - nothing here is part
+#  of the Arduino library, which is why they live outside libraries/.
+#
+#  Usage: HostTests/run.sh [test...]     (default: all tests)
+#
+#  CXX and CXXFLAGS are taken from the environment. Binaries go to $TMPDIR.
+
+cd "$(dirname "$0")" || exit 1
+
+LIB=../libraries/RTIMULib
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+OUT=${TMPDIR:-/tmp}/RTIMULibHostTests
+FAILED=""
+ONLY="$*"
+
+mkdir -p "$OUT" || exit 1
+
+#  runTest name library-sources... builds name.cpp with the listed library sources
+
+runTest()
+{
+    name=$1
+    shift
+    if [ -n "$ONLY" ] && ! echo " $ONLY " | grep -q " $name "; then
+        return
+    fi
+    sources=""
+    for source in "$@"; do
+        sources="$sources $LIB/$source"
+    done
+    echo "=== $name"
+    if ! $CXX -std=gnu++11 $CXXFLAGS -I$LIB -o "$OUT/$name" $name.cpp $sources; then
+        FAILED="$FAILED $name(build)"
+    elif ! "$OUT/$name"; then
+        FAILED="$FAILED $name"
+    fi
+}
+
+#  runArduinoTest name [flags...] builds name.cpp with the whole library against the
+#  Arduino stubs, the flags are added to the compile line
+
+runArduinoTest()
+{
+    name=$1
+    shift
+    if [ -n "$ONLY" ] && ! echo " $ONLY " | grep -q " $name "; then
+        return
+    fi
+    echo "=== $name"
+    if ! $CXX -std=gnu++11 $CXXFLAGS "$@" -pthread -DARDUINO=105 -Istubs -I$LIB -I$LIB/utility -I../libraries/I2CDev \
+            -o "$OUT/$name" $name.cpp stubs/ArduinoStubs.cpp $LIB/*.cpp $LIB/utility/*.cpp \
+            ../libraries/I2CDev/I2Cdev.cpp; then
+        FAILED="$FAILED $name(build)"
+    elif ! "$OUT/$name"; then
+        FAILED="$FAILED $name"
+    fi
+}
+
+runTest TestAccelPoseFit RTAccelPoseFit.cpp RTEllipsoidFit.cpp RTMath.cpp
+runTest TestAltitude RTAltitude.cpp RTMath.cpp
+runTest TestCompassSmoother RTCompassSmoother.cpp RTMath.cpp
+runTest TestEllipsoidFit RTEllipsoidFit.cpp RTMath.cpp
+runTest TestFastMath RTMath.cpp
+runTest TestInertialNav RTInertialNav.cpp RTIMUStillDetector.cpp RTMath.cpp
+runTest TestKalmanGain RTMath.cpp
+runTest TestMagTracker RTMagTracker.cpp RTSphereCoverage.cpp RTMath.cpp
+runTest TestSphereCoverage RTSphereCoverage.cpp RTEllipsoidFit.cpp RTMath.cpp
+runTest TestStillDetector RTIMUStillDetector.cpp RTMath.cpp
+runTest TestTemperatureFit RTTemperatureFit.cpp RTMath.cpp
+runTest TestTimestamp RTIMUTimestamp.cpp RTMath.cpp
+runTest TestVerticalFilter RTVerticalFilter.cpp RTMath.cpp
+runArduinoTest TestCalStore -DHAL_QUIET
+runArduinoTest TestCalibrationComplete
+runArduinoTest TestDataReady
+runArduinoTest TestFusionStaleCompass
+runArduinoTest TestGyroScaleFit
+runArduinoTest TestI2CBlock
+runArduinoTest TestI2CBlock -DI2CDEV_BLOCK_LENGTH=259
+runArduinoTest TestMPU9250Compass -DMPU9250_FIFO_WITH_COMPASS=0
+runArduinoTest TestSensorHub
+
+if [ -n "$FAILED" ]; then
+    echo "failed:$FAILED"
+    exit 1
+fi
+echo "all host tests passed"
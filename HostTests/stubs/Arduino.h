@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  Arduino.h for the host tests - just enough of the Arduino and Teensyduino API for the
+//  library to build on a host. The functions are in ArduinoStubs.cpp.
+
+#ifndef _HOSTTEST_ARDUINO_H
+#define	_HOSTTEST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stddef.h>
+
+#include <type_traits>
+
+#ifndef ARDUINO
+#define ARDUINO 105
+#endif
+
+#define E2END                           0x7ff               // Teensy 3.1/3.2 EEPROM is 2048 bytes
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HEX                             16
+#define DEC                             10
+#define INPUT                           0
+#define OUTPUT                          1
+#define INPUT_PULLUP                    2
+#define LOW                             0
+#define HIGH                            1
+#define FALLING                         2
+#define RISING                          3
+#define CHANGE                          4
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+//  The clock is the host's own unless a test switches to the virtual clock. That one only
+//  moves when delay(), the simulated I2C bus or hostTestAdvanceClock() move it, so a test
+//  can run minutes of sensor time in a moment and get the same result every run.
+
+void hostTestVirtualClock(bool enable);
+void hostTestAdvanceClock(uint64_t us);
+
+//  by value - decltype(a < b ? a : b) would be a reference to a parameter
+
+template<class T, class U> typename std::common_type<T, U>::type min(T a, U b) { return a < b ? a : b; }
+template<class T, class U> typename std::common_type<T, U>::type max(T a, U b) { return a > b ? a : b; }
+
+//  Print sends everything to stdout so that library messages show in the test output
+
+class Print
+{
+public:
+    int printf(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int count = vprintf(format, args);
+        va_end(args);
+        return count;
+    }
+    size_t print(const char *s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+    size_t print(char c) { return putchar(c) != EOF; }
+    size_t print(int n, int base = DEC) { return ::printf(base == HEX ? "%x" : "%d", n); }
+    size_t print(unsigned int n, int base = DEC) { return ::printf(base == HEX ? "%x" : "%u", n); }
+    size_t print(long n, int base = DEC) { return ::printf(base == HEX ? "%lx" : "%ld", n); }
+    size_t print(unsigned long n, int base = DEC) { return ::printf(base == HEX ? "%lx" : "%lu", n); }
+    size_t print(double n, int digits = 2) { return ::printf("%.*f", digits, n); }
+    template<class T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template<class T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+    size_t println() { return putchar('\n') != EOF; }
+    virtual size_t write(uint8_t c) { return putchar(c) != EOF; }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    size_t readBytes(char *buffer, size_t length);
+    void setTimeout(unsigned long timeout) { (void)timeout; }
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(long baud) { (void)baud; }
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // _HOSTTEST_ARDUINO_H
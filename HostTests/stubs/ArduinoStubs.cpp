@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  ArduinoStubs.cpp - the globals and functions declared by the host test stubs. The
+//  clock is the host's monotonic clock and interrupts are never raised by themselves -
+//  a test calls the handler given to attachInterrupt() through hostTestInterrupt.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SD.h>
+#include <SPI.h>
+#include <Wire.h>
+
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+TwoWire Wire;
+SPIClass SPI;
+EEPROMClass EEPROM;
+SDClass SD;
+
+void (*hostTestInterrupt)(void) = NULL;
+
+static bool virtualClock = false;
+static uint64_t virtualMicros = 0;
+
+static uint64_t elapsedMicros()
+{
+    static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (virtualClock)
+        return virtualMicros;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void hostTestVirtualClock(bool enable) { virtualClock = enable; }
+void hostTestAdvanceClock(uint64_t us) { virtualMicros += us; }
+
+unsigned long millis() { return (unsigned long)(elapsedMicros() / 1000); }
+unsigned long micros() { return (unsigned long)elapsedMicros(); }
+
+void delay(unsigned long ms)
+{
+    if (virtualClock)
+        virtualMicros += (uint64_t)ms * 1000;
+    else
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (virtualClock)
+        virtualMicros += us;
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t value) { (void)pin; (void)value; }
+int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) { (void)interrupt; (void)mode; hostTestInterrupt = handler; }
+void detachInterrupt(uint8_t interrupt) { (void)interrupt; hostTestInterrupt = NULL; }
+void noInterrupts() {}
+void interrupts() {}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+
+    while (count < length) {
+        int c = read();
+        if (c < 0)
+            break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+TwoWire::TwoWire()
+{
+    for (int i = 0; i < HOSTTEST_WIRE_DEVICES; i++)
+        m_devices[i] = NULL;
+    m_clock = 100000;
+    m_txLength = 0;
+    m_rxLength = m_rxIndex = 0;
+    resetStats();
+}
+
+void TwoWire::attach(uint8_t address, HostTestI2CDevice *model)
+{
+    for (int i = 0; i < HOSTTEST_WIRE_DEVICES; i++) {
+        if ((m_devices[i] == NULL) || (m_addresses[i] == address)) {
+            m_addresses[i] = address;
+            m_devices[i] = model;
+            return;
+        }
+    }
+}
+
+void TwoWire::resetStats()
+{
+    transactions = 0;
+    bytes = 0;
+    busMicros = 0;
+}
+
+HostTestI2CDevice *TwoWire::device(uint8_t address)
+{
+    for (int i = 0; i < HOSTTEST_WIRE_DEVICES; i++) {
+        if ((m_devices[i] != NULL) && (m_addresses[i] == address))
+            return m_devices[i];
+    }
+    return NULL;
+}
+
+//  transaction() accounts for the address byte, length data bytes and the start and stop
+
+void TwoWire::transaction(int length)
+{
+    uint64_t us = ((uint64_t)(length + 1) * 9 + 2) * 1000000 / m_clock;
+
+    transactions++;
+    bytes += length + 1;
+    busMicros += us;
+    if (virtualClock)
+        virtualMicros += us;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    m_txAddress = address;
+    m_txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (m_txLength >= HOSTTEST_WIRE_MAX_TRANSFER)
+        return 0;
+    m_tx[m_txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+    size_t count = 0;
+
+    while ((count < length) && write(data[count]))
+        count++;
+    return count;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t stop)
+{
+    HostTestI2CDevice *model = device(m_txAddress);
+
+    (void)stop;
+    transaction(model != NULL ? m_txLength : 0);
+    if (model == NULL)
+        return 2;                                           // address NACK
+    model->i2cWrite(m_tx, m_txLength);
+    return 0;
+}
+
+int TwoWire::requestFrom(int address, int length)
+{
+    HostTestI2CDevice *model = device((uint8_t)address);
+
+    m_rxLength = m_rxIndex = 0;
+    if (length > HOSTTEST_WIRE_MAX_TRANSFER)
+        length = HOSTTEST_WIRE_MAX_TRANSFER;
+    transaction(model != NULL ? length : 0);
+    if (model == NULL)
+        return 0;
+    model->i2cRead(m_rx, length);
+    m_rxLength = length;
+    return length;
+}
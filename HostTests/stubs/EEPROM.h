@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  EEPROM.h for the host tests - E2END + 1 bytes of RAM, erased to 0xff. Writes are
+//  counted, and once m_writeLimit writes have been made the rest are lost, as if the power
+//  had been cut. A limit of -1 is no limit.
+
+#ifndef _HOSTTEST_EEPROM_H
+#define	_HOSTTEST_EEPROM_H
+
+#include <Arduino.h>
+
+class EEPROMClass
+{
+public:
+    EEPROMClass() : m_writes(0), m_writeLimit(-1) { memset(m_data, 0xff, sizeof(m_data)); }
+    uint8_t read(int address) { return (address >= 0 && address <= E2END) ? m_data[address] : 0xff; }
+    void write(int address, uint8_t value)
+    {
+        if ((address < 0) || (address > E2END) || (m_writes == m_writeLimit))
+            return;
+        m_data[address] = value;
+        m_writes++;
+    }
+    void update(int address, uint8_t value) { if (read(address) != value) write(address, value); }
+
+    uint8_t m_data[E2END + 1];
+    int m_writes;
+    int m_writeLimit;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // _HOSTTEST_EEPROM_H
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  SD.h for the host tests - there is never a card
+
+#ifndef _HOSTTEST_SD_H
+#define	_HOSTTEST_SD_H
+
+#include <Arduino.h>
+
+#define FILE_READ                       0
+#define FILE_WRITE                      1
+
+class File : public Stream
+{
+public:
+    operator bool() { return false; }
+    void close() {}
+};
+
+class SDClass
+{
+public:
+    bool begin(int select) { (void)select; return false; }
+    File open(const char *name, int mode = FILE_READ) { (void)name; (void)mode; return File(); }
+    bool remove(const char *name) { (void)name; return false; }
+    bool exists(const char *name) { (void)name; return false; }
+};
+
+extern SDClass SD;
+
+#endif // _HOSTTEST_SD_H
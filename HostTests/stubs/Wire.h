@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  Wire.h for the host tests - a simulated bus. A transfer to an address with no device
+//  model attached is NACKed, as on a bus with nothing on it. The bus counts transactions
+//  and bytes and works out how long each transaction takes at the clock given to
+//  setClock(), 9 clocks per byte plus start and stop. With the virtual clock running the
+//  transfer time is added to it.
+
+#ifndef _HOSTTEST_WIRE_H
+#define	_HOSTTEST_WIRE_H
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH                   32
+#define HOSTTEST_WIRE_DEVICES           4                   // device models on the bus
+#define HOSTTEST_WIRE_MAX_TRANSFER      1024                // bytes in one transaction
+
+//  HostTestI2CDevice is a device model. A write transaction passes the register address
+//  and the bytes that follow it, a read transaction continues from the device's own
+//  register pointer.
+
+class HostTestI2CDevice
+{
+public:
+    virtual ~HostTestI2CDevice() {}
+    virtual void i2cWrite(const uint8_t *data, int length) = 0;
+    virtual void i2cRead(uint8_t *data, int length) = 0;
+};
+
+class TwoWire : public Stream
+{
+public:
+    TwoWire();
+
+    void attach(uint8_t address, HostTestI2CDevice *device);
+    void resetStats();
+
+    void begin() {}
+    void setClock(uint32_t clock) { m_clock = clock; }
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission() { return endTransmission(1); }
+    uint8_t endTransmission(uint8_t stop);
+    uint8_t requestFrom(uint8_t address, uint8_t length) { return requestFrom((int)address, (int)length); }
+    uint8_t requestFrom(uint8_t address, uint8_t length, uint8_t stop) { (void)stop; return requestFrom((int)address, (int)length); }
+    int requestFrom(int address, int length);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t length);
+    int available() { return m_rxLength - m_rxIndex; }
+    int read() { return m_rxIndex < m_rxLength ? m_rx[m_rxIndex++] : -1; }
+
+    unsigned long transactions;                             // since resetStats()
+    unsigned long bytes;                                    // address and data bytes since resetStats()
+    uint64_t busMicros;                                     // bus time since resetStats()
+
+private:
+    HostTestI2CDevice *device(uint8_t address);
+    void transaction(int length);
+
+    uint8_t m_addresses[HOSTTEST_WIRE_DEVICES];
+    HostTestI2CDevice *m_devices[HOSTTEST_WIRE_DEVICES];
+    uint32_t m_clock;
+    uint8_t m_txAddress;
+    uint8_t m_tx[HOSTTEST_WIRE_MAX_TRANSFER];
+    int m_txLength;
+    uint8_t m_rx[HOSTTEST_WIRE_MAX_TRANSFER];
+    int m_rxLength;
+    int m_rxIndex;
+};
+
+extern TwoWire Wire;
+
+#endif // _HOSTTEST_WIRE_H
@@ -0,0 +1,527 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  RTCalFit is a native replacement for RTEllipsoidFitMag.m, RTEllipsoidFitAccel.m and
+//  RTFitTemperature.m, built from the library's own fitting code. Every directory named
+//  on the command line, and every subdirectory of it, that holds magRaw.dta, accelRaw.dta
+//  or temperatureRaw.dta gets the matching magCorr.dta, accelCorr.dta or
+//  temperatureCorr.dta - in the same format as the Octave scripts - plus calibration.ini,
+//  the RTIMULib.ini lines for the same values. Directories are processed in parallel.
+//
+//  Build on Linux (ARDUINO is not defined, so only the maths is compiled):
+//
+//  g++ -O2 -std=gnu++11 -pthread -I../libraries/RTIMULib -o RTCalFit RTCalFit.cpp
+//      ../libraries/RTIMULib/RTEllipsoidFit.cpp ../libraries/RTIMULib/RTMath.cpp
+//
+//  Usage: RTCalFit [-j threads] [-b repeats] directory...
+//
+//  -j sets the number of worker threads (default: one per core). -b runs every fit
+//  repeats times without writing anything and reports the time taken.
+
+#include "RTEllipsoidFit.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define RTCALFIT_MAG_RAW                "magRaw.dta"
+#define RTCALFIT_MAG_CORR               "magCorr.dta"
+#define RTCALFIT_ACCEL_RAW              "accelRaw.dta"
+#define RTCALFIT_ACCEL_CORR             "accelCorr.dta"
+#define RTCALFIT_TEMPERATURE_RAW        "temperatureRaw.dta"
+#define RTCALFIT_TEMPERATURE_CORR       "temperatureCorr.dta"
+#define RTCALFIT_INI                    "calibration.ini"
+
+//  the .dta files keep the scripts' %f but the ini values are written with enough digits
+//  to get the float back - the cubic temperature terms are around 1e-7 and %f loses them
+
+#define RTCALFIT_INI_VALUE              "%.9g\n"
+
+#define RTCALFIT_TEMPERATURE_COLUMNS    10                  // accel, gyro, compass xyz then temperature
+#define RTCALFIT_TEMPERATURE_CENTER     32.5                // RTFitTemperature.m removes the offset here
+#define RTCALFIT_OUTLIER_SIGMA          2.0                 // residuals beyond this are refitted without
+
+struct RTCalFitJob
+{
+    std::string dir;
+    std::string log;                                        // printed in order once all jobs are done
+    bool ok;
+};
+
+static bool fileExists(const std::string& path)
+{
+    struct stat st;
+
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+static bool isDirectory(const std::string& path)
+{
+    struct stat st;
+
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool hasRawData(const std::string& dir)
+{
+    return fileExists(dir + "/" RTCALFIT_MAG_RAW) || fileExists(dir + "/" RTCALFIT_ACCEL_RAW) ||
+            fileExists(dir + "/" RTCALFIT_TEMPERATURE_RAW);
+}
+
+//  readValues() loads a whitespace separated file of numbers in one read and parses it
+//  with strtod() - much faster than fscanf() on a FILE. The count has to be a multiple
+//  of columns.
+
+static bool readValues(const std::string& path, int columns, std::vector<double>& values, std::string& log)
+{
+    FILE *fd;
+    long size;
+    std::vector<char> buffer;
+
+    values.clear();
+    if ((fd = fopen(path.c_str(), "rb")) == NULL) {
+        log += "  can't open " + path + "\n";
+        return false;
+    }
+    fseek(fd, 0, SEEK_END);
+    size = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    buffer.resize(size + 1);
+    if (fread(buffer.data(), 1, size, fd) != (size_t)size) {
+        fclose(fd);
+        log += "  can't read " + path + "\n";
+        return false;
+    }
+    fclose(fd);
+    buffer[size] = 0;
+
+    values.reserve(size / 8);
+    char *ptr = buffer.data();
+    char *end;
+
+    while (true) {
+        double value = strtod(ptr, &end);
+
+        if (end == ptr)
+            break;
+        values.push_back(value);
+        ptr = end;
+    }
+
+    while ((*ptr == ' ') || (*ptr == '\t') || (*ptr == '\r') || (*ptr == '\n'))
+        ptr++;
+    if ((*ptr != 0) || (values.size() % columns != 0)) {
+        log += "  bad data in " + path + "\n";
+        return false;
+    }
+    return true;
+}
+
+static void appendf(std::string& str, const char *format, double value)
+{
+    char buffer[64];
+
+    snprintf(buffer, sizeof(buffer), format, value);
+    str += buffer;
+}
+
+static bool writeFile(const std::string& path, const std::string& contents, std::string& log)
+{
+    FILE *fd;
+
+    if ((fd = fopen(path.c_str(), "w")) == NULL) {
+        log += "  can't create " + path + "\n";
+        return false;
+    }
+    fwrite(contents.data(), 1, contents.size(), fd);
+    fclose(fd);
+    return true;
+}
+
+//  fitEllipsoid() does the work of RTEllipsoidFitMag.m / RTEllipsoidFitAccel.m
+
+static bool fitEllipsoid(const std::vector<double>& values, const char *name, const char *keyPrefix,
+                         std::string& corr, std::string& ini, std::string& log)
+{
+    RTEllipsoidFit fit;
+    double offset[3];
+    double matrix[3][3];
+    static const char *axes = "XYZ";
+
+    for (size_t i = 0; i < values.size(); i += 3)
+        fit.addSample(RTVector3(values[i], values[i + 1], values[i + 2]));
+
+    if (!fit.fit(offset, matrix)) {
+        log += std::string("  ") + name + " ellipsoid fit failed\n";
+        return false;
+    }
+
+    corr.clear();
+    for (int i = 0; i < 3; i++)
+        appendf(corr, "%f ", offset[i]);
+    for (int i = 0; i < 9; i++)
+        appendf(corr, i < 8 ? "%f " : "%f\n", matrix[i / 3][i % 3]);
+
+    ini += std::string("# ") + name + " ellipsoid calibration\n";
+    ini += std::string(keyPrefix) + "CalEllipsoidValid=true\n";
+    for (int i = 0; i < 3; i++) {
+        ini += std::string(keyPrefix) + "CalOffset" + axes[i] + "=";
+        appendf(ini, RTCALFIT_INI_VALUE, offset[i]);
+    }
+    for (int i = 0; i < 9; i++) {
+        ini += std::string(keyPrefix) + "CalCorr" + (char)('1' + i / 3) + (char)('1' + i % 3) + "=";
+        appendf(ini, RTCALFIT_INI_VALUE, matrix[i / 3][i % 3]);
+    }
+    ini += "\n";
+
+    log += std::string("  ") + name + ": ";
+    appendf(log, "%.0f samples, radii", fit.getSampleCount());
+    for (int i = 0; i < 3; i++)
+        appendf(log, " %f", fit.getRadii().data(i));
+    log += "\n";
+    return true;
+}
+
+//  cubicFit() is polyfit(t, s, 3) on the samples with use set. It is solved on
+//  (t - mean) / range to keep the normal equations well conditioned and expanded back to
+//  powers of t: p[0] + p[1] * t + p[2] * t^2 + p[3] * t^3.
+
+static bool cubicFit(const std::vector<double>& t, const std::vector<double>& s,
+                     const std::vector<bool>& use, double p[4])
+{
+    double mean = 0;
+    double tMin = 1e30;
+    double tMax = -1e30;
+    int count = 0;
+
+    for (size_t i = 0; i < t.size(); i++) {
+        if (!use[i])
+            continue;
+        mean += t[i];
+        if (t[i] < tMin)
+            tMin = t[i];
+        if (t[i] > tMax)
+            tMax = t[i];
+        count++;
+    }
+    if ((count < 4) || (tMax <= tMin))
+        return false;
+    mean /= count;
+
+    double scale = 2.0 / (tMax - tMin);
+    RTMatrix<4, 4, double> AtA;
+    RTMatrix<4, 1, double> Atb;
+    RTMatrix<4, 1, double> a;
+
+    for (size_t i = 0; i < t.size(); i++) {
+        if (!use[i])
+            continue;
+        double u = (t[i] - mean) * scale;
+        double powers[4] = {1, u, u * u, u * u * u};
+
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++)
+                AtA(row, col) += powers[row] * powers[col];
+            Atb(row, 0) += powers[row] * s[i];
+        }
+    }
+    if (!AtA.choleskySolve(Atb, a))
+        return false;
+
+    //  u = alpha * t + beta, so u^k contributes binomial(k, j) alpha^j beta^(k-j) to t^j
+
+    static const int binomial[4][4] = {{1, 0, 0, 0}, {1, 1, 0, 0}, {1, 2, 1, 0}, {1, 3, 3, 1}};
+    double alpha = scale;
+    double beta = -mean * scale;
+
+    for (int j = 0; j < 4; j++) {
+        p[j] = 0;
+        for (int k = j; k < 4; k++)
+            p[j] += a(k, 0) * binomial[k][j] * pow(alpha, j) * pow(beta, k - j);
+    }
+    return true;
+}
+
+static double cubicValue(const double p[4], double t)
+{
+    return p[0] + t * (p[1] + t * (p[2] + t * p[3]));
+}
+
+//  fitTemperature() does the work of RTFitTemperature.m: for each of the nine sensor axes
+//  a cubic in temperature, refitted without the samples whose residual is more than two
+//  standard deviations from the mean residual, then offset so that it is zero at 32.5C
+//  (or at the mean temperature if 32.5C is outside the data).
+
+static bool fitTemperature(const std::vector<double>& values, std::string& corr, std::string& ini, std::string& log)
+{
+    size_t samples = values.size() / RTCALFIT_TEMPERATURE_COLUMNS;
+    std::vector<double> t(samples);
+    std::vector<double> s(samples);
+    std::vector<bool> use(samples);
+    double c[4][9];
+    int rejected = 0;
+
+    for (size_t i = 0; i < samples; i++)
+        t[i] = values[i * RTCALFIT_TEMPERATURE_COLUMNS + 9];
+
+    for (int axis = 0; axis < 9; axis++) {
+        double p[4];
+
+        for (size_t i = 0; i < samples; i++) {
+            s[i] = values[i * RTCALFIT_TEMPERATURE_COLUMNS + axis];
+            use[i] = true;
+        }
+        if (!cubicFit(t, s, use, p)) {
+            log += "  temperature fit failed - not enough distinct temperatures\n";
+            return false;
+        }
+
+        //  outlier rejection - Octave's std() divides by n - 1
+
+        double mean = 0;
+        double var = 0;
+
+        for (size_t i = 0; i < samples; i++)
+            mean += s[i] - cubicValue(p, t[i]);
+        mean /= samples;
+        for (size_t i = 0; i < samples; i++) {
+            double r = s[i] - cubicValue(p, t[i]) - mean;
+            var += r * r;
+        }
+        double limit = RTCALFIT_OUTLIER_SIGMA * sqrt(var / (samples - 1));
+
+        for (size_t i = 0; i < samples; i++) {
+            double r = s[i] - cubicValue(p, t[i]) - mean;
+
+            use[i] = (r < limit) && (r > -limit);
+            if (!use[i])
+                rejected++;
+        }
+        if (!cubicFit(t, s, use, p)) {
+            log += "  temperature fit failed after outlier rejection\n";
+            return false;
+        }
+
+        //  the script refits after subtracting p(center) from the data - for a least
+        //  squares fit that is the same as subtracting it from the constant term
+
+        double tMin = 1e30;
+        double tMax = -1e30;
+        double tMean = 0;
+        int count = 0;
+
+        for (size_t i = 0; i < samples; i++) {
+            if (!use[i])
+                continue;
+            if (t[i] < tMin)
+                tMin = t[i];
+            if (t[i] > tMax)
+                tMax = t[i];
+            tMean += t[i];
+            count++;
+        }
+        tMean /= count;
+
+        double center = RTCALFIT_TEMPERATURE_CENTER;
+
+        if ((center > tMax) || (center < tMin))
+            center = tMean;
+        p[0] -= cubicValue(p, center);
+
+        for (int k = 0; k < 4; k++)
+            c[k][axis] = p[k];
+    }
+
+    corr.clear();
+    for (int k = 0; k < 4; k++) {
+        for (int axis = 0; axis < 9; axis++)
+            appendf(corr, "%f ", c[k][axis]);
+        corr += "\n";
+    }
+
+    ini += "# Temperature bias calibration\n";
+    ini += "TemperatureCalValid=true\n";
+    for (int k = 0; k < 4; k++) {
+        for (int axis = 0; axis < 9; axis++) {
+            ini += std::string("c") + (char)('0' + k) + "_" + (char)('0' + axis) + "=";
+            appendf(ini, RTCALFIT_INI_VALUE, c[k][axis]);
+        }
+    }
+    ini += "\n";
+
+    log += "  temperature: ";
+    appendf(log, "%.0f samples, ", samples);
+    appendf(log, "%.0f outliers rejected\n", rejected);
+    return true;
+}
+
+static void processDirectory(RTCalFitJob& job, bool write)
+{
+    std::vector<double> values;
+    std::string corr;
+    std::string ini;
+    std::string path;
+
+    job.ok = true;
+    job.log = job.dir + ":\n";
+
+    path = job.dir + "/" RTCALFIT_MAG_RAW;
+    if (fileExists(path)) {
+        if (readValues(path, 3, values, job.log) && fitEllipsoid(values, "compass", "compass", corr, ini, job.log)) {
+            if (write)
+                job.ok &= writeFile(job.dir + "/" RTCALFIT_MAG_CORR, corr, job.log);
+        } else {
+            job.ok = false;
+        }
+    }
+
+    path = job.dir + "/" RTCALFIT_ACCEL_RAW;
+    if (fileExists(path)) {
+        if (readValues(path, 3, values, job.log) && fitEllipsoid(values, "accel", "accel", corr, ini, job.log)) {
+            if (write)
+                job.ok &= writeFile(job.dir + "/" RTCALFIT_ACCEL_CORR, corr, job.log);
+        } else {
+            job.ok = false;
+        }
+    }
+
+    path = job.dir + "/" RTCALFIT_TEMPERATURE_RAW;
+    if (fileExists(path)) {
+        if (readValues(path, RTCALFIT_TEMPERATURE_COLUMNS, values, job.log) && fitTemperature(values, corr, ini, job.log)) {
+            if (write)
+                job.ok &= writeFile(job.dir + "/" RTCALFIT_TEMPERATURE_CORR, corr, job.log);
+        } else {
+            job.ok = false;
+        }
+    }
+
+    if (write && !ini.empty())
+        job.ok &= writeFile(job.dir + "/" RTCALFIT_INI, ini, job.log);
+}
+
+static void addJobs(const std::string& dir, std::vector<RTCalFitJob>& jobs)
+{
+    DIR *d;
+    struct dirent *entry;
+    std::vector<std::string> subdirs;
+
+    if (hasRawData(dir)) {
+        jobs.push_back(RTCalFitJob());
+        jobs.back().dir = dir;
+    }
+    if ((d = opendir(dir.c_str())) == NULL)
+        return;
+    while ((entry = readdir(d)) != NULL) {
+        std::string sub = dir + "/" + entry->d_name;
+
+        if ((entry->d_name[0] != '.') && isDirectory(sub) && hasRawData(sub))
+            subdirs.push_back(sub);
+    }
+    closedir(d);
+
+    //  readdir() order is arbitrary - sort so that the report is repeatable
+
+    for (size_t i = 1; i < subdirs.size(); i++) {
+        for (size_t j = i; (j > 0) && (subdirs[j] < subdirs[j - 1]); j--)
+            subdirs[j].swap(subdirs[j - 1]);
+    }
+    for (size_t i = 0; i < subdirs.size(); i++) {
+        jobs.push_back(RTCalFitJob());
+        jobs.back().dir = subdirs[i];
+    }
+}
+
+static void runJobs(std::vector<RTCalFitJob>& jobs, int threads, bool write)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::thread([&]() {
+            size_t job;
+
+            while ((job = next++) < jobs.size())
+                processDirectory(jobs[job], write);
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+int main(int argc, char **argv)
+{
+    int threads = std::thread::hardware_concurrency();
+    int repeats = 0;
+    std::vector<RTCalFitJob> jobs;
+    int arg;
+
+    for (arg = 1; arg < argc; arg++) {
+        std::string option = argv[arg];
+
+        if ((option == "-j") && (arg + 1 < argc))
+            threads = atoi(argv[++arg]);
+        else if ((option == "-b") && (arg + 1 < argc))
+            repeats = atoi(argv[++arg]);
+        else if (option[0] == '-')
+            break;
+        else
+            addJobs(option, jobs);
+    }
+    if ((arg < argc) || (jobs.empty())) {
+        fprintf(stderr, "Usage: %s [-j threads] [-b repeats] directory...\n", argv[0]);
+        fprintf(stderr, "Fits every directory (and subdirectory) holding %s, %s or %s\n",
+                RTCALFIT_MAG_RAW, RTCALFIT_ACCEL_RAW, RTCALFIT_TEMPERATURE_RAW);
+        return 1;
+    }
+    if (threads < 1)
+        threads = 1;
+
+    if (repeats > 0) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < repeats; i++)
+            runJobs(jobs, threads, false);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%d directories x %d repeats on %d threads: %.1fms, %.3fms per directory\n",
+               (int)jobs.size(), repeats, threads, ms, ms / (jobs.size() * repeats));
+        return 0;
+    }
+
+    runJobs(jobs, threads, true);
+
+    bool ok = true;
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        fputs(jobs[i].log.c_str(), stdout);
+        ok &= jobs[i].ok;
+    }
+    return ok ? 0 : 1;
+}
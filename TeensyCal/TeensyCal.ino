@@ -37,8 +37,10 @@ void doResetAccelCal();
 void pollIMUandDisplay();
 void doMagMinMaxCal();
 void doMagEllipsoidCal();
+void displayMagQuality();
 void doAccelEllipsoidCal();
 void doTemperatureCal();
+void doGyroScaleCal();
 void doAccelMinMaxCal();
 void doRuntimeAccelCal();
 
@@ -144,9 +146,10 @@ void loop()
       Serial.println("  m - calibrate magnetometer with min/max.");
       Serial.println("  M - calibrate magnetometer with ellipsoid (do min/max first).");
       Serial.println("  a - calibrate accelerometers with min/max.");
-      Serial.println("  A - calibrate accelerometers with ellipsoid (do min/max first).");
+      Serial.println("  A - calibrate accelerometers with ellipsoid from still poses (no min/max needed).");
       Serial.println("  G - enabel runtime gyro calibration.");
       Serial.println("  g - disable runtime gyro calibration.");
+      Serial.println("  S - calibrate gyro scale and misalignment (do accel and mag first).");
       Serial.println("  r - runtime accelerometer calibration.");
       Serial.println("  R - reset calibration.");
       Serial.println("  s - save settings to EEPROM.");
@@ -186,6 +189,10 @@ void loop()
         doTemperatureCal();
         break;
 
+      case 'S' :
+        doGyroScaleCal();
+        break;
+
       case 'r' :
         doRuntimeAccelCal();
         break;
@@ -318,9 +325,11 @@ void doMagMinMaxCal()
         Serial.println("or 'x' to abort and discard the data.");
         Serial.print(RTMath::displayRadians("Mag Max[uT]", magCal->m_magMax)); 
         Serial.print(RTMath::displayRadians("Mag Min[uT]", magCal->m_magMin)); 
+        displayMagQuality();
       }      
       pollIMUandDisplay();
-      magCal->newMinMaxData(imuData.compass);
+      if (imuData.compassNew)
+        magCal->newMinMaxData(imuData.compass);
 
       if (Serial.available()) {
         inByte=Serial.read();
@@ -350,18 +359,272 @@ void doMagMinMaxCal()
     } // while
 } // mag max min
 
-void doMagEllipsoidCal()
+void displayMagQuality()
 {
-  Serial.println("Not implemented");
+    Serial.printf("Fit: coverage %4.1f%%, conditioning %5.3f, residual %5.3f%%, change %5.3f%%\n",
+                  magCal->m_coverage.getCoverage(), magCal->getConditioning(),
+                  100 * magCal->getResidual(), 100 * magCal->getFitChange());
+    if (magCal->calibrationComplete())
+        Serial.println("Calibration complete - enter 's' to save.");
 }
 
+void doMagEllipsoidCal()
+{
+    if (!settings->m_compassCalValid) {
+        Serial.println("Do the min/max calibration first.");
+        return;
+    }
+
+    magCal->magCalInit();
+    imu->setCompassCalibrationMode(true);
+
+    while (1) {
+      currentTime = micros();
+      if (currentTime-lastReport >= DISPLAY_INTERVAL) {
+        doReport= true;
+        lastReport = currentTime;
+      } else {
+        doReport = false;
+      }
+
+      if (doReport) {
+        Serial.println("Magnetometer ellipsoid calibration");
+        Serial.println("----------------------------------");
+        Serial.println("Move the IMU slowly through as many orientations as possible until");
+        Serial.println("enough of the sphere is covered. Enter 's' to fit and save, 'r' to reset");
+        Serial.println("or 'x' to abort and discard the data.");
+        Serial.printf("Coverage: %4.1f%% (need %4.1f%%), %d samples, %d of %d bins full\n",
+                      magCal->m_coverage.getCoverage(), RTIMUCALDEFS_ELLIPSOID_MIN_COVERAGE,
+                      magCal->m_coverage.getSampleCount(), magCal->m_coverage.getFullBins(),
+                      magCal->m_coverage.getBinCount());
+        displayMagQuality();
+      }
+      pollIMUandDisplay();
+      if (imuData.compassNew)
+        magCal->newEllipsoidData(imuData.compass);
+
+      if (Serial.available()) {
+        inByte=Serial.read();
+
+        switch (inByte) {
+           case 's' :
+               if (!magCal->magCalEllipsoidValid()) {
+                   Serial.println("Not enough samples yet.");
+                   break;
+               }
+               if (magCal->magCalSaveEllipsoid())
+                   Serial.println("Saved ellipsoid data.");
+               else
+                   Serial.println("Ellipsoid fit failed - reset and try again.");
+               imu->setCompassCalibrationMode(false);
+               return;
+
+           case 'x' :
+               Serial.println("\nAborting.\n");
+               imu->setCompassCalibrationMode(false);
+               return;
+
+           case 'r' :
+               Serial.println("Resetting ellipsoid data.");
+               magCal->magCalReset();
+               break;
+         } // switch
+      } // serial
+    } // while
+} // mag ellipsoid
+
 void doAccelEllipsoidCal()
 {
-  Serial.println("Not implemented");
-}
-void doTemperatureCal() {
-  Serial.println("Not implemented");
-}
+    accCal->accelCalReset();
+    imu->setAccelCalibrationMode(true);
+
+    while (1) {
+      currentTime = micros();
+      if (currentTime-lastReport >= DISPLAY_INTERVAL) {
+        doReport= true;
+        lastReport = currentTime;
+      } else {
+        doReport = false;
+      }
+
+      if (doReport) {
+        Serial.println("Accelerometer ellipsoid calibration");
+        Serial.println("-----------------------------------");
+        Serial.println("Put the IMU down in one orientation after another and hold each for a");
+        Serial.println("second - the six faces and eight corners of a cube work well. Poses are");
+        Serial.printf("picked up automatically and at least %d different ones are needed.\n", RTACCELPOSEFIT_MIN_POSES);
+        Serial.println("Enter 's' to save, 'r' to reset or 'x' to abort and discard the data.");
+        Serial.printf("Poses: %d (%s), conditioning %5.3f, residual %5.3f%%\n",
+                      accCal->m_poseFit.getPoseCount(), accCal->m_poseFit.isStill() ? "still" : "moving",
+                      accCal->m_poseFit.getConditioning(), 100 * accCal->m_poseFit.getResidual());
+        if (accCal->accelCalEllipsoidValid())
+            Serial.println("Calibration complete - enter 's' to save, or add poses to refine it.");
+      }
+      pollIMUandDisplay();
+      accCal->newEllipsoidData(imuData.accel, imuData.timestamp);
+
+      if (Serial.available()) {
+        inByte=Serial.read();
+
+        switch (inByte) {
+           case 's' :
+               if (!accCal->accelCalSaveEllipsoid()) {
+                   Serial.println("Not enough poses yet.");
+                   break;
+               }
+               Serial.println("Saved accelerometer ellipsoid data.");
+               accelMinMaxDone = true;
+               imu->setAccelCalibrationMode(false);
+               return;
+
+           case 'x' :
+               Serial.println("\nAborting.\n");
+               imu->setAccelCalibrationMode(false);
+               return;
+
+           case 'r' :
+               Serial.println("Resetting ellipsoid data.");
+               accCal->accelCalReset();
+               break;
+         } // switch
+      } // serial
+    } // while
+} // accel ellipsoid
+void doGyroScaleCal()
+{
+    if (!settings->m_compassCalValid) {
+        Serial.println("Do the magnetometer calibration first.");
+        return;
+    }
+
+    gyrCal->gyroCalReset();
+    imu->setGyroCalibrationMode(true);
+
+    while (1) {
+      currentTime = micros();
+      if (currentTime-lastReport >= DISPLAY_INTERVAL) {
+        doReport= true;
+        lastReport = currentTime;
+      } else {
+        doReport = false;
+      }
+
+      if (doReport) {
+        Serial.println("Gyro scale and misalignment calibration");
+        Serial.println("---------------------------------------");
+        Serial.println("Hold the IMU still, turn it about 90 degrees about one axis and hold it");
+        Serial.println("still again. Repeat about every axis in both directions, away from iron.");
+        Serial.println("Enter 's' to fit and save, 'r' to reset or 'x' to abort and discard the data.");
+        Serial.printf("%s, %d rotations (need %d), %d rejected, least turned axis %4.0f deg (need %4.0f)\n",
+                      gyrCal->m_scaleFit.isStill() ? "Still" : "Moving",
+                      gyrCal->m_scaleFit.getRotationCount(), RTGYROSCALEFIT_MIN_ROTATIONS,
+                      gyrCal->m_scaleFit.getRejectedCount(),
+                      gyrCal->m_scaleFit.getExcitation() * RTMATH_RAD_TO_DEGREE,
+                      RTGYROSCALEFIT_MIN_EXCITATION * RTMATH_RAD_TO_DEGREE);
+      }
+      pollIMUandDisplay();
+      gyrCal->newRotationData(imuData.gyro, imuData.accel, imuData.compass, imuData.timestamp);
+
+      if (Serial.available()) {
+        inByte=Serial.read();
+
+        switch (inByte) {
+           case 's' :
+               if (!gyrCal->gyroCalCorrValid()) {
+                   Serial.println("Not enough rotations yet.");
+                   break;
+               }
+               if (gyrCal->gyroCalSaveCorr())
+                   Serial.println("Saved gyro correction.");
+               else
+                   Serial.println("Gyro scale fit failed - reset and try again.");
+               imu->setGyroCalibrationMode(false);
+               return;
+
+           case 'x' :
+               Serial.println("\nAborting.\n");
+               imu->setGyroCalibrationMode(false);
+               return;
+
+           case 'r' :
+               Serial.println("Resetting rotation data.");
+               gyrCal->gyroCalReset();
+               break;
+         } // switch
+      } // serial
+    } // while
+} // gyro scale
+
+void doTemperatureCal()
+{
+    //  run time gyro bias learning would track the temperature drift that is being
+    //  measured, so the gyro is only corrected by the saved bias during the session
+
+    bool gyroLearning = imu->getGyroRunTimeCalibrationEnable();
+
+    imu->setGyroRunTimeCalibrationEnable(false);
+    temperatureCal->temperatureCalReset();
+    imu->setTemperatureCalibrationMode(true);
+
+    while (1) {
+      currentTime = micros();
+      if (currentTime-lastReport >= DISPLAY_INTERVAL) {
+        doReport= true;
+        lastReport = currentTime;
+      } else {
+        doReport = false;
+      }
+
+      if (doReport) {
+        Serial.println("Temperature calibration");
+        Serial.println("-----------------------");
+        Serial.println("Leave the IMU still while it slowly warms up or cools down over as wide a");
+        Serial.println("range as possible. Enter 's' to fit and save, 'r' to reset or 'x' to abort");
+        Serial.println("and discard the data.");
+        Serial.print("Samples: "); Serial.print(temperatureCal->m_fit.getSampleCount());
+        Serial.print(" (need "); Serial.print(RTIMUCALDEFS_TEMPERATURE_MIN_SAMPLES); Serial.print(")");
+        Serial.print(", outliers: "); Serial.println(temperatureCal->m_fit.getRejectedCount());
+        if (temperatureCal->m_fit.getSampleCount() > 0)
+          Serial.printf("Temperature range: %4.2f to %4.2f C (need %4.1f)\n",
+                        temperatureCal->m_temperatureMin, temperatureCal->m_temperatureMax, RTIMUCALDEFS_TEMPERATURE_MIN_RANGE);
+      }
+      pollIMUandDisplay();
+      if (imuData.temperatureValid)
+        temperatureCal->newData(imuData.accel, imuData.gyro, imuData.compass, imuData.temperature);
+
+      if (Serial.available()) {
+        inByte=Serial.read();
+
+        switch (inByte) {
+           case 's' :
+               if (!temperatureCal->temperatureCalValid()) {
+                   Serial.println("Not enough samples or temperature range yet.");
+                   break;
+               }
+               if (temperatureCal->temperatureCalSave()) {
+                   temperatureDone = true;
+                   Serial.println("Saved temperature calibration data.");
+               } else {
+                   Serial.println("Temperature fit failed - reset and try again.");
+               }
+               imu->setTemperatureCalibrationMode(false);
+               imu->setGyroRunTimeCalibrationEnable(gyroLearning);
+               return;
+
+           case 'x' :
+               Serial.println("\nAborting.\n");
+               imu->setTemperatureCalibrationMode(false);
+               imu->setGyroRunTimeCalibrationEnable(gyroLearning);
+               return;
+
+           case 'r' :
+               Serial.println("Resetting temperature data.");
+               temperatureCal->temperatureCalReset();
+               break;
+         } // switch
+      } // serial
+    } // while
+} // temperature
 
 void doAccelMinMaxCal()
 {
@@ -403,6 +666,8 @@ void doAccelMinMaxCal()
       Serial.println("  x - return to precious menu.");
       Serial.print(RTMath::displayRadians("Acc Max[g]", accCal->m_accelMax)); 
       Serial.print(RTMath::displayRadians("Acc Min[g]", accCal->m_accelMin)); 
+      Serial.printf("Settled extremes: %d of 6%s\n", accCal->getSettledExtremes(),
+                    accCal->calibrationComplete() ? " - complete, enter 's' to save" : "");
 
     }
     
@@ -22,6 +22,7 @@
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <EEPROM.h>
+#include "RTIMUSettings.h"
 
 #define SERIAL_PORT_SPEED    115200
 
@@ -31,7 +32,9 @@ void setup()
     while (!Serial) {
         ; // wait for serial port to connect. 
     }
-    EEPROM.write(0, 0);
+    EEPROM.write(0, 0);                                     // original RTIMULIB_CAL_DATA record
+    for (int copy = 0; copy < 2; copy++)                    // RTIMULIB_CAL_STORE copies A and B
+        EEPROM.write(RTIMULIB_CAL_STORE_BASE + copy * sizeof(RTIMULIB_CAL_STORE), 0);
     Serial.println("EEPROM data cleared");
 }
 
@@ -43,6 +43,12 @@ RTIMUSettings *settings;                              // the settings object
 
 #define  SERIAL_PORT_SPEED  115200
 
+//  DATA_READY_PIN enables interrupt driven sampling - define it as the pin wired to the IMU's
+//  data ready/INT output. SAMPLE_RING_DEPTH is the number of samples buffered for loop()
+
+// #define DATA_READY_PIN     2
+#define SAMPLE_RING_DEPTH  16
+
 unsigned long lastDisplay;
 unsigned long lastRate;
 int sampleCount;
@@ -88,6 +94,11 @@ void setup()
       Serial.print("Failed to init IMU: "); Serial.println(errcode);
     }
 
+#ifdef DATA_READY_PIN
+    if (!imu->IMUEnableDataReady(DATA_READY_PIN, SAMPLE_RING_DEPTH))
+        Serial.println("Data ready interrupt not available");
+#endif
+
     if (imu->getCompassCalibrationValid())
         Serial.println("Using compass calibration");
     else
@@ -111,8 +122,12 @@ void loop()
     
     RTIMU_DATA imuData;
   
+#ifdef DATA_READY_PIN
+    if (imu->IMUGetSample(imuData)) {                    // oldest sample collected by the interrupt
+#else
     if (imu->IMURead()) {                                // get the latest data if ready yet
         imuData = imu->getIMUData();
+#endif
         sampleCount++;
         if ((delta = now - lastRate) >= 1000) {
             sampleRate=sampleCount;
@@ -123,6 +138,9 @@ void loop()
             lastDisplay = now;
 
             Serial.print("Sample rate: "); Serial.print(sampleRate);
+#ifdef DATA_READY_PIN
+            Serial.print(", overflows: "); Serial.print(imu->IMUSampleOverflows());
+#endif
             if (imu->IMUGyroBiasValid())
                 Serial.print(", gyro bias valid");
             else
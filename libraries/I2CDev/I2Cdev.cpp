@@ -413,6 +413,88 @@ int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t length, uint8_t *data, uint16_
     return count;
 }
 
+/** Read a block of bytes that may be larger than the Wire buffer.
+ * The register is selected once and the data is then pulled in chunks of up
+ * to I2CDEV_BLOCK_LENGTH bytes straight into the caller's buffer. The device
+ * keeps its own register pointer (auto increment or FIFO port) between the
+ * chunks so they are not re-addressed. With i2c_t3 the timeout is handed to
+ * the driver for each chunk on top of its transfer time at I2CDEV_BUS_CLOCK
+ * (9 clocks per byte), so a stalled chunk is abandoned but a long block on a
+ * slow bus is not. The stock Wire library can't abandon a transfer so there
+ * the timeout is not used.
+ * @param devAddr I2C slave device address
+ * @param regAddr First register regAddr to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in (must hold length bytes)
+ * @param timeout Optional per chunk read timeout in milliseconds, i2c_t3 only (0 to disable, leave off to use default class value in I2Cdev::readTimeout)
+ * @return Number of bytes read (-1 indicates failure)
+ */
+int16_t I2Cdev::readBlock(uint8_t devAddr, uint8_t regAddr, uint16_t length, uint8_t *data, uint16_t timeout) {
+    #ifdef I2CDEV_SERIAL_DEBUG
+        Serial.print("I2C (0x");
+        Serial.print(devAddr, HEX);
+        Serial.print(") block reading ");
+        Serial.print(length, DEC);
+        Serial.print(" bytes from 0x");
+        Serial.print(regAddr, HEX);
+        Serial.print("...");
+    #endif
+
+    int16_t count = 0;
+
+    #if (I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE) && (ARDUINO >= 100)
+
+        Wire.beginTransmission(devAddr);
+        Wire.write(regAddr);
+        if (Wire.endTransmission() != 0)
+            return -1;
+
+        while (count < length) {
+            uint16_t chunk = length - count;
+            if (chunk > I2CDEV_BLOCK_LENGTH)
+                chunk = I2CDEV_BLOCK_LENGTH;
+
+            #if defined(I2C_RX_BUFFER_LENGTH)
+                // i2c_t3 abandons a stalled transfer itself, give it the timeout on top
+                // of the time the chunk takes to clock in
+                uint32_t chunkTimeout = 0;
+                if (timeout > 0)
+                    chunkTimeout = 1000UL * (timeout + (9000UL * chunk + I2CDEV_BUS_CLOCK - 1) / I2CDEV_BUS_CLOCK);
+                if (Wire.requestFrom(devAddr, (size_t)chunk, I2C_STOP, chunkTimeout) != chunk)
+                    break;
+            #else
+                // the stock Wire requestFrom() blocks until the transfer is over and
+                // has no timeout of its own
+                if ((uint16_t)Wire.requestFrom((int)devAddr, (int)chunk) != chunk)
+                    break;
+            #endif
+            count += Wire.readBytes((char *)data + count, chunk);
+        }
+
+    #else
+
+        // no bulk transfer available for this implementation - fall back to
+        // buffer sized reads of the same register
+        while (count < length) {
+            uint8_t chunk = (length - count > I2CDEV_BLOCK_LENGTH) ? I2CDEV_BLOCK_LENGTH : length - count;
+            if (readBytes(devAddr, regAddr, chunk, data + count, timeout) != chunk)
+                break;
+            count += chunk;
+        }
+
+    #endif
+
+    if (count < length) count = -1; // short read or timeout
+
+    #ifdef I2CDEV_SERIAL_DEBUG
+        Serial.print(". Done (");
+        Serial.print(count, DEC);
+        Serial.println(" read).");
+    #endif
+
+    return count;
+}
+
 /** Read multiple words from a 16-bit device register.
  * @param devAddr I2C slave device address
  * @param regAddr First register regAddr to read from
@@ -3,6 +3,9 @@
 // 2013-06-05 by Jeff Rowberg <jeff@rowberg.net>
 //
 // Changelog:
+//      2026-10-19 - readBlock() passes its timeout to i2c_t3 so a stalled chunk is abandoned
+//      2026-10-19 - readBlock() timeout allows for the transfer time of each chunk at I2CDEV_BUS_CLOCK
+//      2026-10-18 - add readBlock() for transfers larger than BUFFER_LENGTH (i2c_t3 buffers, per-chunk timeout)
 //      2015-10-30 - simondlevy : support i2c_t3 for Teensy3.1
 //      2013-05-06 - add Francesco Ferrara's Fastwire v0.24 implementation with small modifications
 //      2013-05-05 - fix issue with writing bit values to words (Sasquatch/Farzanegan)
@@ -99,6 +102,24 @@ THE SOFTWARE.
 // 1000ms default read timeout (modify with "I2Cdev::readTimeout = [ms];")
 #define I2CDEV_DEFAULT_READ_TIMEOUT     1000
 
+// largest single requestFrom() issued by readBlock(). i2c_t3 has a much bigger
+// receive buffer than the stock Wire library so use all of it when available
+#ifndef I2CDEV_BLOCK_LENGTH
+    #if defined(I2C_RX_BUFFER_LENGTH)
+        #define I2CDEV_BLOCK_LENGTH     I2C_RX_BUFFER_LENGTH
+    #elif defined(BUFFER_LENGTH)
+        #define I2CDEV_BLOCK_LENGTH     BUFFER_LENGTH
+    #else
+        #define I2CDEV_BLOCK_LENGTH     32
+    #endif
+#endif
+
+// bus clock assumed by readBlock() when it works out how long a chunk takes. Wire starts
+// at 100kHz, define this to the clock set with Wire.setClock() if it is changed
+#ifndef I2CDEV_BUS_CLOCK
+    #define I2CDEV_BUS_CLOCK            100000
+#endif
+
 class I2Cdev {
     public:
         I2Cdev();
@@ -112,6 +133,7 @@ class I2Cdev {
         static int8_t readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout=I2Cdev::readTimeout);
 		static int8_t readBytes(uint8_t devAddr, uint8_t length, uint8_t *data, uint16_t timeout);
         static int8_t readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t *data, uint16_t timeout=I2Cdev::readTimeout);
+        static int16_t readBlock(uint8_t devAddr, uint8_t regAddr, uint16_t length, uint8_t *data, uint16_t timeout=I2Cdev::readTimeout);
 
         static bool writeBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t data);
         static bool writeBitW(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint16_t data);
@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTAccelPoseFit.h"
+
+RTAccelPoseFit::RTAccelPoseFit()
+{
+    reset();
+}
+
+void RTAccelPoseFit::reset()
+{
+    m_lastTimestamp = 0;
+    m_windowIndex = 0;
+    m_windowCount = 0;
+    m_still = false;
+
+    m_poseSum.zero();
+    m_poseSamples = 0;
+    m_poseCount = 0;
+
+    m_conditioning = 0;
+    m_residual = 1;
+
+    m_valid = false;
+    m_offset.zero();
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            m_corr[row][col] = (row == col) ? 1 : 0;
+    }
+}
+
+bool RTAccelPoseFit::addSample(const RTVector3& accel, uint64_t timestamp)
+{
+    //  a repeated timestamp is the same sample polled again and a gap means the window
+    //  no longer shows what happened in between
+
+    if (timestamp == m_lastTimestamp)
+        return false;
+
+    if ((m_lastTimestamp != 0) && ((timestamp < m_lastTimestamp) || (timestamp - m_lastTimestamp > RTACCELPOSEFIT_MAX_GAP))) {
+        m_windowCount = 0;
+        m_poseSamples = 0;
+        m_poseSum.zero();
+    }
+    m_lastTimestamp = timestamp;
+
+    m_window[m_windowIndex] = accel;
+    if (++m_windowIndex == RTACCELPOSEFIT_WINDOW)
+        m_windowIndex = 0;
+    if (m_windowCount < RTACCELPOSEFIT_WINDOW)
+        m_windowCount++;
+
+    m_still = windowStill();
+    if (!m_still) {
+        m_poseSamples = 0;
+        m_poseSum.zero();
+        return false;
+    }
+
+    if (m_poseSamples < 0)
+        return false;                                       // already taken in this still period
+
+    m_poseSum += accel;
+    if (++m_poseSamples < RTACCELPOSEFIT_POSE_SAMPLES)
+        return false;
+
+    addPose(m_poseSum, m_poseSamples);
+    m_poseSamples = -1;
+    return true;
+}
+
+bool RTAccelPoseFit::windowStill()
+{
+    RTVector3 mean;
+
+    if (m_windowCount < RTACCELPOSEFIT_WINDOW)
+        return false;
+
+    //  the window is small enough to go through every time, which avoids the rounding
+    //  of running sums of squares in float
+
+    mean.zero();
+    for (int i = 0; i < RTACCELPOSEFIT_WINDOW; i++)
+        mean += m_window[i];
+    mean /= RTACCELPOSEFIT_WINDOW;
+
+    RTFLOAT limit = RTACCELPOSEFIT_MAX_STD * RTACCELPOSEFIT_MAX_STD * RTACCELPOSEFIT_WINDOW;
+
+    for (int axis = 0; axis < 3; axis++) {
+        RTFLOAT sumSq = 0;
+
+        for (int i = 0; i < RTACCELPOSEFIT_WINDOW; i++) {
+            RTFLOAT delta = m_window[i].data(axis) - mean.data(axis);
+
+            sumSq += delta * delta;
+        }
+        if (sumSq > limit)
+            return false;
+    }
+    return true;
+}
+
+void RTAccelPoseFit::addPose(const RTVector3& pose, int samples)
+{
+    RTVector3 mean = pose / samples;
+    RTFLOAT length = mean.length();
+    RTFLOAT cosLimit = cos(RTACCELPOSEFIT_CLUSTER_ANGLE);
+
+    if ((length < RTACCELPOSEFIT_MIN_MAGNITUDE) || (length > RTACCELPOSEFIT_MAX_MAGNITUDE))
+        return;
+
+    for (int cluster = 0; cluster < m_poseCount; cluster++) {
+        RTVector3 clusterMean = m_clusterSum[cluster] / m_clusterSamples[cluster];
+
+        if (RTVector3::dotProduct(mean, clusterMean) >= cosLimit * length * clusterMean.length()) {
+            m_clusterSum[cluster] += pose;
+            m_clusterSamples[cluster] += samples;
+            solve();
+            return;
+        }
+    }
+
+    if (m_poseCount == RTACCELPOSEFIT_MAX_POSES)
+        return;
+
+    m_clusterSum[m_poseCount] = pose;
+    m_clusterSamples[m_poseCount] = samples;
+    m_poseCount++;
+    solve();
+}
+
+void RTAccelPoseFit::solve()
+{
+    RTEllipsoidFit fit;
+    double offset[3];
+    double corr[3][3];
+
+    for (int cluster = 0; cluster < m_poseCount; cluster++)
+        fit.addSample(m_clusterSum[cluster] / m_clusterSamples[cluster]);
+
+    if (!fit.evaluate()) {
+        m_conditioning = 0;
+        m_residual = 1;
+        return;
+    }
+    m_conditioning = fit.getConditioning();
+    m_residual = fit.getResidual();
+
+    if ((m_poseCount < RTACCELPOSEFIT_MIN_POSES) || (m_conditioning < RTACCELPOSEFIT_MIN_CONDITIONING) ||
+            (m_residual > RTACCELPOSEFIT_MAX_RESIDUAL))
+        return;
+
+    if (!fit.fit(offset, corr))
+        return;
+
+    //  RTEllipsoidFit scales to the smallest radius - an accelerometer has to be scaled
+    //  to 1g, so the correction is divided by that radius
+
+    const RTVector3& radii = fit.getRadii();
+    double minRadius = radii.x();
+
+    if (radii.y() < minRadius)
+        minRadius = radii.y();
+    if (radii.z() < minRadius)
+        minRadius = radii.z();
+
+    m_offset = RTVector3(offset[0], offset[1], offset[2]);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            m_corr[row][col] = corr[row][col] / minRadius;
+    }
+    m_valid = true;
+}
+
+void RTAccelPoseFit::getCorr(float corr[3][3])
+{
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            corr[row][col] = m_corr[row][col];
+    }
+}
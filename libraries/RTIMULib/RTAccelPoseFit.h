@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTACCELPOSEFIT_H
+#define	_RTACCELPOSEFIT_H
+
+#include "RTMath.h"
+#include "RTEllipsoidFit.h"
+
+//  RTAccelPoseFit calibrates the accelerometer from a handful of still poses instead of
+//  per axis min/max sweeps. The sensor is put down in one orientation after another and
+//  everything else is automatic:
+//
+//  - a pose is detected when the variance of every axis over the last
+//    RTACCELPOSEFIT_WINDOW samples is within RTACCELPOSEFIT_MAX_STD squared. Raw data can't
+//    use RTIMUStillDetector as its magnitude is not yet known to be 1g.
+//  - the next RTACCELPOSEFIT_POSE_SAMPLES still samples are averaged into the pose. One
+//    pose is taken per still period and any movement before it is complete drops it.
+//  - poses are clustered by the direction of gravity. A pose within
+//    RTACCELPOSEFIT_CLUSTER_ANGLE of an earlier one is averaged into it, so going back to
+//    an orientation refines it rather than weighting the fit towards it.
+//  - after every pose the full ellipsoid is refitted to the cluster means. Once there are
+//    RTACCELPOSEFIT_MIN_POSES clusters and RTEllipsoidFit::evaluate() finds the fit well
+//    conditioned with a small residual, the result is valid. It keeps being refined as
+//    more poses arrive.
+//
+//  The result is the offset and the matrix that map the raw ellipsoid onto the 1g sphere -
+//  RTIMU::calibrateAccel() applies it as the ellipsoid correction. Twelve or more poses
+//  spread over the sphere, for example the six faces plus the eight corners of a cube
+//  resting on a table, are enough. At a second per pose that is well under half a minute.
+
+#define RTACCELPOSEFIT_WINDOW           16                  // samples in the variance window
+#define RTACCELPOSEFIT_MAX_STD          0.01f               // largest rms per axis in a still window, g
+#define RTACCELPOSEFIT_POSE_SAMPLES     32                  // still samples averaged for a pose
+#define RTACCELPOSEFIT_MIN_MAGNITUDE    0.5f                // plausible range of |pose|, g
+#define RTACCELPOSEFIT_MAX_MAGNITUDE    1.5f
+#define RTACCELPOSEFIT_CLUSTER_ANGLE    (RTMATH_PI / 12)    // poses closer than this are the same, rad
+#define RTACCELPOSEFIT_MAX_POSES        32                  // distinct poses kept
+#define RTACCELPOSEFIT_MIN_POSES        12                  // distinct poses needed for a fit
+#define RTACCELPOSEFIT_MIN_CONDITIONING 0.05f               // see RTEllipsoidFit::evaluate()
+#define RTACCELPOSEFIT_MAX_RESIDUAL     0.005f              // rms |pose| error after correction, fraction of 1g
+#define RTACCELPOSEFIT_MAX_GAP          100000              // uS between samples that restarts the window
+
+class RTAccelPoseFit
+{
+public:
+    RTAccelPoseFit();
+
+    void reset();
+
+    //  addSample() takes the raw accel in g and its timestamp in uS. It returns true when a
+    //  pose has just been taken. A sample with the same timestamp as the last one is
+    //  ignored.
+
+    bool addSample(const RTVector3& accel, uint64_t timestamp);
+
+    bool isStill() { return m_still; }
+    int getPoseCount() { return m_poseCount; }              // distinct poses
+
+    //  the last fit, whether or not it passes the gates
+
+    RTFLOAT getConditioning() { return m_conditioning; }
+    RTFLOAT getResidual() { return m_residual; }
+
+    //  isValid() returns true once a fit has passed the gates. getOffset() and getCorr()
+    //  return the last such fit.
+
+    bool isValid() { return m_valid; }
+    const RTVector3& getOffset() { return m_offset; }
+    void getCorr(float corr[3][3]);
+
+private:
+    bool windowStill();                                     // the variance test
+    void addPose(const RTVector3& pose, int samples);       // clusters a completed pose
+    void solve();                                           // refits to the cluster means
+
+    uint64_t m_lastTimestamp;
+    RTVector3 m_window[RTACCELPOSEFIT_WINDOW];
+    int m_windowIndex;                                      // next slot to write
+    int m_windowCount;                                      // valid samples in the window
+    bool m_still;
+
+    RTVector3 m_poseSum;                                    // the pose being averaged
+    int m_poseSamples;                                      // samples in it, or -1 once taken
+
+    RTVector3 m_clusterSum[RTACCELPOSEFIT_MAX_POSES];       // sum of the samples of each pose
+    int m_clusterSamples[RTACCELPOSEFIT_MAX_POSES];
+    int m_poseCount;
+
+    RTFLOAT m_conditioning;
+    RTFLOAT m_residual;
+
+    bool m_valid;
+    RTVector3 m_offset;
+    float m_corr[3][3];
+};
+
+#endif // _RTACCELPOSEFIT_H
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTAltitude.h"
+
+RTAltitude::RTAltitude(RTFLOAT staticPressure, RTFLOAT latitude)
+{
+    double step = (double)(RTALTITUDE_RATIO_MAX - RTALTITUDE_RATIO_MIN) / RTALTITUDE_SEGMENTS;
+
+    //  the table is built once with pow() - d/dr r**a = a * r**a / r
+
+    for (int i = 0; i <= RTALTITUDE_SEGMENTS; i++) {
+        double r = RTALTITUDE_RATIO_MIN + i * step;
+        double value = pow(r, (double)RTALTITUDE_EXPONENT);
+
+        m_value[i] = value;
+        m_slope[i] = RTALTITUDE_EXPONENT * value / r * step;
+    }
+
+    setStaticPressure(staticPressure);
+    setLatitude(latitude);
+}
+
+void RTAltitude::setStaticPressure(RTFLOAT staticPressure)
+{
+    RTFLOAT step = (RTALTITUDE_RATIO_MAX - RTALTITUDE_RATIO_MIN) / RTALTITUDE_SEGMENTS;
+
+    m_staticPressure = staticPressure;
+    m_ratioScale = 1.0f / (staticPressure * step);
+    m_ratioOffset = RTALTITUDE_RATIO_MIN / step;
+}
+
+void RTAltitude::setLatitude(RTFLOAT latitude)
+{
+    RTFLOAT temp = sin(latitude / 57.29578);
+    RTFLOAT x = temp * temp;
+
+    m_gravity = 9.780318 * (1.0 + (5.2788E-3 + 2.36E-5 * x) * x);
+}
+
+RTFLOAT RTAltitude::height(RTFLOAT pressure)
+{
+    RTFLOAT x = pressure * m_ratioScale - m_ratioOffset;
+
+    if ((x < 0) || (x >= RTALTITUDE_SEGMENTS))
+        return RTMath::convertPressureToHeight(pressure, m_staticPressure);
+
+    int i = (int)x;
+    RTFLOAT t = x - i;
+    RTFLOAT v0 = m_value[i];
+    RTFLOAT v1 = m_value[i + 1];
+    RTFLOAT s0 = m_slope[i];
+    RTFLOAT s1 = m_slope[i + 1];
+
+    //  cubic Hermite segment in Horner form
+
+    RTFLOAT c2 = 3.0f * (v1 - v0) - 2.0f * s0 - s1;
+    RTFLOAT c3 = 2.0f * (v0 - v1) + s0 + s1;
+
+    return RTALTITUDE_SCALE * (1.0f - (v0 + t * (s0 + t * (c2 + t * c3))));
+}
+
+RTFLOAT RTAltitude::depth(RTFLOAT pressure)
+{
+    RTFLOAT g = m_gravity + 1.092E-10f * pressure;
+    RTFLOAT p = pressure - m_staticPressure;
+
+    return ((((-1.82E-15f * p + 2.279E-10f) * p - 2.251E-5f) * p + 9.72659f) * p) / g;
+    // http://www.seabird.com/document/an69-conversion-pressure-depth
+}
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTALTITUDE_H
+#define	_RTALTITUDE_H
+
+#include "RTMath.h"
+
+//  The barometric formula h = 44330.8 * (1 - (p / P0)**0.190263) is evaluated
+//  from a cubic Hermite table of r**0.190263 over the pressure ratio r = p / P0.
+//  With 64 segments between r = 0.25 and r = 1.25 the interpolation error is far
+//  below float resolution - the result is within 7mm of a double precision pow()
+//  between 300 and 1100hPa, about the same as a float pow(). Outside that range
+//  (above roughly 10km or far below sea level) pow() is used.
+
+#define RTALTITUDE_SEGMENTS             64                  // table segments
+#define RTALTITUDE_RATIO_MIN            0.25f               // lowest p / P0 in the table
+#define RTALTITUDE_RATIO_MAX            1.25f               // highest p / P0 in the table
+#define RTALTITUDE_EXPONENT             0.190263f
+#define RTALTITUDE_SCALE                44330.8f
+
+class RTAltitude
+{
+public:
+    RTAltitude(RTFLOAT staticPressure = 1013.25, RTFLOAT latitude = 32.13);
+
+    //  staticPressure is the sea level (or reference) pressure in hPa
+
+    void setStaticPressure(RTFLOAT staticPressure);
+    RTFLOAT getStaticPressure() { return m_staticPressure; }
+
+    //  latitude in degrees is only used for depth
+
+    void setLatitude(RTFLOAT latitude);
+
+    //  height() matches RTMath::convertPressureToHeight(), depth() matches
+    //  RTMath::convertPressureLatitudeToDepth(). pressure is in hPa (mbar).
+
+    RTFLOAT height(RTFLOAT pressure);
+    RTFLOAT depth(RTFLOAT pressure);
+
+private:
+    RTFLOAT m_staticPressure;
+    RTFLOAT m_ratioScale;                                   // segments per unit pressure: 1 / (P0 * step)
+    RTFLOAT m_ratioOffset;                                  // segment position of RTALTITUDE_RATIO_MIN
+    RTFLOAT m_gravity;                                      // latitude dependent part of g
+
+    RTFLOAT m_value[RTALTITUDE_SEGMENTS + 1];               // r**0.190263 at each knot
+    RTFLOAT m_slope[RTALTITUDE_SEGMENTS + 1];               // derivative at each knot times step
+};
+
+#endif // _RTALTITUDE_H
@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTCompassSmoother.h"
+
+RTCompassSmoother::RTCompassSmoother()
+{
+    m_type = RTCOMPASSSMOOTH_BOXCAR;
+    m_length = RTCOMPASSSMOOTH_LENGTH;
+    m_timeConstant = RTCOMPASSSMOOTH_TIME_CONSTANT;
+    m_minCutoff = RTCOMPASSSMOOTH_MIN_CUTOFF;
+    m_beta = RTCOMPASSSMOOTH_BETA;
+    reset();
+}
+
+void RTCompassSmoother::setType(int type)
+{
+    if ((type < 0) || (type >= RTCOMPASSSMOOTH_TYPE_COUNT))
+        type = RTCOMPASSSMOOTH_BOXCAR;
+    m_type = type;
+    reset();
+}
+
+void RTCompassSmoother::setBoxcarLength(int length)
+{
+    if (length < 1)
+        length = 1;
+    if (length > RTCOMPASSSMOOTH_MAX_LENGTH)
+        length = RTCOMPASSSMOOTH_MAX_LENGTH;
+    m_length = length;
+    reset();
+}
+
+void RTCompassSmoother::setTimeConstant(RTFLOAT timeConstant)
+{
+    m_timeConstant = (timeConstant > 0) ? timeConstant : 0;
+    reset();
+}
+
+void RTCompassSmoother::setOneEuro(RTFLOAT minCutoff, RTFLOAT beta)
+{
+    m_minCutoff = (minCutoff > 0) ? minCutoff : RTCOMPASSSMOOTH_MIN_CUTOFF;
+    m_beta = (beta > 0) ? beta : 0;
+    reset();
+}
+
+void RTCompassSmoother::reset()
+{
+    m_primed = false;
+    m_lastTimestamp = 0;
+    m_output.zero();
+    m_boxcarSum.zero();
+    m_boxcarIndex = 0;
+    m_boxcarCount = 0;
+    m_derivative.zero();
+}
+
+const char *RTCompassSmoother::smootherName(int type)
+{
+    switch (type) {
+    case RTCOMPASSSMOOTH_NONE:
+        return "none";
+    case RTCOMPASSSMOOTH_BOXCAR:
+        return "boxcar";
+    case RTCOMPASSSMOOTH_EXPONENTIAL:
+        return "exponential";
+    case RTCOMPASSSMOOTH_ONE_EURO:
+        return "one euro";
+    }
+    return "unknown";
+}
+
+RTFLOAT RTCompassSmoother::alpha(RTFLOAT cutoff, RTFLOAT dt)
+{
+    RTFLOAT tau = 1.0f / (2.0f * (RTFLOAT)RTMATH_PI * cutoff);
+
+    return dt / (dt + tau);
+}
+
+const RTVector3& RTCompassSmoother::update(const RTVector3& mag, uint64_t timestamp)
+{
+    RTFLOAT dt = (RTFLOAT)(timestamp - m_lastTimestamp) / 1000000.0f;
+
+    //  the filters restart from the current sample after a gap
+
+    if (!m_primed || (timestamp <= m_lastTimestamp) || (timestamp - m_lastTimestamp > RTCOMPASSSMOOTH_MAX_GAP)) {
+        reset();
+        m_primed = true;
+        m_lastTimestamp = timestamp;
+        m_output = mag;
+        m_boxcar[0] = mag;
+        m_boxcarSum = mag;
+        m_boxcarIndex = 1 % m_length;
+        m_boxcarCount = 1;
+        return m_output;
+    }
+    m_lastTimestamp = timestamp;
+
+    switch (m_type) {
+    case RTCOMPASSSMOOTH_BOXCAR:
+        if (m_boxcarCount == m_length)
+            m_boxcarSum -= m_boxcar[m_boxcarIndex];
+        else
+            m_boxcarCount++;
+        m_boxcar[m_boxcarIndex] = mag;
+        m_boxcarSum += mag;
+        if (++m_boxcarIndex == m_length) {
+            m_boxcarIndex = 0;
+
+            //  resum once per lap so float rounding in the running sum can't build up
+
+            m_boxcarSum.zero();
+            for (int i = 0; i < m_boxcarCount; i++)
+                m_boxcarSum += m_boxcar[i];
+        }
+        m_output = m_boxcarSum / (RTFLOAT)m_boxcarCount;
+        break;
+
+    case RTCOMPASSSMOOTH_EXPONENTIAL:
+        m_output += (mag - m_output) * (dt / (dt + m_timeConstant));
+        break;
+
+    case RTCOMPASSSMOOTH_ONE_EURO:
+    {
+        RTVector3 change = (mag - m_output) / dt;
+
+        m_derivative += (change - m_derivative) * alpha(RTCOMPASSSMOOTH_DERIVATIVE_CUTOFF, dt);
+        m_output += (mag - m_output) * alpha(m_minCutoff + m_beta * m_derivative.length(), dt);
+        break;
+    }
+
+    default:
+        m_output = mag;
+        break;
+    }
+    return m_output;
+}
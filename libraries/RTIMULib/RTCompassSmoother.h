@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTCOMPASSSMOOTHER_H
+#define	_RTCOMPASSSMOOTHER_H
+
+#include "RTMath.h"
+
+//  RTCompassSmoother reduces compass noise before fusion. The options trade noise against
+//  the heading lag they add:
+//
+//  none          raw calibrated samples, no lag
+//  boxcar        mean of the last N samples, (N - 1) / 2 samples of lag - the original
+//                20 sample average is 95mS at 100Hz
+//  exponential   first order low pass with time constant tau, tau of lag
+//  one euro      first order low pass whose cutoff rises with the rate of change of the
+//                field (Casiez et al, CHI 2012) - heavy smoothing when the heading is
+//                steady and little lag while it turns
+//
+//  The exponential and one euro filters use the sample timestamps, so they behave the
+//  same at any compass rate. Feed only new compass samples - a repeated sample would count
+//  twice in the boxcar and looks like a stop to the one euro filter. Each update is O(1).
+
+#define RTCOMPASSSMOOTH_NONE                0               // compass smoothing types
+#define RTCOMPASSSMOOTH_BOXCAR              1
+#define RTCOMPASSSMOOTH_EXPONENTIAL         2
+#define RTCOMPASSSMOOTH_ONE_EURO            3
+#define RTCOMPASSSMOOTH_TYPE_COUNT          4
+
+#define RTCOMPASSSMOOTH_MAX_LENGTH          32              // largest boxcar
+#define RTCOMPASSSMOOTH_LENGTH              20              // default boxcar length, samples
+#define RTCOMPASSSMOOTH_TIME_CONSTANT       0.05f           // default exponential time constant, seconds
+#define RTCOMPASSSMOOTH_MIN_CUTOFF          1.0f            // default one euro cutoff when steady, Hz
+#define RTCOMPASSSMOOTH_BETA                0.1f            // default cutoff increase, Hz per uT/s
+#define RTCOMPASSSMOOTH_DERIVATIVE_CUTOFF   1.0f            // cutoff of the rate of change estimate, Hz
+#define RTCOMPASSSMOOTH_MAX_GAP             500000          // uS between samples that restarts the filter
+
+class RTCompassSmoother
+{
+public:
+    RTCompassSmoother();
+
+    //  the setters all reset the filter
+
+    void setType(int type);
+    void setBoxcarLength(int length);
+    void setTimeConstant(RTFLOAT timeConstant);
+    void setOneEuro(RTFLOAT minCutoff, RTFLOAT beta);
+
+    void reset();
+
+    //  update() takes a new compass sample in uT and its timestamp in uS and returns the
+    //  smoothed field
+
+    const RTVector3& update(const RTVector3& mag, uint64_t timestamp);
+
+    int getType() { return m_type; }
+    static const char *smootherName(int type);
+
+private:
+    static RTFLOAT alpha(RTFLOAT cutoff, RTFLOAT dt);       // first order low pass gain
+
+    int m_type;
+    int m_length;
+    RTFLOAT m_timeConstant;
+    RTFLOAT m_minCutoff;
+    RTFLOAT m_beta;
+
+    bool m_primed;                                          // false until the first sample
+    uint64_t m_lastTimestamp;
+    RTVector3 m_output;
+
+    RTVector3 m_boxcar[RTCOMPASSSMOOTH_MAX_LENGTH];
+    RTVector3 m_boxcarSum;
+    int m_boxcarIndex;                                      // next slot to write
+    int m_boxcarCount;
+
+    RTVector3 m_derivative;                                 // filtered rate of change, uT/s
+};
+
+#endif // _RTCOMPASSSMOOTHER_H
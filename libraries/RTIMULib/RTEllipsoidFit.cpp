@@ -0,0 +1,272 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTEllipsoidFit.h"
+
+RTEllipsoidFit::RTEllipsoidFit()
+{
+    reset();
+}
+
+void RTEllipsoidFit::reset()
+{
+    m_count = 0;
+    m_DtD.fill(0);
+    m_Dt1.fill(0);
+    m_radii.zero();
+
+    m_conditioning = 0;
+    m_residual = 1;
+    m_fitChange = 1;
+    m_lastOffsetValid = false;
+}
+
+void RTEllipsoidFit::addSample(const RTVector3& sample)
+{
+    double x = sample.x();
+    double y = sample.y();
+    double z = sample.z();
+    double d[RTELLIPSOIDFIT_PARAMS] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z};
+
+    for (int row = 0; row < RTELLIPSOIDFIT_PARAMS; row++) {
+        for (int col = row; col < RTELLIPSOIDFIT_PARAMS; col++)
+            m_DtD(row, col) += d[row] * d[col];
+        m_Dt1(row, 0) += d[row];
+    }
+    m_count++;
+}
+
+bool RTEllipsoidFit::fit(RTVector3& offset, float corr[3][3])
+{
+    double offsetD[3];
+    double corrD[3][3];
+
+    if (!fit(offsetD, corrD))
+        return false;
+
+    offset = RTVector3(offsetD[0], offsetD[1], offsetD[2]);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            corr[row][col] = corrD[row][col];
+    }
+    return true;
+}
+
+void RTEllipsoidFit::normalMatrix(RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS, double>& DtD)
+{
+    DtD = m_DtD;
+    for (int row = 1; row < RTELLIPSOIDFIT_PARAMS; row++) {
+        for (int col = 0; col < row; col++)
+            DtD(row, col) = DtD(col, row);
+    }
+}
+
+bool RTEllipsoidFit::fit(double offset[3], double corr[3][3])
+{
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS, double> DtD;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, 1, double> v;
+
+    if (m_count < RTELLIPSOIDFIT_MIN_SAMPLES)
+        return false;
+
+    normalMatrix(DtD);
+    if (!DtD.choleskySolve(m_Dt1, v))
+        return false;
+
+    //  the quadratic part and the centre, -A \ [G H I]
+
+    RTMatrix<3, 3, double> A;
+    RTMatrix<3, 1, double> b;
+    RTMatrix<3, 1, double> center;
+
+    A(0, 0) = v(0, 0);
+    A(1, 1) = v(1, 0);
+    A(2, 2) = v(2, 0);
+    A(0, 1) = A(1, 0) = v(3, 0);
+    A(0, 2) = A(2, 0) = v(4, 0);
+    A(1, 2) = A(2, 1) = v(5, 0);
+    for (int i = 0; i < 3; i++)
+        b(i, 0) = -v(6 + i, 0);
+
+    if (!A.solve(b, center))
+        return false;
+
+    //  moving the origin to the centre changes the constant term to
+    //  c' A c + 2 [G H I] c - 1, the ellipsoid is then A / -constant (A and the
+    //  constant both change sign when the origin is outside the ellipsoid)
+
+    double constant = -1;
+
+    for (int i = 0; i < 3; i++) {
+        double Ac = A(i, 0) * center(0, 0) + A(i, 1) * center(1, 0) + A(i, 2) * center(2, 0);
+
+        constant += center(i, 0) * Ac + 2 * v(6 + i, 0) * center(i, 0);
+    }
+    if (constant == 0)
+        return false;
+
+    RTMatrix<3, 3, double> evecs;
+    RTMatrix<3, 1, double> evals;
+    double radii[3];
+    double minRadius;
+
+    (A * (-1 / constant)).symmetricEigen(evecs, evals);
+
+    for (int i = 0; i < 3; i++) {
+        if (evals(i, 0) <= 0)
+            return false;                                   // a hyperboloid, not an ellipsoid
+        radii[i] = sqrt(1 / evals(i, 0));
+    }
+    minRadius = radii[0];
+    if (radii[1] < minRadius)
+        minRadius = radii[1];
+    if (radii[2] < minRadius)
+        minRadius = radii[2];
+
+    //  corr = evecs * diag(minRadius / radii) * evecs'
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            double sum = 0;
+
+            for (int k = 0; k < 3; k++)
+                sum += evecs(row, k) * (minRadius / radii[k]) * evecs(col, k);
+            corr[row][col] = sum;
+        }
+    }
+
+    //  sum of the squared algebraic residuals, N - v'D'1
+
+    double sumSq = m_count;
+
+    for (int i = 0; i < RTELLIPSOIDFIT_PARAMS; i++)
+        sumSq -= v(i, 0) * m_Dt1(i, 0);
+    if (sumSq < 0)
+        sumSq = 0;
+
+    for (int i = 0; i < 3; i++)
+        offset[i] = center(i, 0);
+    m_radii = RTVector3(radii[0], radii[1], radii[2]);
+    m_residual = sqrt(sumSq / m_count) / (2 * fabs(constant));
+    return true;
+}
+
+bool RTEllipsoidFit::evaluate()
+{
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS, double> DtD;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS> scaled;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS> vectors;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, 1> values;
+    double diagonal[RTELLIPSOIDFIT_PARAMS];
+    double offset[3];
+    double corr[3][3];
+
+    m_conditioning = 0;
+    m_fitChange = 1;
+
+    if (!fit(offset, corr)) {
+        m_residual = 1;
+        m_lastOffsetValid = false;
+        return false;
+    }
+
+    //  the normal matrix depends on where the origin is - the columns of x^2 and x are
+    //  nearly parallel when the samples are far from it - so it is moved to the fitted
+    //  centre first. With the constant 1 appended to d, d about the centre is S d and the
+    //  augmented normal matrix becomes S [D'D D'1; 1'D N] S'.
+
+    RTMatrix<RTELLIPSOIDFIT_PARAMS + 1, RTELLIPSOIDFIT_PARAMS + 1, double> E;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS + 1, RTELLIPSOIDFIT_PARAMS + 1, double> shift;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS + 1, RTELLIPSOIDFIT_PARAMS + 1, double> centred;
+    static const int cross[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+
+    normalMatrix(DtD);
+    for (int row = 0; row < RTELLIPSOIDFIT_PARAMS; row++) {
+        for (int col = 0; col < RTELLIPSOIDFIT_PARAMS; col++)
+            E(row, col) = DtD(row, col);
+        E(row, RTELLIPSOIDFIT_PARAMS) = E(RTELLIPSOIDFIT_PARAMS, row) = m_Dt1(row, 0);
+    }
+    E(RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS) = m_count;
+
+    shift.setToIdentity();
+    for (int i = 0; i < 3; i++) {
+        //  (x - c)^2 = x^2 - c * 2x + c^2 and 2(x - c) = 2x - 2c
+
+        shift(i, 6 + i) = -offset[i];
+        shift(i, RTELLIPSOIDFIT_PARAMS) = offset[i] * offset[i];
+        shift(6 + i, RTELLIPSOIDFIT_PARAMS) = -2 * offset[i];
+
+        //  2(x - cx)(y - cy) = 2xy - cy * 2x - cx * 2y + 2cxcy
+
+        int a = cross[i][0];
+        int b = cross[i][1];
+
+        shift(3 + i, 6 + a) = -offset[b];
+        shift(3 + i, 6 + b) = -offset[a];
+        shift(3 + i, RTELLIPSOIDFIT_PARAMS) = 2 * offset[a] * offset[b];
+    }
+    centred = shift * E * shift.transposed();
+
+    //  the scaled matrix has a unit diagonal so float is plenty for the eigenvalues
+
+    for (int i = 0; i < RTELLIPSOIDFIT_PARAMS; i++)
+        diagonal[i] = 1 / sqrt(centred(i, i));
+    for (int row = 0; row < RTELLIPSOIDFIT_PARAMS; row++) {
+        for (int col = 0; col < RTELLIPSOIDFIT_PARAMS; col++)
+            scaled(row, col) = centred(row, col) * diagonal[row] * diagonal[col];
+    }
+    scaled.symmetricEigen(vectors, values);
+
+    RTFLOAT smallest = values(0, 0);
+    RTFLOAT largest = values(0, 0);
+
+    for (int i = 1; i < RTELLIPSOIDFIT_PARAMS; i++) {
+        if (values(i, 0) < smallest)
+            smallest = values(i, 0);
+        if (values(i, 0) > largest)
+            largest = values(i, 0);
+    }
+    if ((smallest > 0) && (largest > 0))
+        m_conditioning = smallest / largest;
+
+    //  centre movement against the smallest radius
+
+    RTFLOAT minRadius = m_radii.x();
+
+    if (m_radii.y() < minRadius)
+        minRadius = m_radii.y();
+    if (m_radii.z() < minRadius)
+        minRadius = m_radii.z();
+
+    if (m_lastOffsetValid) {
+        double dx = offset[0] - m_lastOffset[0];
+        double dy = offset[1] - m_lastOffset[1];
+        double dz = offset[2] - m_lastOffset[2];
+
+        m_fitChange = sqrt(dx * dx + dy * dy + dz * dz) / minRadius;
+    }
+    for (int i = 0; i < 3; i++)
+        m_lastOffset[i] = offset[i];
+    m_lastOffsetValid = true;
+    return true;
+}
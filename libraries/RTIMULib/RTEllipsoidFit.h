@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTELLIPSOIDFIT_H
+#define	_RTELLIPSOIDFIT_H
+
+#include "RTMath.h"
+
+//  RTEllipsoidFit is the ellipsoid_fit.m least squares fit of
+//
+//  Ax^2 + By^2 + Cz^2 + 2Dxy + 2Exz + 2Fyz + 2Gx + 2Hy + 2Iz = 1
+//
+//  done on the device. Each sample is added straight into the 9x9 normal equations so
+//  memory use does not depend on the number of samples and nothing has to be stored.
+//  The sums are kept in double - with samples of 50uT or more they outgrow float
+//  precision after a few hundred samples.
+//
+//  fit() gives the same offset and correction matrix as RTEllipsoidFitMag.m: the
+//  correction rotates onto the ellipsoid axes, scales every axis to the smallest radius
+//  and rotates back.
+//
+//  evaluate() measures how well the samples so far pin the fit down, so that a
+//  calibration can stop as soon as the data is good enough:
+//
+//  conditioning - smallest over largest eigenvalue of the normal matrix, taken about the
+//  fitted centre and with its diagonal scaled to one so that neither the offset nor the
+//  units matter. It drops towards zero when the samples leave some combination of the
+//  parameters undetermined, for example when one side of the sphere is missing.
+//
+//  residual - rms distance of the samples from the fitted surface as a fraction of the
+//  radius. The algebraic residual of a sample is d'v - 1 and, as the least squares
+//  residual is orthogonal to the fit, their sum of squares is N - v'D'1. Near the surface
+//  an algebraic residual e is a radial error of about e / 2 in units of the radius, once
+//  v is scaled so that the ellipsoid is x'Ax = 1 about its centre.
+//
+//  fit change - how far the centre has moved since the previous evaluate(), as a
+//  fraction of the smallest radius.
+//
+//  evaluate() costs a fit plus a 9x9 eigen decomposition whatever the number of samples,
+//  so it is meant to be run every few samples rather than on every one.
+
+#define RTELLIPSOIDFIT_PARAMS           9                   // quadric parameters A to I
+#define RTELLIPSOIDFIT_MIN_SAMPLES      9                   // fewer leave the fit undetermined
+
+class RTEllipsoidFit
+{
+public:
+    RTEllipsoidFit();
+
+    void reset();
+
+    void addSample(const RTVector3& sample);
+    int getSampleCount() { return m_count; }
+
+    //  fit() returns false if the samples do not describe an ellipsoid (too few, all in a
+    //  plane and so on). offset and corr are left untouched in that case. The double
+    //  version is for host tools that need the full precision of the solve.
+
+    bool fit(RTVector3& offset, float corr[3][3]);
+    bool fit(double offset[3], double corr[3][3]);
+
+    //  radii of the last successful fit, in eigenvector order
+
+    const RTVector3& getRadii() { return m_radii; }
+
+    //  evaluate() returns false if the fit fails, and the metrics are then set to their
+    //  worst values
+
+    bool evaluate();
+
+    RTFLOAT getConditioning() { return m_conditioning; }    // 0 to 1, larger is better
+    RTFLOAT getResidual() { return m_residual; }            // fraction of the radius
+    RTFLOAT getFitChange() { return m_fitChange; }          // fraction of the smallest radius
+
+private:
+    void normalMatrix(RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS, double>& DtD);
+
+    int m_count;
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, RTELLIPSOIDFIT_PARAMS, double> m_DtD;   // upper triangle only
+    RTMatrix<RTELLIPSOIDFIT_PARAMS, 1, double> m_Dt1;
+    RTVector3 m_radii;
+
+    RTFLOAT m_conditioning;
+    RTFLOAT m_residual;                                     // of the last successful fit
+    RTFLOAT m_fitChange;
+    double m_lastOffset[3];                                 // centre at the last evaluate()
+    bool m_lastOffsetValid;
+};
+
+#endif // _RTELLIPSOIDFIT_H
@@ -44,6 +44,7 @@ RTFusion::RTFusion()
     m_enableGyro = true;
     m_enableAccel = true;
     m_enableCompass = true;
+    m_compassNew = true;
 
     m_gravity.setScalar(0);
     m_gravity.setX(0);
@@ -69,7 +70,10 @@ void RTFusion::calculatePose(const RTVector3& accel, const RTVector3& mag, float
         m_measuredPose.setZ(0);
     }
 
-    if (m_enableCompass && m_compassValid) {
+    //  a stale compass sample is a repeat of one already used, so after the first
+    //  pose the heading is only corrected when a fresh one arrives
+
+    if (m_enableCompass && m_compassValid && (m_compassNew || m_firstTime)) {
         q.fromEuler(m_measuredPose);
         m.setScalar(0);
         m.setX(mag.x());
@@ -99,6 +99,7 @@ protected:
     bool m_enableAccel;                                     // enables accel as input
     bool m_enableCompass;                                   // enables compass a input
     bool m_compassValid;                                    // true if compass data valid
+    bool m_compassNew;                                      // true if the compass sample is fresh
 
     bool m_firstTime;                                       // if first time after reset
     uint64_t m_lastFusionTime;                              // for delta time calculation
@@ -85,6 +85,7 @@ void RTFusionAHRS::newIMUData(RTIMU_DATA& data, const RTIMUSettings *settings)
     m_accel = data.accel;
     m_compass = data.compass;
     m_compassValid = data.compassValid;
+    m_compassNew = data.compassNew;
 
     if (m_firstTime) {
         
@@ -135,7 +136,7 @@ void RTFusionAHRS::newIMUData(RTIMU_DATA& data, const RTIMUSettings *settings)
         float _4q1, _4q2, _4q3, _8q2, _8q3;
         float _2q3q4, _2q1q3;
 
-        if (m_enableCompass) {
+        if (m_enableCompass && m_compassNew) {
           mx = m_compass.x();
           my = m_compass.y();
           mz = m_compass.z();
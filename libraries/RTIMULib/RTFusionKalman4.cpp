@@ -132,7 +132,7 @@ void RTFusionKalman4::predict()
 void RTFusionKalman4::update()
 {
     RTQuaternion delta;
-    RTMatrix4x4 Sk, SkInverse;
+    RTMatrix4x4 Sk, KkTranspose;
 
     if (m_enableCompass || m_enableAccel) {
         m_stateQError = m_measuredQPose - m_stateQ;
@@ -146,11 +146,14 @@ void RTFusionKalman4::update()
     Sk = m_Pkk_1 + m_Rk;
 
     //	Compute Kalman gain Kk = Pkk_1 * HkTranspose * SkInverse
-    //  Note: again, the HkTranspose part is omitted
+    //  Note: again, the HkTranspose part is omitted. Sk is a covariance, so symmetric
+    //  positive definite, and Kk' = SkInverse * Pkk_1' is a Cholesky solve with no
+    //  inverse. The general inverse is only needed if rounding has broken that.
 
-    SkInverse = Sk.inverted();
-
-    m_Kk = m_Pkk_1 * SkInverse;
+    if (Sk.choleskySolve(m_Pkk_1.transposed(), KkTranspose))
+        m_Kk = KkTranspose.transposed();
+    else
+        m_Kk = m_Pkk_1 * Sk.inverted();
 
     if (m_debug)
         HAL_INFO(RTMath::display("Gain", m_Kk));
@@ -184,6 +187,7 @@ void RTFusionKalman4::newIMUData(RTIMU_DATA& data, const RTIMUSettings *settings
     m_accel = data.accel;
     m_compass = data.compass;
     m_compassValid = data.compassValid;
+    m_compassNew = data.compassNew;
 
     if (m_firstTime) {
         m_lastFusionTime = data.timestamp;
@@ -86,10 +86,10 @@ void RTFusionRTQF::update()
 
         // take it to the power (0 to 1) to give the desired amount of correction
 
-        RTFLOAT theta = acos(m_rotationDelta.scalar());
+        RTFLOAT theta = RTMATH_ACOS(m_rotationDelta.scalar());
 
-        RTFLOAT sinPowerTheta = sin(theta * m_slerpPower);
-        RTFLOAT cosPowerTheta = cos(theta * m_slerpPower);
+        RTFLOAT sinPowerTheta = RTMATH_SIN(theta * m_slerpPower);
+        RTFLOAT cosPowerTheta = RTMATH_COS(theta * m_slerpPower);
 
         m_rotationUnitVector.setX(m_rotationDelta.x());
         m_rotationUnitVector.setY(m_rotationDelta.y());
@@ -124,6 +124,7 @@ void RTFusionRTQF::newIMUData(RTIMU_DATA& data, const RTIMUSettings *settings)
     m_accel = data.accel;
     m_compass = data.compass;
     m_compassValid = data.compassValid;
+    m_compassNew = data.compassNew;
 
     if (m_firstTime) {
         m_lastFusionTime = data.timestamp;
@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTGyroScaleFit.h"
+
+RTGyroScaleFit::RTGyroScaleFit()
+{
+    reset();
+}
+
+void RTGyroScaleFit::reset()
+{
+    m_stillDetector.reset();
+    m_gyroPose = RTQuaternion(1, 0, 0, 0);
+    m_lastTimestamp = 0;
+    m_accelSum.zero();
+    m_compassSum.zero();
+    m_stillCount = 0;
+    m_haveReference = false;
+    m_thetaS.fill(0);
+    m_SS.fill(0);
+    m_rotations = 0;
+    m_rejected = 0;
+}
+
+bool RTGyroScaleFit::addSample(const RTVector3& gyro, const RTVector3& accel, const RTVector3& compass, uint64_t timestamp)
+{
+    bool accepted = false;
+
+    //  integrate the gyro on every sample so that the start of a rotation is not lost while
+    //  the still detector catches up. A gap spoils the rotation in progress. A repeated
+    //  timestamp is the same sample polled again.
+
+    if (timestamp == m_lastTimestamp)
+        return false;
+
+    if (m_lastTimestamp != 0) {
+        if ((timestamp <= m_lastTimestamp) || (timestamp - m_lastTimestamp > RTGYROSCALEFIT_MAX_GAP)) {
+            m_haveReference = false;
+        } else {
+            RTVector3 rate = gyro;
+            RTFLOAT length = rate.length();
+            RTFLOAT halfAngle = length * (RTFLOAT)(timestamp - m_lastTimestamp) / 2000000.0f;
+
+            //  the fast sin/cos approximations would bias the scale, so these are exact
+
+            if (length > 0) {
+                RTFLOAT k = sin(halfAngle) / length;
+
+                m_gyroPose *= RTQuaternion(cos(halfAngle), gyro.x() * k, gyro.y() * k, gyro.z() * k);
+                m_gyroPose.normalize();
+            }
+        }
+    }
+    m_lastTimestamp = timestamp;
+
+    if (!m_stillDetector.update(accel, gyro)) {
+        m_stillCount = 0;
+        m_accelSum.zero();
+        m_compassSum.zero();
+        return false;
+    }
+
+    //  only the start of a still period is averaged, so the samples the detector still
+    //  calls still after the next rotation has begun are not included
+
+    if (m_stillCount >= RTGYROSCALEFIT_STILL_SAMPLES)
+        return false;
+
+    m_accelSum += accel;
+    m_compassSum += compass;
+    if (++m_stillCount < RTGYROSCALEFIT_STILL_SAMPLES)
+        return false;
+
+    RTMatrix<3, 3> triad;
+
+    referenceAttitude(m_accelSum, m_compassSum, triad);
+
+    if (m_haveReference) {
+        //  with triads of fixed world vectors in body axes T = R' * W, the body frame
+        //  rotation between them is T0 * T1'
+
+        RTVector3 s = rotationVector(m_referencePose.conjugate() * m_gyroPose);
+        RTVector3 theta = rotationVector(matrixToQuaternion(m_referenceTriad * triad.transposed()));
+        RTVector3 error = theta - s;
+        RTFLOAT angle = s.length();
+
+        if ((angle >= RTGYROSCALEFIT_MIN_ANGLE) && (angle <= RTGYROSCALEFIT_MAX_ANGLE) &&
+                (error.length() < RTGYROSCALEFIT_MAX_MISMATCH * angle)) {
+            for (int row = 0; row < 3; row++) {
+                for (int col = 0; col < 3; col++) {
+                    m_thetaS(row, col) += (double)theta.data(row) * s.data(col);
+                    m_SS(row, col) += (double)s.data(row) * s.data(col);
+                }
+            }
+            m_rotations++;
+            accepted = true;
+        } else if (angle >= RTGYROSCALEFIT_MIN_ANGLE) {
+            m_rejected++;
+        }
+    }
+
+    m_referenceTriad = triad;
+    m_referencePose = m_gyroPose;
+    m_haveReference = true;
+    return accepted;
+}
+
+RTFLOAT RTGyroScaleFit::getExcitation()
+{
+    RTMatrix<3, 3, double> vectors;
+    RTMatrix<3, 1, double> values;
+    double smallest;
+
+    if (!m_SS.symmetricEigen(vectors, values))
+        return 0;
+
+    smallest = values(0, 0);
+    for (int i = 1; i < 3; i++) {
+        if (values(i, 0) < smallest)
+            smallest = values(i, 0);
+    }
+    return (smallest > 0) ? sqrt(smallest) : 0;
+}
+
+bool RTGyroScaleFit::fit(float corr[3][3])
+{
+    RTMatrix<3, 3, double> B;
+    RTMatrix<3, 3, double> X;
+
+    if ((m_rotations < RTGYROSCALEFIT_MIN_ROTATIONS) || (getExcitation() < RTGYROSCALEFIT_MIN_EXCITATION))
+        return false;
+
+    //  C * SS = thetaS, and SS is symmetric, so SS * C' = thetaS'
+
+    B = m_thetaS.transposed();
+    if (!m_SS.choleskySolve(B, X))
+        return false;
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            double deviation = X(col, row) - ((row == col) ? 1 : 0);
+
+            if ((deviation > RTGYROSCALEFIT_MAX_CORRECTION) || (deviation < -RTGYROSCALEFIT_MAX_CORRECTION))
+                return false;
+        }
+    }
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            corr[row][col] = X(col, row);
+    }
+    return true;
+}
+
+void RTGyroScaleFit::referenceAttitude(const RTVector3& accel, const RTVector3& compass, RTMatrix<3, 3>& triad)
+{
+    RTVector3 e1, e2, e3;
+
+    //  columns are gravity, gravity x field and the third axis, all in body axes
+
+    e3 = accel;
+    e3.normalize();
+    RTVector3::crossProduct(e3, compass, e2);
+    e2.normalize();
+    RTVector3::crossProduct(e2, e3, e1);
+
+    for (int row = 0; row < 3; row++) {
+        triad(row, 0) = e1.data(row);
+        triad(row, 1) = e2.data(row);
+        triad(row, 2) = e3.data(row);
+    }
+}
+
+RTQuaternion RTGyroScaleFit::matrixToQuaternion(const RTMatrix<3, 3>& m)
+{
+    RTFLOAT trace = m(0, 0) + m(1, 1) + m(2, 2);
+    RTFLOAT s;
+
+    //  Shepperd's method - divide by the largest of the four candidates
+
+    if ((trace >= m(0, 0)) && (trace >= m(1, 1)) && (trace >= m(2, 2))) {
+        s = 2 * sqrt(1 + trace);
+        return RTQuaternion(s / 4, (m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s);
+    }
+    if ((m(0, 0) >= m(1, 1)) && (m(0, 0) >= m(2, 2))) {
+        s = 2 * sqrt(1 + m(0, 0) - m(1, 1) - m(2, 2));
+        return RTQuaternion((m(2, 1) - m(1, 2)) / s, s / 4, (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s);
+    }
+    if (m(1, 1) >= m(2, 2)) {
+        s = 2 * sqrt(1 - m(0, 0) + m(1, 1) - m(2, 2));
+        return RTQuaternion((m(0, 2) - m(2, 0)) / s, (m(0, 1) + m(1, 0)) / s, s / 4, (m(1, 2) + m(2, 1)) / s);
+    }
+    s = 2 * sqrt(1 - m(0, 0) - m(1, 1) + m(2, 2));
+    return RTQuaternion((m(1, 0) - m(0, 1)) / s, (m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / 4);
+}
+
+RTVector3 RTGyroScaleFit::rotationVector(const RTQuaternion& q)
+{
+    RTFLOAT sign = (q.scalar() < 0) ? -1 : 1;
+    RTVector3 axis(q.x() * sign, q.y() * sign, q.z() * sign);
+    RTFLOAT sinHalf = axis.length();
+
+    if (sinHalf <= 0)
+        return RTVector3(0, 0, 0);
+
+    return axis * (2 * atan2(sinHalf, q.scalar() * sign) / sinHalf);
+}
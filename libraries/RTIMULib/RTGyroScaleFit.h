@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTGYROSCALEFIT_H
+#define	_RTGYROSCALEFIT_H
+
+#include "RTMath.h"
+#include "RTIMUStillDetector.h"
+
+//  RTGyroScaleFit estimates the full 3x3 gyro correction - scale factors and axis
+//  misalignment - from deliberate rotations between still poses. Each still pose gives a
+//  reference attitude from the averaged accel and compass, independent of the gyro, and
+//  the bias corrected gyro is integrated into a quaternion throughout. For each rotation
+//  between two still poses:
+//
+//  theta = C * s
+//
+//  where theta is the rotation vector between the two reference attitudes, s is the
+//  rotation vector of the integrated gyro over the same interval and C is the correction
+//  to be applied to the gyro rates. This is exact for a rotation about a fixed axis and
+//  close for hand held turns. Only the 3x3 sums of theta * s' and s * s' are kept, so
+//  any number of rotations costs the same memory, and the fit is one 3x3 solve.
+//
+//  Rotations need to be between RTGYROSCALEFIT_MIN_ANGLE (smaller ones carry little scale
+//  information) and RTGYROSCALEFIT_MAX_ANGLE (the rotation vector is ambiguous near 180
+//  degrees). Rotations where the gyro and the reference disagree by more than
+//  RTGYROSCALEFIT_MAX_MISMATCH, typically from a magnetic disturbance, are rejected.
+//  About six turns of 90 degrees, two about each axis, give a good fit.
+
+#define RTGYROSCALEFIT_STILL_SAMPLES    50                  // samples averaged for each reference attitude
+#define RTGYROSCALEFIT_MIN_ANGLE        (RTMATH_PI / 4)     // smallest rotation used, rad
+#define RTGYROSCALEFIT_MAX_ANGLE        (RTMATH_PI * 0.9)   // largest rotation used, rad
+#define RTGYROSCALEFIT_MAX_MISMATCH     0.1                 // |theta - s| as a fraction of |s|
+#define RTGYROSCALEFIT_MAX_GAP          100000              // uS between samples that spoils a rotation
+#define RTGYROSCALEFIT_MIN_ROTATIONS    6                   // rotations needed for a fit
+#define RTGYROSCALEFIT_MIN_EXCITATION   (RTMATH_PI / 2)     // rotation needed about every axis, rad
+#define RTGYROSCALEFIT_MAX_CORRECTION   0.2                 // largest plausible element of C - I
+
+class RTGyroScaleFit
+{
+public:
+    RTGyroScaleFit();
+
+    void reset();
+
+    //  addSample() takes the bias corrected gyro in rad/s, the calibrated accel and compass
+    //  and the timestamp in uS. It returns true when a rotation has just been accepted. A
+    //  sample with the same timestamp as the last one is ignored.
+
+    bool addSample(const RTVector3& gyro, const RTVector3& accel, const RTVector3& compass, uint64_t timestamp);
+
+    bool isStill() { return m_stillDetector.isStill(); }
+    int getRotationCount() { return m_rotations; }
+    int getRejectedCount() { return m_rejected; }
+
+    //  getExcitation() returns the rotation seen about the least exercised axis, rad
+
+    RTFLOAT getExcitation();
+
+    //  fit() computes the correction C. It returns false if there are too few rotations,
+    //  an axis has not been exercised enough or the result is implausible.
+
+    bool fit(float corr[3][3]);
+
+private:
+    static void referenceAttitude(const RTVector3& accel, const RTVector3& compass, RTMatrix<3, 3>& triad);
+    static RTQuaternion matrixToQuaternion(const RTMatrix<3, 3>& rotation);
+    static RTVector3 rotationVector(const RTQuaternion& q);
+
+    RTIMUStillDetector m_stillDetector;
+
+    RTQuaternion m_gyroPose;                                // integrated gyro
+    uint64_t m_lastTimestamp;
+
+    RTVector3 m_accelSum;                                   // the still pose being averaged
+    RTVector3 m_compassSum;
+    int m_stillCount;
+
+    bool m_haveReference;                                   // the last still pose
+    RTMatrix<3, 3> m_referenceTriad;                        // gravity and field frame in body axes
+    RTQuaternion m_referencePose;                           // m_gyroPose at that time
+
+    RTMatrix<3, 3, double> m_thetaS;                        // sum of theta * s'
+    RTMatrix<3, 3, double> m_SS;                            // sum of s * s'
+    int m_rotations;
+    int m_rejected;
+};
+
+#endif // _RTGYROSCALEFIT_H
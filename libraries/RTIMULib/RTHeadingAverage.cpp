@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTHeadingAverage.h"
+
+RTHeadingAverage::RTHeadingAverage()
+{
+    setSize(RTHEADING_AVERAGE_MAX);
+}
+
+void RTHeadingAverage::setSize(int size)
+{
+    if (size < 1)
+        size = 1;
+    if (size > RTHEADING_AVERAGE_MAX)
+        size = RTHEADING_AVERAGE_MAX;
+    m_size = size;
+    clear();
+}
+
+void RTHeadingAverage::clear()
+{
+    m_sumNorth = 0;
+    m_sumEast = 0;
+    m_index = 0;
+    m_count = 0;
+}
+
+void RTHeadingAverage::addVector(RTFLOAT north, RTFLOAT east)
+{
+    RTFLOAT length = sqrt(north * north + east * east);
+
+    if (length <= 0)
+        return;
+
+    north /= length;
+    east /= length;
+
+    if (m_count == m_size) {
+        m_sumNorth -= m_north[m_index];
+        m_sumEast -= m_east[m_index];
+    } else {
+        m_count++;
+    }
+    m_north[m_index] = north;
+    m_east[m_index] = east;
+    m_sumNorth += north;
+    m_sumEast += east;
+
+    if (++m_index < m_size)
+        return;
+
+    //  resum once per window so rounding errors cannot build up
+
+    m_index = 0;
+    m_sumNorth = 0;
+    m_sumEast = 0;
+    for (int i = 0; i < m_count; i++) {
+        m_sumNorth += m_north[i];
+        m_sumEast += m_east[i];
+    }
+}
+
+void RTHeadingAverage::addHeading(RTFLOAT heading)
+{
+    addVector(cos(heading), sin(heading));
+}
+
+void RTHeadingAverage::addCompass(RTQuaternion& pose, const RTVector3& mag)
+{
+    RTFLOAT north, east;
+
+    pose.toHeadingVector(mag, north, east);
+    addVector(north, east);
+}
+
+RTFLOAT RTHeadingAverage::getHeading()
+{
+    if (m_count == 0)
+        return 0;
+    return RTMath::clamp2PI(atan2(m_sumEast, m_sumNorth));
+}
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTHEADINGAVERAGE_H
+#define	_RTHEADINGAVERAGE_H
+
+#include "RTMath.h"
+
+#define RTHEADING_AVERAGE_MAX           32                  // largest window
+
+//  RTHeadingAverage is a moving average of headings that handles the 0 - 2PI wrap.
+//  Each heading is kept as a unit (north, east) vector in a fixed window, the window
+//  sum is updated per sample and atan2() is only called when the heading is read.
+//  Vectors can be added directly from the pose and compass, which needs no trig at all.
+
+class RTHeadingAverage
+{
+public:
+    RTHeadingAverage();
+
+    void setSize(int size);                                 // also clears the window
+    void clear();
+
+    //  addVector() takes any horizontal (north, east) vector, only the direction counts
+
+    void addVector(RTFLOAT north, RTFLOAT east);
+    void addHeading(RTFLOAT heading);                       // heading in radians
+    void addCompass(RTQuaternion& pose, const RTVector3& mag);
+
+    RTFLOAT getHeading();                                   // average heading, 0 to 2PI
+    int getCount() { return m_count; }
+
+private:
+    RTFLOAT m_north[RTHEADING_AVERAGE_MAX];
+    RTFLOAT m_east[RTHEADING_AVERAGE_MAX];
+    RTFLOAT m_sumNorth;
+    RTFLOAT m_sumEast;
+    int m_size;
+    int m_index;                                            // next slot to write
+    int m_count;                                            // valid entries in the window
+};
+
+#endif // _RTHEADINGAVERAGE_H
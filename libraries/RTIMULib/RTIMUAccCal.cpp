@@ -30,6 +30,7 @@ RTIMUAccCal::RTIMUAccCal(RTIMUSettings *settings)
     m_settings = settings;
     for (int i = 0; i < 3; i++)
         m_accelCalEnable[i] = false; // disable X, Y and Z calibration
+    settleReset();
 }
 
 RTIMUAccCal::~RTIMUAccCal()
@@ -45,6 +46,8 @@ void RTIMUAccCal::accelCalInit()
         m_accelMin = RTVector3(RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN);
         m_accelMax = RTVector3(RTIMUCALDEFS_DEFAULT_MAX, RTIMUCALDEFS_DEFAULT_MAX, RTIMUCALDEFS_DEFAULT_MAX);
     }
+    settleReset();
+    m_poseFit.reset();
     // accCalReset();
 }
 
@@ -52,6 +55,8 @@ void RTIMUAccCal::accelCalReset()
 {
 	m_accelMin = RTVector3(RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN);
     m_accelMax = RTVector3(RTIMUCALDEFS_DEFAULT_MAX, RTIMUCALDEFS_DEFAULT_MAX, RTIMUCALDEFS_DEFAULT_MAX);
+    settleReset();
+    m_poseFit.reset();
 }
 
 void RTIMUAccCal::accCalReset()
@@ -83,10 +88,87 @@ void RTIMUAccCal::newMinMaxData(const RTVector3& data)
             if (m_accelMax.data(i) <  m_averageValue.data(i)) {
                 m_accelMax.setData(i,  m_averageValue.data(i));
             }
+            settleExtreme(2 * i, -m_accelMin.data(i), -m_averageValue.data(i));
+            settleExtreme(2 * i + 1, m_accelMax.data(i), m_averageValue.data(i));
         }
     }
 }
 
+void RTIMUAccCal::settleReset()
+{
+    for (int i = 0; i < 6; i++) {
+        m_settleStart[i] = RTIMUCALDEFS_DEFAULT_MAX;
+        m_settleCount[i] = 0;
+    }
+}
+
+void RTIMUAccCal::settleExtreme(int extreme, RTFLOAT value, RTFLOAT average)
+{
+    //  the count restarts whenever the extreme moves out by more than the band, so it
+    //  only reaches the limit when the extreme has been found and held. Once it has, the
+    //  band is measured from the settled extreme rather than from where the count started.
+
+    if (value - m_settleStart[extreme] > RTIMUCALDEFS_ACCEL_SETTLE_BAND) {
+        m_settleStart[extreme] = value;
+        m_settleCount[extreme] = 0;
+    }
+    if ((value - average > RTIMUCALDEFS_ACCEL_SETTLE_BAND) || (m_settleCount[extreme] >= RTIMUCALDEFS_ACCEL_SETTLE_SAMPLES))
+        return;
+
+    if (++m_settleCount[extreme] == RTIMUCALDEFS_ACCEL_SETTLE_SAMPLES)
+        m_settleStart[extreme] = value;
+}
+
+int RTIMUAccCal::getSettledExtremes()
+{
+    int settled = 0;
+
+    for (int i = 0; i < 3; i++) {
+        if ((m_settleCount[2 * i] >= RTIMUCALDEFS_ACCEL_SETTLE_SAMPLES) && (m_accelMin.data(i) <= -RTIMUCALDEFS_ACCEL_MIN_EXTREME))
+            settled++;
+        if ((m_settleCount[2 * i + 1] >= RTIMUCALDEFS_ACCEL_SETTLE_SAMPLES) && (m_accelMax.data(i) >= RTIMUCALDEFS_ACCEL_MIN_EXTREME))
+            settled++;
+    }
+    return settled;
+}
+
+bool RTIMUAccCal::calibrationComplete()
+{
+    return (getSettledExtremes() == 6) || m_poseFit.isValid();
+}
+
+void RTIMUAccCal::newEllipsoidData(const RTVector3& data, uint64_t timestamp)
+{
+    m_poseFit.addSample(data, timestamp);
+}
+
+bool RTIMUAccCal::accelCalEllipsoidValid()
+{
+    return m_poseFit.isValid();
+}
+
+bool RTIMUAccCal::accelCalSaveEllipsoid()
+{
+    float corr[3][3];
+
+    if (!m_poseFit.isValid())
+        return false;
+
+    m_poseFit.getCorr(corr);
+
+    m_settings->m_accelCalValid = true;
+    m_settings->m_accelCalMin = RTVector3(-1, -1, -1);
+    m_settings->m_accelCalMax = RTVector3(1, 1, 1);
+    m_settings->m_accelCalEllipsoidValid = true;
+    m_settings->m_accelCalEllipsoidOffset = m_poseFit.getOffset();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            m_settings->m_accelCalEllipsoidCorr[i][j] = corr[i][j];
+    }
+    m_settings->saveSettings();
+    return true;
+}
+
 bool RTIMUAccCal::accelCalValid()
 
 {
@@ -27,6 +27,7 @@
 
 #include "RTIMUCalDefs.h"
 #include "RTIMULib.h"
+#include "RTAccelPoseFit.h"
 
 class RTIMUAccCal
 {
@@ -61,6 +62,29 @@ public:
     // magCalSaveMinMax() saves the current min/max values to settings
     bool accelCalSaveMinMax();
 
+    // newEllipsoidData() adds a raw sample (accel calibration mode) to the pose based
+    // calibration, with its timestamp in uS. It needs no axis enables - still poses are
+    // found and sorted by themselves.
+    void newEllipsoidData(const RTVector3& data, uint64_t timestamp);
+
+    // accelCalEllipsoidValid() returns true once the poses so far give a good fit
+    bool accelCalEllipsoidValid();
+
+    // accelCalSaveEllipsoid() saves the pose fit as the whole accel calibration. The min/max
+    // is set to +/-1g so that it passes the data through unchanged and the ellipsoid
+    // correction does the rest.
+    bool accelCalSaveEllipsoid();
+
+    // calibrationComplete() returns true once the data is sufficient. For min/max that
+    // is when all six extremes are beyond RTIMUCALDEFS_ACCEL_MIN_EXTREME and each has been
+    // held, within RTIMUCALDEFS_ACCEL_SETTLE_BAND, for RTIMUCALDEFS_ACCEL_SETTLE_SAMPLES
+    // samples without being pushed further out. For the ellipsoid it is
+    // accelCalEllipsoidValid().
+    bool calibrationComplete();
+
+    // getSettledExtremes() returns how many of the six extremes meet that test
+    int getSettledExtremes();
+
     // these vars used during the calibration process
 	
     bool m_accelCalValid;                                   // true if the mag min/max data valid
@@ -71,12 +95,23 @@ public:
 
     bool m_accelCalEnable[3];                               // the enable flags
 
+    RTAccelPoseFit m_poseFit;                               // the pose based ellipsoid calibration
+
     RTIMUSettings *m_settings;
 
     const RTVector3& getMin()      { return m_accelMin; } // get accel data in gs
     const RTVector3& getMax()      { return m_accelMax; } // get accel data in gs
 
 private:
+    void settleReset();                                     // restarts all the settle counts
+
+    //  settleExtreme() tracks extreme 2 * axis (min) or 2 * axis + 1 (max). value is the
+    //  extreme and average the current reading, both negated for a min.
+
+    void settleExtreme(int extreme, RTFLOAT value, RTFLOAT average);
+
+    RTFLOAT m_settleStart[6];                               // the extreme when its count started
+    int m_settleCount[6];                                   // samples held near the extreme
 };
 
 #endif // _RTIMUACCCAL_H
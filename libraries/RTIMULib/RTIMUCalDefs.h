@@ -32,13 +32,27 @@
 
 #define	RTIMUCALDEFS_MAX_MAG_SAMPLES	           1            // max saved mag records
 #define	RTIMUCALDEFS_MAX_ACC_SAMPLES	           1            // max saved acc records
-#define	RTIMUCALDEFS_MAX_TEMPERATURE_SAMPLES	   1            // max saved acc records [0:0.01:90]
 
 #define RTIMUCALDEFS_OCTANT_MIN_SAMPLES    400              // must have at least this in each octant
+#define RTIMUCALDEFS_ELLIPSOID_MIN_COVERAGE 75.0f           // percent of RTSphereCoverage bins needed for an ellipsoid fit
 
 #define RTIMUCALDEFS_ELLIPSOID_MIN_SPACING  0.1f            // min distance between ellipsoid samples to be recorded
 #define RTIMUCALDEFS_ACCEL_ELLIPSOID_MIN_SPACING  0.01f     // min distance between ellipsoid samples to be recorded
 #define RTIMUCALDEFS_TEMPERATURE_MIN_SPACING  0.01f         // min temperature distance between samples to be recorded
+#define RTIMUCALDEFS_TEMPERATURE_MIN_SAMPLES  100           // must have at least this many temperature samples
+#define RTIMUCALDEFS_TEMPERATURE_MIN_RANGE    10.0f         // and they must cover at least this many degrees C
+
+//  calibrationComplete() thresholds - see RTEllipsoidFit::evaluate() for the metrics
+
+#define RTIMUCALDEFS_QUALITY_INTERVAL       32              // fit samples between quality evaluations
+#define RTIMUCALDEFS_MIN_CONDITIONING       0.2f            // smallest / largest scaled normal matrix eigenvalue
+#define RTIMUCALDEFS_MAX_RESIDUAL           0.03f           // rms radial residual as a fraction of the radius
+#define RTIMUCALDEFS_MAX_FIT_CHANGE         0.005f          // centre movement between evaluations as a fraction of the radius
+#define RTIMUCALDEFS_STABLE_EVALUATIONS     3               // evaluations in a row within the fit change limit
+
+#define RTIMUCALDEFS_ACCEL_MIN_EXTREME      0.5f            // g an accel extreme must pass to count
+#define RTIMUCALDEFS_ACCEL_SETTLE_BAND      0.005f          // g the averaged accel must stay within of an extreme
+#define RTIMUCALDEFS_ACCEL_SETTLE_SAMPLES   50              // samples it must stay there for
 
 //  Octant defs
 
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTIMUFifoPoller.h"
+
+RTIMUFifoPoller::RTIMUFifoPoller()
+{
+    m_countReads = 0;
+    m_savedReads = 0;
+    m_inconsistencies = 0;
+    reset(100, 1);
+}
+
+void RTIMUFifoPoller::reset(int sampleRate, int capacity)
+{
+    m_nominalRate = sampleRate > 0 ? sampleRate : 1;
+    m_capacity = capacity;
+    m_rate = (RTFLOAT)m_nominalRate;
+    m_lockCount = 0;
+    m_refValid = false;
+    m_readTotal = 0;
+}
+
+int RTIMUFifoPoller::samplesWaiting(uint64_t now)
+{
+    if (!locked() || !m_refValid || (now - m_refTime) >= RTIMU_FIFO_POLL_VERIFY)
+        return -1;
+
+    RTFLOAT elapsed = (RTFLOAT)(now - m_refTime) * m_rate / 1000000.0f;
+    RTFLOAT expected = m_refSamples + elapsed;
+
+    if (expected >= (RTFLOAT)(m_capacity - 1))
+        return -1;                                          // close to overflow - get the real count
+
+    RTFLOAT safe = expected - RTIMU_FIFO_POLL_MARGIN - elapsed * RTIMU_FIFO_POLL_TOLERANCE;
+
+    m_savedReads++;
+    return safe > 0 ? (int)safe : 0;
+}
+
+bool RTIMUFifoPoller::countRead(uint64_t now, int samples)
+{
+    bool consistent = true;
+
+    m_countReads++;
+
+    if (m_refValid && locked()) {
+        //  samples that were assumed present but not yet read must still be there
+
+        RTFLOAT elapsed = (RTFLOAT)(now - m_refTime) * m_rate / 1000000.0f;
+        if ((RTFLOAT)samples < m_refSamples + elapsed * (1.0f - RTIMU_FIFO_POLL_TOLERANCE) - RTIMU_FIFO_POLL_MARGIN - 1.0f) {
+            m_inconsistencies++;
+            consistent = false;
+        }
+    }
+
+    if (!m_refValid) {
+        m_rateTime = now;
+        m_rateTotal = m_readTotal + samples;
+    } else if ((now - m_rateTime) >= RTIMU_FIFO_POLL_RATE_WINDOW) {
+        unsigned long total = m_readTotal + samples;
+        RTFLOAT rate = (RTFLOAT)(total - m_rateTotal) * 1000000.0f / (RTFLOAT)(now - m_rateTime);
+
+        if (fabs(rate / (RTFLOAT)m_nominalRate - 1.0f) > RTIMU_FIFO_POLL_MAX_DRIFT) {
+            m_lockCount = 0;                                // not believable - FIFO lost data or was reset
+        } else {
+            if (m_lockCount == 0)
+                m_rate = rate;
+            else
+                m_rate += RTIMU_FIFO_POLL_RATE_ALPHA * (rate - m_rate);
+            if (m_lockCount < RTIMU_FIFO_POLL_LOCK_COUNT)
+                m_lockCount++;
+        }
+        m_rateTime = now;
+        m_rateTotal = total;
+    }
+
+    if (!consistent)
+        m_lockCount = 0;
+
+    m_refTime = now;
+    m_refSamples = (RTFLOAT)samples;
+    m_refValid = true;
+    return consistent;
+}
+
+void RTIMUFifoPoller::samplesRead(int samples)
+{
+    m_refSamples -= (RTFLOAT)samples;
+    m_readTotal += samples;
+}
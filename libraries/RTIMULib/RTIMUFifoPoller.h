@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTIMUFIFOPOLLER_H
+#define	_RTIMUFIFOPOLLER_H
+
+#include "RTMath.h"
+
+//  RTIMUFifoPoller predicts how many samples are waiting in an IMU FIFO from the
+//  measured output rate so that the FIFO count register only has to be read now and
+//  then. Between count reads samplesWaiting() returns a conservative number of
+//  samples that must be there. Every count read checks the prediction - if fewer
+//  samples are present than were assumed the lock is dropped and the caller should
+//  resync the FIFO.
+
+#define RTIMU_FIFO_POLL_VERIFY          200000              // max time between count reads in uS
+#define RTIMU_FIFO_POLL_RATE_WINDOW     100000              // min span for a rate measurement in uS
+#define RTIMU_FIFO_POLL_RATE_ALPHA      0.2f                // rate smoothing
+#define RTIMU_FIFO_POLL_LOCK_COUNT      3                   // rate measurements needed before predicting
+#define RTIMU_FIFO_POLL_MARGIN          1.0f                // samples always assumed missing
+#define RTIMU_FIFO_POLL_TOLERANCE       0.005f              // extra fraction of elapsed samples assumed missing
+#define RTIMU_FIFO_POLL_MAX_DRIFT       0.1f                // measured rate must be within 10% of nominal
+
+class RTIMUFifoPoller
+{
+public:
+    RTIMUFifoPoller();
+
+    //  reset() must be called whenever the FIFO is reset. capacity is the FIFO size in samples
+
+    void reset(int sampleRate, int capacity);
+
+    //  samplesWaiting() returns the number of samples that can be read without checking the
+    //  count register, or -1 if the count register must be read now
+
+    int samplesWaiting(uint64_t now);
+
+    //  countRead() passes in the result of a count register read. Returns false if the
+    //  prediction had assumed more samples than were actually there
+
+    bool countRead(uint64_t now, int samples);
+
+    //  samplesRead() must be called for every sample taken out of the FIFO
+
+    void samplesRead(int samples);
+
+    //  statistics
+
+    bool locked() { return m_lockCount >= RTIMU_FIFO_POLL_LOCK_COUNT; }
+    RTFLOAT measuredRate() { return m_rate; }               // samples per second
+    RTFLOAT driftPPM() { return (m_rate / (RTFLOAT)m_nominalRate - 1.0f) * 1000000.0f; }
+    unsigned long countReads() { return m_countReads; }     // count register reads done
+    unsigned long savedReads() { return m_savedReads; }     // count register reads avoided
+    unsigned long inconsistencies() { return m_inconsistencies; }
+
+private:
+    int m_nominalRate;
+    int m_capacity;
+    RTFLOAT m_rate;                                         // measured output rate
+    int m_lockCount;                                        // number of good rate measurements
+
+    uint64_t m_refTime;                                     // time of the last count read
+    RTFLOAT m_refSamples;                                   // samples left in the FIFO since then
+    bool m_refValid;
+
+    uint64_t m_rateTime;                                    // start of the current rate measurement
+    unsigned long m_rateTotal;                              // samples produced at m_rateTime
+    unsigned long m_readTotal;                              // samples read since reset
+
+    unsigned long m_countReads;
+    unsigned long m_savedReads;
+    unsigned long m_inconsistencies;
+};
+
+#endif // _RTIMUFIFOPOLLER_H
@@ -40,6 +40,7 @@ void RTIMUGyroCal::gyroCalInit()
 
 void RTIMUGyroCal::gyroCalReset()
 {
+    m_scaleFit.reset();
 }
 
 bool RTIMUGyroCal::gyroCalValid()
@@ -52,3 +53,36 @@ void RTIMUGyroCal::gyroCalSaveBias()
 {
     m_settings->saveSettings();
 }
+
+void RTIMUGyroCal::newRotationData(const RTVector3& gyro, const RTVector3& accel, const RTVector3& compass, uint64_t timestamp)
+{
+    RTVector3 rate = gyro;
+
+    if (m_settings->m_gyroBiasValid)
+        rate -= m_settings->m_gyroBias;
+    m_scaleFit.addSample(rate, accel, compass, timestamp);
+}
+
+bool RTIMUGyroCal::gyroCalCorrValid()
+{
+    return (m_scaleFit.getRotationCount() >= RTGYROSCALEFIT_MIN_ROTATIONS) &&
+            (m_scaleFit.getExcitation() >= RTGYROSCALEFIT_MIN_EXCITATION);
+}
+
+bool RTIMUGyroCal::gyroCalSaveCorr()
+{
+    float corr[3][3];
+
+    if (!m_scaleFit.fit(corr)) {
+        HAL_ERROR("Gyro scale fit failed\n");
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            m_settings->m_gyroCalCorr[i][j] = corr[i][j];
+    }
+    m_settings->m_gyroCalCorrValid = true;
+    m_settings->saveSettings();
+    return true;
+}
@@ -27,6 +27,7 @@
 
 #include "RTIMUCalDefs.h"
 #include "RTIMULib.h"
+#include "RTGyroScaleFit.h"
 
 class RTIMUGyroCal
 {
@@ -44,8 +45,21 @@ public:
     // magCalSaveMinMax() saves the current min/max values to settings
     void gyroCalSaveBias();
 
+    // newRotationData() is used to submit a sample for the scale and misalignment fit. The
+    // gyro should be uncorrected (gyro calibration mode) - the saved bias is subtracted here.
+    // Accel and compass should be calibrated as they provide the reference attitudes.
+    void newRotationData(const RTVector3& gyro, const RTVector3& accel, const RTVector3& compass, uint64_t timestamp);
+
+    // gyroCalCorrValid() returns true if enough rotations about all axes have been seen
+    bool gyroCalCorrValid();
+
+    // gyroCalSaveCorr() fits the correction matrix and saves it to settings
+    bool gyroCalSaveCorr();
+
     // these vars used during the calibration process
 
+    RTGyroScaleFit m_scaleFit;                              // rotations seen so far
+
     RTIMUSettings *m_settings;
 
 private:
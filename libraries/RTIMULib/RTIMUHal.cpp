@@ -28,6 +28,8 @@
 #include "I2Cdev.h"
 #include <SPI.h>
 
+volatile bool HALInInterrupt = false;
+
 RTIMUHal::RTIMUHal()
 {
 }
@@ -104,6 +106,29 @@ bool RTIMUHal::HALRead(unsigned char slaveAddr, unsigned char length,
         return true;
     }
 }
+
+bool RTIMUHal::HALReadBlock(unsigned char slaveAddr, unsigned char regAddr, unsigned int length,
+                 unsigned char *data, const char *errorMsg)
+{
+    if (m_busIsI2C) {
+        if (I2Cdev::readBlock(slaveAddr, regAddr, length, data, 10) == (int)length)
+             return true;
+
+        if (strlen(errorMsg) > 0)
+            HAL_ERROR1("I2C block read failed - %s\n", errorMsg);
+        return false;
+
+    } else {
+        SPI.beginTransaction(m_SPISettings);
+        digitalWrite(m_SPISelect, LOW);
+        SPI.transfer(regAddr | 0x80);
+        for (unsigned int i = 0; i < length; i++)
+            data[i] = SPI.transfer(0);
+        digitalWrite(m_SPISelect, HIGH);
+        SPI.endTransaction();
+        return true;
+    }
+}
 					
 bool RTIMUHal::HALWrite(unsigned char slaveAddr, unsigned char regAddr,
                   unsigned char length, unsigned char const *data, const char *errorMsg)
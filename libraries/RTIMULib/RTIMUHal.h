@@ -29,24 +29,52 @@
 
 #include <math.h>
 #include <stdint.h>
+
+//  Without ARDUINO only the maths (RTMath, RTMatrix, the fits) is usable - that is
+//  enough for host tools such as RTEllipsoidFit/RTCalFit.cpp. Messages go to stderr.
+
+#ifdef ARDUINO
 #include <Arduino.h>
 #include <SPI.h>
+#else
+#include <stdio.h>
+#include <string.h>
+#endif
 
 // #define HAL_QUIET
 
-#ifndef HAL_QUIET
-
-#define HAL_INFO(m) Serial.printf(m);
-#define HAL_INFO1(m, x)  Serial.printf(m, x);
-#define HAL_INFO2(m, x, y)  Serial.printf(m, x, y);
-#define HAL_INFO3(m, x, y, z)  Serial.printf(m, x, y, z);
-#define HAL_INFO4(m, x, y, z, a)  Serial.printf(m, x, y, z, a);
-#define HAL_INFO5(m, x, y, z, a, b)  Serial.printf(m, x, y, z, a, b);
-#define HAL_ERROR(m)     Serial.printf(m);
-#define HAL_ERROR1(m, x)     Serial.printf(m, x);
-#define HAL_ERROR2(m, x, y)     Serial.printf(m, x, y);
-#define HAL_ERROR3(m, x, y, z)     Serial.printf(m, x, y, z);
-#define HAL_ERROR4(m, x, y, z, a)     Serial.printf(m, x, y, z, a);
+#ifndef ARDUINO
+
+#define HAL_INFO(m) fprintf(stderr, m);
+#define HAL_INFO1(m, x)  fprintf(stderr, m, x);
+#define HAL_INFO2(m, x, y)  fprintf(stderr, m, x, y);
+#define HAL_INFO3(m, x, y, z)  fprintf(stderr, m, x, y, z);
+#define HAL_INFO4(m, x, y, z, a)  fprintf(stderr, m, x, y, z, a);
+#define HAL_INFO5(m, x, y, z, a, b)  fprintf(stderr, m, x, y, z, a, b);
+#define HAL_ERROR(m)     fprintf(stderr, m);
+#define HAL_ERROR1(m, x)     fprintf(stderr, m, x);
+#define HAL_ERROR2(m, x, y)     fprintf(stderr, m, x, y);
+#define HAL_ERROR3(m, x, y, z)     fprintf(stderr, m, x, y, z);
+#define HAL_ERROR4(m, x, y, z, a)     fprintf(stderr, m, x, y, z, a);
+
+#elif !defined(HAL_QUIET)
+
+//  HALInInterrupt is set while the data ready interrupt reads the IMU. Serial output can
+//  block, so messages are dropped rather than printed from interrupt context.
+
+extern volatile bool HALInInterrupt;
+
+#define HAL_INFO(m) if (!HALInInterrupt) Serial.printf(m);
+#define HAL_INFO1(m, x)  if (!HALInInterrupt) Serial.printf(m, x);
+#define HAL_INFO2(m, x, y)  if (!HALInInterrupt) Serial.printf(m, x, y);
+#define HAL_INFO3(m, x, y, z)  if (!HALInInterrupt) Serial.printf(m, x, y, z);
+#define HAL_INFO4(m, x, y, z, a)  if (!HALInInterrupt) Serial.printf(m, x, y, z, a);
+#define HAL_INFO5(m, x, y, z, a, b)  if (!HALInInterrupt) Serial.printf(m, x, y, z, a, b);
+#define HAL_ERROR(m)     if (!HALInInterrupt) Serial.printf(m);
+#define HAL_ERROR1(m, x)     if (!HALInInterrupt) Serial.printf(m, x);
+#define HAL_ERROR2(m, x, y)     if (!HALInInterrupt) Serial.printf(m, x, y);
+#define HAL_ERROR3(m, x, y, z)     if (!HALInInterrupt) Serial.printf(m, x, y, z);
+#define HAL_ERROR4(m, x, y, z, a)     if (!HALInInterrupt) Serial.printf(m, x, y, z, a);
 
 #else
 
@@ -56,15 +84,19 @@
 #define HAL_INFO3(m, x, y, z)
 #define HAL_INFO4(m, x, y, z, a)
 #define HAL_INFO5(m, x, y, z, a, b)
-#define HAL_ERROR(m)     Serial.printf(m);
-#define HAL_ERROR1(m, x)     Serial.printf(m, x);
-#define HAL_ERROR2(m, x, y)     Serial.printf(m, x, y);
-#define HAL_ERROR3(m, x, y, z)     Serial.printf(m, x, y, z);
-#define HAL_ERROR4(m, x, y, z, a)     Serial.printf(m, x, y, z, a);
+
+extern volatile bool HALInInterrupt;
+
+#define HAL_ERROR(m)     if (!HALInInterrupt) Serial.printf(m);
+#define HAL_ERROR1(m, x)     if (!HALInInterrupt) Serial.printf(m, x);
+#define HAL_ERROR2(m, x, y)     if (!HALInInterrupt) Serial.printf(m, x, y);
+#define HAL_ERROR3(m, x, y, z)     if (!HALInInterrupt) Serial.printf(m, x, y, z);
+#define HAL_ERROR4(m, x, y, z, a)     if (!HALInInterrupt) Serial.printf(m, x, y, z, a);
 
 
 #endif
 
+#ifdef ARDUINO
 
 class RTIMUHal
 {
@@ -84,6 +116,8 @@ public:
                  unsigned char *data, const char *errorMsg); // normal read with register select
     bool HALRead(unsigned char slaveAddr, unsigned char length,
                  unsigned char *data, const char *errorMsg);    // read without register select
+    bool HALReadBlock(unsigned char slaveAddr, unsigned char regAddr, unsigned int length,
+                 unsigned char *data, const char *errorMsg); // large read (> 255 bytes) with register select
     bool HALWrite(unsigned char slaveAddr, unsigned char regAddr,
                   unsigned char length, unsigned char const *data, const char *errorMsg);
     bool HALWrite(unsigned char slaveAddr, unsigned char regAddr,
@@ -99,4 +133,6 @@ private:
     SPISettings m_SPISettings;
 };
 
+#endif // ARDUINO
+
 #endif // _RTIMUHAL_H
@@ -60,6 +60,7 @@ typedef struct
     bool accelValid;
     RTVector3 accel;
     bool compassValid;
+    bool compassNew;
     RTVector3 compass;
     bool motion;
     bool temperatureValid;
@@ -36,6 +36,7 @@ RTIMUMagCal::~RTIMUMagCal()
 void RTIMUMagCal::magCalInit()
 {
     magCalReset();
+    setMinMaxCorrection();
 }
 
 void RTIMUMagCal::magCalReset()
@@ -51,6 +52,11 @@ void RTIMUMagCal::magCalReset()
 		m_magMinAutoTune = RTVector3(RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN);
 		m_magMaxAutoTune = RTVector3(RTIMUCALDEFS_DEFAULT_MAX, RTIMUCALDEFS_DEFAULT_MAX, RTIMUCALDEFS_DEFAULT_MAX);
     }
+
+    m_ellipsoidFit.reset();
+    m_coverage.reset();
+    m_lastEllipsoidSample = RTVector3(RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN, RTIMUCALDEFS_DEFAULT_MIN);
+    m_stableEvaluations = 0;
 }
 
 void RTIMUMagCal::newMinMaxData(const RTVector3& data)
@@ -64,6 +70,12 @@ void RTIMUMagCal::newMinMaxData(const RTVector3& data)
 		    m_magMax.setData(i, data.data(i));
 	    }
     }
+
+    //  the raw samples are fitted as well, to tell when the min/max is complete. They are
+    //  binned by direction from the centre of the min/max box so far.
+
+    if (magCalValid())
+        newFitSample(data, data - (m_magMin + m_magMax) * 0.5f);
 }
 
 bool RTIMUMagCal::magCalValid()
@@ -84,5 +96,111 @@ void RTIMUMagCal::magCalSaveMinMax()
     m_settings->m_compassCalMax = m_magMax;
     m_settings->m_compassCalEllipsoidValid = false;
     m_settings->saveSettings();
+    setMinMaxCorrection();
+}
+
+void RTIMUMagCal::setMinMaxCorrection()
+{
+    float maxDelta = -1;
+    float delta;
+
+    //  the same correction as RTIMU::setCalibrationData()
+
+    m_minMaxOffset = RTVector3(0, 0, 0);
+    m_minMaxScale = RTVector3(1, 1, 1);
+
+    if (!m_settings->m_compassCalValid)
+        return;
+
+    for (int i = 0; i < 3; i++) {
+        if ((m_settings->m_compassCalMax.data(i) - m_settings->m_compassCalMin.data(i)) > maxDelta)
+            maxDelta = m_settings->m_compassCalMax.data(i) - m_settings->m_compassCalMin.data(i);
+    }
+    if (maxDelta < 0)
+        return;
+    maxDelta /= 2.0f;
+
+    for (int i = 0; i < 3; i++) {
+        delta = (m_settings->m_compassCalMax.data(i) - m_settings->m_compassCalMin.data(i)) / 2.0f;
+        m_minMaxScale.setData(i, maxDelta / delta);
+        m_minMaxOffset.setData(i, (m_settings->m_compassCalMax.data(i) + m_settings->m_compassCalMin.data(i)) / 2.0f);
+    }
+}
+
+void RTIMUMagCal::newEllipsoidData(const RTVector3& data)
+{
+    RTVector3 calData;
+
+    for (int i = 0; i < 3; i++)
+        calData.setData(i, (data.data(i) - m_minMaxOffset.data(i)) * m_minMaxScale.data(i));
+
+    //  the min/max correction centres the data well enough to bin by direction
+
+    newFitSample(calData, calData);
+}
+
+void RTIMUMagCal::newFitSample(const RTVector3& data, const RTVector3& direction)
+{
+    //  skip repeats of the same reading so that a stationary IMU doesn't swamp the fit
+
+    if ((fabs(data.x() - m_lastEllipsoidSample.x()) < RTIMUCALDEFS_ELLIPSOID_MIN_SPACING) &&
+            (fabs(data.y() - m_lastEllipsoidSample.y()) < RTIMUCALDEFS_ELLIPSOID_MIN_SPACING) &&
+            (fabs(data.z() - m_lastEllipsoidSample.z()) < RTIMUCALDEFS_ELLIPSOID_MIN_SPACING))
+        return;
+
+    m_lastEllipsoidSample = data;
+
+    //  once a bin is full further samples in that direction add nothing to the fit
+
+    if (!m_coverage.addSample(direction))
+        return;
+    m_ellipsoidFit.addSample(data);
+
+    if ((m_ellipsoidFit.getSampleCount() % RTIMUCALDEFS_QUALITY_INTERVAL) != 0)
+        return;
+
+    if (m_ellipsoidFit.evaluate() && (m_ellipsoidFit.getFitChange() <= RTIMUCALDEFS_MAX_FIT_CHANGE))
+        m_stableEvaluations++;
+    else
+        m_stableEvaluations = 0;
+}
+
+bool RTIMUMagCal::magCalEllipsoidValid()
+{
+    if (!m_settings->m_compassCalValid)
+        return false;
+
+    return m_coverage.getCoverage() >= RTIMUCALDEFS_ELLIPSOID_MIN_COVERAGE;
+}
+
+bool RTIMUMagCal::calibrationComplete()
+{
+    return (m_coverage.getCoverage() >= RTIMUCALDEFS_ELLIPSOID_MIN_COVERAGE) &&
+            (m_ellipsoidFit.getConditioning() >= RTIMUCALDEFS_MIN_CONDITIONING) &&
+            (m_ellipsoidFit.getResidual() <= RTIMUCALDEFS_MAX_RESIDUAL) &&
+            (m_stableEvaluations >= RTIMUCALDEFS_STABLE_EVALUATIONS);
+}
+
+bool RTIMUMagCal::magCalSaveEllipsoid()
+{
+    RTVector3 offset;
+    float corr[3][3];
+
+    if (!magCalEllipsoidValid())
+        return false;
+
+    if (!m_ellipsoidFit.fit(offset, corr)) {
+        HAL_ERROR("Compass ellipsoid fit failed\n");
+        return false;
+    }
+
+    m_settings->m_compassCalEllipsoidValid = true;
+    m_settings->m_compassCalEllipsoidOffset = offset;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            m_settings->m_compassCalEllipsoidCorr[i][j] = corr[i][j];
+    }
+    m_settings->saveSettings();
+    return true;
 }
 
@@ -27,6 +27,8 @@
 
 #include "RTIMUCalDefs.h"
 #include "RTIMULib.h"
+#include "RTEllipsoidFit.h"
+#include "RTSphereCoverage.h"
 
 class RTIMUMagCal
 {
@@ -47,6 +49,28 @@ public:
     // magCalSaveMinMax() saves the current min/max values to settings
     void magCalSaveMinMax();
 
+    // newEllipsoidData() is used to submit a new sample for the ellipsoid fit. The sample
+    // should be uncalibrated (compass calibration mode) - the saved min/max calibration is
+    // applied here, as RTIMU applies it before the ellipsoid correction.
+    void newEllipsoidData(const RTVector3& data);
+
+    // magCalEllipsoidValid() returns true if there is min/max data and enough of the sphere has been covered
+    bool magCalEllipsoidValid();
+
+    // magCalSaveEllipsoid() fits the ellipsoid and saves the offset and correction matrix to settings
+    bool magCalSaveEllipsoid();
+
+    // calibrationComplete() returns true once the samples given to newMinMaxData() or
+    // newEllipsoidData() since the last reset are enough: the sphere is covered, the fit
+    // is well conditioned with a small residual and its centre has stopped moving. The
+    // fit is evaluated every RTIMUCALDEFS_QUALITY_INTERVAL accepted samples.
+    bool calibrationComplete();
+
+    // the metrics of the last evaluation - see RTEllipsoidFit
+    RTFLOAT getConditioning() { return m_ellipsoidFit.getConditioning(); }
+    RTFLOAT getResidual() { return m_ellipsoidFit.getResidual(); }
+    RTFLOAT getFitChange() { return m_ellipsoidFit.getFitChange(); }
+
     // these vars used during the calibration process
 
    	RTVector3 m_magMin;                                     // the min values
@@ -54,14 +78,27 @@ public:
    	RTVector3 m_magMinAutoTune;                                     // the min values
 	RTVector3 m_magMaxAutoTune;                                     // the max values
 
+    RTSphereCoverage m_coverage;                            // ellipsoid samples by direction
+
     RTIMUSettings *m_settings;
 
     const RTVector3& getMin()      { return m_magMin; } // get accel data in gs
     const RTVector3& getMax()      { return m_magMax; } // get accel data in gs
 
 private:
+    void setMinMaxCorrection();                             // sets m_minMaxOffset/Scale from settings
+
+    //  newFitSample() adds a sample to the fit if it has moved far enough and its bin,
+    //  chosen by direction, is not full
+
+    void newFitSample(const RTVector3& data, const RTVector3& direction);
+
     RTVector3 m_minMaxOffset;                               // the min/max calibration offset
     RTVector3 m_minMaxScale;                                // the min/max scale
+
+    RTEllipsoidFit m_ellipsoidFit;                          // accumulated ellipsoid samples
+    RTVector3 m_lastEllipsoidSample;                        // for the minimum spacing check
+    int m_stableEvaluations;                                // evaluations in a row within the fit change limit
 };
 
 #endif // _RTIMUMAGCAL_H
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTIMUSampleRing.h"
+
+RTIMUSampleRing::RTIMUSampleRing(int depth)
+{
+    if (depth < 1)
+        depth = 1;
+    m_size = depth + 1;
+    m_ring = new RTIMU_DATA[m_size];
+    if (m_ring == NULL)
+        m_size = 1;                                         // permanently empty
+    reset();
+}
+
+RTIMUSampleRing::~RTIMUSampleRing()
+{
+    if (m_ring != NULL)
+        delete [] m_ring;
+}
+
+void RTIMUSampleRing::reset()
+{
+    m_head = m_tail = 0;
+    m_overflows = 0;
+}
+
+bool RTIMUSampleRing::push(const RTIMU_DATA& data)
+{
+    int head = m_head;
+    int next = head + 1;
+
+    if (next == m_size)
+        next = 0;
+
+    if (next == m_tail) {
+        m_overflows++;
+        return false;
+    }
+
+    m_ring[head] = data;
+    RTIMU_RING_BARRIER();                                   // slot must be complete before it is published
+    m_head = next;
+    return true;
+}
+
+bool RTIMUSampleRing::pop(RTIMU_DATA& data)
+{
+    int tail = m_tail;
+
+    if (tail == m_head)
+        return false;
+
+    RTIMU_RING_BARRIER();                                   // don't read the slot before seeing the new head
+    data = m_ring[tail];
+    RTIMU_RING_BARRIER();                                   // slot must be copied before it is released
+
+    if (++tail == m_size)
+        tail = 0;
+    m_tail = tail;
+    return true;
+}
+
+int RTIMUSampleRing::count()
+{
+    int count = m_head - m_tail;
+
+    if (count < 0)
+        count += m_size;
+    return count;
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTIMUSAMPLERING_H
+#define	_RTIMUSAMPLERING_H
+
+#include "RTIMULibDefs.h"
+
+//  RTIMU_RING_BARRIER orders the slot copy against the index update. On the
+//  single core Teensy this only has to stop the compiler reordering, a full
+//  barrier keeps the ring correct when producer and consumer are threads.
+
+#define RTIMU_RING_BARRIER()    __sync_synchronize()
+
+//  RTIMUSampleRing is a single producer/single consumer ring of RTIMU_DATA.
+//  The producer (the data ready interrupt) only writes m_head and the consumer
+//  (loop()) only writes m_tail so no locking is needed. When the ring is full
+//  the new sample is dropped and counted, the consumer's data is never touched.
+
+class RTIMUSampleRing
+{
+public:
+    RTIMUSampleRing(int depth);                             // depth is the number of samples that can be held
+    virtual ~RTIMUSampleRing();
+
+    bool push(const RTIMU_DATA& data);                      // producer side - false if full (sample dropped)
+    bool pop(RTIMU_DATA& data);                             // consumer side - false if empty
+
+    int depth() { return m_size - 1; }
+    int count();                                            // samples waiting (snapshot)
+    unsigned long overflows() { return m_overflows; }       // samples dropped because the ring was full
+    void reset();                                           // only call with the producer stopped
+
+private:
+    RTIMU_DATA *m_ring;                                     // m_size slots, one always kept free
+    int m_size;
+    volatile int m_head;                                    // next slot to write (producer)
+    volatile int m_tail;                                    // next slot to read (consumer)
+    volatile unsigned long m_overflows;
+};
+
+#endif // _RTIMUSAMPLERING_H
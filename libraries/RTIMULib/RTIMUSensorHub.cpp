@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTIMUSensorHub.h"
+
+RTIMUSensorHub::RTIMUSensorHub()
+{
+    m_imu = NULL;
+    m_pressure = NULL;
+    m_humidity = NULL;
+    m_lastIMUSample = 0;
+    m_imuInterval = 0;
+
+    for (int sensor = 0; sensor < RTIMU_HUB_SENSORS; sensor++) {
+        m_active[sensor] = false;
+        m_due[sensor] = 0;
+        m_period[sensor] = 0;
+        m_cycleStart[sensor] = 0;
+        m_retry[sensor] = 0;
+        memset(&m_stats[sensor], 0, sizeof(RTIMU_HUB_STATS));
+        m_windowCount[sensor] = 0;
+        m_windowLatency[sensor] = 0;
+        m_windowLatencyMax[sensor] = 0;
+    }
+    m_windowStart = RTMath::currentUSecsSinceEpoch();
+}
+
+RTIMUSensorHub::~RTIMUSensorHub()
+{
+    delete m_imu;
+    delete m_pressure;
+    delete m_humidity;
+}
+
+void RTIMUSensorHub::setIMU(RTIMU *imu)
+{
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+
+    m_imu = imu;
+    m_active[RTIMU_HUB_IMU] = imu != NULL;
+    m_due[RTIMU_HUB_IMU] = now;
+    m_period[RTIMU_HUB_IMU] = 0;
+    if ((imu != NULL) && (imu->IMUGetSampleRate() > 0))
+        m_period[RTIMU_HUB_IMU] = 1000000 / imu->IMUGetSampleRate();
+
+    //  a late sample is looked for again after an eighth of a period
+
+    m_retry[RTIMU_HUB_IMU] = m_period[RTIMU_HUB_IMU] / 8;
+    m_imuInterval = (RTFLOAT)m_period[RTIMU_HUB_IMU];
+    m_lastIMUSample = 0;
+}
+
+void RTIMUSensorHub::setPressure(RTPressure *pressure, RTFLOAT rate)
+{
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+
+    m_pressure = pressure;
+    m_active[RTIMU_HUB_PRESSURE] = pressure != NULL;
+    m_due[RTIMU_HUB_PRESSURE] = now;
+    m_period[RTIMU_HUB_PRESSURE] = rate > 0 ? (uint64_t)(1000000.0f / rate) : 0;
+    m_cycleStart[RTIMU_HUB_PRESSURE] = now;
+    m_retry[RTIMU_HUB_PRESSURE] = pressure != NULL ? (uint64_t)pressure->pressureGetPollInterval() * 1000 : 0;
+}
+
+void RTIMUSensorHub::setHumidity(RTHumidity *humidity, RTFLOAT rate)
+{
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+
+    m_humidity = humidity;
+    m_active[RTIMU_HUB_HUMIDITY] = humidity != NULL;
+    m_due[RTIMU_HUB_HUMIDITY] = now;
+    m_period[RTIMU_HUB_HUMIDITY] = rate > 0 ? (uint64_t)(1000000.0f / rate) : 0;
+    m_cycleStart[RTIMU_HUB_HUMIDITY] = now;
+    m_retry[RTIMU_HUB_HUMIDITY] = humidity != NULL ? (uint64_t)humidity->humidityGetPollInterval() * 1000 : 0;
+}
+
+int RTIMUSensorHub::poll()
+{
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+    int result = 0;
+    int next = -1;
+
+    if (m_active[RTIMU_HUB_IMU] && (now >= m_due[RTIMU_HUB_IMU])) {
+        if (serviceIMU(now))
+            result |= RTIMU_HUB_NEW(RTIMU_HUB_IMU);
+        now = RTMath::currentUSecsSinceEpoch();
+    }
+
+    //  find the slow sensor that has been waiting longest
+
+    for (int sensor = RTIMU_HUB_PRESSURE; sensor < RTIMU_HUB_SENSORS; sensor++) {
+        if (m_active[sensor] && (now >= m_due[sensor]) && ((next < 0) || (m_due[sensor] < m_due[next])))
+            next = sensor;
+    }
+
+    //  only start its transfer if it cannot run into the next IMU read
+
+    if (next >= 0) {
+        if (!m_active[RTIMU_HUB_IMU] || (m_due[RTIMU_HUB_IMU] >= now + RTIMU_HUB_BUS_GUARD) ||
+                (now - m_due[next] >= RTIMU_HUB_MAX_DEFER)) {
+            if (serviceSlow(next, now))
+                result |= RTIMU_HUB_NEW(next);
+        } else {
+            m_stats[next].deferred++;
+        }
+    }
+
+    updateStats(now);
+    return result;
+}
+
+uint64_t RTIMUSensorHub::nextDeadline()
+{
+    uint64_t deadline = 0;
+    bool found = false;
+
+    for (int sensor = 0; sensor < RTIMU_HUB_SENSORS; sensor++) {
+        if (m_active[sensor] && (!found || (m_due[sensor] < deadline))) {
+            deadline = m_due[sensor];
+            found = true;
+        }
+    }
+    return deadline;
+}
+
+bool RTIMUSensorHub::serviceIMU(uint64_t now)
+{
+    if (!m_imu->IMURead()) {
+        //  expect the next sample one period after the last one, look again soon if it is late
+
+        uint64_t expected = m_lastIMUSample + (uint64_t)m_imuInterval;
+        m_due[RTIMU_HUB_IMU] = expected > now ? expected : now + m_retry[RTIMU_HUB_IMU];
+        return false;
+    }
+
+    uint64_t timestamp = m_imu->getIMUData().timestamp;
+
+    if (timestamp > now)
+        timestamp = now;
+    sampleDone(RTIMU_HUB_IMU, now - timestamp);
+
+    //  track the real sample interval, the IMU clock can be several percent off nominal
+
+    if (m_lastIMUSample != 0) {
+        RTFLOAT interval = (RTFLOAT)(timestamp - m_lastIMUSample);
+        if ((interval > 0.5f * m_period[RTIMU_HUB_IMU]) && (interval < 1.5f * m_period[RTIMU_HUB_IMU]))
+            m_imuInterval += RTIMU_HUB_INTERVAL_ALPHA * (interval - m_imuInterval);
+    }
+    m_lastIMUSample = timestamp;
+    m_due[RTIMU_HUB_IMU] = now;                             // drain whatever else is buffered first
+    return true;
+}
+
+bool RTIMUSensorHub::serviceSlow(int sensor, uint64_t now)
+{
+    uint64_t latency = now - m_due[sensor];
+    uint64_t ready;
+    bool valid;
+
+    if (sensor == RTIMU_HUB_PRESSURE) {
+        valid = m_pressure->pressureRead();
+        ready = m_pressure->pressureReadyTime();
+    } else {
+        valid = m_humidity->humidityRead();
+        ready = m_humidity->humidityReadyTime();
+    }
+    now = RTMath::currentUSecsSinceEpoch();
+
+    if (valid) {
+        sampleDone(sensor, latency);
+
+        //  pace the next cycle, but never try to catch up on missed ones
+
+        if (m_period[sensor] > 0) {
+            m_cycleStart[sensor] += m_period[sensor];
+            if (m_cycleStart[sensor] < now)
+                m_cycleStart[sensor] = now;
+            m_due[sensor] = m_cycleStart[sensor];
+        } else {
+            m_due[sensor] = now;
+        }
+        return true;
+    }
+
+    //  a conversion is running - come back when it is done
+
+    m_due[sensor] = ready > now ? ready : now + m_retry[sensor];
+    return false;
+}
+
+void RTIMUSensorHub::sampleDone(int sensor, uint64_t latency)
+{
+    m_stats[sensor].samples++;
+    m_windowCount[sensor]++;
+    m_windowLatency[sensor] += latency;
+    if (latency > m_windowLatencyMax[sensor])
+        m_windowLatencyMax[sensor] = (unsigned long)latency;
+}
+
+void RTIMUSensorHub::updateStats(uint64_t now)
+{
+    if ((now - m_windowStart) < RTIMU_HUB_STATS_WINDOW)
+        return;
+
+    for (int sensor = 0; sensor < RTIMU_HUB_SENSORS; sensor++) {
+        m_stats[sensor].rate = (RTFLOAT)m_windowCount[sensor] * 1000000.0f / (RTFLOAT)(now - m_windowStart);
+        m_stats[sensor].latencyMean = m_windowCount[sensor] > 0 ?
+                (RTFLOAT)m_windowLatency[sensor] / (RTFLOAT)m_windowCount[sensor] : 0;
+        m_stats[sensor].latencyMax = m_windowLatencyMax[sensor];
+        m_windowCount[sensor] = 0;
+        m_windowLatency[sensor] = 0;
+        m_windowLatencyMax[sensor] = 0;
+    }
+    m_windowStart = now;
+}
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTIMUSENSORHUB_H
+#define	_RTIMUSENSORHUB_H
+
+#include "RTIMULibDefs.h"
+#include "utility/RTIMU.h"
+#include "utility/RTPressure.h"
+#include "utility/RTHumidity.h"
+
+//  Sensor indices for poll() results and getStats()
+
+#define RTIMU_HUB_IMU                   0
+#define RTIMU_HUB_PRESSURE              1
+#define RTIMU_HUB_HUMIDITY              2
+#define RTIMU_HUB_SENSORS               3
+
+#define RTIMU_HUB_NEW(sensor)           (1 << (sensor))     // poll() result bit for a sensor
+
+#define RTIMU_HUB_BUS_GUARD             500                 // uS kept free ahead of an IMU deadline
+#define RTIMU_HUB_MAX_DEFER             5000                // uS a slow sensor can be held back for the IMU
+#define RTIMU_HUB_STATS_WINDOW          1000000             // uS over which rate and latency are measured
+#define RTIMU_HUB_INTERVAL_ALPHA        0.05f               // smoothing of the measured IMU sample interval
+
+//  Statistics for one sensor, updated at the end of each stats window
+
+typedef struct
+{
+    unsigned long samples;                                  // total samples delivered
+    unsigned long deferred;                                 // polls where the sensor waited for the IMU
+    RTFLOAT rate;                                           // achieved samples per second
+    RTFLOAT latencyMean;                                    // mean uS from data ready to read
+    unsigned long latencyMax;                               // worst uS from data ready to read
+} RTIMU_HUB_STATS;
+
+//  RTIMUSensorHub schedules the IMU, pressure and humidity sensors on the shared bus.
+//  Each sensor has a deadline - the time its next conversion is ready or its next
+//  cycle is due - and poll() only touches a sensor once its deadline has passed.
+//  The IMU always goes first. A pressure or humidity transfer is only started when
+//  the IMU FIFO has been drained and its next sample is at least RTIMU_HUB_BUS_GUARD
+//  away, unless the slow sensor has already been held back RTIMU_HUB_MAX_DEFER.
+//
+//  The hub takes ownership of the sensor objects and deletes them. The IMU must be
+//  polled, not driven by IMUEnableDataReady(), as the interrupt would access the bus
+//  behind the scheduler's back.
+
+class RTIMUSensorHub
+{
+public:
+    RTIMUSensorHub();
+    virtual ~RTIMUSensorHub();
+
+    //  rate is the wanted cycle rate in Hz, 0 runs conversions back to back
+
+    void setIMU(RTIMU *imu);
+    void setPressure(RTPressure *pressure, RTFLOAT rate);
+    void setHumidity(RTHumidity *humidity, RTFLOAT rate);
+
+    RTIMU *getIMU() { return m_imu; }
+    RTPressure *getPressure() { return m_pressure; }
+    RTHumidity *getHumidity() { return m_humidity; }
+
+    //  poll() should be called from loop() as often as possible. It returns a mask of
+    //  RTIMU_HUB_NEW() bits for the sensors that have new data.
+
+    int poll();
+
+    //  nextDeadline() is the earliest time in uS at which poll() has work to do
+
+    uint64_t nextDeadline();
+
+    const RTIMU_HUB_STATS& getStats(int sensor) { return m_stats[sensor]; }
+
+private:
+    bool serviceIMU(uint64_t now);
+    bool serviceSlow(int sensor, uint64_t now);
+    void sampleDone(int sensor, uint64_t latency);
+    void updateStats(uint64_t now);
+
+    RTIMU *m_imu;
+    RTPressure *m_pressure;
+    RTHumidity *m_humidity;
+
+    bool m_active[RTIMU_HUB_SENSORS];
+    uint64_t m_due[RTIMU_HUB_SENSORS];                      // deadline queue, one entry per sensor
+    uint64_t m_period[RTIMU_HUB_SENSORS];                   // cycle period in uS, 0 if free running
+    uint64_t m_cycleStart[RTIMU_HUB_SENSORS];               // when the current cycle was scheduled
+    uint64_t m_retry[RTIMU_HUB_SENSORS];                    // recheck delay if a sensor gives no ready time
+    uint64_t m_lastIMUSample;                               // timestamp of the last IMU sample
+    RTFLOAT m_imuInterval;                                  // measured uS between IMU samples
+
+    RTIMU_HUB_STATS m_stats[RTIMU_HUB_SENSORS];
+    unsigned long m_windowCount[RTIMU_HUB_SENSORS];         // stats accumulators for the current window
+    uint64_t m_windowLatency[RTIMU_HUB_SENSORS];
+    unsigned long m_windowLatencyMax[RTIMU_HUB_SENSORS];
+    uint64_t m_windowStart;
+};
+
+#endif // _RTIMUSENSORHUB_H
@@ -29,6 +29,7 @@
 // Sections for Temperature Compensation
 
 #include "RTIMUSettings.h"
+#include "RTCompassSmoother.h"
 #include "utility/RTIMUMPU9150.h"
 #include "utility/RTIMUMPU9250.h"
 #include "utility/RTIMUMPU9255.h"
@@ -69,6 +70,8 @@ RTIMUSettings::RTIMUSettings(const char *productType)
         m_usingSD = true;
     }
 
+    m_storeCopy = -1;
+    m_storeSequence = 0;
     loadSettings();
 }
 
@@ -487,6 +490,9 @@ void RTIMUSettings::setDefaults()
     m_axisRotation = RTIMU_XNORTH_YEAST;
     m_pressureType = RTPRESSURE_TYPE_AUTODISCOVER;
     m_I2CPressureAddress = 0;
+    m_pressureOSR = 0;
+    m_pressureTempOSR = 0;
+    m_pressureTempDecimation = 1;
     m_humidityType = RTHUMIDITY_TYPE_AUTODISCOVER;
     m_I2CHumidityAddress = 0;
     
@@ -512,6 +518,12 @@ void RTIMUSettings::setDefaults()
 
     m_compassAdjDeclination = DECLINATION;
 
+    m_compassSmoothing = RTCOMPASSSMOOTH_BOXCAR;
+    m_compassSmoothingLength = RTCOMPASSSMOOTH_LENGTH;
+    m_compassSmoothingTimeConstant = RTCOMPASSSMOOTH_TIME_CONSTANT;
+    m_compassSmoothingMinCutoff = RTCOMPASSSMOOTH_MIN_CUTOFF;
+    m_compassSmoothingBeta = RTCOMPASSSMOOTH_BETA;
+
     m_accelCalValid = false;
     m_accelCalEllipsoidValid = false;
     for (int i = 0; i < 3; i++) {
@@ -525,6 +537,13 @@ void RTIMUSettings::setDefaults()
 
     m_gyroBiasValid = false;
 
+    m_gyroCalCorrValid = false;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            m_gyroCalCorr[i][j] = (i == j) ? 1 : 0;
+        }
+    }
+
     //  MPU9150 defaults
 
     m_MPU9150GyroAccelSampleRate = 50;
@@ -644,7 +663,10 @@ bool RTIMUSettings::loadSettings()
     setDefaults();
 
     if (!m_usingSD) {
-        //  see if EEPROM has valid cal data
+        if (EEStoreRead())
+            return true;
+
+        //  no versioned record - see if EEPROM has original cal data
         m_compassCalValid = false;
 
         RTIMULIB_CAL_DATA calData;
@@ -759,6 +781,12 @@ bool RTIMUSettings::loadSettings()
             m_pressureType = atoi(val);
         } else if (strcmp(key, RTIMULIB_I2C_PRESSUREADDRESS) == 0) {
             m_I2CPressureAddress = atoi(val);
+        } else if (strcmp(key, RTIMULIB_PRESSURE_OSR) == 0) {
+            m_pressureOSR = atoi(val);
+        } else if (strcmp(key, RTIMULIB_PRESSURE_TEMP_OSR) == 0) {
+            m_pressureTempOSR = atoi(val);
+        } else if (strcmp(key, RTIMULIB_PRESSURE_TEMP_DECIMATION) == 0) {
+            m_pressureTempDecimation = atoi(val);
         } else if (strcmp(key, RTIMULIB_HUMIDITY_TYPE) == 0) {
             m_humidityType = atoi(val);
         } else if (strcmp(key, RTIMULIB_I2C_HUMIDITYADDRESS) == 0) {
@@ -911,6 +939,22 @@ bool RTIMUSettings::loadSettings()
             sscanf(val, "%f", &ftemp);
             m_compassAdjDeclination = ftemp;
 
+        // compass smoothing
+
+        } else if (strcmp(key, RTIMULIB_COMPASS_SMOOTHING) == 0) {
+            m_compassSmoothing = atoi(val);
+        } else if (strcmp(key, RTIMULIB_COMPASS_SMOOTHING_LENGTH) == 0) {
+            m_compassSmoothingLength = atoi(val);
+        } else if (strcmp(key, RTIMULIB_COMPASS_SMOOTHING_TC) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_compassSmoothingTimeConstant = ftemp;
+        } else if (strcmp(key, RTIMULIB_COMPASS_SMOOTHING_CUTOFF) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_compassSmoothingMinCutoff = ftemp;
+        } else if (strcmp(key, RTIMULIB_COMPASS_SMOOTHING_BETA) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_compassSmoothingBeta = ftemp;
+
         // compass ellipsoid calibration
 
         } else if (strcmp(key, RTIMULIB_COMPASSCAL_ELLIPSOID_VALID) == 0) {
@@ -1029,6 +1073,38 @@ bool RTIMUSettings::loadSettings()
             sscanf(val, "%f", &ftemp);
             m_gyroBias.setZ(ftemp);
 
+		// gyro scale and misalignment
+
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR_VALID) == 0) {
+            m_gyroCalCorrValid = strcmp(val, "true") == 0;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR11) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[0][0] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR12) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[0][1] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR13) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[0][2] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR21) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[1][0] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR22) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[1][1] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR23) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[1][2] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR31) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[2][0] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR32) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[2][1] = ftemp;
+        } else if (strcmp(key, RTIMULIB_GYROCAL_CORR33) == 0) {
+            sscanf(val, "%f", &ftemp);
+            m_gyroCalCorr[2][2] = ftemp;
+
         //  MPU9150 settings
 
         } else if (strcmp(key, RTIMULIB_MPU9150_GYROACCEL_SAMPLERATE) == 0) {
@@ -1200,31 +1276,7 @@ bool RTIMUSettings::loadSettings()
 bool RTIMUSettings::saveSettings()
 {
     if (!m_usingSD) {
-        // UP TO 2048 bytes, 512 floats
-        RTIMULIB_CAL_DATA calData;
-
-        calData.magValid = m_compassCalValid;
-        calData.magMin[0] = m_compassCalMin.x();
-        calData.magMin[1] = m_compassCalMin.y();
-        calData.magMin[2] = m_compassCalMin.z();
-        calData.magMax[0] = m_compassCalMax.x();
-        calData.magMax[1] = m_compassCalMax.y();
-        calData.magMax[2] = m_compassCalMax.z();
-
-        calData.accValid = m_accelCalValid;
-        calData.accMin[0] = m_accelCalMin.x();
-        calData.accMin[1] = m_accelCalMin.y();
-        calData.accMin[2] = m_accelCalMin.z();
-        calData.accMax[0] = m_accelCalMax.x();
-        calData.accMax[1] = m_accelCalMax.y();
-        calData.accMax[2] = m_accelCalMax.z();
-		
-		calData.gyrValid  = m_gyroBiasValid;
-		calData.gyrBias[0] = m_gyroBias.x();   
-		calData.gyrBias[1] = m_gyroBias.y();   
-		calData.gyrBias[2] = m_gyroBias.z();   
-		
-        EEWrite(0, &calData);
+        EEStoreWrite();
         return true;
     }
 
@@ -1352,6 +1404,17 @@ bool RTIMUSettings::saveSettings()
     setComment("I2C pressure sensor address (filled in automatically by auto discover) ");
     setValue(RTIMULIB_I2C_PRESSUREADDRESS, m_I2CPressureAddress);
 
+    setBlank();
+    setComment("MS5611/MS5637/MS5803/MS5837 oversampling ratio for pressure and temperature - ");
+    setComment("  0 = driver default (4096, 8192 for MS5837)");
+    setComment("  256, 512, 1024, 2048, 4096 or 8192 (8192 on MS5637 and MS5837 only)");
+    setValue(RTIMULIB_PRESSURE_OSR, m_pressureOSR);
+    setValue(RTIMULIB_PRESSURE_TEMP_OSR, m_pressureTempOSR);
+
+    setBlank();
+    setComment("MS5611/MS5637/MS5803/MS5837 pressure conversions per temperature conversion");
+    setValue(RTIMULIB_PRESSURE_TEMP_DECIMATION, m_pressureTempDecimation);
+
     setBlank();
     setComment("Humidity sensor type - ");
     setComment("  0 = Auto discover");
@@ -1445,6 +1508,18 @@ bool RTIMUSettings::saveSettings()
     setComment("Compass declination is in radians and is subtracted from calculated heading");
     setValue(RTIMULIB_COMPASSADJ_DECLINATION, m_compassAdjDeclination);
 
+    setBlank();
+    setComment("Compass smoothing type - ");
+    setComment("  0 - None");
+    setComment("  1 - Boxcar average of CompassSmoothingLength samples (at most 32)");
+    setComment("  2 - Exponential with CompassSmoothingTimeConstant in seconds");
+    setComment("  3 - One euro, cutoff CompassSmoothingMinCutoff Hz plus CompassSmoothingBeta Hz per uT/s");
+    setValue(RTIMULIB_COMPASS_SMOOTHING, m_compassSmoothing);
+    setValue(RTIMULIB_COMPASS_SMOOTHING_LENGTH, m_compassSmoothingLength);
+    setValue(RTIMULIB_COMPASS_SMOOTHING_TC, m_compassSmoothingTimeConstant);
+    setValue(RTIMULIB_COMPASS_SMOOTHING_CUTOFF, m_compassSmoothingMinCutoff);
+    setValue(RTIMULIB_COMPASS_SMOOTHING_BETA, m_compassSmoothingBeta);
+
     //  Compass ellipsoid calibration settings
 
     setBlank();
@@ -1518,6 +1593,19 @@ bool RTIMUSettings::saveSettings()
     setValue(RTIMULIB_GYRO_BIAS_Y, m_gyroBias.y());
     setValue(RTIMULIB_GYRO_BIAS_Z, m_gyroBias.z());
 
+    setBlank();
+    setComment("Gyro scale and misalignment correction - applied after the bias");
+    setValue(RTIMULIB_GYROCAL_CORR_VALID, m_gyroCalCorrValid);
+    setValue(RTIMULIB_GYROCAL_CORR11, m_gyroCalCorr[0][0]);
+    setValue(RTIMULIB_GYROCAL_CORR12, m_gyroCalCorr[0][1]);
+    setValue(RTIMULIB_GYROCAL_CORR13, m_gyroCalCorr[0][2]);
+    setValue(RTIMULIB_GYROCAL_CORR21, m_gyroCalCorr[1][0]);
+    setValue(RTIMULIB_GYROCAL_CORR22, m_gyroCalCorr[1][1]);
+    setValue(RTIMULIB_GYROCAL_CORR23, m_gyroCalCorr[1][2]);
+    setValue(RTIMULIB_GYROCAL_CORR31, m_gyroCalCorr[2][0]);
+    setValue(RTIMULIB_GYROCAL_CORR32, m_gyroCalCorr[2][1]);
+    setValue(RTIMULIB_GYROCAL_CORR33, m_gyroCalCorr[2][2]);
+
     //  MPU-9150 settings
 
     setBlank();
@@ -2260,3 +2348,173 @@ boolean RTIMUSettings::EERead(byte device, RTIMULIB_CAL_DATA *calData)
     return true;
 }
 
+static int16_t EEStoreToQ13(float val)
+{
+    float scaled = val * RTIMULIB_CAL_STORE_MATRIX_SCALE;
+
+    if (scaled > 32767.0f)
+        return 32767;
+    if (scaled < -32767.0f)
+        return -32767;
+    return (int16_t)(scaled + ((scaled >= 0) ? 0.5f : -0.5f));
+}
+
+uint16_t RTIMUSettings::EEStoreCRC(const RTIMULIB_CAL_STORE *store)
+{
+    const byte *ptr = (const byte *)store;
+    uint16_t crc = 0xffff;
+
+    for (unsigned int i = 0; i < offsetof(RTIMULIB_CAL_STORE, crc); i++) {
+        crc ^= (uint16_t)ptr[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+bool RTIMUSettings::EEStoreReadCopy(int copy, RTIMULIB_CAL_STORE *store)
+{
+    byte *ptr = (byte *)store;
+    int eeprom = RTIMULIB_CAL_STORE_BASE + copy * sizeof(RTIMULIB_CAL_STORE);
+
+    for (unsigned int i = 0; i < sizeof(RTIMULIB_CAL_STORE); i++)
+        *ptr++ = EEPROM.read(eeprom + i);
+
+    return (store->magic == RTIMULIB_CAL_STORE_MAGIC) && (store->version == RTIMULIB_CAL_STORE_VERSION) &&
+            (store->crc == EEStoreCRC(store));
+}
+
+bool RTIMUSettings::EEStoreRead()
+{
+    RTIMULIB_CAL_STORE copies[2];
+    bool good[2];
+    int copy;
+
+    good[0] = EEStoreReadCopy(0, copies + 0);
+    good[1] = EEStoreReadCopy(1, copies + 1);
+
+    if (good[0] && good[1])
+        copy = ((int16_t)(copies[1].sequence - copies[0].sequence) > 0) ? 1 : 0;
+    else if (good[0] || good[1])
+        copy = good[0] ? 0 : 1;
+    else
+        return false;
+
+    const RTIMULIB_CAL_STORE& store = copies[copy];
+
+    m_storeCopy = copy;
+    m_storeSequence = store.sequence;
+
+    m_axisRotation = store.axisRotation;
+
+    m_compassCalValid = (store.flags & RTIMULIB_CAL_STORE_MAG_MINMAX) != 0;
+    m_compassCalEllipsoidValid = (store.flags & RTIMULIB_CAL_STORE_MAG_ELLIPSOID) != 0;
+    m_accelCalValid = (store.flags & RTIMULIB_CAL_STORE_ACCEL_MINMAX) != 0;
+    m_accelCalEllipsoidValid = (store.flags & RTIMULIB_CAL_STORE_ACCEL_ELLIPSOID) != 0;
+    m_temperatureCalValid = (store.flags & RTIMULIB_CAL_STORE_TEMPERATURE) != 0;
+    m_gyroBiasValid = (store.flags & RTIMULIB_CAL_STORE_GYRO_BIAS) != 0;
+    m_gyroCalCorrValid = (store.flags & RTIMULIB_CAL_STORE_GYRO_CORR) != 0;
+
+    m_compassCalMin = RTVector3(store.magMin[0], store.magMin[1], store.magMin[2]);
+    m_compassCalMax = RTVector3(store.magMax[0], store.magMax[1], store.magMax[2]);
+    m_compassCalEllipsoidOffset = RTVector3(store.magEllipsoidOffset[0], store.magEllipsoidOffset[1], store.magEllipsoidOffset[2]);
+    m_accelCalMin = RTVector3(store.accelMin[0], store.accelMin[1], store.accelMin[2]);
+    m_accelCalMax = RTVector3(store.accelMax[0], store.accelMax[1], store.accelMax[2]);
+    m_accelCalEllipsoidOffset = RTVector3(store.accelEllipsoidOffset[0], store.accelEllipsoidOffset[1], store.accelEllipsoidOffset[2]);
+    m_gyroBias = RTVector3(store.gyroBias[0], store.gyroBias[1], store.gyroBias[2]);
+
+    for (int i = 0; i < 9; i++) {
+        m_c0[i] = store.temperatureC[0][i];
+        m_c1[i] = store.temperatureC[1][i];
+        m_c2[i] = store.temperatureC[2][i];
+        m_c3[i] = store.temperatureC[3][i];
+    }
+    m_senTemp_break = store.temperatureBreak;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            m_compassCalEllipsoidCorr[i][j] = store.magEllipsoidCorr[i][j] / RTIMULIB_CAL_STORE_MATRIX_SCALE;
+            m_accelCalEllipsoidCorr[i][j] = store.accelEllipsoidCorr[i][j] / RTIMULIB_CAL_STORE_MATRIX_SCALE;
+            m_gyroCalCorr[i][j] = store.gyroCorr[i][j] / RTIMULIB_CAL_STORE_MATRIX_SCALE;
+        }
+    }
+
+    HAL_INFO2("Calibration loaded from EEPROM copy %c, sequence %d\n", 'A' + copy, store.sequence);
+    return true;
+}
+
+void RTIMUSettings::EEStoreWrite()
+{
+    RTIMULIB_CAL_STORE store;
+    const byte *ptr = (const byte *)&store;
+    int copy = (m_storeCopy == 0) ? 1 : 0;
+    int eeprom = RTIMULIB_CAL_STORE_BASE + copy * sizeof(RTIMULIB_CAL_STORE);
+
+    memset(&store, 0, sizeof(RTIMULIB_CAL_STORE));
+    store.magic = RTIMULIB_CAL_STORE_MAGIC;
+    store.version = RTIMULIB_CAL_STORE_VERSION;
+    store.sequence = m_storeSequence + 1;
+    store.axisRotation = m_axisRotation;
+
+    store.flags = 0;
+    if (m_compassCalValid)
+        store.flags |= RTIMULIB_CAL_STORE_MAG_MINMAX;
+    if (m_compassCalEllipsoidValid)
+        store.flags |= RTIMULIB_CAL_STORE_MAG_ELLIPSOID;
+    if (m_accelCalValid)
+        store.flags |= RTIMULIB_CAL_STORE_ACCEL_MINMAX;
+    if (m_accelCalEllipsoidValid)
+        store.flags |= RTIMULIB_CAL_STORE_ACCEL_ELLIPSOID;
+    if (m_temperatureCalValid)
+        store.flags |= RTIMULIB_CAL_STORE_TEMPERATURE;
+    if (m_gyroBiasValid)
+        store.flags |= RTIMULIB_CAL_STORE_GYRO_BIAS;
+    if (m_gyroCalCorrValid)
+        store.flags |= RTIMULIB_CAL_STORE_GYRO_CORR;
+
+    for (int i = 0; i < 3; i++) {
+        store.magMin[i] = m_compassCalMin.data(i);
+        store.magMax[i] = m_compassCalMax.data(i);
+        store.magEllipsoidOffset[i] = m_compassCalEllipsoidOffset.data(i);
+        store.accelMin[i] = m_accelCalMin.data(i);
+        store.accelMax[i] = m_accelCalMax.data(i);
+        store.accelEllipsoidOffset[i] = m_accelCalEllipsoidOffset.data(i);
+        store.gyroBias[i] = m_gyroBias.data(i);
+        for (int j = 0; j < 3; j++) {
+            store.magEllipsoidCorr[i][j] = EEStoreToQ13(m_compassCalEllipsoidCorr[i][j]);
+            store.accelEllipsoidCorr[i][j] = EEStoreToQ13(m_accelCalEllipsoidCorr[i][j]);
+            store.gyroCorr[i][j] = EEStoreToQ13(m_gyroCalCorr[i][j]);
+        }
+    }
+
+    for (int i = 0; i < 9; i++) {
+        store.temperatureC[0][i] = m_c0[i];
+        store.temperatureC[1][i] = m_c1[i];
+        store.temperatureC[2][i] = m_c2[i];
+        store.temperatureC[3][i] = m_c3[i];
+    }
+    store.temperatureBreak = m_senTemp_break;
+
+    //  runtime gyro calibration saves often, so a save that changes nothing is skipped
+
+    if (m_storeCopy >= 0) {
+        RTIMULIB_CAL_STORE current;
+
+        if (EEStoreReadCopy(m_storeCopy, &current)) {
+            current.sequence = store.sequence;
+            if (memcmp(&current, &store, offsetof(RTIMULIB_CAL_STORE, crc)) == 0)
+                return;
+        }
+    }
+
+    store.crc = EEStoreCRC(&store);
+
+    //  update() skips bytes that are unchanged, which saves wear. The CRC goes last so an
+    //  interrupted save never looks complete.
+
+    for (unsigned int i = 0; i < sizeof(RTIMULIB_CAL_STORE); i++)
+        EEPROM.update(eeprom + i, *ptr++);
+
+    m_storeCopy = copy;
+    m_storeSequence = store.sequence;
+}
@@ -62,6 +62,63 @@ typedef struct
 	// not sure why there was a pad, I assume we want even number of bytes going to EEPROM?
 } RTIMULIB_CAL_DATA;
 
+//  RTIMULIB_CAL_DATA above is the original record and only holds min/max calibration.
+//  RTIMULIB_CAL_STORE is the versioned record that replaces it. Two copies, A and B, are
+//  kept after the original record and each save goes to the older one, so a power loss
+//  during a save leaves the previous calibration intact. The copy with a good CRC and the
+//  newest sequence number is loaded and the original record is only read if neither copy
+//  is good.
+//
+//  The correction matrices are close to identity and are stored as Q13 (range +-4,
+//  resolution 1.2e-4). Everything else is float - the temperature polynomials in
+//  particular have large terms that cancel.
+
+#define RTIMULIB_CAL_STORE_MAGIC            0x52c1          // marks a calibration record
+#define RTIMULIB_CAL_STORE_VERSION          1               // layout version
+#define RTIMULIB_CAL_STORE_BASE             128             // EEPROM address of copy A, after RTIMULIB_CAL_DATA
+#define RTIMULIB_CAL_STORE_MATRIX_SCALE     8192.0f         // Q13
+
+//  RTIMULIB_CAL_STORE flags - which parts of the record are valid
+
+#define RTIMULIB_CAL_STORE_MAG_MINMAX       0x01
+#define RTIMULIB_CAL_STORE_MAG_ELLIPSOID    0x02
+#define RTIMULIB_CAL_STORE_ACCEL_MINMAX     0x04
+#define RTIMULIB_CAL_STORE_ACCEL_ELLIPSOID  0x08
+#define RTIMULIB_CAL_STORE_TEMPERATURE      0x10
+#define RTIMULIB_CAL_STORE_GYRO_BIAS        0x20
+#define RTIMULIB_CAL_STORE_GYRO_CORR        0x40
+
+typedef struct
+{
+    uint16_t magic;                                         // RTIMULIB_CAL_STORE_MAGIC
+    uint8_t version;                                        // RTIMULIB_CAL_STORE_VERSION
+    uint8_t flags;                                          // RTIMULIB_CAL_STORE_xxx flags
+    uint16_t sequence;                                      // incremented by every save
+    uint8_t axisRotation;                                   // the axis rotation code
+    uint8_t pad;
+    float magMin[3];                                        // compass min/max
+    float magMax[3];
+    float magEllipsoidOffset[3];                            // compass ellipsoid offset
+    float accelMin[3];                                      // accel min/max
+    float accelMax[3];
+    float accelEllipsoidOffset[3];                          // accel ellipsoid offset
+    float gyroBias[3];                                      // gyro bias, rad/s
+    float temperatureC[4][9];                               // temperature bias c0 to c3
+    float temperatureBreak;                                 // temperature bias breakpoint
+    int16_t magEllipsoidCorr[3][3];                         // Q13 correction matrices
+    int16_t accelEllipsoidCorr[3][3];
+    int16_t gyroCorr[3][3];
+    uint16_t crc;                                           // CRC-16/CCITT of everything before it
+} RTIMULIB_CAL_STORE;
+
+//  both copies must fit between the original record and the end of the EEPROM
+
+static_assert(sizeof(RTIMULIB_CAL_DATA) <= RTIMULIB_CAL_STORE_BASE, "RTIMULIB_CAL_DATA overlaps RTIMULIB_CAL_STORE");
+#ifdef E2END
+static_assert(RTIMULIB_CAL_STORE_BASE + 2 * sizeof(RTIMULIB_CAL_STORE) <= E2END + 1,
+              "RTIMULIB_CAL_STORE copies A and B don't fit in the EEPROM");
+#endif
+
 //  Settings keys for SD card based  config
 
 #define RTIMULIB_IMU_TYPE                   "IMUType"
@@ -76,6 +133,9 @@ typedef struct
 #define RTIMULIB_AXIS_ROTATION              "AxisRotation"
 #define RTIMULIB_PRESSURE_TYPE              "PressureType"
 #define RTIMULIB_I2C_PRESSUREADDRESS        "I2CPressureAddress"
+#define RTIMULIB_PRESSURE_OSR               "PressureOSR"
+#define RTIMULIB_PRESSURE_TEMP_OSR          "PressureTempOSR"
+#define RTIMULIB_PRESSURE_TEMP_DECIMATION   "PressureTempDecimation"
 #define RTIMULIB_HUMIDITY_TYPE              "HumidityType"
 #define RTIMULIB_I2C_HUMIDITYADDRESS        "I2CHumidityAddress"
 
@@ -235,6 +295,19 @@ typedef struct
 #define RTIMULIB_GYRO_BIAS_Y                "GyroBiasY"
 #define RTIMULIB_GYRO_BIAS_Z                "GyroBiasZ"
 
+//  Gyro scale and misalignment calibration keys
+
+#define RTIMULIB_GYROCAL_CORR_VALID         "GyroCalCorrValid"
+#define RTIMULIB_GYROCAL_CORR11             "GyroCalCorr11"
+#define RTIMULIB_GYROCAL_CORR12             "GyroCalCorr12"
+#define RTIMULIB_GYROCAL_CORR13             "GyroCalCorr13"
+#define RTIMULIB_GYROCAL_CORR21             "GyroCalCorr21"
+#define RTIMULIB_GYROCAL_CORR22             "GyroCalCorr22"
+#define RTIMULIB_GYROCAL_CORR23             "GyroCalCorr23"
+#define RTIMULIB_GYROCAL_CORR31             "GyroCalCorr31"
+#define RTIMULIB_GYROCAL_CORR32             "GyroCalCorr32"
+#define RTIMULIB_GYROCAL_CORR33             "GyroCalCorr33"
+
 //  Compass calibration and adjustment settings keys
 
 #define RTIMULIB_COMPASSCAL_VALID           "CompassCalValid"
@@ -261,6 +334,14 @@ typedef struct
 
 #define RTIMULIB_COMPASSADJ_DECLINATION     "compassAdjDeclination"
 
+//  Compass smoothing settings keys
+
+#define RTIMULIB_COMPASS_SMOOTHING          "CompassSmoothing"
+#define RTIMULIB_COMPASS_SMOOTHING_LENGTH   "CompassSmoothingLength"
+#define RTIMULIB_COMPASS_SMOOTHING_TC       "CompassSmoothingTimeConstant"
+#define RTIMULIB_COMPASS_SMOOTHING_CUTOFF   "CompassSmoothingMinCutoff"
+#define RTIMULIB_COMPASS_SMOOTHING_BETA     "CompassSmoothingBeta"
+
 //  Accel calibration settings keys
 
 #define RTIMULIB_ACCELCAL_VALID             "AccelCalValid"
@@ -323,6 +404,9 @@ public:
     int m_axisRotation;                                     // axis rotation code
     int m_pressureType;                                     // type code of pressure sensor in use
     unsigned char m_I2CPressureAddress;                     // I2C slave address of the pressure sensor
+    int m_pressureOSR;                                      // MS56xx/MS58xx pressure oversampling ratio, 0 = driver default
+    int m_pressureTempOSR;                                  // MS56xx/MS58xx temperature oversampling ratio, 0 = driver default
+    int m_pressureTempDecimation;                           // pressure conversions per temperature conversion
     int m_humidityType;                                     // type code of humidity sensor in use
     unsigned char m_I2CHumidityAddress;                     // I2C slave address of the humidity sensor
 
@@ -345,6 +429,12 @@ public:
     float m_compassAdjDeclination;                          // magnetic declination adjustment - subtracted from measured
     void  setDeclination(float declination) { m_compassAdjDeclination = declination;}
     const float getDeclination() { return m_compassAdjDeclination;}
+
+    int m_compassSmoothing;                                 // compass smoothing type (RTCOMPASSSMOOTH_xxx)
+    int m_compassSmoothingLength;                           // boxcar length, samples
+    float m_compassSmoothingTimeConstant;                   // exponential time constant, seconds
+    float m_compassSmoothingMinCutoff;                      // one euro cutoff when steady, Hz
+    float m_compassSmoothingBeta;                           // one euro cutoff increase, Hz per uT/s
 	
     bool m_accelCalValid;                                   // true if there is valid accel calibration data
     RTVector3 m_accelCalMin;                                // the minimum values
@@ -357,6 +447,9 @@ public:
     bool m_gyroBiasValid;                                   // true if the recorded gyro bias is valid
     RTVector3 m_gyroBias;                                   // the recorded gyro bias
 
+    bool m_gyroCalCorrValid;                                // true if the gyro correction matrix is valid
+    float m_gyroCalCorr[3][3];                              // scale and misalignment, applied after the bias
+
     //  IMU-specific vars
 
     //  MPU9150
@@ -478,6 +571,16 @@ private:
     void EEErase(byte device);
     void EEWrite(byte device, RTIMULIB_CAL_DATA * calData);
     boolean EERead(byte device, RTIMULIB_CAL_DATA * calData);
+
+    //  the versioned calibration record
+
+    bool EEStoreRead();                                     // loads the newest good copy
+    void EEStoreWrite();                                    // saves to the older copy
+    bool EEStoreReadCopy(int copy, RTIMULIB_CAL_STORE *store);
+    static uint16_t EEStoreCRC(const RTIMULIB_CAL_STORE *store);
+
+    int m_storeCopy;                                        // copy last loaded or saved, -1 if none
+    uint16_t m_storeSequence;                               // and its sequence number
 };
 
 #endif // _RTIMUSETTINGS_H
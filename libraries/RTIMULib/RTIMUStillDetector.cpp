@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTIMUStillDetector.h"
+
+RTIMUStillDetector::RTIMUStillDetector()
+{
+    m_window = RTIMU_STILL_WINDOW;
+    setNoise(RTIMU_STILL_ACCEL_NOISE, RTIMU_STILL_GYRO_NOISE);
+    setThreshold(RTIMU_STILL_THRESHOLD);
+    setGyroLimit(RTIMU_STILL_GYRO_LIMIT);
+    setGravityWeight(RTIMU_STILL_GRAVITY_WEIGHT);
+    reset();
+}
+
+void RTIMUStillDetector::setWindow(int window)
+{
+    if (window < 2)
+        window = 2;
+    if (window > RTIMU_STILL_WINDOW_MAX)
+        window = RTIMU_STILL_WINDOW_MAX;
+    m_window = window;
+    reset();
+}
+
+void RTIMUStillDetector::setNoise(RTFLOAT accelNoise, RTFLOAT gyroNoise)
+{
+    m_accelWeight = 1.0f / (accelNoise * accelNoise);
+    m_gyroWeight = 1.0f / (gyroNoise * gyroNoise);
+}
+
+void RTIMUStillDetector::setThreshold(RTFLOAT threshold, RTFLOAT hysteresis)
+{
+    m_threshold = threshold;
+    m_hysteresis = hysteresis;
+}
+
+void RTIMUStillDetector::setGyroLimit(RTFLOAT limit)
+{
+    m_gyroLimitSq = limit * limit;
+}
+
+void RTIMUStillDetector::setGravityWeight(RTFLOAT weight)
+{
+    m_gravityWeight = weight;
+}
+
+void RTIMUStillDetector::reset()
+{
+    for (int i = 0; i < 3; i++) {
+        m_sumAccel[i] = 0;
+        m_sumGyro[i] = 0;
+    }
+    m_sumAccelSq = 0;
+    m_sumGyroSq = 0;
+    m_index = 0;
+    m_count = 0;
+    m_still = false;
+    m_score = 0;
+}
+
+bool RTIMUStillDetector::update(const RTVector3& accel, const RTVector3& gyro)
+{
+    RTFLOAT *a = m_accel[m_index];
+    RTFLOAT *w = m_gyro[m_index];
+
+    if (m_count == m_window) {
+        for (int i = 0; i < 3; i++) {
+            m_sumAccel[i] -= a[i];
+            m_sumGyro[i] -= w[i];
+        }
+        m_sumAccelSq -= m_accelSq[m_index];
+        m_sumGyroSq -= m_gyroSq[m_index];
+    } else {
+        m_count++;
+    }
+
+    accel.toArray(a);
+    gyro.toArray(w);
+    m_accelSq[m_index] = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+    m_gyroSq[m_index] = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+    for (int i = 0; i < 3; i++) {
+        m_sumAccel[i] += a[i];
+        m_sumGyro[i] += w[i];
+    }
+    m_sumAccelSq += m_accelSq[m_index];
+    m_sumGyroSq += m_gyroSq[m_index];
+
+    if (++m_index == m_window) {
+        //  resum once per window so rounding errors cannot build up
+
+        m_index = 0;
+        for (int i = 0; i < 3; i++) {
+            m_sumAccel[i] = 0;
+            m_sumGyro[i] = 0;
+        }
+        m_sumAccelSq = 0;
+        m_sumGyroSq = 0;
+        for (int j = 0; j < m_count; j++) {
+            for (int i = 0; i < 3; i++) {
+                m_sumAccel[i] += m_accel[j][i];
+                m_sumGyro[i] += m_gyro[j][i];
+            }
+            m_sumAccelSq += m_accelSq[j];
+            m_sumGyroSq += m_gyroSq[j];
+        }
+    }
+
+    if (m_count < m_window) {
+        m_still = false;
+        return false;
+    }
+
+    RTFLOAT scale = 1.0f / m_window;
+    RTFLOAT meanAccelSq = 0;
+    RTFLOAT meanGyroSq = 0;
+
+    for (int i = 0; i < 3; i++) {
+        RTFLOAT ma = m_sumAccel[i] * scale;
+        RTFLOAT mw = m_sumGyro[i] * scale;
+
+        meanAccelSq += ma * ma;
+        meanGyroSq += mw * mw;
+    }
+
+    RTFLOAT gravityError = meanAccelSq - 1.0f;
+
+    m_score = m_accelWeight * (m_sumAccelSq * scale - meanAccelSq + m_gravityWeight * 0.25f * gravityError * gravityError) +
+            m_gyroWeight * (m_sumGyroSq * scale - meanGyroSq);
+
+    if (m_still)
+        m_still = (m_score <= m_threshold * m_hysteresis) &&
+                ((m_gyroLimitSq == 0) || (meanGyroSq <= m_gyroLimitSq * m_hysteresis * m_hysteresis));
+    else
+        m_still = (m_score < m_threshold) && ((m_gyroLimitSq == 0) || (meanGyroSq < m_gyroLimitSq));
+    return m_still;
+}
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTIMUSTILLDETECTOR_H
+#define	_RTIMUSTILLDETECTOR_H
+
+#include "RTMath.h"
+
+#define RTIMU_STILL_WINDOW_MAX          32                  // largest window in samples
+#define RTIMU_STILL_WINDOW              16                  // default window in samples
+
+#define RTIMU_STILL_ACCEL_NOISE         0.005f              // default accel noise, g
+#define RTIMU_STILL_GYRO_NOISE          0.005f              // default gyro noise, rad/s
+#define RTIMU_STILL_THRESHOLD           15.0f               // default score below which the sensor is still
+#define RTIMU_STILL_HYSTERESIS          2.0f                // score must exceed threshold * this to leave still
+#define RTIMU_STILL_GYRO_LIMIT          0.07f               // default limit on the mean gyro, rad/s
+#define RTIMU_STILL_GRAVITY_WEIGHT      0.0f                // default weight of the gravity magnitude term
+
+//  RTIMUStillDetector decides whether the sensor is at rest from a window of accel and
+//  gyro samples. The score is the generalized likelihood ratio test statistic per sample,
+//  for a still sensor seeing gravity (1g) along the mean accel direction:
+//
+//  T = (tr(var(a)) + g * (|mean(a)| - 1)**2) / accelNoise**2 + tr(var(w)) / gyroNoise**2
+//
+//  With correctly set noise levels T is close to 6 at rest. Window sums and sums of squares
+//  are kept so each update is O(1), and (|mean(a)| - 1)**2 is taken as
+//  (|mean(a)|**2 - 1)**2 / 4 so only squared norms are needed.
+//
+//  The gravity weight g defaults to 0. A 2% accel scale error alone adds 16 to T, so the
+//  gravity term must only be enabled (setGravityWeight(1)) when the accel fed in is
+//  calibrated. With g = 0 the test is on variance only. The gyro variance term does
+//  not see a constant rotation, so the mean gyro is also limited - feed bias corrected
+//  rates if the bias is known.
+//
+//  The sensor becomes still when T drops below the threshold and the mean gyro is within
+//  its limit, and stays still until T exceeds threshold * hysteresis or the mean gyro
+//  exceeds limit * hysteresis. With a gyro limit of 0 and g = 0 only the variances are
+//  tested, for callers whose accel and gyro offsets are what is being measured.
+
+class RTIMUStillDetector
+{
+public:
+    RTIMUStillDetector();
+
+    void setWindow(int window);                             // also resets the detector
+    void setNoise(RTFLOAT accelNoise, RTFLOAT gyroNoise);
+    void setThreshold(RTFLOAT threshold, RTFLOAT hysteresis = RTIMU_STILL_HYSTERESIS);
+    void setGyroLimit(RTFLOAT limit);                       // 0 turns the mean gyro test off
+    void setGravityWeight(RTFLOAT weight);                  // 0 for raw accel, 1 for calibrated
+    void reset();
+
+    //  update() adds one sample (accel in g, gyro in rad/s) and returns isStill()
+
+    bool update(const RTVector3& accel, const RTVector3& gyro);
+
+    bool isStill() { return m_still; }
+    RTFLOAT getScore() { return m_score; }                  // last GLRT score per sample
+
+private:
+    RTFLOAT m_accel[RTIMU_STILL_WINDOW_MAX][3];
+    RTFLOAT m_gyro[RTIMU_STILL_WINDOW_MAX][3];
+    RTFLOAT m_accelSq[RTIMU_STILL_WINDOW_MAX];              // |a|**2 per sample
+    RTFLOAT m_gyroSq[RTIMU_STILL_WINDOW_MAX];               // |w|**2 per sample
+
+    RTFLOAT m_sumAccel[3];
+    RTFLOAT m_sumGyro[3];
+    RTFLOAT m_sumAccelSq;
+    RTFLOAT m_sumGyroSq;
+
+    int m_window;
+    int m_index;                                            // next slot to write
+    int m_count;                                            // valid samples in the window
+
+    RTFLOAT m_accelWeight;                                  // 1 / accelNoise**2
+    RTFLOAT m_gyroWeight;                                   // 1 / gyroNoise**2
+    RTFLOAT m_gravityWeight;
+    RTFLOAT m_threshold;
+    RTFLOAT m_hysteresis;
+    RTFLOAT m_gyroLimitSq;
+
+    bool m_still;
+    RTFLOAT m_score;
+};
+
+#endif // _RTIMUSTILLDETECTOR_H
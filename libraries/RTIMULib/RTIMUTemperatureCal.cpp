@@ -31,6 +31,13 @@
 RTIMUTemperatureCal::RTIMUTemperatureCal(RTIMUSettings *settings)
 {
     m_settings = settings;
+
+    //  the offsets drift with temperature and are what is being fitted, so stillness is
+    //  decided on the accel and gyro variance only
+
+    m_stillDetector.setGravityWeight(0);
+    m_stillDetector.setGyroLimit(0);
+    temperatureCalReset();
 }
 
 RTIMUTemperatureCal::~RTIMUTemperatureCal()
@@ -40,35 +47,71 @@ RTIMUTemperatureCal::~RTIMUTemperatureCal()
 
 void RTIMUTemperatureCal::temperatureCalInit()
 {
-
+    temperatureCalReset();
 }
 
 void RTIMUTemperatureCal::temperatureCalReset()
 {
+    m_fit.reset();
+    m_stillDetector.reset();
+    m_temperatureMax = RTIMUCALDEFS_DEFAULT_MAX;
+    m_temperatureMin = RTIMUCALDEFS_DEFAULT_MIN;
+    m_lastTemperature = RTIMUCALDEFS_DEFAULT_MIN;
 }
 
 bool RTIMUTemperatureCal::newData(const RTVector3& accel, const RTVector3& gyro, const RTVector3& mag, const RTFLOAT& temperature)
 {
+    RTFLOAT values[RTTEMPERATUREFIT_CHANNELS];
+
+    if (!m_stillDetector.update(accel, gyro))
+        return false;
+
+    if (fabs(temperature - m_lastTemperature) < RTIMUCALDEFS_TEMPERATURE_MIN_SPACING)
+        return false;
+
+    //  same order as the raw file and RTIMUSettings::m_temperaturebias
+
+    for (int i = 0; i < 3; i++) {
+        values[i] = accel.data(i);
+        values[i + 3] = gyro.data(i);
+        values[i + 6] = mag.data(i);
+    }
+    m_fit.addSample(values, temperature);
+
+    m_lastTemperature = temperature;
+    if (temperature > m_temperatureMax)
+        m_temperatureMax = temperature;
+    if (temperature < m_temperatureMin)
+        m_temperatureMin = temperature;
     return true;
 }
 
 bool RTIMUTemperatureCal::temperatureCalValid()
 {
-    return true;
+    if (m_fit.getSampleCount() < RTIMUCALDEFS_TEMPERATURE_MIN_SAMPLES)
+        return false;
+    return (m_temperatureMax - m_temperatureMin) >= RTIMUCALDEFS_TEMPERATURE_MIN_RANGE;
 }
 
-TEMPERATURE_CAL_DATA RTIMUTemperatureCal::removeTemperatureCalData()
+bool RTIMUTemperatureCal::temperatureCalSave()
 {
-    TEMPERATURE_CAL_DATA ret;
-    return ret;
-}
+    double c[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_CHANNELS];
 
-bool RTIMUTemperatureCal::temperatureCalSaveRaw(const char *ellipsoidFitPath)
-{
-  return true;
-}
+    if (!temperatureCalValid())
+        return false;
 
-bool RTIMUTemperatureCal::temperatureCalSaveCorr(const char *ellipsoidFitPath)
-{
-  return true;
+    if (!m_fit.fit(c)) {
+        HAL_ERROR("Temperature fit failed\n");
+        return false;
+    }
+
+    for (int i = 0; i < RTTEMPERATUREFIT_CHANNELS; i++) {
+        m_settings->m_c0[i] = c[0][i];
+        m_settings->m_c1[i] = c[1][i];
+        m_settings->m_c2[i] = c[2][i];
+        m_settings->m_c3[i] = c[3][i];
+    }
+    m_settings->m_temperatureCalValid = true;
+    m_settings->saveSettings();
+    return true;
 }
@@ -27,16 +27,14 @@
 
 #include "RTIMUCalDefs.h"
 #include "RTIMULib.h"
+#include "RTTemperatureFit.h"
+#include "RTIMUStillDetector.h"
 
-typedef struct
-{
-    RTVector3 accel;
-    RTVector3 mag;
-    RTVector3 gyro;
-    RTFLOAT temperature;
-} TEMPERATURE_CAL_DATA;
-
-//  RTIMUAccelCal is a helper class for performing accelerometer calibration
+//  RTIMUTemperatureCal is a helper class for performing temperature bias calibration.
+//  Samples are only taken while the sensor is still and the temperature has moved by
+//  RTIMUCALDEFS_TEMPERATURE_MIN_SPACING since the last one. They go straight into the
+//  running sums of RTTemperatureFit so there is no sample buffer and no limit on the
+//  length of the run.
 
 class RTIMUTemperatureCal
 {
@@ -46,45 +44,36 @@ public:
     virtual ~RTIMUTemperatureCal();
 
     //  This should be called at the start of the calibration process
-    //  Loads previous values if available
     void temperatureCalInit();
 
     //  This should be called to clear for a new run
     void temperatureCalReset();
 
-    // accelCalValid() checks if all values are reasonable. Should be called before saving
+    //  temperatureCalSetOutlierRejection() turns the 2 sigma outlier test on or off (default on).
+    //  It should be called before the first sample.
+    void temperatureCalSetOutlierRejection(bool enable) { m_fit.setOutlierRejection(enable); }
+
+    // temperatureCalValid() checks if there are enough samples over a wide enough range. Should be called before saving
     bool temperatureCalValid();
 
     //  temperatureCalSave() should be called at the end of the process to save the cal data
     //  to the settings file. Returns false if invalid data
     bool temperatureCalSave();
 
-    // temperatureCalSaveRaw saves the temperature data for later octave fitting
-    // Returns true if everything worked correctly.
-    bool temperatureCalSaveRaw(const char *ellipsoidFitPath);
-
-    // temperatureCalSaveCorr loads the correction data produced by the octave fit program and saves it in the
-    // .ini file
-    bool temperatureCalSaveCorr(const char *ellipsoidFitPath);
-
-    // newData is used to save data to the accel,gyro,compass sample array
+    // newData() adds a sample if the sensor is still and the temperature has changed enough.
+    // Returns true if the sample was used.
     bool newData(const RTVector3& accel, const RTVector3& gyro, const RTVector3& mag, const RTFLOAT& temperature);
 
     // these vars used during the calibration process
 
     RTIMUSettings *m_settings;
 
-    TEMPERATURE_CAL_DATA m_temperatureCalSamples[RTIMUCALDEFS_MAX_TEMPERATURE_SAMPLES];
-    
-    int m_temperatureCalInIndex;
-    int m_temperatureCalOutIndex;
-    int m_temperatureCalCount;
-    
-    RTFLOAT m_temperatureMax;
-    RTFLOAT m_temperatureMin;;
+    RTTemperatureFit m_fit;
+    RTIMUStillDetector m_stillDetector;
 
-private:
-     TEMPERATURE_CAL_DATA removeTemperatureCalData();                           // takes an entry out of the buffer
+    RTFLOAT m_temperatureMax;
+    RTFLOAT m_temperatureMin;
+    RTFLOAT m_lastTemperature;                              // temperature of the last sample used
 };
 
-#endif // _RTIMUACCELCAL_H
+#endif // _RTIMUTEMPERATURECAL_H
@@ -0,0 +1,196 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTIMUTimestamp.h"
+
+RTIMUTimestamp::RTIMUTimestamp()
+{
+    reset(100);
+}
+
+void RTIMUTimestamp::reset(int sampleRate)
+{
+    m_nominalPeriod = 1000000.0 / (double)(sampleRate > 0 ? sampleRate : 1);
+    m_period = m_nominalPeriod;
+    m_readIndex = 0;
+    m_nextIndex = 0;
+    m_outputValid = false;
+    m_hostValid = false;
+    m_residualMean = 0;
+    m_residualMax = 0;
+    m_outputError = 0;
+    m_observations = 0;
+    m_resyncs = 0;
+    resync();
+    m_resyncs = 0;
+}
+
+void RTIMUTimestamp::resync()
+{
+    //  the period estimate survives, the phase has to be found again. Samples already
+    //  read but not yet timestamped belong before the new sequence
+
+    m_nextIndex -= m_readIndex;
+    m_readIndex = 0;
+    m_fitValid = false;
+    m_s0 = m_sx = m_sy = m_sxx = m_sxy = 0;
+    m_resyncs++;
+}
+
+double RTIMUTimestamp::fit(int64_t index)
+{
+    return m_offset + m_period * (double)(index - m_refIndex);
+}
+
+uint64_t RTIMUTimestamp::hostTime(uint64_t now)
+{
+    uint32_t low = (uint32_t)now;
+
+    if (!m_hostValid) {
+        m_hostTime = now;
+        m_hostValid = true;
+    } else {
+        int32_t delta = (int32_t)(low - m_hostLow);
+
+        if (delta > 0)
+            m_hostTime += delta;
+    }
+    m_hostLow = low;
+    return m_hostTime;
+}
+
+void RTIMUTimestamp::fifoCount(uint64_t now, int samples)
+{
+    now = hostTime(now);
+
+    if (samples <= 0)
+        return;                                             // empty FIFO says nothing about the phase
+
+    //  the newest sample was produced somewhere in the last period, so on average half
+    //  a period before now
+
+    int64_t index = m_readIndex + samples - 1;
+    double t = -0.5 * m_nominalPeriod;
+
+    m_observations++;
+
+    if (!m_fitValid) {
+        m_refIndex = index;
+        m_refTime = now;
+        m_offset = t;
+        m_s0 = 1;
+        m_sx = m_sxx = m_sxy = 0;
+        m_sy = t;
+        m_fitValid = true;
+        return;
+    }
+
+    //  move the origin to this observation so the sums stay small
+
+    double ax = (double)(index - m_refIndex);
+    double ay = (double)(int64_t)(now - m_refTime);
+
+    double y = t;
+    double residual = (ay + t) - fit(index);
+
+    m_sxx += ax * ax * m_s0 - 2.0 * ax * m_sx;
+    m_sxy += ax * ay * m_s0 - ax * m_sy - ay * m_sx;
+    m_sx -= ax * m_s0;
+    m_sy -= ay * m_s0;
+    m_refIndex = index;
+    m_refTime = now;
+
+    //  add the new point (x = 0) with forgetting
+
+    m_s0 = RTIMU_TIMESTAMP_FORGET * m_s0 + 1.0;
+    m_sx = RTIMU_TIMESTAMP_FORGET * m_sx;
+    m_sy = RTIMU_TIMESTAMP_FORGET * m_sy + y;
+    m_sxx = RTIMU_TIMESTAMP_FORGET * m_sxx;
+    m_sxy = RTIMU_TIMESTAMP_FORGET * m_sxy;
+
+    double det = m_s0 * m_sxx - m_sx * m_sx;
+
+    if (det > 1.0) {
+        double period = (m_s0 * m_sxy - m_sx * m_sy) / det;
+        if (fabs(period / m_nominalPeriod - 1.0) <= RTIMU_TIMESTAMP_MAX_DRIFT)
+            m_period = period;
+    }
+    m_offset = (m_sy - m_period * m_sx) / m_s0;
+
+    residual = fabs(residual);
+    m_residualMean += 0.1 * (residual - m_residualMean);
+    if (residual > m_residualMax)
+        m_residualMax = residual;
+}
+
+uint64_t RTIMUTimestamp::next()
+{
+    uint64_t timestamp;
+
+    if (!m_fitValid) {
+        //  no observation yet - just count periods
+
+        if (m_outputValid)
+            timestamp = m_lastOutput + (uint64_t)m_period;
+        else
+            timestamp = hostTime(RTMath::currentUSecsSinceEpoch());
+    } else {
+        double target = fit(m_nextIndex);
+        int64_t targetTime = (int64_t)m_refTime + (int64_t)target;
+
+        if (!m_outputValid) {
+            timestamp = targetTime;
+        } else {
+            double error = (double)(targetTime - (int64_t)m_lastOutput) - m_period;
+
+            if (fabs(error) > RTIMU_TIMESTAMP_RESYNC * m_period) {
+                //  too far out to slew (samples were lost) - jump, but never backwards
+
+                if (targetTime > (int64_t)m_lastOutput)
+                    timestamp = targetTime;
+                else
+                    timestamp = m_lastOutput + (uint64_t)(m_period * (1.0 - RTIMU_TIMESTAMP_SLEW));
+            } else {
+                double limit = RTIMU_TIMESTAMP_SLEW * m_period;
+                if (error > limit)
+                    error = limit;
+                if (error < -limit)
+                    error = -limit;
+                timestamp = m_lastOutput + (uint64_t)(m_period + error + 0.5);
+            }
+        }
+        m_outputError = (double)((int64_t)timestamp - targetTime);
+    }
+
+    m_nextIndex++;
+    m_lastOutput = timestamp;
+    m_outputValid = true;
+    return timestamp;
+}
+
+void RTIMUTimestamp::skip(int samples)
+{
+    m_nextIndex += samples;
+    if (m_outputValid)
+        m_lastOutput += (uint64_t)(m_period * samples);
+}
@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTIMUTIMESTAMP_H
+#define	_RTIMUTIMESTAMP_H
+
+#include "RTMath.h"
+
+//  RTIMUTimestamp generates per sample timestamps for FIFO based IMUs. The IMU's own
+//  oscillator is usually a percent or two off the nominal rate, so counting nominal
+//  intervals drifts. Instead each FIFO count read is used as an observation - the newest
+//  sample in the FIFO was produced just before the host time of the read. A weighted
+//  linear regression over recent observations gives the true sample period and phase.
+//  Output timestamps follow the fit but are slewed by at most a fraction of a period per
+//  sample, so they are always monotonic and free of the host polling jitter.
+//
+//  micros() wraps every 71.6 minutes. Host times are extended to 64 bits from the 32 bit
+//  difference to the previous call, so the host has to look at least every 35 minutes. A
+//  host clock that steps backwards is held rather than followed.
+//
+//  Driver usage:
+//      reset()         - at init with the nominal rate
+//      fifoCount()     - whenever the FIFO count register has been read
+//      samplesRead()   - for every sample taken out of the FIFO
+//      next()          - for every sample processed, in order
+//      skip()          - for samples read but discarded
+//      resync()        - after the FIFO has been reset (sample sequence broken)
+
+#define RTIMU_TIMESTAMP_FORGET      0.95                    // per observation forgetting factor of the fit
+#define RTIMU_TIMESTAMP_SLEW        0.05                    // max correction per sample as a fraction of a period
+#define RTIMU_TIMESTAMP_RESYNC      20                      // error in periods that makes the output jump
+#define RTIMU_TIMESTAMP_MAX_DRIFT   0.1                     // fitted rate must be within 10% of nominal
+
+class RTIMUTimestamp
+{
+public:
+    RTIMUTimestamp();
+
+    void reset(int sampleRate);
+    void resync();
+    void fifoCount(uint64_t now, int samples);
+    void samplesRead(int samples) { m_readIndex += samples; }
+    uint64_t next();
+    void skip(int samples);
+
+    //  statistics
+
+    double periodUs() { return m_period; }                  // fitted sample period
+    double rateHz() { return 1000000.0 / m_period; }
+    double residualMeanUs() { return m_residualMean; }      // smoothed abs error of observations against the fit
+    double residualMaxUs() { return m_residualMax; }        // worst observation error seen
+    double outputErrorUs() { return m_outputError; }        // last output timestamp minus the fit
+    unsigned long observations() { return m_observations; }
+    unsigned long resyncs() { return m_resyncs; }
+
+private:
+    double fit(int64_t index);                              // fitted time of a sample relative to m_refTime
+    uint64_t hostTime(uint64_t now);                        // extends now to a monotonic 64 bit time
+
+    double m_nominalPeriod;
+    double m_period;                                        // current period estimate in uS
+
+    int64_t m_readIndex;                                    // samples read from the FIFO since resync
+    int64_t m_nextIndex;                                    // next sample to timestamp
+
+    bool m_fitValid;                                        // at least one observation since resync
+    int64_t m_refIndex;                                     // regression origin
+    uint64_t m_refTime;
+    double m_s0, m_sx, m_sy, m_sxx, m_sxy;                  // weighted sums relative to the origin
+    double m_offset;                                        // fitted time of m_refIndex relative to m_refTime
+
+    bool m_outputValid;
+    uint64_t m_lastOutput;
+
+    bool m_hostValid;
+    uint64_t m_hostTime;                                    // extended host time of the last call
+    uint32_t m_hostLow;                                     // low 32 bits of the last now
+
+    double m_residualMean;
+    double m_residualMax;
+    double m_outputError;
+    unsigned long m_observations;
+    unsigned long m_resyncs;
+};
+
+#endif // _RTIMUTIMESTAMP_H
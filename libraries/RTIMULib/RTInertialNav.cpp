@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTInertialNav.h"
+
+RTInertialNav::RTInertialNav()
+{
+    m_accelNoise = RTINS_ACCEL_NOISE;
+    m_zuptNoise = RTINS_ZUPT_NOISE;
+    m_accelBias.zero();
+    m_lastTimestamp = 0;
+
+    //  the accel is calibrated here so a wrong gravity magnitude means motion
+
+    m_stillDetector.setGravityWeight(1.0f);
+    reset();
+}
+
+void RTInertialNav::reset()
+{
+    m_stationary = false;
+    m_velocity.zero();
+    m_position.zero();
+    m_worldAccel.zero();
+    memset(m_P, 0, sizeof(m_P));
+}
+
+void RTInertialNav::resetPosition()
+{
+    m_position.zero();
+    m_P[0][0] = 0;
+    m_P[0][1] = m_P[1][0] = 0;
+}
+
+void RTInertialNav::newIMUData(const RTIMU_DATA& data)
+{
+    RTFLOAT dt = (RTFLOAT)(data.timestamp - m_lastTimestamp) / 1000000.0f;
+    bool timed = (m_lastTimestamp != 0) && (data.timestamp > m_lastTimestamp) && (dt < RTINS_MAX_DT);
+
+    m_lastTimestamp = data.timestamp;
+    m_stationary = m_stillDetector.update(data.accel, data.gyro);
+
+    //  rotate the bias corrected specific force into the world frame and remove gravity
+
+    RTVector3 worldAccel = RTMath::toWorld(data.accel - m_accelBias, data.fusionQPose);
+
+    worldAccel.setZ(worldAccel.z() - 1.0f);
+    worldAccel *= RTINS_GRAVITY;
+
+    if (timed) {
+        //  trapezoidal integration as in RTMotion
+
+        RTVector3 velocity = m_velocity + (worldAccel + m_worldAccel) * (0.5f * dt);
+
+        m_position += (velocity + m_velocity) * (0.5f * dt);
+        m_velocity = velocity;
+
+        //  P = F * P * F' + Q with F = [1 dt; 0 1]
+
+        RTFLOAT q = m_accelNoise * m_accelNoise;
+        RTFLOAT p01 = m_P[0][1] + dt * m_P[1][1];
+
+        m_P[0][0] += dt * (m_P[0][1] + p01) + 0.25f * dt * dt * dt * dt * q;
+        m_P[0][1] = p01 + 0.5f * dt * dt * dt * q;
+        m_P[1][0] = m_P[0][1];
+        m_P[1][1] += dt * dt * q;
+    }
+    m_worldAccel = worldAccel;
+
+    if (m_stationary) {
+        zeroVelocityUpdate();
+
+        //  at rest the accelerometer should read 1g along the pose's gravity. The pose is
+        //  tilted by any bias across gravity so only the component along it is learnt.
+
+        RTQuaternion pose = data.fusionQPose;
+        RTVector3 gravity;
+
+        pose.toGravity(gravity);
+        RTFLOAT error = RTVector3::dotProduct(data.accel - m_accelBias, gravity) - 1.0f;
+        m_accelBias += gravity * (error * RTINS_BIAS_ALPHA);
+    }
+}
+
+void RTInertialNav::zeroVelocityUpdate()
+{
+    //  velocity measured as zero - the same gain applies to every axis
+
+    RTFLOAT S = m_P[1][1] + m_zuptNoise * m_zuptNoise;
+    RTFLOAT k0 = m_P[0][1] / S;
+    RTFLOAT k1 = m_P[1][1] / S;
+
+    m_position -= m_velocity * k0;
+    m_velocity -= m_velocity * k1;
+
+    m_P[0][0] -= k0 * m_P[1][0];
+    m_P[0][1] -= k0 * m_P[1][1];
+    m_P[1][1] -= k1 * m_P[1][1];
+    m_P[1][0] = m_P[0][1];
+}
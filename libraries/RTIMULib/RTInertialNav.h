@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTINERTIALNAV_H
+#define	_RTINERTIALNAV_H
+
+#include "RTMath.h"
+#include "RTIMULibDefs.h"
+#include "RTIMUStillDetector.h"
+
+#define RTINS_GRAVITY                   9.80665f            // m/s/s per g
+#define RTINS_MAX_DT                    0.1f                // longer gaps restart the time base
+
+#define RTINS_ACCEL_NOISE               0.05f               // default accel noise, m/s/s
+#define RTINS_ZUPT_NOISE                0.01f               // default zero velocity noise, m/s
+#define RTINS_BIAS_ALPHA                0.01f               // accel bias learning rate at rest
+
+//  RTInertialNav is a strapdown inertial navigator for bursts of motion separated by rest,
+//  such as a foot mounted sensor. The accelerometer is rotated into the world frame with
+//  the fusion pose, gravity is removed and the result is integrated to velocity and
+//  position. Whenever the sensor is detected at rest a zero velocity update (ZUPT) pulls
+//  the velocity back to zero, corrects the position through the velocity / position
+//  correlation and the accelerometer bias is learnt.
+//
+//  Only the bias along gravity can be learnt. The fusion pose comes from the same
+//  accelerometer, so at rest it settles tilted by exactly the bias across gravity and the
+//  two can't be told apart - that part stays in the pose as a small tilt, and it is only
+//  learnt along the axes the sensor is later left resting on.
+//
+//  The uncertainty model is the same for all three axes, so a single 2x2 covariance of
+//  position and velocity per axis is kept. Positions are in m, velocities in m/s.
+
+class RTInertialNav
+{
+public:
+    RTInertialNav();
+
+    //  reset() zeroes velocity and position and their uncertainty, the bias is kept
+
+    void reset();
+    void resetPosition();
+
+    void setAccelNoise(RTFLOAT noise) { m_accelNoise = noise; }
+    void setZUPTNoise(RTFLOAT noise) { m_zuptNoise = noise; }
+
+    //  the rest detector can be tuned through getStillDetector()
+
+    RTIMUStillDetector& getStillDetector() { return m_stillDetector; }
+
+    //  newIMUData() should be called for every sample after fusion has updated fusionQPose
+
+    void newIMUData(const RTIMU_DATA& data);
+
+    bool isStationary() { return m_stationary; }
+    const RTVector3& getVelocity() { return m_velocity; }
+    const RTVector3& getPosition() { return m_position; }
+    const RTVector3& getWorldAccel() { return m_worldAccel; }
+    const RTVector3& getAccelBias() { return m_accelBias; }   // body frame, g, learnt along gravity only
+    RTFLOAT getVelocityVariance() { return m_P[1][1]; }     // per axis, (m/s)**2
+    RTFLOAT getPositionVariance() { return m_P[0][0]; }     // per axis, m*m
+
+private:
+    void zeroVelocityUpdate();
+
+    uint64_t m_lastTimestamp;                               // 0 if there is no time base
+    bool m_stationary;
+
+    RTVector3 m_velocity;
+    RTVector3 m_position;
+    RTVector3 m_worldAccel;                                 // gravity free, m/s/s
+    RTVector3 m_accelBias;
+    RTFLOAT m_P[2][2];                                      // position / velocity covariance per axis
+
+    RTFLOAT m_accelNoise;
+    RTFLOAT m_zuptNoise;
+
+    RTIMUStillDetector m_stillDetector;
+};
+
+#endif // _RTINERTIALNAV_H
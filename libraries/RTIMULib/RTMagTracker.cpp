@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTMagTracker.h"
+
+RTMagTracker::RTMagTracker()
+{
+    setRate(RTMAGTRACK_RATE);
+    m_coverage.setBinLimit(1);
+    setForgettingFactor(RTMAGTRACK_LAMBDA);
+}
+
+void RTMagTracker::reset()
+{
+    m_lastTimestamp = 0;
+    m_lastSample = RTVector3(0, 0, 0);
+
+    m_theta.fill(0);
+    m_P.setToIdentity();
+    m_P *= RTMAGTRACK_INITIAL_VARIANCE;
+    m_residualSq = 0;
+    m_updates = 0;
+
+    m_coverage.reset();
+    m_lastCoverage = 0;
+    m_coverageUpdates = 0;
+
+    m_offset = RTVector3(0, 0, 0);
+    m_valid = false;
+}
+
+void RTMagTracker::setForgettingFactor(RTFLOAT lambda)
+{
+    if (lambda < RTMAGTRACK_MIN_LAMBDA)
+        lambda = RTMAGTRACK_MIN_LAMBDA;
+    if (lambda > RTMAGTRACK_MAX_LAMBDA)
+        lambda = RTMAGTRACK_MAX_LAMBDA;
+    m_lambda = lambda;
+    m_coverageWindow = (int)(1.0f / (1.0f - m_lambda) + 0.5f);
+    reset();
+}
+
+void RTMagTracker::setRate(RTFLOAT rate)
+{
+    if (rate <= 0)
+        rate = RTMAGTRACK_RATE;
+    m_interval = (uint64_t)(1000000.0f / rate);
+}
+
+bool RTMagTracker::newSample(const RTVector3& mag, uint64_t timestamp)
+{
+    if ((m_lastTimestamp != 0) && (timestamp - m_lastTimestamp < m_interval))
+        return false;
+
+    RTVector3 delta = mag - m_lastSample;
+
+    if (delta.squareLength() < RTMAGTRACK_MIN_SPACING * RTMAGTRACK_MIN_SPACING)
+        return false;
+
+    m_lastTimestamp = timestamp;
+    m_lastSample = mag;
+
+    //  regressor phi = [2x 2y 2z 1] and measurement |x|^2 in scaled units
+
+    RTFLOAT scale = 1.0f / RTMAGTRACK_FIELD_SCALE;
+    RTFLOAT x[3] = {mag.x() * scale, mag.y() * scale, mag.z() * scale};
+    RTFLOAT phi[4] = {2 * x[0], 2 * x[1], 2 * x[2], 1};
+    RTFLOAT y = x[0] * x[0] + x[1] * x[1] + x[2] * x[2];
+    RTFLOAT Pphi[4];
+    RTFLOAT error = y;
+    RTFLOAT denom = m_lambda;
+
+    for (int row = 0; row < 4; row++) {
+        Pphi[row] = 0;
+        for (int col = 0; col < 4; col++)
+            Pphi[row] += m_P(row, col) * phi[col];
+        error -= phi[row] * m_theta(row, 0);
+        denom += phi[row] * Pphi[row];
+    }
+
+    //  theta += K * error, P = (P - K * phi' * P) / lambda with K = P * phi / denom. P stays
+    //  symmetric so only the upper triangle is computed.
+
+    RTFLOAT trace = m_P(0, 0) + m_P(1, 1) + m_P(2, 2) + m_P(3, 3);
+    RTFLOAT forget = (trace > RTMAGTRACK_MAX_TRACE) ? 1.0f : 1.0f / m_lambda;
+
+    for (int row = 0; row < 4; row++) {
+        m_theta(row, 0) += Pphi[row] * error / denom;
+        for (int col = row; col < 4; col++) {
+            m_P(row, col) = (m_P(row, col) - Pphi[row] * Pphi[col] / denom) * forget;
+            m_P(col, row) = m_P(row, col);
+        }
+    }
+    m_updates++;
+
+    //  radial residual against the updated sphere
+
+    RTFLOAT b[3] = {m_theta(0, 0), m_theta(1, 0), m_theta(2, 0)};
+    RTFLOAT radiusSq = m_theta(3, 0) + b[0] * b[0] + b[1] * b[1] + b[2] * b[2];
+    RTVector3 direction(x[0] - b[0], x[1] - b[1], x[2] - b[2]);
+
+    if (radiusSq <= 0)
+        return true;
+
+    RTFLOAT radial = direction.length() - sqrt(radiusSq);
+
+    m_residualSq += (radial * radial - m_residualSq) * RTMAGTRACK_RESIDUAL_ALPHA;
+
+    m_coverage.addSample(direction);
+    if (++m_coverageUpdates >= m_coverageWindow) {
+        m_lastCoverage = m_coverage.getCoverage();
+        m_coverage.reset();
+        m_coverageUpdates = 0;
+    }
+
+    if ((m_updates >= RTMAGTRACK_MIN_SAMPLES) && (getCoverage() >= RTMAGTRACK_MIN_COVERAGE) &&
+            (m_residualSq < RTMAGTRACK_MAX_RESIDUAL * RTMAGTRACK_MAX_RESIDUAL * radiusSq) &&
+            (getCentreError() < RTMAGTRACK_MAX_CENTRE_ERROR)) {
+        m_offset = getCentre();
+        m_valid = true;
+    }
+    return true;
+}
+
+RTVector3 RTMagTracker::getCentre()
+{
+    return RTVector3(m_theta(0, 0), m_theta(1, 0), m_theta(2, 0)) * RTMAGTRACK_FIELD_SCALE;
+}
+
+RTFLOAT RTMagTracker::getRadius()
+{
+    RTFLOAT radiusSq = m_theta(3, 0) + m_theta(0, 0) * m_theta(0, 0) + m_theta(1, 0) * m_theta(1, 0) +
+            m_theta(2, 0) * m_theta(2, 0);
+
+    return (radiusSq > 0) ? sqrt(radiusSq) * RTMAGTRACK_FIELD_SCALE : 0;
+}
+
+RTFLOAT RTMagTracker::getResidual()
+{
+    return sqrt(m_residualSq) * RTMAGTRACK_FIELD_SCALE;
+}
+
+RTFLOAT RTMagTracker::getCoverage()
+{
+    RTFLOAT coverage = m_coverage.getCoverage();
+
+    return (coverage > m_lastCoverage) ? coverage : m_lastCoverage;
+}
+
+RTFLOAT RTMagTracker::getCentreError()
+{
+    //  a radial error r changes |x|^2 by about 2 * radius * r, and P scaled by the
+    //  measurement variance is the covariance of the parameters
+
+    RTFLOAT largest = m_P(0, 0);
+
+    if (m_P(1, 1) > largest)
+        largest = m_P(1, 1);
+    if (m_P(2, 2) > largest)
+        largest = m_P(2, 2);
+
+    RTFLOAT radius = getRadius() / RTMAGTRACK_FIELD_SCALE;
+
+    return 2 * radius * sqrt(m_residualSq * largest) * RTMAGTRACK_FIELD_SCALE;
+}
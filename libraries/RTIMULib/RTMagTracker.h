@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTMAGTRACKER_H
+#define	_RTMAGTRACKER_H
+
+#include "RTMath.h"
+#include "RTSphereCoverage.h"
+
+//  RTMagTracker follows slow changes of the hard iron offset during normal operation, for
+//  example when a payload is added, so that a full calibration session is not needed. It
+//  runs a recursive least squares fit of a sphere to the calibrated compass:
+//
+//  |m|^2 = 2 * b.m + k       with centre b and radius sqrt(k + |b|^2)
+//
+//  which is linear in (b, k). The forgetting factor lets old samples fade out with a time
+//  constant of 1 / (1 - lambda) updates. Samples are taken at a fixed, decimated rate and
+//  only when the field has moved since the last one, and the forgetting is suspended when
+//  the covariance grows too large, so a stationary sensor doesn't wind the filter up. Each
+//  update is a fixed 4x4 step.
+//
+//  The centre is only handed out once the fit is trustworthy: enough samples, enough of
+//  the sphere covered within the last time constant, a small residual and a small centre
+//  uncertainty. The last gate catches samples that cover enough bins but still leave an
+//  axis undetermined, such as a sensor that only turns about one axis. The last accepted
+//  centre is kept when the gates close again.
+//
+//  Fields are scaled by RTMAGTRACK_FIELD_SCALE inside the filter to keep the float
+//  arithmetic well conditioned.
+
+#define RTMAGTRACK_RATE                 10                  // default update rate, Hz
+#define RTMAGTRACK_LAMBDA               0.995f              // default forgetting factor (20 seconds at 10Hz)
+#define RTMAGTRACK_MIN_LAMBDA           0.9f                // shortest memory, 10 updates
+#define RTMAGTRACK_MAX_LAMBDA           0.9999f             // longest memory, 10000 updates - 1 would never forget
+#define RTMAGTRACK_FIELD_SCALE          50.0f               // typical field, uT
+#define RTMAGTRACK_MIN_SPACING          1.0f                // uT the field must move between samples
+#define RTMAGTRACK_INITIAL_VARIANCE     100.0f              // initial covariance diagonal, scaled units
+#define RTMAGTRACK_MAX_TRACE            1000.0f             // no forgetting above this covariance trace
+
+#define RTMAGTRACK_MIN_SAMPLES          100                 // updates before a centre is accepted
+#define RTMAGTRACK_MIN_COVERAGE         20.0f               // percent of the sphere within one time constant
+#define RTMAGTRACK_MAX_RESIDUAL         0.03f               // rms radial residual as a fraction of the radius
+#define RTMAGTRACK_RESIDUAL_ALPHA       0.05f               // residual filter, faster than the fit
+#define RTMAGTRACK_MAX_CENTRE_ERROR     1.0f                // largest standard deviation of the centre, uT
+
+class RTMagTracker
+{
+public:
+    RTMagTracker();
+
+    //  reset() restarts the fit and forgets the accepted centre
+
+    void reset();
+
+    void setForgettingFactor(RTFLOAT lambda);               // clamped to the limits above, also resets
+    void setRate(RTFLOAT rate);                             // Hz
+
+    //  newSample() takes a compass sample in uT and its timestamp in uS. It returns true if
+    //  the sample was used to update the fit.
+
+    bool newSample(const RTVector3& mag, uint64_t timestamp);
+
+    bool isValid() { return m_valid; }                      // true once a centre has been accepted
+    const RTVector3& getOffset() { return m_offset; }       // accepted centre, uT
+
+    //  the current estimate, whether or not it passes the gates
+
+    RTVector3 getCentre();
+    RTFLOAT getRadius();                                    // uT
+    RTFLOAT getResidual();                                  // rms radial residual, uT
+    RTFLOAT getCoverage();                                  // percent
+    RTFLOAT getCentreError();                               // largest centre standard deviation, uT
+
+private:
+    RTFLOAT m_lambda;
+    uint64_t m_interval;                                    // uS between updates
+    uint64_t m_lastTimestamp;
+    RTVector3 m_lastSample;
+
+    RTMatrix<4, 1> m_theta;                                 // scaled b and k
+    RTMatrix<4, 4> m_P;
+    RTFLOAT m_residualSq;                                   // filtered squared radial residual, scaled units
+    int m_updates;
+
+    //  the coverage of the previous time constant is kept while the current one fills
+
+    RTSphereCoverage m_coverage;
+    RTFLOAT m_lastCoverage;
+    int m_coverageUpdates;
+    int m_coverageWindow;                                   // updates in one time constant
+
+    RTVector3 m_offset;
+    bool m_valid;
+};
+
+#endif // _RTMAGTRACKER_H
@@ -27,7 +27,15 @@
 // added tilt compensated heading
 
 #include "RTMath.h"
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#include <sys/time.h>
+#endif
+
+#ifdef RTMATH_OUT_OF_LINE
+#include "RTMathInline.h"
+#endif
 
 //  Strings are put here. So the display functions are no re-entrant!
 
@@ -35,7 +43,14 @@ char RTMath::m_string[1000];
 
 uint64_t RTMath::currentUSecsSinceEpoch()
 {
+#ifdef ARDUINO
     return micros();
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+#endif
 }
 
 const char *RTMath::displayRadians(const char *label, RTVector3& vec)
@@ -108,39 +123,7 @@ RTFLOAT RTMath::convertPressureLatitudeToDepth(RTFLOAT pressure, RTFLOAT staticP
     return ((((-1.82E-15  * p + 2.279E-10 ) * p - 2.251E-5 ) * p + 9.72659) * p) / g;
     // http://www.seabird.com/document/an69-conversion-pressure-depth
 }
-RTFLOAT RTMath::clamp2PI(RTFLOAT x) {
-	while ((x) >= (2.0f*RTMATH_PI)) (x) -= (2.0f*RTMATH_PI); 
-	while ((x) < 0) (x) += (2.0f*RTMATH_PI); 
-	return x;
-}
-RTVector3 RTMath::toWorld(const RTVector3& vec, const RTQuaternion& q)
-{
-    // Vector rotation by quaternion
-    // P_out = q * P_in * conj(q)
-    // - P_out is the output vector
-    // - q is the orientation quaternion
-    // - P_in is the input vector
-    // - conj(q) is the conjugate of the orientation quaternion (q=[w,x,y,z], q*=[w,-x,-y,-z])
-	
-    RTQuaternion q_tmp;
-    RTQuaternion q_con;
-    
-    RTVector3 world_vec;
-	
-    q_tmp.setScalar(0.0f);
-    q_tmp.setX(vec.x());
-    q_tmp.setY(vec.y());
-    q_tmp.setZ(vec.z());
-    
-    // Backwards
-    q_tmp = q * q_tmp * q.conjugate();
-    
-    world_vec.setX(q_tmp.x());
-    world_vec.setY(q_tmp.y());
-    world_vec.setZ(q_tmp.z());
 
-    return world_vec;
-}
 RTVector3 RTMath::poseFromAccelMag(const RTVector3& accel, const RTVector3& mag)
 {
     // Estimate Pose Vector from Accelerometer and Compass
@@ -158,10 +141,10 @@ RTVector3 RTMath::poseFromAccelMag(const RTVector3& accel, const RTVector3& mag)
 //  q.fromEuler(result);
 //  since result.z() is always 0, this can be optimized a little
 
-    RTFLOAT cosX2 = cos(result.x() / 2.0f);
-    RTFLOAT sinX2 = sin(result.x() / 2.0f);
-    RTFLOAT cosY2 = cos(result.y() / 2.0f);
-    RTFLOAT sinY2 = sin(result.y() / 2.0f);
+    RTFLOAT cosX2 = RTMATH_COS(result.x() / 2.0f);
+    RTFLOAT sinX2 = RTMATH_SIN(result.x() / 2.0f);
+    RTFLOAT cosY2 = RTMATH_COS(result.y() / 2.0f);
+    RTFLOAT sinY2 = RTMATH_SIN(result.y() / 2.0f);
 
     q.setScalar(cosX2 * cosY2);
     q.setX(sinX2 * cosY2);
@@ -177,7 +160,7 @@ RTVector3 RTMath::poseFromAccelMag(const RTVector3& accel, const RTVector3& mag)
 
     m = q * m * q.conjugate();
     // Update Yaw in RPY from Magnetometer
-    result.setZ(-atan2(m.y(), m.x()));
+    result.setZ(-RTMATH_ATAN2(m.y(), m.x()));
     return result;
 }
 
@@ -195,191 +178,21 @@ void RTMath::convertToVector(unsigned char *rawData, RTVector3& vec, RTFLOAT sca
 }
 
 
-
 //----------------------------------------------------------
 //
 //  The RTVector3 class
 
-RTVector3::RTVector3()
-{
-    zero();
-}
-
-RTVector3::RTVector3(RTFLOAT x, RTFLOAT y, RTFLOAT z)
-{
-    m_data[0] = x;
-    m_data[1] = y;
-    m_data[2] = z;
-}
-
-RTVector3& RTVector3::operator =(const RTVector3& vec)
-{
-    if (this == &vec)
-        return *this;
-
-    m_data[0] = vec.m_data[0];
-    m_data[1] = vec.m_data[1];
-    m_data[2] = vec.m_data[2];
-
-    return *this;
-}
-
-RTVector3& RTVector3::operator =(const RTFLOAT val)
-{
-    for (int i = 0; i < 3; i++)
-        m_data[i] = val;
-    return *this;
-}
-
-RTVector3& RTVector3::operator +=(const RTFLOAT val)
-{
-    for (int i = 0; i < 3; i++)
-        m_data[i] += val;
-    return *this;
-}
-
-RTVector3& RTVector3::operator +=(const RTVector3& vec)
-{
-    for (int i = 0; i < 3; i++)
-        m_data[i] += vec.m_data[i];
-    return *this;
-}
-
-RTVector3& RTVector3::operator -=(const RTFLOAT val)
-{
-    for (int i = 0; i < 3; i++)
-        m_data[i] -= val;
-    return *this;
-}
-
-RTVector3& RTVector3::operator -=(const RTVector3& vec)
-{
-    for (int i = 0; i < 3; i++)
-        m_data[i] -= vec.m_data[i];
-    return *this;
-}
-
-RTVector3& RTVector3::operator *=(const RTFLOAT val)
-{
-    m_data[0] *= val;
-    m_data[1] *= val;
-    m_data[2] *= val;
-
-    return *this;
-}
-
-RTVector3& RTVector3::operator *=(const RTVector3& vec)
-{
-    RTVector3 va;
-    RTVector3 vb;
-    //RTFLOAT dotAB;
-    RTVector3 crossAB;
-
-    va.setX(m_data[0]);
-    va.setY(m_data[1]);
-    va.setZ(m_data[2]);
-
-    //dotAB = RTVector3::dotProduct(va, vec);
-    RTVector3::crossProduct(va, vec, crossAB);
-
-    m_data[0] = vb.x() + va.x() + crossAB.x();
-    m_data[1] = vb.y() + va.y() + crossAB.y();
-    m_data[2] = vb.z() + va.z() + crossAB.z();
-
-    return *this;
-}
-
-RTVector3& RTVector3::operator /=(const RTFLOAT val)
-{
-    m_data[0] /= val;
-    m_data[1] /= val;
-    m_data[2] /= val;
-
-    return *this;
-}
-
-const RTVector3 RTVector3::operator *(const RTVector3& vec) const
-{
-    RTVector3 result = *this;
-    result *= vec;
-    return result;
-}
-
-const RTVector3 RTVector3::operator *(const RTFLOAT val) const
-{
-    RTVector3 result = *this;
-    result *= val;
-    return result;
-}
-
-const RTVector3 RTVector3::operator /(const RTFLOAT val) const
-{
-    RTVector3 result = *this;
-    result /= val;
-    return result;
-}
-
-
-const RTVector3 RTVector3::operator -(const RTVector3& vec) const
-{
-    RTVector3 result = *this;
-    result -= vec;
-    return result;
-}
-
-const RTVector3 RTVector3::operator -(const RTFLOAT val) const
-{
-    RTVector3 result = *this;
-    result -= val;
-    return result;
-}
-
-const RTVector3 RTVector3::operator +(const RTVector3& vec) const
-{
-    RTVector3 result = *this;
-    result += vec;
-    return result;
-}
-
-const RTVector3 RTVector3::operator +(const RTFLOAT val) const
-{
-    RTVector3 result = *this;
-    result += val;
-    return result;
-}
-
-void RTVector3::zero()
-{
-    for (int i = 0; i < 3; i++)
-        m_data[i] = 0;
-}
-
-
-RTFLOAT RTVector3::dotProduct(const RTVector3& a, const RTVector3& b)
-{
-    return a.x() * b.x() + a.y() * b.y() + a.z() * b.z();
-}
-
-void RTVector3::crossProduct(const RTVector3& a, const RTVector3& b, RTVector3& d)
-{
-    d.setX(a.y() * b.z() - a.z() * b.y());
-    d.setY(a.z() * b.x() - a.x() * b.z());
-    d.setZ(a.x() * b.y() - a.y() * b.x());
-}
-
-
 void RTVector3::accelToEuler(RTVector3& rollPitchYaw) const
 {
     RTVector3 normAccel = *this;
 
     normAccel.normalize();
 
-    rollPitchYaw.setX(atan2(normAccel.y(), normAccel.z()));
-    rollPitchYaw.setY(-atan2(normAccel.x(), sqrt(normAccel.y() * normAccel.y() + normAccel.z() * normAccel.z())));
+    rollPitchYaw.setX(RTMATH_ATAN2(normAccel.y(), normAccel.z()));
+    rollPitchYaw.setY(-RTMATH_ATAN2(normAccel.x(), sqrt(normAccel.y() * normAccel.y() + normAccel.z() * normAccel.z())));
     rollPitchYaw.setZ(0);
 }
 
-
 void RTVector3::accelToQuaternion(RTQuaternion& qPose) const
 {
     RTVector3 normAccel = *this;
@@ -388,338 +201,40 @@ void RTVector3::accelToQuaternion(RTQuaternion& qPose) const
 
     normAccel.normalize();
 
-    RTFLOAT angle = acos(RTVector3::dotProduct(z, normAccel));
+    RTFLOAT angle = RTMATH_ACOS(RTVector3::dotProduct(z, normAccel));
     RTVector3::crossProduct(normAccel, z, vec);
     vec.normalize();
 
     qPose.fromAngleVector(angle, vec);
 }
 
-
-void RTVector3::normalize()
-{
-    RTFLOAT length = sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
-            m_data[2] * m_data[2]);
-
-    if (length == 0)
-        return;
-
-    m_data[0] /= length;
-    m_data[1] /= length;
-    m_data[2] /= length;
-}
-
-RTFLOAT RTVector3::length()
-{
-    return sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
-            m_data[2] * m_data[2]);
-}
-RTFLOAT RTVector3::squareLength()
-{
-   return m_data[0] * m_data[0] + m_data[1] * m_data[1] +
-            m_data[2] * m_data[2];
-}
 RTFLOAT RTVector3::toHeading(const RTVector3& mag, const float declination)
 {
   // Tilt compensated heading from compass, skips conversion to RPY, as those are provided as input
   RTVector3 rpy = *this;
   float heading;
   
-  float cos_roll = cos(rpy.x());
-  float sin_roll = sin(rpy.x());
-  float cos_pitch = cos(rpy.y());
-  float sin_pitch = sin(rpy.y());
+  float cos_roll = RTMATH_COS(rpy.x());
+  float sin_roll = RTMATH_SIN(rpy.x());
+  float cos_pitch = RTMATH_COS(rpy.y());
+  float sin_pitch = RTMATH_SIN(rpy.y());
   
   // Tilt compensated Magnetic field X component:
   float Head_X = mag.x()*cos_pitch + mag.y()*sin_roll*sin_pitch + mag.z()*cos_roll*sin_pitch;
   // Tilt compensated Magnetic field Y component:
   float Head_Y = mag.y()*cos_roll - mag.z()*sin_roll;
   // Magnetic Heading
-  heading = -atan2(Head_Y,Head_X) -declination;
+  heading = -RTMATH_ATAN2(Head_Y,Head_X) -declination;
   if(heading < -9990) { heading = 0; }
   heading = RTMath::clamp2PI(heading);
 
   return (heading);
 }
+
 //----------------------------------------------------------
 //
 //  The RTQuaternion class
 
-RTQuaternion::RTQuaternion()
-{
-    zero();
-}
-
-RTQuaternion::RTQuaternion(RTFLOAT scalar, RTFLOAT x, RTFLOAT y, RTFLOAT z)
-{
-    m_data[0] = scalar;
-    m_data[1] = x;
-    m_data[2] = y;
-    m_data[3] = z;
-}
-
-RTQuaternion& RTQuaternion::operator =(const RTQuaternion& quat)
-{
-    if (this == &quat)
-        return *this;
-
-    m_data[0] = quat.m_data[0];
-    m_data[1] = quat.m_data[1];
-    m_data[2] = quat.m_data[2];
-    m_data[3] = quat.m_data[3];
-
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator =(const RTFLOAT val)
-{
-    for (int i = 0; i < 4; i++)
-        m_data[i] = val;
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator +=(const RTFLOAT val)
-{
-    for (int i = 0; i < 4; i++)
-        m_data[i] += val;
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator +=(const RTQuaternion& quat)
-{
-    for (int i = 0; i < 4; i++)
-        m_data[i] += quat.m_data[i];
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator -=(const RTFLOAT val)
-{
-    for (int i = 0; i < 4; i++)
-        m_data[i] -= val;
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator -=(const RTQuaternion& quat)
-{
-    for (int i = 0; i < 4; i++)
-        m_data[i] -= quat.m_data[i];
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator *=(const RTFLOAT val)
-{
-    m_data[0] *= val;
-    m_data[1] *= val;
-    m_data[2] *= val;
-    m_data[3] *= val;
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator *=(const RTQuaternion& qb)
-{
-    RTQuaternion qa;
-
-    qa = *this;
-
-    m_data[0] = qa.scalar() * qb.scalar() - qa.x() * qb.x() - qa.y() * qb.y() - qa.z() * qb.z();
-    m_data[1] = qa.scalar() * qb.x() + qa.x() * qb.scalar() + qa.y() * qb.z() - qa.z() * qb.y();
-    m_data[2] = qa.scalar() * qb.y() - qa.x() * qb.z() + qa.y() * qb.scalar() + qa.z() * qb.x();
-    m_data[3] = qa.scalar() * qb.z() + qa.x() * qb.y() - qa.y() * qb.x() + qa.z() * qb.scalar();
-    
-	/*
-	SAGE CODE
-	N.<c,d,qas,qax,qay,qaz,qbs,qbx,qby,qbz,s> = QQ[]
-	H.<i,j,k> = QuaternionAlgebra(c,d)
-	a = qas + qax * i + qay * j + qaz * k
-	b = qbs + qbx * i + qby * j + qbz * k
-	a*b
-	
-	-qaz*qbz  - qax*qbx - qay*qby + qas*qbs  
-	(-qaz*qby + qay*qbz + qax*qbs + qas*qbx)*i 
-	(qaz*qbx  - qax*qbz + qay*qbs + qas*qby)*j
-	(qaz*qbs  - qay*qbx + qax*qby + qas*qbz)*k
-    */
-	
-    return *this;
-}
-
-
-RTQuaternion& RTQuaternion::operator /=(const RTFLOAT val)
-{
-    m_data[0] /= val;
-    m_data[1] /= val;
-    m_data[2] /= val;
-    m_data[3] /= val;
-
-    return *this;
-}
-
-RTQuaternion& RTQuaternion::operator /=(const RTQuaternion& qb)
-{
-    RTQuaternion qa;
-    
-    qa = *this;
-    
-    RTFLOAT qsql = qb.scalar()*qb.scalar() + qb.x() * qb.x() +
-            qb.y() * qb.y() + qb.z() * qb.z();
-    qa *= (qb.conjugate() / qsql);
-    
-    m_data[0] =   qa.scalar();
-    m_data[1] =   qa.x();
-    m_data[2] =   qa.y();
-    m_data[3] =   qa.z();
-  
-    return *this;
-}
-
-const RTQuaternion RTQuaternion::operator *(const RTQuaternion& qb) const
-{
-    RTQuaternion result = *this;
-    result *= qb;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator *(const RTFLOAT val) const
-{
-    RTQuaternion result = *this;
-    result *= val;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator /(const RTQuaternion& qb) const
-{
-    RTQuaternion result = *this;
-    result /= qb;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator /(const RTFLOAT val) const
-{
-    RTQuaternion result = *this;
-    result /= val;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator -(const RTQuaternion& qb) const
-{
-    RTQuaternion result = *this;
-    result -= qb;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator -(const RTFLOAT val) const
-{
-    RTQuaternion result = *this;
-    result -= val;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator +(const RTQuaternion& qb) const
-{
-    RTQuaternion result = *this;
-    result += qb;
-    return result;
-}
-
-const RTQuaternion RTQuaternion::operator +(const RTFLOAT val) const
-{
-    RTQuaternion result = *this;
-    result += val;
-    return result;
-}
-
-void RTQuaternion::zero()
-{
-    for (int i = 0; i < 4; i++)
-        m_data[i] = 0;
-}
-
-void RTQuaternion::normalize()
-{
-    RTFLOAT length = sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
-            m_data[2] * m_data[2] + m_data[3] * m_data[3]);
-
-    if ((length == 0) || (length == 1))
-        return;
-
-    m_data[0] /= length;
-    m_data[1] /= length;
-    m_data[2] /= length;
-    m_data[3] /= length;
-}
-
-void RTQuaternion::toEuler(RTVector3& vec)
-{
-    // RT Code same as Wikipedia
-    // Ideally quaternion is normalized before calling this function
-
-    vec.setX(atan2(2.0 * (m_data[2] * m_data[3] + m_data[0] * m_data[1]),
-            1 - 2.0 * (m_data[1] * m_data[1] + m_data[2] * m_data[2])));
-
-    vec.setY(asin(2.0 * (m_data[0] * m_data[2] - m_data[1] * m_data[3])));
-
-    vec.setZ(atan2(2.0 * (m_data[1] * m_data[2] + m_data[0] * m_data[3]),
-            1 - 2.0 * (m_data[2] * m_data[2] + m_data[3] * m_data[3])));
-
-    // Matlab Code, uses more multiplications, no normalization needed
-    //vec.setX(atan2(2.0f * (m_data[2] * m_data[3] + m_data[0] * m_data[1]),
-    //        (m_data[0] * m_data[0] - m_data[1] * m_data[1] - m_data[2] * m_data[2] + m_data[3] * m_data[3] )));
-    //
-    //vec.setY(asin(2.0f * (m_data[0] * m_data[2] - m_data[1] * m_data[3])));
-    // 
-    //vec.setZ(atan2(2.0f * (m_data[1] * m_data[2] + m_data[0] * m_data[3]),
-    //        (m_data[0] * m_data[0] + m_data[1] * m_data[1] - m_data[2] * m_data[2] - m_data[3] * m_data[3])));
-	
-}
-
-void RTQuaternion::toGravity(RTVector3& vec) 
-{
-// Creates Gravity vector from pose quaternion
-  vec.setX( 2.0f * (m_data[1]*m_data[3] - m_data[0]*m_data[2]));
-  vec.setY( 2.0f * (m_data[0]*m_data[1] + m_data[2]*m_data[3]));
-  vec.setZ( m_data[0]*m_data[0] - m_data[1]*m_data[1] - m_data[2]*m_data[2] + m_data[3]*m_data[3]);
-}
-
-void RTQuaternion::fromEuler(RTVector3& vec)
-{
-    // RT Code same as Wikipedia and Matlab
-    RTFLOAT cosX2 = cos(vec.x() / 2.0f);
-    RTFLOAT sinX2 = sin(vec.x() / 2.0f);
-    RTFLOAT cosY2 = cos(vec.y() / 2.0f);
-    RTFLOAT sinY2 = sin(vec.y() / 2.0f);
-    RTFLOAT cosZ2 = cos(vec.z() / 2.0f);
-    RTFLOAT sinZ2 = sin(vec.z() / 2.0f);
-
-    m_data[0] = cosX2 * cosY2 * cosZ2 + sinX2 * sinY2 * sinZ2;
-    m_data[1] = sinX2 * cosY2 * cosZ2 - cosX2 * sinY2 * sinZ2;
-    m_data[2] = cosX2 * sinY2 * cosZ2 + sinX2 * cosY2 * sinZ2;
-    m_data[3] = cosX2 * cosY2 * sinZ2 - sinX2 * sinY2 * cosZ2;
-    normalize();
-}
-
-RTQuaternion RTQuaternion::conjugate() const
-{
-    RTQuaternion q;
-    q.setScalar(m_data[0]);
-    q.setX(-m_data[1]);
-    q.setY(-m_data[2]);
-    q.setZ(-m_data[3]);
-    return q;
-}
-
-RTFLOAT RTQuaternion::length()
-{
-   return sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
-            m_data[2] * m_data[2] + m_data[3] * m_data[3]);
-}
-
-RTFLOAT RTQuaternion::squareLength()
-{
-   return m_data[0] * m_data[0] + m_data[1] * m_data[1] +
-            m_data[2] * m_data[2] + m_data[3] * m_data[3];
-}
-
-
 void RTQuaternion::toAngleVector(RTFLOAT& angle, RTVector3& vec)
 {
     // Converts quaternion to vector and rotation around that vector
@@ -728,8 +243,8 @@ void RTQuaternion::toAngleVector(RTFLOAT& angle, RTVector3& vec)
     RTFLOAT halfTheta;
     RTFLOAT sinHalfTheta;
 
-    halfTheta = acos(m_data[0]);
-    sinHalfTheta = sin(halfTheta);
+    halfTheta = RTMATH_ACOS(m_data[0]);
+    sinHalfTheta = RTMATH_SIN(halfTheta);
 
     if (sinHalfTheta == 0) {
         vec.setX(1.0);
@@ -746,8 +261,8 @@ void RTQuaternion::toAngleVector(RTFLOAT& angle, RTVector3& vec)
 void RTQuaternion::fromAngleVector(const RTFLOAT& angle, const RTVector3& vec)
 {
     // Converts rotation of angle around vector to quaternion
-    RTFLOAT sinHalfTheta = sin(angle / 2.0);
-    m_data[0] = cos(angle / 2.0);
+    RTFLOAT sinHalfTheta = RTMATH_SIN(angle / 2.0);
+    m_data[0] = RTMATH_COS(angle / 2.0);
     m_data[1] = vec.x() * sinHalfTheta;
     m_data[2] = vec.y() * sinHalfTheta;
     m_data[3] = vec.z() * sinHalfTheta;
@@ -757,24 +272,13 @@ RTFLOAT RTQuaternion::toHeading(const RTVector3& mag, const float declination)
 {
   // Tilt compensated heading from compass
   // Corrected for local magnetic declination
-  RTVector3 rpy;
+  RTFLOAT north, east;
   float heading;
 
-  // Convert pose quaternion to RPY
-  RTQuaternion q = *this;
-  q.toEuler(rpy);
-  
-  float cos_roll = cos(rpy.x());
-  float sin_roll = sin(rpy.x());
-  float cos_pitch = cos(rpy.y());
-  float sin_pitch = sin(rpy.y());
-  
-  // Tilt compensated Magnetic field X component:
-  float Head_X = mag.x()*cos_pitch + mag.y()*sin_roll*sin_pitch + mag.z()*cos_roll*sin_pitch;
-  // Tilt compensated Magnetic field Y component:
-  float Head_Y = mag.y()*cos_roll - mag.z()*sin_roll;
+  toHeadingVector(mag, north, east);
+
   // Magnetic Heading
-  heading = -atan2(Head_Y,Head_X) - declination;
+  heading = RTMATH_ATAN2(east, north) - declination;
 
   if(heading < -9990) { heading = 0; }
   heading = RTMath::clamp2PI(heading);
@@ -782,181 +286,16 @@ RTFLOAT RTQuaternion::toHeading(const RTVector3& mag, const float declination)
   return (heading);
 }
 
-//----------------------------------------------------------
-//
-//  The RTMatrix4x4 class
-
-RTMatrix4x4::RTMatrix4x4()
-{
-    fill(0);
-}
-
-RTMatrix4x4& RTMatrix4x4::operator =(const RTMatrix4x4& mat)
-{
-    if (this == &mat)
-        return *this;
-
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            m_data[row][col] = mat.m_data[row][col];
-
-    return *this;
-}
-
-
-void RTMatrix4x4::fill(RTFLOAT val)
-{
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            m_data[row][col] = val;
-}
-
-
-RTMatrix4x4& RTMatrix4x4::operator +=(const RTMatrix4x4& mat)
-{
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            m_data[row][col] += mat.m_data[row][col];
-
-    return *this;
-}
-
-RTMatrix4x4& RTMatrix4x4::operator -=(const RTMatrix4x4& mat)
-{
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            m_data[row][col] -= mat.m_data[row][col];
-
-    return *this;
-}
-
-RTMatrix4x4& RTMatrix4x4::operator *=(const RTFLOAT val)
-{
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            m_data[row][col] *= val;
-
-    return *this;
-}
-
-const RTMatrix4x4 RTMatrix4x4::operator +(const RTMatrix4x4& mat) const
+void RTQuaternion::toHeadingVector(const RTVector3& mag, RTFLOAT& north, RTFLOAT& east)
 {
-    RTMatrix4x4 result = *this;
-    result += mat;
-    return result;
-}
+  // Horizontal magnetic field seen along the sensor x axis, without any trig:
+  // with d the vertical from the pose, e = d x mag points east and n = e x d north.
+  // atan2(east, north) is the same heading as the roll/pitch tilt compensation.
+  RTVector3 d, e, n;
 
-const RTMatrix4x4 RTMatrix4x4::operator *(const RTFLOAT val) const
-{
-    RTMatrix4x4 result = *this;
-    result *= val;
-    return result;
+  toGravity(d);
+  RTVector3::crossProduct(d, mag, e);
+  RTVector3::crossProduct(e, d, n);
+  north = n.x();
+  east = e.x();
 }
-
-
-const RTMatrix4x4 RTMatrix4x4::operator *(const RTMatrix4x4& mat) const
-{
-    RTMatrix4x4 res;
-
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            res.m_data[row][col] =
-                    m_data[row][0] * mat.m_data[0][col] +
-                    m_data[row][1] * mat.m_data[1][col] +
-                    m_data[row][2] * mat.m_data[2][col] +
-                    m_data[row][3] * mat.m_data[3][col];
-
-    return res;
-}
-
-
-const RTQuaternion RTMatrix4x4::operator *(const RTQuaternion& q) const
-{
-    RTQuaternion res;
-
-    res.setScalar(m_data[0][0] * q.scalar() + m_data[0][1] * q.x() + m_data[0][2] * q.y() + m_data[0][3] * q.z());
-    res.setX(m_data[1][0] * q.scalar() + m_data[1][1] * q.x() + m_data[1][2] * q.y() + m_data[1][3] * q.z());
-    res.setY(m_data[2][0] * q.scalar() + m_data[2][1] * q.x() + m_data[2][2] * q.y() + m_data[2][3] * q.z());
-    res.setZ(m_data[3][0] * q.scalar() + m_data[3][1] * q.x() + m_data[3][2] * q.y() + m_data[3][3] * q.z());
-
-    return res;
-}
-
-void RTMatrix4x4::setToIdentity()
-{
-    fill(0);
-    m_data[0][0] = 1;
-    m_data[1][1] = 1;
-    m_data[2][2] = 1;
-    m_data[3][3] = 1;
-}
-
-RTMatrix4x4 RTMatrix4x4::transposed()
-{
-    RTMatrix4x4 res;
-
-    for (int row = 0; row < 4; row++)
-        for (int col = 0; col < 4; col++)
-            res.m_data[col][row] = m_data[row][col];
-    return res;
-}
-
-//  Note:
-//  The matrix inversion code here was strongly influenced by some old code I found
-//  but I have no idea where it came from. Apologies to whoever wrote it originally!
-//  If it's you, please let me know at info@richards-tech.com so I can credit it correctly.
-
-RTMatrix4x4 RTMatrix4x4::inverted()
-{
-    RTMatrix4x4 res;
-
-    RTFLOAT det = matDet();
-
-    if (det == 0) {
-        res.setToIdentity();
-        return res;
-    }
-
-    for (int row = 0; row < 4; row++) {
-        for (int col = 0; col < 4; col++) {
-            if ((row + col) & 1)
-                res.m_data[col][row] = -matMinor(row, col) / det;
-            else
-                res.m_data[col][row] = matMinor(row, col) / det;
-        }
-    }
-
-    return res;
-}
-
-RTFLOAT RTMatrix4x4::matDet()
-{
-    RTFLOAT det = 0;
-
-    det += m_data[0][0] * matMinor(0, 0);
-    det -= m_data[0][1] * matMinor(0, 1);
-    det += m_data[0][2] * matMinor(0, 2);
-    det -= m_data[0][3] * matMinor(0, 3);
-    return det;
-}
-
-RTFLOAT RTMatrix4x4::matMinor(const int row, const int col)
-{
-    static int map[] = {1, 2, 3, 0, 2, 3, 0, 1, 3, 0, 1, 2};
-
-    int *rc;
-    int *cc;
-    RTFLOAT res = 0;
-
-    rc = map + row * 3;
-    cc = map + col * 3;
-
-    res += m_data[rc[0]][cc[0]] * m_data[rc[1]][cc[1]] * m_data[rc[2]][cc[2]];
-    res -= m_data[rc[0]][cc[0]] * m_data[rc[1]][cc[2]] * m_data[rc[2]][cc[1]];
-    res -= m_data[rc[0]][cc[1]] * m_data[rc[1]][cc[0]] * m_data[rc[2]][cc[2]];
-    res += m_data[rc[0]][cc[1]] * m_data[rc[1]][cc[2]] * m_data[rc[2]][cc[0]];
-    res += m_data[rc[0]][cc[2]] * m_data[rc[1]][cc[0]] * m_data[rc[2]][cc[1]];
-    res -= m_data[rc[0]][cc[2]] * m_data[rc[1]][cc[1]] * m_data[rc[2]][cc[0]];
-    return res;
-}
-
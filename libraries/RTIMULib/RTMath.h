@@ -40,10 +40,56 @@ typedef float RTFLOAT;
 #define	RTMATH_DEGREE_TO_RAD		(RTMATH_PI / 180.0)
 #define	RTMATH_RAD_TO_DEGREE		(180.0 / RTMATH_PI)
 
+//  Fast math selection. Each group of functions can be switched from libm to the
+//  approximations in RTMathInline.h by defining its flag in the build, RTMATH_FAST_ALL
+//  switches all of them. Worst case errors over the whole domain in a float build:
+//
+//  RTMATH_FAST_TRIG        sin, cos            1.9e-7
+//  RTMATH_FAST_ATAN        atan2               2.0e-6 rad
+//  RTMATH_FAST_ASIN        asin, acos          1.4e-6 rad
+//  RTMATH_FAST_INVSQRT     1/sqrt (normalize)  4.8e-6 relative
+//
+//  sin and cos use libm beyond RTMATH_FAST_TRIG_RANGE radians, where the range reduction
+//  would lose accuracy. A double build keeps the same polynomial errors, 1/sqrt is refined
+//  to full precision. HostTests/TestFastMath.cpp measures these bounds.
+
+#define RTMATH_FAST_TRIG_RANGE          8192.0f             // |x| in radians
+
+#ifdef RTMATH_FAST_ALL
+#define RTMATH_FAST_TRIG
+#define RTMATH_FAST_ATAN
+#define RTMATH_FAST_ASIN
+#define RTMATH_FAST_INVSQRT
+#endif
+
+#ifdef RTMATH_FAST_TRIG
+#define RTMATH_SIN(x)                   RTMath::fastSin(x)
+#define RTMATH_COS(x)                   RTMath::fastCos(x)
+#else
+#define RTMATH_SIN(x)                   sin(x)
+#define RTMATH_COS(x)                   cos(x)
+#endif
+
+#ifdef RTMATH_FAST_ATAN
+#define RTMATH_ATAN2(y, x)              RTMath::fastAtan2(y, x)
+#else
+#define RTMATH_ATAN2(y, x)              atan2(y, x)
+#endif
+
+#ifdef RTMATH_FAST_ASIN
+#define RTMATH_ASIN(x)                  RTMath::fastAsin(x)
+#define RTMATH_ACOS(x)                  RTMath::fastAcos(x)
+#else
+#define RTMATH_ASIN(x)                  asin(x)
+#define RTMATH_ACOS(x)                  acos(x)
+#endif
+
 class RTVector3;
-class RTMatrix4x4;
 class RTQuaternion;
 
+template <int R, int C, typename T = RTFLOAT> class RTMatrix;
+typedef RTMatrix<4, 4> RTMatrix4x4;
+
 class RTMath
 {
 public:
@@ -60,6 +106,15 @@ public:
     static uint64_t currentUSecsSinceEpoch();
 
     static RTFLOAT clamp2PI(RTFLOAT angle);
+
+    //  fast approximations, normally used through the RTMATH_SIN() etc. macros
+
+    static RTFLOAT fastSin(RTFLOAT x);
+    static RTFLOAT fastCos(RTFLOAT x);
+    static RTFLOAT fastAtan2(RTFLOAT y, RTFLOAT x);
+    static RTFLOAT fastAsin(RTFLOAT x);
+    static RTFLOAT fastAcos(RTFLOAT x);
+    static RTFLOAT fastInvSqrt(RTFLOAT x);
     
     static RTVector3 toWorld(const RTVector3& vec, const RTQuaternion& q);
     //  poseFromAccelMag generates pose Euler angles from measured settings
@@ -112,7 +167,7 @@ public:
     const char *display();
     const char *displayDegrees();
 
-    static float dotProduct(const RTVector3& a, const RTVector3& b);
+    static RTFLOAT dotProduct(const RTVector3& a, const RTVector3& b);
     static void crossProduct(const RTVector3& a, const RTVector3& b, RTVector3& d);
 
     void accelToEuler(RTVector3& rollPitchYaw) const;
@@ -168,6 +223,7 @@ public:
     void toEuler(RTVector3& vec);
     void fromEuler(RTVector3& vec);
     RTFLOAT toHeading(const RTVector3& mag, const float declination);
+    void toHeadingVector(const RTVector3& mag, RTFLOAT& north, RTFLOAT& east);
     RTQuaternion conjugate() const;
     RTFLOAT length();
     RTFLOAT squareLength();
@@ -195,34 +251,11 @@ private:
     RTFLOAT m_data[4];
 };
 
-class RTMatrix4x4
-{
-public:
-    RTMatrix4x4();
-
-    RTMatrix4x4& operator +=(const RTMatrix4x4& mat);
-    RTMatrix4x4& operator -=(const RTMatrix4x4& mat);
-    RTMatrix4x4& operator *=(const RTFLOAT val);
 
-    RTMatrix4x4& operator =(const RTMatrix4x4& vec);
-    const RTQuaternion operator *(const RTQuaternion& q) const;
-    const RTMatrix4x4 operator *(const RTFLOAT val) const;
-    const RTMatrix4x4 operator *(const RTMatrix4x4& mat) const;
-    const RTMatrix4x4 operator +(const RTMatrix4x4& mat) const;
+#include "RTMatrix.h"
 
-    inline RTFLOAT val(int row, int col) const { return m_data[row][col]; }
-    inline void setVal(int row, int col, RTFLOAT val) { m_data[row][col] = val; }
-    void fill(RTFLOAT val);
-    void setToIdentity();
-
-    RTMatrix4x4 inverted();
-    RTMatrix4x4 transposed();
-
-private:
-    RTFLOAT m_data[4][4];                                   // row, column
-
-    RTFLOAT matDet();
-    RTFLOAT matMinor(const int row, const int col);
-};
+#ifndef RTMATH_OUT_OF_LINE
+#include "RTMathInline.h"
+#endif
 
 #endif /* _RTMATH_H_ */
@@ -0,0 +1,695 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTMATHINLINE_H_
+#define _RTMATHINLINE_H_
+
+//  The small RTVector3 and RTQuaternion operations live here so that the fusion filters,
+//  RTIMU and RTMotion can inline them - Arduino builds have no link time optimization.
+//  RTMath.h includes this file at its end. Defining RTMATH_OUT_OF_LINE in the build
+//  compiles them once in RTMath.cpp instead, as before.
+
+#ifdef RTMATH_OUT_OF_LINE
+#define RTMATH_INLINE
+#else
+#define RTMATH_INLINE inline
+#endif
+
+//----------------------------------------------------------
+//
+//  The RTMath class
+
+RTMATH_INLINE RTFLOAT RTMath::clamp2PI(RTFLOAT x) {
+	while ((x) >= (2.0f*RTMATH_PI)) (x) -= (2.0f*RTMATH_PI); 
+	while ((x) < 0) (x) += (2.0f*RTMATH_PI); 
+	return x;
+}
+
+//  fastTrigReduce() returns n and r = x - n * PI with |r| <= PI/2. PI is split in three
+//  so that n * PI_A and n * PI_B are exact for |n| < 4096, which RTMATH_FAST_TRIG_RANGE
+//  keeps well inside - beyond it sin and cos go to libm.
+
+#define RTMATH_PI_A                     3.140625f
+#define RTMATH_PI_B                     0.0009677410125732422f
+#define RTMATH_PI_C                     -8.742278012618954e-8f
+
+static inline int fastTrigReduce(RTFLOAT x, RTFLOAT& r)
+{
+    int n = (int)(x * (RTFLOAT)(1.0 / RTMATH_PI) + (x < 0 ? -0.5f : 0.5f));
+    RTFLOAT k = (RTFLOAT)n;
+
+    r = ((x - k * RTMATH_PI_A) - k * RTMATH_PI_B) - k * RTMATH_PI_C;
+    return n;
+}
+
+//  sin(r) = r * P(r * r) on [-PI/2, PI/2], minimax
+
+RTMATH_INLINE RTFLOAT RTMath::fastSin(RTFLOAT x)
+{
+    if (fabs(x) > RTMATH_FAST_TRIG_RANGE)
+        return sin(x);
+
+    RTFLOAT r;
+    int n = fastTrigReduce(x, r);
+    RTFLOAT r2 = r * r;
+    RTFLOAT s = r * (0.99999997659f + r2 * (-0.16666647635f + r2 * (0.0083328998223f +
+            r2 * (-0.00019800897695f + r2 * 2.5904883558e-6f))));
+
+    return (n & 1) ? -s : s;
+}
+
+//  cos(r) = P(r * r) on [-PI/2, PI/2], Taylor to r^12 - reducing x itself rather than
+//  x + PI/2 keeps the rounding of the phase shift out of the result
+
+RTMATH_INLINE RTFLOAT RTMath::fastCos(RTFLOAT x)
+{
+    if (fabs(x) > RTMATH_FAST_TRIG_RANGE)
+        return cos(x);
+
+    RTFLOAT r;
+    int n = fastTrigReduce(x, r);
+    RTFLOAT r2 = r * r;
+    RTFLOAT c = 1.0f + r2 * (-0.5f + r2 * (4.1666666667e-2f + r2 * (-1.3888888889e-3f +
+            r2 * (2.4801587302e-5f + r2 * (-2.7557319224e-7f + r2 * 2.0876756988e-9f)))));
+
+    return (n & 1) ? -c : c;
+}
+
+//  atan(x) = x * P(x * x) on [0, 1], minimax, the octant is restored afterwards
+
+RTMATH_INLINE RTFLOAT RTMath::fastAtan2(RTFLOAT y, RTFLOAT x)
+{
+    RTFLOAT ax = fabs(x);
+    RTFLOAT ay = fabs(y);
+    RTFLOAT angle;
+
+    if ((ax == 0) && (ay == 0))
+        return 0;
+
+    bool swap = ay > ax;
+    RTFLOAT t = swap ? ax / ay : ay / ax;
+    RTFLOAT t2 = t * t;
+
+    angle = t * (0.99997721901f + t2 * (-0.33262282580f + t2 * (0.19354036134f +
+            t2 * (-0.11642644194f + t2 * (0.052647305456f + t2 * -0.011719116902f)))));
+    if (swap)
+        angle = (RTFLOAT)(RTMATH_PI / 2.0) - angle;
+    if (x < 0)
+        angle = (RTFLOAT)RTMATH_PI - angle;
+    return y < 0 ? -angle : angle;
+}
+
+//  acos(x) = sqrt(1 - x) * P(x) on [0, 1], minimax, asin(x) = PI/2 - acos(x)
+
+RTMATH_INLINE RTFLOAT RTMath::fastAcos(RTFLOAT x)
+{
+    RTFLOAT ax = fabs(x);
+
+    if (ax > 1.0f)
+        ax = 1.0f;
+
+    RTFLOAT angle = sqrt(1.0f - ax) * (1.5707952064f + ax * (-0.21451227254f + ax * (0.087875654930f +
+            ax * (-0.044957245309f + ax * (0.019348269389f + ax * -0.0043371708882f)))));
+
+    return x < 0 ? (RTFLOAT)RTMATH_PI - angle : angle;
+}
+
+RTMATH_INLINE RTFLOAT RTMath::fastAsin(RTFLOAT x)
+{
+    return (RTFLOAT)(RTMATH_PI / 2.0) - fastAcos(x);
+}
+
+//  initial estimate from the float exponent bits, then Newton steps
+
+RTMATH_INLINE RTFLOAT RTMath::fastInvSqrt(RTFLOAT x)
+{
+    float f = (float)x;
+    uint32_t i;
+
+    memcpy(&i, &f, sizeof(i));
+    i = 0x5f375a86 - (i >> 1);
+    memcpy(&f, &i, sizeof(f));
+
+    RTFLOAT y = f;
+    RTFLOAT half = 0.5f * x;
+
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+#ifdef RTMATH_USE_DOUBLE
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+#endif
+    return y;
+}
+
+RTMATH_INLINE RTVector3 RTMath::toWorld(const RTVector3& vec, const RTQuaternion& q)
+{
+    // Vector rotation by quaternion
+    // P_out = q * P_in * conj(q)
+    // - P_out is the output vector
+    // - q is the orientation quaternion
+    // - P_in is the input vector
+    // - conj(q) is the conjugate of the orientation quaternion (q=[w,x,y,z], q*=[w,-x,-y,-z])
+	
+    RTQuaternion q_tmp;
+    RTQuaternion q_con;
+    
+    RTVector3 world_vec;
+	
+    q_tmp.setScalar(0.0f);
+    q_tmp.setX(vec.x());
+    q_tmp.setY(vec.y());
+    q_tmp.setZ(vec.z());
+    
+    // Backwards
+    q_tmp = q * q_tmp * q.conjugate();
+    
+    world_vec.setX(q_tmp.x());
+    world_vec.setY(q_tmp.y());
+    world_vec.setZ(q_tmp.z());
+
+    return world_vec;
+}
+
+
+//----------------------------------------------------------
+//
+//  The RTVector3 class
+
+RTMATH_INLINE RTVector3::RTVector3()
+{
+    zero();
+}
+
+RTMATH_INLINE RTVector3::RTVector3(RTFLOAT x, RTFLOAT y, RTFLOAT z)
+{
+    m_data[0] = x;
+    m_data[1] = y;
+    m_data[2] = z;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator =(const RTVector3& vec)
+{
+    if (this == &vec)
+        return *this;
+
+    m_data[0] = vec.m_data[0];
+    m_data[1] = vec.m_data[1];
+    m_data[2] = vec.m_data[2];
+
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator =(const RTFLOAT val)
+{
+    for (int i = 0; i < 3; i++)
+        m_data[i] = val;
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator +=(const RTFLOAT val)
+{
+    for (int i = 0; i < 3; i++)
+        m_data[i] += val;
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator +=(const RTVector3& vec)
+{
+    for (int i = 0; i < 3; i++)
+        m_data[i] += vec.m_data[i];
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator -=(const RTFLOAT val)
+{
+    for (int i = 0; i < 3; i++)
+        m_data[i] -= val;
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator -=(const RTVector3& vec)
+{
+    for (int i = 0; i < 3; i++)
+        m_data[i] -= vec.m_data[i];
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator *=(const RTFLOAT val)
+{
+    m_data[0] *= val;
+    m_data[1] *= val;
+    m_data[2] *= val;
+
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator *=(const RTVector3& vec)
+{
+    RTVector3 va;
+    RTVector3 vb;
+    //RTFLOAT dotAB;
+    RTVector3 crossAB;
+
+    va.setX(m_data[0]);
+    va.setY(m_data[1]);
+    va.setZ(m_data[2]);
+
+    //dotAB = RTVector3::dotProduct(va, vec);
+    RTVector3::crossProduct(va, vec, crossAB);
+
+    m_data[0] = vb.x() + va.x() + crossAB.x();
+    m_data[1] = vb.y() + va.y() + crossAB.y();
+    m_data[2] = vb.z() + va.z() + crossAB.z();
+
+    return *this;
+}
+
+RTMATH_INLINE RTVector3& RTVector3::operator /=(const RTFLOAT val)
+{
+    m_data[0] /= val;
+    m_data[1] /= val;
+    m_data[2] /= val;
+
+    return *this;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator *(const RTVector3& vec) const
+{
+    RTVector3 result = *this;
+    result *= vec;
+    return result;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator *(const RTFLOAT val) const
+{
+    RTVector3 result = *this;
+    result *= val;
+    return result;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator /(const RTFLOAT val) const
+{
+    RTVector3 result = *this;
+    result /= val;
+    return result;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator -(const RTVector3& vec) const
+{
+    RTVector3 result = *this;
+    result -= vec;
+    return result;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator -(const RTFLOAT val) const
+{
+    RTVector3 result = *this;
+    result -= val;
+    return result;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator +(const RTVector3& vec) const
+{
+    RTVector3 result = *this;
+    result += vec;
+    return result;
+}
+
+RTMATH_INLINE const RTVector3 RTVector3::operator +(const RTFLOAT val) const
+{
+    RTVector3 result = *this;
+    result += val;
+    return result;
+}
+
+RTMATH_INLINE void RTVector3::zero()
+{
+    for (int i = 0; i < 3; i++)
+        m_data[i] = 0;
+}
+
+RTMATH_INLINE RTFLOAT RTVector3::dotProduct(const RTVector3& a, const RTVector3& b)
+{
+    return a.x() * b.x() + a.y() * b.y() + a.z() * b.z();
+}
+
+RTMATH_INLINE void RTVector3::crossProduct(const RTVector3& a, const RTVector3& b, RTVector3& d)
+{
+    d.setX(a.y() * b.z() - a.z() * b.y());
+    d.setY(a.z() * b.x() - a.x() * b.z());
+    d.setZ(a.x() * b.y() - a.y() * b.x());
+}
+
+RTMATH_INLINE void RTVector3::normalize()
+{
+#ifdef RTMATH_FAST_INVSQRT
+    RTFLOAT square = m_data[0] * m_data[0] + m_data[1] * m_data[1] + m_data[2] * m_data[2];
+
+    if (square == 0)
+        return;
+
+    RTFLOAT scale = RTMath::fastInvSqrt(square);
+
+    m_data[0] *= scale;
+    m_data[1] *= scale;
+    m_data[2] *= scale;
+#else
+    RTFLOAT length = sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2]);
+
+    if (length == 0)
+        return;
+
+    m_data[0] /= length;
+    m_data[1] /= length;
+    m_data[2] /= length;
+#endif
+}
+
+RTMATH_INLINE RTFLOAT RTVector3::length()
+{
+    return sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2]);
+}
+
+RTMATH_INLINE RTFLOAT RTVector3::squareLength()
+{
+   return m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2];
+}
+
+
+//----------------------------------------------------------
+//
+//  The RTQuaternion class
+
+RTMATH_INLINE RTQuaternion::RTQuaternion()
+{
+    zero();
+}
+
+RTMATH_INLINE RTQuaternion::RTQuaternion(RTFLOAT scalar, RTFLOAT x, RTFLOAT y, RTFLOAT z)
+{
+    m_data[0] = scalar;
+    m_data[1] = x;
+    m_data[2] = y;
+    m_data[3] = z;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator =(const RTQuaternion& quat)
+{
+    if (this == &quat)
+        return *this;
+
+    m_data[0] = quat.m_data[0];
+    m_data[1] = quat.m_data[1];
+    m_data[2] = quat.m_data[2];
+    m_data[3] = quat.m_data[3];
+
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator =(const RTFLOAT val)
+{
+    for (int i = 0; i < 4; i++)
+        m_data[i] = val;
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator +=(const RTFLOAT val)
+{
+    for (int i = 0; i < 4; i++)
+        m_data[i] += val;
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator +=(const RTQuaternion& quat)
+{
+    for (int i = 0; i < 4; i++)
+        m_data[i] += quat.m_data[i];
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator -=(const RTFLOAT val)
+{
+    for (int i = 0; i < 4; i++)
+        m_data[i] -= val;
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator -=(const RTQuaternion& quat)
+{
+    for (int i = 0; i < 4; i++)
+        m_data[i] -= quat.m_data[i];
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator *=(const RTFLOAT val)
+{
+    m_data[0] *= val;
+    m_data[1] *= val;
+    m_data[2] *= val;
+    m_data[3] *= val;
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator *=(const RTQuaternion& qb)
+{
+    RTQuaternion qa;
+
+    qa = *this;
+
+    m_data[0] = qa.scalar() * qb.scalar() - qa.x() * qb.x() - qa.y() * qb.y() - qa.z() * qb.z();
+    m_data[1] = qa.scalar() * qb.x() + qa.x() * qb.scalar() + qa.y() * qb.z() - qa.z() * qb.y();
+    m_data[2] = qa.scalar() * qb.y() - qa.x() * qb.z() + qa.y() * qb.scalar() + qa.z() * qb.x();
+    m_data[3] = qa.scalar() * qb.z() + qa.x() * qb.y() - qa.y() * qb.x() + qa.z() * qb.scalar();
+    
+	/*
+	SAGE CODE
+	N.<c,d,qas,qax,qay,qaz,qbs,qbx,qby,qbz,s> = QQ[]
+	H.<i,j,k> = QuaternionAlgebra(c,d)
+	a = qas + qax * i + qay * j + qaz * k
+	b = qbs + qbx * i + qby * j + qbz * k
+	a*b
+	
+	-qaz*qbz  - qax*qbx - qay*qby + qas*qbs  
+	(-qaz*qby + qay*qbz + qax*qbs + qas*qbx)*i 
+	(qaz*qbx  - qax*qbz + qay*qbs + qas*qby)*j
+	(qaz*qbs  - qay*qbx + qax*qby + qas*qbz)*k
+    */
+	
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator /=(const RTFLOAT val)
+{
+    m_data[0] /= val;
+    m_data[1] /= val;
+    m_data[2] /= val;
+    m_data[3] /= val;
+
+    return *this;
+}
+
+RTMATH_INLINE RTQuaternion& RTQuaternion::operator /=(const RTQuaternion& qb)
+{
+    RTQuaternion qa;
+    
+    qa = *this;
+    
+    RTFLOAT qsql = qb.scalar()*qb.scalar() + qb.x() * qb.x() +
+            qb.y() * qb.y() + qb.z() * qb.z();
+    qa *= (qb.conjugate() / qsql);
+    
+    m_data[0] =   qa.scalar();
+    m_data[1] =   qa.x();
+    m_data[2] =   qa.y();
+    m_data[3] =   qa.z();
+  
+    return *this;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator *(const RTQuaternion& qb) const
+{
+    RTQuaternion result = *this;
+    result *= qb;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator *(const RTFLOAT val) const
+{
+    RTQuaternion result = *this;
+    result *= val;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator /(const RTQuaternion& qb) const
+{
+    RTQuaternion result = *this;
+    result /= qb;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator /(const RTFLOAT val) const
+{
+    RTQuaternion result = *this;
+    result /= val;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator -(const RTQuaternion& qb) const
+{
+    RTQuaternion result = *this;
+    result -= qb;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator -(const RTFLOAT val) const
+{
+    RTQuaternion result = *this;
+    result -= val;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator +(const RTQuaternion& qb) const
+{
+    RTQuaternion result = *this;
+    result += qb;
+    return result;
+}
+
+RTMATH_INLINE const RTQuaternion RTQuaternion::operator +(const RTFLOAT val) const
+{
+    RTQuaternion result = *this;
+    result += val;
+    return result;
+}
+
+RTMATH_INLINE void RTQuaternion::zero()
+{
+    for (int i = 0; i < 4; i++)
+        m_data[i] = 0;
+}
+
+RTMATH_INLINE void RTQuaternion::normalize()
+{
+#ifdef RTMATH_FAST_INVSQRT
+    RTFLOAT square = m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2] + m_data[3] * m_data[3];
+
+    if ((square == 0) || (square == 1))
+        return;
+
+    RTFLOAT scale = RTMath::fastInvSqrt(square);
+
+    m_data[0] *= scale;
+    m_data[1] *= scale;
+    m_data[2] *= scale;
+    m_data[3] *= scale;
+#else
+    RTFLOAT length = sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2] + m_data[3] * m_data[3]);
+
+    if ((length == 0) || (length == 1))
+        return;
+
+    m_data[0] /= length;
+    m_data[1] /= length;
+    m_data[2] /= length;
+    m_data[3] /= length;
+#endif
+}
+
+RTMATH_INLINE void RTQuaternion::toEuler(RTVector3& vec)
+{
+    // RT Code same as Wikipedia
+    // Ideally quaternion is normalized before calling this function
+
+    vec.setX(RTMATH_ATAN2(2.0 * (m_data[2] * m_data[3] + m_data[0] * m_data[1]),
+            1 - 2.0 * (m_data[1] * m_data[1] + m_data[2] * m_data[2])));
+
+    vec.setY(RTMATH_ASIN(2.0 * (m_data[0] * m_data[2] - m_data[1] * m_data[3])));
+
+    vec.setZ(RTMATH_ATAN2(2.0 * (m_data[1] * m_data[2] + m_data[0] * m_data[3]),
+            1 - 2.0 * (m_data[2] * m_data[2] + m_data[3] * m_data[3])));
+
+    // Matlab Code, uses more multiplications, no normalization needed
+    //vec.setX(atan2(2.0f * (m_data[2] * m_data[3] + m_data[0] * m_data[1]),
+    //        (m_data[0] * m_data[0] - m_data[1] * m_data[1] - m_data[2] * m_data[2] + m_data[3] * m_data[3] )));
+    //
+    //vec.setY(asin(2.0f * (m_data[0] * m_data[2] - m_data[1] * m_data[3])));
+    // 
+    //vec.setZ(atan2(2.0f * (m_data[1] * m_data[2] + m_data[0] * m_data[3]),
+    //        (m_data[0] * m_data[0] + m_data[1] * m_data[1] - m_data[2] * m_data[2] - m_data[3] * m_data[3])));
+	
+}
+
+RTMATH_INLINE void RTQuaternion::toGravity(RTVector3& vec) 
+{
+// Creates Gravity vector from pose quaternion
+  vec.setX( 2.0f * (m_data[1]*m_data[3] - m_data[0]*m_data[2]));
+  vec.setY( 2.0f * (m_data[0]*m_data[1] + m_data[2]*m_data[3]));
+  vec.setZ( m_data[0]*m_data[0] - m_data[1]*m_data[1] - m_data[2]*m_data[2] + m_data[3]*m_data[3]);
+}
+
+RTMATH_INLINE void RTQuaternion::fromEuler(RTVector3& vec)
+{
+    // RT Code same as Wikipedia and Matlab
+    RTFLOAT cosX2 = RTMATH_COS(vec.x() / 2.0f);
+    RTFLOAT sinX2 = RTMATH_SIN(vec.x() / 2.0f);
+    RTFLOAT cosY2 = RTMATH_COS(vec.y() / 2.0f);
+    RTFLOAT sinY2 = RTMATH_SIN(vec.y() / 2.0f);
+    RTFLOAT cosZ2 = RTMATH_COS(vec.z() / 2.0f);
+    RTFLOAT sinZ2 = RTMATH_SIN(vec.z() / 2.0f);
+
+    m_data[0] = cosX2 * cosY2 * cosZ2 + sinX2 * sinY2 * sinZ2;
+    m_data[1] = sinX2 * cosY2 * cosZ2 - cosX2 * sinY2 * sinZ2;
+    m_data[2] = cosX2 * sinY2 * cosZ2 + sinX2 * cosY2 * sinZ2;
+    m_data[3] = cosX2 * cosY2 * sinZ2 - sinX2 * sinY2 * cosZ2;
+    normalize();
+}
+
+RTMATH_INLINE RTQuaternion RTQuaternion::conjugate() const
+{
+    RTQuaternion q;
+    q.setScalar(m_data[0]);
+    q.setX(-m_data[1]);
+    q.setY(-m_data[2]);
+    q.setZ(-m_data[3]);
+    return q;
+}
+
+RTMATH_INLINE RTFLOAT RTQuaternion::length()
+{
+   return sqrt(m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2] + m_data[3] * m_data[3]);
+}
+
+RTMATH_INLINE RTFLOAT RTQuaternion::squareLength()
+{
+   return m_data[0] * m_data[0] + m_data[1] * m_data[1] +
+            m_data[2] * m_data[2] + m_data[3] * m_data[3];
+}
+
+#endif // _RTMATHINLINE_H_
@@ -0,0 +1,418 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTMATRIX_H
+#define	_RTMATRIX_H
+
+//  RTMatrix is a fixed size R x C matrix held by value - there is no heap use and all loop
+//  bounds are compile time constants so the compiler can unroll them. RTMatrix4x4 is
+//  RTMatrix<4, 4>. This header is included by RTMath.h and should not be included directly.
+//
+//  Square matrices also have:
+//
+//  inverted()          Gauss-Jordan with partial pivoting, identity if singular
+//  cholesky()          lower triangular L with L * L' = this, for symmetric positive definite
+//  choleskySolve()     X with this * X = B, for symmetric positive definite (covariances)
+//  solve()             X with this * X = B, Gaussian elimination with partial pivoting
+//  symmetricEigen()    eigenvalues and eigenvectors of a symmetric matrix (cyclic Jacobi)
+//
+//  and any F has symmetricProduct(P) = F * P * F', computing only one triangle.
+
+//  RTMatrixDot<K> is a K term dot product unrolled at compile time (so it is unrolled with -Os
+//  too). It sums left to right, in the same order as a plain loop.
+
+template <int K, typename T>
+struct RTMatrixDot
+{
+    static inline T sum(const T *row, const T *col, const int stride)
+    {
+        return RTMatrixDot<K - 1, T>::sum(row, col, stride) + row[K - 1] * col[(K - 1) * stride];
+    }
+};
+
+template <typename T>
+struct RTMatrixDot<1, T>
+{
+    static inline T sum(const T *row, const T *col, const int)
+    {
+        return row[0] * col[0];
+    }
+};
+
+#define RTMATRIX_JACOBI_SWEEPS          20                  // a 3x3 normally needs 4 or 5
+
+template <int R, int C, typename T>
+class RTMatrix
+{
+public:
+    RTMatrix() { fill(0); }
+
+    inline T val(int row, int col) const { return m_data[row][col]; }
+    inline void setVal(int row, int col, T val) { m_data[row][col] = val; }
+    inline T& operator ()(int row, int col) { return m_data[row][col]; }
+    inline const T& operator ()(int row, int col) const { return m_data[row][col]; }
+
+    void fill(T val)
+    {
+        for (int row = 0; row < R; row++)
+            for (int col = 0; col < C; col++)
+                m_data[row][col] = val;
+    }
+
+    void setToIdentity()
+    {
+        fill(0);
+        for (int i = 0; i < R && i < C; i++)
+            m_data[i][i] = 1;
+    }
+
+    RTMatrix& operator +=(const RTMatrix& mat)
+    {
+        for (int row = 0; row < R; row++)
+            for (int col = 0; col < C; col++)
+                m_data[row][col] += mat.m_data[row][col];
+        return *this;
+    }
+
+    RTMatrix& operator -=(const RTMatrix& mat)
+    {
+        for (int row = 0; row < R; row++)
+            for (int col = 0; col < C; col++)
+                m_data[row][col] -= mat.m_data[row][col];
+        return *this;
+    }
+
+    RTMatrix& operator *=(const T val)
+    {
+        for (int row = 0; row < R; row++)
+            for (int col = 0; col < C; col++)
+                m_data[row][col] *= val;
+        return *this;
+    }
+
+    const RTMatrix operator +(const RTMatrix& mat) const
+    {
+        RTMatrix result = *this;
+        result += mat;
+        return result;
+    }
+
+    const RTMatrix operator -(const RTMatrix& mat) const
+    {
+        RTMatrix result = *this;
+        result -= mat;
+        return result;
+    }
+
+    const RTMatrix operator *(const T val) const
+    {
+        RTMatrix result = *this;
+        result *= val;
+        return result;
+    }
+
+    template <int N>
+    const RTMatrix<R, N, T> operator *(const RTMatrix<C, N, T>& mat) const
+    {
+        RTMatrix<R, N, T> res(RTMatrix<R, N, T>::NOINIT);
+
+        for (int row = 0; row < R; row++) {
+            for (int col = 0; col < N; col++)
+                res.m_data[row][col] = RTMatrixDot<C, T>::sum(m_data[row], &mat.m_data[0][col], N);
+        }
+        return res;
+    }
+
+    //  a quaternion is treated as the column (scalar, x, y, z)
+
+    const RTQuaternion operator *(const RTQuaternion& q) const
+    {
+        static_assert((R == 4) && (C == 4), "quaternion product needs a 4x4 matrix");
+
+        RTQuaternion res;
+
+        res.setScalar(m_data[0][0] * q.scalar() + m_data[0][1] * q.x() + m_data[0][2] * q.y() + m_data[0][3] * q.z());
+        res.setX(m_data[1][0] * q.scalar() + m_data[1][1] * q.x() + m_data[1][2] * q.y() + m_data[1][3] * q.z());
+        res.setY(m_data[2][0] * q.scalar() + m_data[2][1] * q.x() + m_data[2][2] * q.y() + m_data[2][3] * q.z());
+        res.setZ(m_data[3][0] * q.scalar() + m_data[3][1] * q.x() + m_data[3][2] * q.y() + m_data[3][3] * q.z());
+        return res;
+    }
+
+    RTMatrix<C, R, T> transposed() const
+    {
+        RTMatrix<C, R, T> res(RTMatrix<C, R, T>::NOINIT);
+
+        for (int row = 0; row < R; row++)
+            for (int col = 0; col < C; col++)
+                res.m_data[col][row] = m_data[row][col];
+        return res;
+    }
+
+    //  this * P * this' for a symmetric P - the result is symmetric so only the upper
+    //  triangle is computed
+
+    RTMatrix<R, R, T> symmetricProduct(const RTMatrix<C, C, T>& P) const
+    {
+        RTMatrix<R, C, T> FP = *this * P;
+        RTMatrix<R, R, T> res(RTMatrix<R, R, T>::NOINIT);
+
+        for (int row = 0; row < R; row++) {
+            for (int col = row; col < R; col++) {
+                T sum = RTMatrixDot<C, T>::sum(FP.m_data[row], m_data[col], 1);
+
+                res.m_data[row][col] = sum;
+                res.m_data[col][row] = sum;
+            }
+        }
+        return res;
+    }
+
+    RTMatrix inverted() const
+    {
+        static_assert(R == C, "only square matrices can be inverted");
+
+        RTMatrix identity;
+        RTMatrix res(NOINIT);
+
+        identity.setToIdentity();
+        if (!solve(identity, res))
+            res.setToIdentity();
+        return res;
+    }
+
+    bool cholesky(RTMatrix& L) const
+    {
+        static_assert(R == C, "Cholesky needs a square matrix");
+
+        L.fill(0);
+        for (int col = 0; col < C; col++) {
+            T diag = m_data[col][col];
+
+            for (int k = 0; k < col; k++)
+                diag -= L.m_data[col][k] * L.m_data[col][k];
+            if (diag <= 0)
+                return false;
+            diag = sqrt(diag);
+            L.m_data[col][col] = diag;
+
+            for (int row = col + 1; row < R; row++) {
+                T sum = m_data[row][col];
+
+                for (int k = 0; k < col; k++)
+                    sum -= L.m_data[row][k] * L.m_data[col][k];
+                L.m_data[row][col] = sum / diag;
+            }
+        }
+        return true;
+    }
+
+    //  choleskySolve() uses the square root free form this = L * D * L' with unit diagonal L,
+    //  so there is no sqrt on the dependency chain and only one divide per row
+
+    template <int N>
+    bool choleskySolve(const RTMatrix<R, N, T>& B, RTMatrix<R, N, T>& X) const
+    {
+        static_assert(R == C, "Cholesky needs a square matrix");
+
+        RTMatrix L(NOINIT);
+        T d[R];
+        T recip[R];
+
+        for (int col = 0; col < C; col++) {
+            T diag = m_data[col][col];
+
+            for (int k = 0; k < col; k++)
+                diag -= L.m_data[col][k] * L.m_data[col][k] * d[k];
+            if (diag <= 0)
+                return false;
+            d[col] = diag;
+            recip[col] = 1 / diag;
+
+            for (int row = col + 1; row < R; row++) {
+                T sum = m_data[row][col];
+
+                for (int k = 0; k < col; k++)
+                    sum -= L.m_data[row][k] * L.m_data[col][k] * d[k];
+                L.m_data[row][col] = sum * recip[col];
+            }
+        }
+
+        for (int col = 0; col < N; col++) {
+            //  L * y = b, then D * L' * x = y
+
+            for (int row = 0; row < R; row++) {
+                T sum = B.m_data[row][col];
+
+                for (int k = 0; k < row; k++)
+                    sum -= L.m_data[row][k] * X.m_data[k][col];
+                X.m_data[row][col] = sum;
+            }
+            for (int row = R - 1; row >= 0; row--) {
+                T sum = X.m_data[row][col] * recip[row];
+
+                for (int k = row + 1; k < R; k++)
+                    sum -= L.m_data[k][row] * X.m_data[k][col];
+                X.m_data[row][col] = sum;
+            }
+        }
+        return true;
+    }
+
+    template <int N>
+    bool solve(const RTMatrix<R, N, T>& B, RTMatrix<R, N, T>& X) const
+    {
+        static_assert(R == C, "solve needs a square matrix");
+
+        RTMatrix A = *this;
+
+        X = B;
+        for (int col = 0; col < C; col++) {
+            int pivot = col;
+
+            for (int row = col + 1; row < R; row++) {
+                if (fabs(A.m_data[row][col]) > fabs(A.m_data[pivot][col]))
+                    pivot = row;
+            }
+            if (A.m_data[pivot][col] == 0)
+                return false;
+
+            if (pivot != col) {
+                for (int k = 0; k < C; k++) {
+                    T temp = A.m_data[col][k];
+                    A.m_data[col][k] = A.m_data[pivot][k];
+                    A.m_data[pivot][k] = temp;
+                }
+                for (int k = 0; k < N; k++) {
+                    T temp = X.m_data[col][k];
+                    X.m_data[col][k] = X.m_data[pivot][k];
+                    X.m_data[pivot][k] = temp;
+                }
+            }
+
+            T recip = 1 / A.m_data[col][col];
+
+            A.m_data[col][col] = recip;                     // kept for the back substitution
+            for (int row = col + 1; row < R; row++) {
+                T factor = A.m_data[row][col] * recip;
+
+                if (factor == 0)
+                    continue;
+                for (int k = col + 1; k < C; k++)
+                    A.m_data[row][k] -= factor * A.m_data[col][k];
+                for (int k = 0; k < N; k++)
+                    X.m_data[row][k] -= factor * X.m_data[col][k];
+            }
+        }
+
+        for (int row = R - 1; row >= 0; row--) {
+            for (int k = 0; k < N; k++) {
+                T sum = X.m_data[row][k];
+
+                for (int j = row + 1; j < C; j++)
+                    sum -= A.m_data[row][j] * X.m_data[j][k];
+                X.m_data[row][k] = sum * A.m_data[row][row];
+            }
+        }
+        return true;
+    }
+
+    //  symmetricEigen() leaves the eigenvalues in values and the matching unit eigenvectors
+    //  in the columns of vectors, in no particular order. It returns false if the
+    //  rotations had not converged after RTMATRIX_JACOBI_SWEEPS sweeps.
+
+    bool symmetricEigen(RTMatrix& vectors, RTMatrix<R, 1, T>& values) const
+    {
+        static_assert(R == C, "eigen decomposition needs a square matrix");
+
+        RTMatrix A = *this;
+        bool converged = false;
+
+        vectors.setToIdentity();
+        for (int sweep = 0; (sweep < RTMATRIX_JACOBI_SWEEPS) && !converged; sweep++) {
+            converged = true;
+            for (int p = 0; p < R - 1; p++) {
+                for (int q = p + 1; q < R; q++) {
+                    T apq = A.m_data[p][q];
+                    T small = 100 * fabs(apq);
+
+                    //  an element that no longer changes either diagonal term is zero
+
+                    if ((fabs(A.m_data[p][p]) + small == fabs(A.m_data[p][p])) &&
+                            (fabs(A.m_data[q][q]) + small == fabs(A.m_data[q][q]))) {
+                        A.m_data[p][q] = A.m_data[q][p] = 0;
+                        continue;
+                    }
+                    converged = false;
+
+                    //  the rotation that zeroes A[p][q], using the smaller angle
+
+                    T theta = (A.m_data[q][q] - A.m_data[p][p]) / (2 * apq);
+                    T t = 1 / (fabs(theta) + sqrt(theta * theta + 1));
+
+                    if (theta < 0)
+                        t = -t;
+
+                    T c = 1 / sqrt(t * t + 1);
+                    T s = t * c;
+
+                    for (int k = 0; k < R; k++) {
+                        T akp = A.m_data[k][p];
+                        T akq = A.m_data[k][q];
+
+                        A.m_data[k][p] = c * akp - s * akq;
+                        A.m_data[k][q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < R; k++) {
+                        T apk = A.m_data[p][k];
+                        T aqk = A.m_data[q][k];
+
+                        A.m_data[p][k] = c * apk - s * aqk;
+                        A.m_data[q][k] = s * apk + c * aqk;
+                    }
+                    for (int k = 0; k < R; k++) {
+                        T vkp = vectors.m_data[k][p];
+                        T vkq = vectors.m_data[k][q];
+
+                        vectors.m_data[k][p] = c * vkp - s * vkq;
+                        vectors.m_data[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < R; i++)
+            values.m_data[i][0] = A.m_data[i][i];
+        return converged;
+    }
+
+private:
+    enum NoInit { NOINIT };
+
+    RTMatrix(NoInit) {}                                     // for results that are fully written
+
+    T m_data[R][C];                                         // row, column
+
+    template <int R2, int C2, typename T2> friend class RTMatrix;
+};
+
+#endif // _RTMATRIX_H
@@ -3,10 +3,7 @@
 RTMotion::RTMotion(RTIMUSettings *settings)
 {
     m_settings = settings;
-    m_accnorm_avg = new RunningAverage(ACCEL_AVG_HISTORY);
-    m_accnorm_var = new RunningAverage(ACCEL_VAR_HISTORY);
-    m_heading_X_avg = new RunningAverage(HEADING_AVG_HISTORY);
-    m_heading_Y_avg = new RunningAverage(HEADING_AVG_HISTORY);
+    m_heading_avg.setSize(HEADING_AVG_HISTORY);
 }
 
 RTMotion::~RTMotion()
@@ -58,71 +55,22 @@ void RTMotion::motionResetPosition()
 RTFLOAT RTMotion::updateAverageHeading(RTFLOAT& heading) 
 {
     // this needs two component because of 0 - 360 jump at North 
-    m_heading_X_avg->addValue(cos(heading));
-    m_heading_Y_avg->addValue(sin(heading));
-    float t = atan2(m_heading_Y_avg->getAverage(),m_heading_X_avg->getAverage());
-    return t > 0 ? t : 2 * RTMATH_PI + t;
+    m_heading_avg.addHeading(heading);
+    return m_heading_avg.getHeading();
 }
 
-bool RTMotion::detectMotion(RTVector3& acc, RTVector3& gyr) {
-// Three Stage Motion Detection
-// Original Code is from FreeIMU Processing example
-// Some modifications and tuning
-//
-// 1. Change in Acceleration Variance
-// 2. Gyro activity
-// Any of the two triggers motion
-//
-  
-  bool accnorm_var_test, omega_test, omega_var_test;
-  
-  // ACCELEROMETER
-  ////////////////
-
-  // Test for sudden accelerometer changes
-  RTVector3 deltaAccel = m_previousAccel;
-  deltaAccel -= acc;   // compute difference
-  m_previousAccel = acc;
-  // printf("Delta Acc: %4.3f ",  deltaAccel.length());
-  if (deltaAccel.length() < RTIMU_FUZZY_ACCEL_ZERO) {
-	  accnorm_var_test = false; 
-  } else {
-	  accnorm_var_test = true; 
-  }
-
-  // GYRO
-  ////////////////
-  RTVector3 deltaGyro = m_previousGyro;
-  deltaGyro -= gyr;     // compute gyro variations
-  m_previousGyro = gyr;
-  // printf("Gyration: %4.3f ",  gyr.length());
- 
-  if (deltaGyro.length() < RTIMU_FUZZY_DELTA_GYRO_ZERO) { 
-
-    omega_var_test = false; 
-  } else { 
-    omega_var_test = true; 
-  }
-  
-  if (gyr.length() < RTIMU_FUZZY_GYRO_ZERO) { 
-    omega_test = false; 
-  } else { 
-    omega_test = true; 
-  }
-
-  //printf("Delta Accel: %f, Gyration: %f, Delta Gyration: %f\n", deltaAccel.length(), m_imuData.gyro.length(), deltaGyro.length());
-  //printf("Test: %d %d %d\n",  accnorm_var_test, omega_test, omega_var_test );
- 
-  // Combine acceleration test, acceleration deviation test and gyro test
-  ///////////////////////////////////////////////////////////////////////
-  if (omega_test || accnorm_var_test || omega_var_test) { 
-    return true; 
-  } else { 
-    return false;
-  }
- 
+RTFLOAT RTMotion::updateAverageHeading(RTQuaternion& pose, const RTVector3& mag)
+{
+    m_heading_avg.addCompass(pose, mag);
+    return m_heading_avg.getHeading();
 }
-	
+
+bool RTMotion::detectMotion(RTVector3& acc, RTVector3& gyr)
+{
+    // accel and gyro variance over a window, with hysteresis
+    return !m_stillDetector.update(acc, gyr);
+}
+
 void RTMotion::updateVelocityPosition(RTVector3& residuals, RTQuaternion& q, float accScale, uint64_t& timestamp, bool& motion)
 {
 // Input:
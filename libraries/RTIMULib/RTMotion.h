@@ -4,25 +4,19 @@
 #include "RTIMULib.h"
 #include "RTIMULibDefs.h"
 #include "RunningAverage.h"
+#include "RTHeadingAverage.h"
+#include "RTIMUStillDetector.h"
 
-#define ACCEL_AVG_HISTORY     5                      // size of moving average filter
-#define ACCEL_VAR_HISTORY     7                      // size of moving average filter
 #define HEADING_AVG_HISTORY   25                     // size of moving average filter 
 
 # define velocityDriftLearningAlpha 0.2f
 
-//  this defines the gyroscope noise level
+//  gyro bias learning limits, motion itself is detected by RTIMUStillDetector
 
-// #define RTIMU_FUZZY_GYRO_ZERO      0.20
-#define RTIMU_FUZZY_GYRO_ZERO         0.07
 #define RTIMU_FUZZY_GYRO_MAX          1.0
-#define RTIMU_FUZZY_DELTA_GYRO_ZERO   0.01
 // defines the threshold for fast/slow learning
 #define RTIMU_FUZZY_GYRO_BIAS         0.01
 
-//  this defines the accelerometer noise level
-#define RTIMU_FUZZY_ACCEL_ZERO     0.01
-
 class RTMotion
 {
 public:
@@ -45,12 +39,14 @@ public:
     // Updates heading averaging filter and returns average heading
     RTFLOAT updateAverageHeading(RTFLOAT& heading);
 
-    // Based on 3 measures decided if motion occurred:
-    // Absolute acceleration - gravity
-    // Acceleration deviation from moving average
-    // ABsotulte gyro values
+    // Same from the pose and compass vector, without trig on each sample
+    RTFLOAT updateAverageHeading(RTQuaternion& pose, const RTVector3& mag);
+
+    // Windowed likelihood ratio test on accel and gyro, see RTIMUStillDetector
     bool detectMotion(RTVector3& acc, RTVector3& gyr);
 
+    RTIMUStillDetector& getStillDetector() { return m_stillDetector; }
+
     // Computes world coordinate based residuals, velocity and position
     // Computes velocity drift when motion comes to halt, as velocity should be zero at that time
     void updateVelocityPosition(RTVector3& residuals, RTQuaternion& q, float accScale, uint64_t& timestamp, bool& motion);
@@ -76,13 +72,8 @@ protected:
     uint64_t  m_motionStart_time;
     float     m_dtmotion;
 	
-    RTVector3  m_previousAccel;
-    RTVector3  m_previousGyro;
-    
-    RunningAverage *m_accnorm_avg;   // Running average for acceleration (motion detection)
-    RunningAverage *m_accnorm_var;   // Running average for acceleration variance (motion detection)
-    RunningAverage *m_heading_X_avg; // Running average for heading (noise reduction)
-    RunningAverage *m_heading_Y_avg; // Running average for heading (noise reduction)
+    RTIMUStillDetector m_stillDetector; // motion detection
+    RTHeadingAverage m_heading_avg;  // Windowed heading vector sum (noise reduction)
   
 };
 #endif // _Motion_H
\ No newline at end of file
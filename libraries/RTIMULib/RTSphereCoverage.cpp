@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTSphereCoverage.h"
+
+RTSphereCoverage::RTSphereCoverage()
+{
+    int zoneBins[RTSPHERECOVERAGE_ZONES];
+    RTFLOAT step = RTMATH_PI / RTSPHERECOVERAGE_ZONES;
+    RTFLOAT z;
+
+    //  bins per zone from the area of equal latitude zones and square bins of side step
+
+    m_binCount = 0;
+    for (int zone = 0; zone < RTSPHERECOVERAGE_ZONES; zone++) {
+        RTFLOAT area = 2 * RTMATH_PI * (cos(zone * step) - cos((zone + 1) * step));
+
+        zoneBins[zone] = (int)(area / (step * step) + 0.5f);
+        if (zoneBins[zone] < 1)
+            zoneBins[zone] = 1;
+        m_binCount += zoneBins[zone];
+    }
+
+    //  then zone heights so that every bin covers 4 * pi / m_binCount
+
+    z = 1;
+    for (int zone = 0, first = 0; zone < RTSPHERECOVERAGE_ZONES; zone++) {
+        m_zoneTop[zone] = z;
+        m_zoneFirst[zone] = first;
+        m_zoneBins[zone] = zoneBins[zone];
+        m_zoneScale[zone] = zoneBins[zone] / (2 * RTMATH_PI);
+        z -= 2.0f * zoneBins[zone] / m_binCount;
+        first += zoneBins[zone];
+    }
+
+    m_binLimit = RTSPHERECOVERAGE_BIN_LIMIT;
+    reset();
+}
+
+void RTSphereCoverage::reset()
+{
+    for (int bin = 0; bin < RTSPHERECOVERAGE_MAX_BINS; bin++)
+        m_counts[bin] = 0;
+    m_filledBins = 0;
+    m_fullBins = 0;
+    m_samples = 0;
+}
+
+void RTSphereCoverage::setBinLimit(int limit)
+{
+    if (limit < 1)
+        limit = 1;
+    if (limit > 255)
+        limit = 255;
+    m_binLimit = limit;
+    reset();
+}
+
+int RTSphereCoverage::getBin(const RTVector3& vec) const
+{
+    RTFLOAT lengthSq = vec.x() * vec.x() + vec.y() * vec.y() + vec.z() * vec.z();
+    RTFLOAT z;
+    RTFLOAT longitude;
+    int zone;
+    int bin;
+
+    if (lengthSq <= 0)
+        return -1;
+    z = vec.z() / sqrt(lengthSq);
+
+    //  zone n runs from the top of zone n + 1 up to its own top
+
+    for (zone = 0; zone < RTSPHERECOVERAGE_ZONES - 1; zone++) {
+        if (z >= m_zoneTop[zone + 1])
+            break;
+    }
+
+    longitude = RTMATH_ATAN2(vec.y(), vec.x()) + (RTFLOAT)RTMATH_PI;
+    bin = (int)(longitude * m_zoneScale[zone]);
+    if (bin >= m_zoneBins[zone])
+        bin = m_zoneBins[zone] - 1;
+    if (bin < 0)
+        bin = 0;
+    return m_zoneFirst[zone] + bin;
+}
+
+bool RTSphereCoverage::addSample(const RTVector3& vec)
+{
+    int bin = getBin(vec);
+
+    if ((bin < 0) || (m_counts[bin] >= m_binLimit))
+        return false;
+
+    if (m_counts[bin] == 0)
+        m_filledBins++;
+    if (++m_counts[bin] == m_binLimit)
+        m_fullBins++;
+    m_samples++;
+    return true;
+}
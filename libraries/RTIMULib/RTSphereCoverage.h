@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTSPHERECOVERAGE_H
+#define	_RTSPHERECOVERAGE_H
+
+#include "RTMath.h"
+
+//  RTSphereCoverage divides the unit sphere of directions into bins of equal area and
+//  counts the calibration samples in each. Bins are laid out in zones between planes of
+//  constant z (equal steps in z cut the sphere into equal areas) and each zone is split
+//  into equal steps in longitude. The number of bins in a zone follows the zone area so
+//  that bins are close to square, about 180 / RTSPHERECOVERAGE_ZONES degrees across, and
+//  the zone boundaries are then moved slightly to make every bin the same area.
+//
+//  Finding the bin of a sample is a scan of the zone boundaries and one atan2, so
+//  collection costs the same whatever the number of samples. A per bin limit stops a
+//  slow sweep over part of the sphere from swamping the fit, and the fraction of bins
+//  with samples is the coverage.
+
+#define RTSPHERECOVERAGE_ZONES          10                  // zones from pole to pole - 128 bins
+
+//  upper bound of the bin count - the rounding of each zone can add half a bin
+
+#define RTSPHERECOVERAGE_MAX_BINS       ((4 * RTSPHERECOVERAGE_ZONES * RTSPHERECOVERAGE_ZONES) / 3 + RTSPHERECOVERAGE_ZONES)
+
+#define RTSPHERECOVERAGE_BIN_LIMIT      8                   // default samples per bin, at most 255
+
+class RTSphereCoverage
+{
+public:
+    RTSphereCoverage();
+
+    void reset();                                           // clears the counts, keeps the limit
+
+    //  setBinLimit() also resets the counts
+
+    void setBinLimit(int limit);
+
+    //  getBin() returns the bin of the direction of vec, or -1 for a zero vector.
+    //  vec doesn't need to be normalized.
+
+    int getBin(const RTVector3& vec) const;
+
+    bool isBinFull(int bin) const { return m_counts[bin] >= m_binLimit; }
+
+    //  addSample() counts vec in its bin. It returns false, without counting, if the bin
+    //  is already at the limit or vec is zero - the caller should then drop the sample.
+
+    bool addSample(const RTVector3& vec);
+
+    int getBinCount() const { return m_binCount; }
+    int getBinSamples(int bin) const { return m_counts[bin]; }
+    int getFilledBins() const { return m_filledBins; }      // bins with at least one sample
+    int getFullBins() const { return m_fullBins; }          // bins at the limit
+    int getSampleCount() const { return m_samples; }
+
+    RTFLOAT getCoverage() const { return (RTFLOAT)(100 * m_filledBins) / (RTFLOAT)m_binCount; }   // percent
+
+private:
+    RTFLOAT m_zoneTop[RTSPHERECOVERAGE_ZONES];              // z at the top of each zone
+    int m_zoneFirst[RTSPHERECOVERAGE_ZONES];                // first bin of each zone
+    int m_zoneBins[RTSPHERECOVERAGE_ZONES];                 // bins in each zone
+    RTFLOAT m_zoneScale[RTSPHERECOVERAGE_ZONES];            // bins per radian of longitude
+    int m_binCount;
+
+    uint8_t m_counts[RTSPHERECOVERAGE_MAX_BINS];
+    int m_binLimit;
+    int m_filledBins;
+    int m_fullBins;
+    int m_samples;
+};
+
+#endif // _RTSPHERECOVERAGE_H
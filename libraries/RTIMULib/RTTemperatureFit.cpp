@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTTemperatureFit.h"
+
+RTTemperatureFit::RTTemperatureFit()
+{
+    m_outlierRejection = true;
+    reset();
+}
+
+void RTTemperatureFit::reset()
+{
+    m_rejected = 0;
+
+    for (int k = 0; k < RTTEMPERATUREFIT_MOMENTS; k++)
+        m_allPower[k] = 0;
+
+    for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++) {
+        RTTEMPERATUREFIT_SUMS& sums = m_inliers[channel];
+
+        for (int k = 0; k < RTTEMPERATUREFIT_MOMENTS; k++)
+            sums.uPower[k] = 0;
+        for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++) {
+            sums.uY[k] = 0;
+            m_allUY[channel][k] = 0;
+        }
+        sums.uMin = 1e30;
+        sums.uMax = -1e30;
+        m_allYY[channel] = 0;
+    }
+}
+
+void RTTemperatureFit::addPowers(double *uPower, double u)
+{
+    double power = 1;
+
+    for (int k = 0; k < RTTEMPERATUREFIT_MOMENTS; k++) {
+        uPower[k] += power;
+        power *= u;
+    }
+}
+
+void RTTemperatureFit::normalMatrix(const double *uPower, RTMatrix<RTTEMPERATUREFIT_TERMS, RTTEMPERATUREFIT_TERMS, double>& AtA)
+{
+    for (int row = 0; row < RTTEMPERATUREFIT_TERMS; row++) {
+        for (int col = 0; col < RTTEMPERATUREFIT_TERMS; col++)
+            AtA(row, col) = uPower[row + col];
+    }
+}
+
+int RTTemperatureFit::addSample(const RTFLOAT *values, RTFLOAT temperature)
+{
+    double u = ((double)temperature - RTTEMPERATUREFIT_CENTER) * RTTEMPERATUREFIT_SCALE;
+    double powers[RTTEMPERATUREFIT_TERMS];
+    bool inlier[RTTEMPERATUREFIT_CHANNELS];
+    int rejected = 0;
+
+    powers[0] = 1;
+    for (int k = 1; k < RTTEMPERATUREFIT_TERMS; k++)
+        powers[k] = powers[k - 1] * u;
+
+    for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++)
+        inlier[channel] = true;
+
+    //  test against the fit of all samples so far. The residuals of a least squares fit with
+    //  a constant term have zero mean and their sum of squares is y'y - p'A'y.
+
+    if (m_outlierRejection && (m_allPower[0] >= RTTEMPERATUREFIT_MIN_SAMPLES)) {
+        RTMatrix<RTTEMPERATUREFIT_TERMS, RTTEMPERATUREFIT_TERMS, double> AtA;
+        RTMatrix<RTTEMPERATUREFIT_TERMS, RTTEMPERATUREFIT_CHANNELS, double> Aty;
+        RTMatrix<RTTEMPERATUREFIT_TERMS, RTTEMPERATUREFIT_CHANNELS, double> p;
+
+        normalMatrix(m_allPower, AtA);
+        for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++) {
+            for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++)
+                Aty(k, channel) = m_allUY[channel][k];
+        }
+
+        if (AtA.choleskySolve(Aty, p)) {
+            for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++) {
+                double residual = values[channel];
+                double sumSq = m_allYY[channel];
+
+                for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++) {
+                    residual -= p(k, channel) * powers[k];
+                    sumSq -= p(k, channel) * Aty(k, channel);
+                }
+                if (sumSq <= 0)
+                    continue;
+
+                double limit = RTTEMPERATUREFIT_OUTLIER_SIGMA * sqrt(sumSq / (m_allPower[0] - 1));
+
+                if ((residual >= limit) || (residual <= -limit)) {
+                    inlier[channel] = false;
+                    rejected++;
+                }
+            }
+        }
+    }
+
+    addPowers(m_allPower, u);
+    for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++) {
+        double y = values[channel];
+
+        for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++)
+            m_allUY[channel][k] += powers[k] * y;
+        m_allYY[channel] += y * y;
+
+        if (!inlier[channel])
+            continue;
+
+        RTTEMPERATUREFIT_SUMS& sums = m_inliers[channel];
+
+        addPowers(sums.uPower, u);
+        for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++)
+            sums.uY[k] += powers[k] * y;
+        if (u < sums.uMin)
+            sums.uMin = u;
+        if (u > sums.uMax)
+            sums.uMax = u;
+    }
+
+    m_rejected += rejected;
+    return rejected;
+}
+
+bool RTTemperatureFit::fit(double c[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_CHANNELS])
+{
+    static const int binomial[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_TERMS] =
+        {{1, 0, 0, 0}, {1, 1, 0, 0}, {1, 2, 1, 0}, {1, 3, 3, 1}};
+
+    double result[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_CHANNELS];
+
+    //  u = alpha * T + beta, so u^k contributes binomial(k, j) alpha^j beta^(k-j) to T^j
+
+    double alpha = RTTEMPERATUREFIT_SCALE;
+    double beta = -RTTEMPERATUREFIT_CENTER * RTTEMPERATUREFIT_SCALE;
+    double alphaPower[RTTEMPERATUREFIT_TERMS];
+    double betaPower[RTTEMPERATUREFIT_TERMS];
+
+    alphaPower[0] = betaPower[0] = 1;
+    for (int k = 1; k < RTTEMPERATUREFIT_TERMS; k++) {
+        alphaPower[k] = alphaPower[k - 1] * alpha;
+        betaPower[k] = betaPower[k - 1] * beta;
+    }
+
+    for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++) {
+        const RTTEMPERATUREFIT_SUMS& sums = m_inliers[channel];
+        RTMatrix<RTTEMPERATUREFIT_TERMS, RTTEMPERATUREFIT_TERMS, double> AtA;
+        RTMatrix<RTTEMPERATUREFIT_TERMS, 1, double> Aty;
+        RTMatrix<RTTEMPERATUREFIT_TERMS, 1, double> a;
+
+        if ((sums.uPower[0] < RTTEMPERATUREFIT_TERMS) || (sums.uMax <= sums.uMin))
+            return false;
+
+        normalMatrix(sums.uPower, AtA);
+        for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++)
+            Aty(k, 0) = sums.uY[k];
+        if (!AtA.choleskySolve(Aty, a))
+            return false;
+
+        //  zero at 32.5C (u = 0) if that is inside the data, else at the mean temperature
+
+        double uCenter = 0;
+        double offset = 0;
+
+        if ((sums.uMin > 0) || (sums.uMax < 0))
+            uCenter = sums.uPower[1] / sums.uPower[0];
+        for (int k = RTTEMPERATUREFIT_TERMS - 1; k >= 0; k--)
+            offset = offset * uCenter + a(k, 0);
+        a(0, 0) -= offset;
+
+        for (int j = 0; j < RTTEMPERATUREFIT_TERMS; j++) {
+            result[j][channel] = 0;
+            for (int k = j; k < RTTEMPERATUREFIT_TERMS; k++)
+                result[j][channel] += a(k, 0) * binomial[k][j] * alphaPower[j] * betaPower[k - j];
+        }
+    }
+
+    for (int k = 0; k < RTTEMPERATUREFIT_TERMS; k++) {
+        for (int channel = 0; channel < RTTEMPERATUREFIT_CHANNELS; channel++)
+            c[k][channel] = result[k][channel];
+    }
+    return true;
+}
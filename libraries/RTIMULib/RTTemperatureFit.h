@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTTEMPERATUREFIT_H
+#define	_RTTEMPERATUREFIT_H
+
+#include "RTMath.h"
+
+//  RTTemperatureFit is the cubic fit of RTFitTemperature.m done on the device. Every
+//  channel (accel x, y, z, gyro x, y, z, compass x, y, z - the order of the raw file and
+//  of RTIMUSettings::m_temperaturebias) gets its own
+//
+//  y = c0 + c1 * T + c2 * T^2 + c3 * T^3
+//
+//  Only the moment sums of the normal equations (sum of u^k for k up to 6, sum of u^k * y
+//  for k up to 3 and sum of y^2) are kept, so memory use does not depend on the number of
+//  samples. u = (T - RTTEMPERATUREFIT_CENTER) * RTTEMPERATUREFIT_SCALE keeps the powers
+//  near one and the normal equations well conditioned. The sums are in double.
+//
+//  Outlier rejection follows the script's 2 sigma test. As the samples are not stored the
+//  test is made as each sample arrives, against the fit and residual standard deviation of
+//  all samples so far. Samples that pass go into a second set of sums per channel and
+//  fit() solves those. With rejection turned off fit() is the plain polyfit of all samples.
+//
+//  fit() then removes the offset at 32.5C (or at the mean temperature if 32.5C is outside
+//  the data) as the script does - only the change with temperature is corrected.
+
+#define RTTEMPERATUREFIT_CHANNELS       9                   // accel, gyro and compass axes
+#define RTTEMPERATUREFIT_TERMS          4                   // cubic
+#define RTTEMPERATUREFIT_MOMENTS        (2 * RTTEMPERATUREFIT_TERMS - 1)
+
+#define RTTEMPERATUREFIT_CENTER         32.5                // C, also the zero point of the correction
+#define RTTEMPERATUREFIT_SCALE          0.05                // 1 / C
+#define RTTEMPERATUREFIT_OUTLIER_SIGMA  2.0                 // rejection limit in residual standard deviations
+#define RTTEMPERATUREFIT_MIN_SAMPLES    20                  // samples before outliers are rejected
+
+typedef struct
+{
+    double uPower[RTTEMPERATUREFIT_MOMENTS];                // sum of u^k, uPower[0] is the sample count
+    double uY[RTTEMPERATUREFIT_TERMS];                      // sum of u^k * y
+    double uMin;
+    double uMax;
+} RTTEMPERATUREFIT_SUMS;
+
+class RTTemperatureFit
+{
+public:
+    RTTemperatureFit();
+
+    void reset();
+
+    //  setOutlierRejection() should be called before the first sample - it is on by default
+
+    void setOutlierRejection(bool enable) { m_outlierRejection = enable; }
+
+    //  addSample() takes the nine channel values in the order above and the temperature in C.
+    //  It returns the number of channels that rejected the sample as an outlier.
+
+    int addSample(const RTFLOAT *values, RTFLOAT temperature);
+
+    int getSampleCount() { return (int)m_allPower[0]; }
+    int getRejectedCount() { return m_rejected; }           // summed over the channels
+
+    //  fit() returns c[k][channel], the coefficient of T^k, in the layout of the
+    //  temperatureCorr.dta file. It returns false if any channel has too few distinct
+    //  temperatures and c is left untouched in that case.
+
+    bool fit(double c[RTTEMPERATUREFIT_TERMS][RTTEMPERATUREFIT_CHANNELS]);
+
+private:
+    static void addPowers(double *uPower, double u);
+    static void normalMatrix(const double *uPower, RTMatrix<RTTEMPERATUREFIT_TERMS, RTTEMPERATUREFIT_TERMS, double>& AtA);
+
+    bool m_outlierRejection;
+    int m_rejected;
+
+    //  every sample - the powers of u are the same for all channels
+
+    double m_allPower[RTTEMPERATUREFIT_MOMENTS];
+    double m_allUY[RTTEMPERATUREFIT_CHANNELS][RTTEMPERATUREFIT_TERMS];
+    double m_allYY[RTTEMPERATUREFIT_CHANNELS];
+
+    RTTEMPERATUREFIT_SUMS m_inliers[RTTEMPERATUREFIT_CHANNELS];
+};
+
+#endif // _RTTEMPERATUREFIT_H
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "RTVerticalFilter.h"
+
+RTVerticalFilter::RTVerticalFilter()
+{
+    m_accelNoise = RTVERTICAL_ACCEL_NOISE;
+    m_biasNoise = RTVERTICAL_BIAS_NOISE;
+    m_heightNoise = RTVERTICAL_HEIGHT_NOISE;
+    reset();
+}
+
+void RTVerticalFilter::reset()
+{
+    m_valid = false;
+    m_lastTimestamp = 0;
+    m_height = 0;
+    m_velocity = 0;
+    m_bias = 0;
+    m_P.fill(0);
+}
+
+RTFLOAT RTVerticalFilter::verticalAccel(const RTVector3& accel, const RTQuaternion& pose)
+{
+    //  the world z axis seen from the sensor - the same rotated gravity that
+    //  RTFusion::getAccelResiduals() uses
+
+    RTFLOAT x = 2.0f * (pose.x() * pose.z() - pose.scalar() * pose.y());
+    RTFLOAT y = 2.0f * (pose.y() * pose.z() + pose.scalar() * pose.x());
+    RTFLOAT z = pose.scalar() * pose.scalar() - pose.x() * pose.x() - pose.y() * pose.y() + pose.z() * pose.z();
+
+    return (accel.x() * x + accel.y() * y + accel.z() * z - 1.0f) * RTVERTICAL_GRAVITY;
+}
+
+void RTVerticalFilter::newAccel(RTFLOAT accel, uint64_t timestamp)
+{
+    RTFLOAT dt = (RTFLOAT)(timestamp - m_lastTimestamp) / 1000000.0f;
+    bool timed = (m_lastTimestamp != 0) && (timestamp > m_lastTimestamp) && (dt < RTVERTICAL_MAX_DT);
+
+    m_lastTimestamp = timestamp;
+    if (!m_valid || !timed)
+        return;
+
+    //  state prediction with the bias corrected acceleration
+
+    RTFLOAT halfDt2 = 0.5f * dt * dt;
+    RTFLOAT a = accel - m_bias;
+
+    m_height += m_velocity * dt + a * halfDt2;
+    m_velocity += a * dt;
+
+    //  P = F * P * F' + Q with F = [1 dt -dt*dt/2; 0 1 -dt; 0 0 1]
+
+    RTMatrix<3, 3> F;
+
+    F.setToIdentity();
+    F(0, 1) = dt;
+    F(0, 2) = -halfDt2;
+    F(1, 2) = -dt;
+    m_P = F.symmetricProduct(m_P);
+
+    //  acceleration noise enters through [dt*dt/2 dt 0], the bias is a random walk
+
+    RTFLOAT q = m_accelNoise * m_accelNoise;
+
+    m_P(0, 0) += halfDt2 * halfDt2 * q;
+    m_P(0, 1) += halfDt2 * dt * q;
+    m_P(1, 0) += halfDt2 * dt * q;
+    m_P(1, 1) += dt * dt * q;
+    m_P(2, 2) += m_biasNoise * m_biasNoise * dt;
+}
+
+void RTVerticalFilter::newHeight(RTFLOAT height)
+{
+    if (!m_valid) {
+        m_height = height;
+        m_velocity = 0;
+        m_bias = 0;
+        m_P.fill(0);
+        m_P(0, 0) = m_heightNoise * m_heightNoise;
+        m_P(1, 1) = RTVERTICAL_INITIAL_VELOCITY_VAR;
+        m_P(2, 2) = RTVERTICAL_INITIAL_BIAS_VAR;
+        m_valid = true;
+        return;
+    }
+
+    //  scalar measurement of the height state
+
+    RTFLOAT innovation = height - m_height;
+    RTFLOAT S = m_P(0, 0) + m_heightNoise * m_heightNoise;
+    RTFLOAT K[3];
+
+    for (int row = 0; row < 3; row++)
+        K[row] = m_P(row, 0) / S;
+
+    m_height += K[0] * innovation;
+    m_velocity += K[1] * innovation;
+    m_bias += K[2] * innovation;
+
+    RTFLOAT P0[3] = {m_P(0, 0), m_P(0, 1), m_P(0, 2)};
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++)
+            m_P(row, col) -= K[row] * P0[col];
+    }
+}
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////
+//
+//  This file is part of RTIMULib-Teensy
+//
+//  Copyright (c) 2014-2015, richards-tech
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//  this software and associated documentation files (the "Software"), to deal in
+//  the Software without restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+//  Software, and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef _RTVERTICALFILTER_H
+#define	_RTVERTICALFILTER_H
+
+#include "RTMath.h"
+
+//  RTVerticalFilter fuses vertical acceleration at the IMU rate with barometric height
+//  at the pressure sensor rate in a three state Kalman filter (height, vertical speed,
+//  accelerometer bias). The accelerometer carries the short term motion, the barometer
+//  pins down the long term height and, through the bias state, stops the integrated
+//  speed from drifting. Feed it raw, unaveraged heights - the filter does the smoothing
+//  without the lag of the pressure running average.
+//
+//  Heights and speeds are in m and m/s, positive up.
+
+#define RTVERTICAL_GRAVITY              9.80665f            // m/s/s per g
+#define RTVERTICAL_MAX_DT               0.5f                // longer gaps restart the time base
+
+#define RTVERTICAL_ACCEL_NOISE          0.3f                // default accel noise, m/s/s
+#define RTVERTICAL_BIAS_NOISE           0.005f              // default bias random walk, m/s/s per root second
+#define RTVERTICAL_HEIGHT_NOISE         0.5f                // default baro height noise, m
+
+#define RTVERTICAL_INITIAL_BIAS_VAR     0.25f               // bias variance at start, (m/s/s)**2
+#define RTVERTICAL_INITIAL_VELOCITY_VAR 1.0f                // speed variance at start, (m/s)**2
+
+class RTVerticalFilter
+{
+public:
+    RTVerticalFilter();
+
+    //  reset() forgets the state - the next height measurement restarts the filter
+
+    void reset();
+
+    //  noise levels are standard deviations, see the defaults above
+
+    void setAccelNoise(RTFLOAT noise) { m_accelNoise = noise; }
+    void setBiasNoise(RTFLOAT noise) { m_biasNoise = noise; }
+    void setHeightNoise(RTFLOAT noise) { m_heightNoise = noise; }
+
+    //  verticalAccel() turns the accelerometer reading (in g) and the fusion pose into
+    //  the world vertical acceleration with gravity removed, in m/s/s
+
+    static RTFLOAT verticalAccel(const RTVector3& accel, const RTQuaternion& pose);
+
+    //  newAccel() should be called for every IMU sample, newHeight() for every pressure
+    //  sample (for example with RTAltitude::height()). timestamp is in uS.
+
+    void newAccel(RTFLOAT accel, uint64_t timestamp);
+    void newHeight(RTFLOAT height);
+
+    bool isValid() { return m_valid; }
+    RTFLOAT getHeight() { return m_height; }
+    RTFLOAT getVelocity() { return m_velocity; }
+    RTFLOAT getAccelBias() { return m_bias; }
+    RTFLOAT getHeightVariance() { return m_P(0, 0); }
+
+private:
+    bool m_valid;                                           // set once the first height has arrived
+    uint64_t m_lastTimestamp;                               // 0 if there is no time base
+
+    RTFLOAT m_height;
+    RTFLOAT m_velocity;
+    RTFLOAT m_bias;                                         // accelerometer bias, m/s/s
+    RTMatrix<3, 3> m_P;                                     // state covariance
+
+    RTFLOAT m_accelNoise;
+    RTFLOAT m_biasNoise;
+    RTFLOAT m_heightNoise;
+};
+
+#endif // _RTVERTICALFILTER_H
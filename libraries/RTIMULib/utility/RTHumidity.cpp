@@ -58,6 +58,7 @@ RTHumidity::RTHumidity(RTIMUSettings *settings)
 {
     m_settings = settings;
     m_humidity_avg = new RunningAverage(HUMIDITY_AVG_HISTORY);
+    m_readyTime = 0;
 }
 
 RTHumidity::~RTHumidity()
@@ -50,6 +50,11 @@ public:
     virtual bool humidityRead() = 0;                        // get latest value
     virtual int  humidityGetPollInterval() = 0;             // get recommended polling interval
 
+    //  Time in uS at which the next humidityRead() call can make progress. A time in the past
+    //  means the sensor is idle or has a conversion ready.
+
+    uint64_t humidityReadyTime() { return m_readyTime; }
+
     const HUMIDITY_DATA& getHumidityData() { return m_humidityData; }
     const RTFLOAT&       getHumidityTemp() { return m_humidityData.temperature; } // gets temperature data in C
 
@@ -57,6 +62,7 @@ protected:
     RTIMUSettings  *m_settings;                             // the settings object pointer
     RunningAverage *m_humidity_avg;                         // Running average for humidity sensor
     HUMIDITY_DATA   m_humidityData;                         // the data from the IMU
+    uint64_t        m_readyTime;                            // when the running conversion completes
 
 };
 
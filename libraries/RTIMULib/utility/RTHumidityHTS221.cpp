@@ -112,7 +112,7 @@ bool RTHumidityHTS221::humidityInit()
     m_humidityData.temperature = -9999.9999;
 	
     m_state = HTS221_STATE_IN_RESET;
-    m_timer = RTMath::currentUSecsSinceEpoch();
+    m_readyTime = RTMath::currentUSecsSinceEpoch() + 1000000;                  // 1 second for reset
 
     return true;
 }
@@ -128,14 +128,14 @@ bool RTHumidityHTS221::humidityRead()
 
     case HTS221_STATE_IN_RESET:
         // printf("State: reset\n");
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) <= 1000000) // 1 second for reset
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
             return false;                                            // not time yet
         m_state = HTS221_STATE_DATA_REQ;
         break;
 
     case HTS221_STATE_DATA_REQ:
 
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) <= 80000) // 12.5Hz = 80ms
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
             return false;                                          // not time yet
 
         if (!m_settings->HALRead(m_humidityAddr, HTS221_STATUS, 1, &status, "Failed to read HTS221 status"))
@@ -163,7 +163,7 @@ bool RTHumidityHTS221::humidityRead()
             m_humidityData.temperatureValid = true;
         }
 
-        m_timer = RTMath::currentUSecsSinceEpoch();
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + 80000;   // 12.5Hz = 80ms
         break;
     }
 	
@@ -45,7 +45,6 @@ private:
     unsigned char m_humidityAddr;                           // I2C address
 
     int m_state;
-    uint64_t m_timer;
 
     RTFLOAT m_temperature_m;                                // temperature calibration slope
     RTFLOAT m_temperature_c;                                // temperature calibration y intercept
@@ -53,7 +53,7 @@ bool RTHumidityHTU21D::humidityInit()
         return false;
 
     m_state = HTU21D_STATE_IN_RESET;
-    m_timer = RTMath::currentUSecsSinceEpoch();
+    m_readyTime = RTMath::currentUSecsSinceEpoch() + 1000000;
 
     m_humidityData.humidityValid = false;
     m_humidityData.humidity = -9999.9999;
@@ -72,7 +72,7 @@ bool RTHumidityHTU21D::humidityRead()
         
     case HTU21D_STATE_IN_RESET:
         // printf("State: reset\n");
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) <= 1000000) // 1 second for reset
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime) // 1 second for reset
             return false;                                          // not time yet
         m_state = HTU21D_STATE_IDLE;
         break;
@@ -83,13 +83,13 @@ bool RTHumidityHTU21D::humidityRead()
         if (!m_settings->HALWrite(m_humidityAddr, HTU21D_CMD_TRIG_TEMP, 0, NULL, "Failed to start HTU21D temp conv"))
             return false;
         m_state = HTU21D_STATE_TEMP_REQ;
-        m_timer = RTMath::currentUSecsSinceEpoch();
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + 45000;
         break;
 
     case HTU21D_STATE_TEMP_REQ:
         // read temperature data
         // printf("State: temp\n");
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) <= 45000) // 44ms needed for 14 bits
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime) // 44ms needed for 14 bits
             return false;                                          // not time yet
         if (!m_settings->HALRead(m_humidityAddr, 3, rawData, "Failed to read HTU21D temperature"))
             return false;
@@ -103,13 +103,13 @@ bool RTHumidityHTU21D::humidityRead()
             return false;
         
         m_state = HTU21D_STATE_HUM_REQ;
-        m_timer = RTMath::currentUSecsSinceEpoch();
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + 15000;
         break;
 
     case HTU21D_STATE_HUM_REQ:
         // read humidity data
         // printf("State: humidity");
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) <= 15000) // 16ms needed for 12 bits
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime) // 16ms needed for 12 bits
             return false;                                          // not time yet
         if (!m_settings->HALRead(m_humidityAddr, 3, rawData, "Failed to read HTU21D humidity"))
             return false;
@@ -45,7 +45,6 @@ private:
     unsigned char m_humidityAddr;                           // I2C address
 
     int m_state;
-    uint64_t m_timer;
 
 };
 
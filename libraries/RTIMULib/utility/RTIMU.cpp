@@ -49,11 +49,6 @@
 #include "RTIMUBMX055.h"
 #include "RTIMUBNO055.h"
 #include "RTMotion.h"
-#include "RunningAverage.h"
-
-//  this sets the learning rate for compass and accelerometer running average calculation
-// 0.2 original
-#define COMPASS_ALPHA 0.1f
 
 // this sets the learning rate for the acceleration legnth to become 1 g during no motion
 #define ACCEL_ALPHA 0.01f
@@ -94,6 +89,8 @@ float RTIMU::m_axisRotation[RTIMU_AXIS_ROTATION_COUNT][9] = {
     {0, 0, -1, -1, 0, 0, 0, 1, 0}                   // RTIMU_XWEST_YDOWN
 };
 
+RTIMU *RTIMU::m_dataReadyIMU = NULL;
+
 RTIMU *RTIMU::createIMU(RTIMUSettings *settings)
 {
     switch (settings->m_imuType) {
@@ -158,6 +155,7 @@ RTIMU::RTIMU(RTIMUSettings *settings)
     m_gyroRunTimeCalibrationEnable = true;
     m_accelRunTimeCalibrationEnable = false;
     m_compassRunTimeCalibrationEnable = false;
+    m_compassTrackingEnable = false;
 
     switch (m_settings->m_fusionType) {
     case RTFUSION_TYPE_KALMANSTATE4:
@@ -177,21 +175,24 @@ RTIMU::RTIMU(RTIMUSettings *settings)
         break;
     }
     HAL_INFO1("Using fusion algorithm %s\n", RTFusion::fusionName(m_settings->m_fusionType));
-    m_compassAverageX = new RunningAverage(20); // 0.1f * m_sampleRate;
-    m_compassAverageY = new RunningAverage(20);
-    m_compassAverageZ = new RunningAverage(20);
+    m_compassSmoother.setType(m_settings->m_compassSmoothing);
+    m_compassSmoother.setBoxcarLength(m_settings->m_compassSmoothingLength);
+    m_compassSmoother.setTimeConstant(m_settings->m_compassSmoothingTimeConstant);
+    m_compassSmoother.setOneEuro(m_settings->m_compassSmoothingMinCutoff, m_settings->m_compassSmoothingBeta);
+    HAL_INFO1("Using compass smoothing %s\n", RTCompassSmoother::smootherName(m_compassSmoother.getType()));
+    m_compassAverageValid = false;
+    m_imuData.compassNew = true;
+
+    m_sampleRing = NULL;
+    m_dataReadyPin = -1;
+    m_readRawOnly = false;
 }
 
 RTIMU::~RTIMU()
 {
+    IMUDisableDataReady();
     delete m_fusion;
-    delete m_compassAverageX;
-    delete m_compassAverageY;
-    delete m_compassAverageZ;
     m_fusion = NULL;
-    m_compassAverageX = NULL;
-    m_compassAverageY = NULL;
-    m_compassAverageZ = NULL;
 }
 
 	
@@ -237,6 +238,7 @@ void RTIMU::setCalibrationData()
     } else {
         HAL_INFO("Ellipsoid compass calibration not in use\n");
     }
+    m_compassTracker.reset();                               // the calibrated field it sees may have changed
 
     if (m_settings->m_accelCalValid) {
         HAL_INFO("Using accel calibration\n");
@@ -249,6 +251,12 @@ void RTIMU::setCalibrationData()
     } else {
         HAL_INFO("Ellipsoid accelerometer calibration not in use\n");
     }
+
+    if (m_settings->m_gyroCalCorrValid) {
+        HAL_INFO("Using gyro scale and misalignment calibration\n");
+    } else {
+        HAL_INFO("Gyro scale and misalignment calibration not in use\n");
+    }
 }
 
 void RTIMU::updateTempBias(float senTemp)
@@ -302,6 +310,12 @@ void RTIMU::gyroBiasInit()
     m_EEPROMCount = 0;
     m_intervalCount = 0;
     m_previousMotion = false;
+
+    //  the motion detector looks at the last 50mS of samples. setWindow() keeps this to
+    //  between 2 and RTIMU_STILL_WINDOW_MAX samples, so above 640Hz the window is shorter -
+    //  32mS at 1kHz - and below 40Hz it is two samples
+
+    m_stillDetector.setWindow(m_sampleRate / 20);
 }
 
 //  Note - code assumes that this is the first thing called after axis swapping
@@ -364,20 +378,9 @@ void RTIMU::handleGyroBias()
 
     // Motion Detection
     // ----------------
-    RTVector3 deltaAccel = m_previousAccel;
-    deltaAccel -= m_imuData.accel;   // compute accel variations
-    m_previousAccel = m_imuData.accel;
-    RTVector3 deltaGyro = m_previousGyro;
-    deltaGyro -= m_imuData.gyro;     // compute gyro variations
-    m_previousGyro = m_imuData.gyro;
-    //printf("Delta Accel: %f, Gyration: %f, Delta Gyration: %f\n", deltaAccel.length(), m_imuData.gyro.length(), deltaGyro.length());
     m_previousMotion = m_imuData.motion;  // to keep track of motion transitions
-    // is the IMU moving?
-    if ((deltaAccel.length() < RTIMU_FUZZY_ACCEL_ZERO) && (deltaGyro.length() < RTIMU_FUZZY_DELTA_GYRO_ZERO) && (m_imuData.gyro.length() < RTIMU_FUZZY_GYRO_ZERO)) {
-        m_imuData.motion = false; 
-    } else {
-        m_imuData.motion = true;
-    }
+    // is the IMU moving? the gyro limit applies to the rate left after the current bias
+    m_imuData.motion = !m_stillDetector.update(m_imuData.accel, m_imuData.gyro - m_settings->m_gyroBias);
     // if (m_imuData.motion) { Serial.println("Sensor is moving."); } else { Serial.println("Sensor is still."); } 
 
     // GyroBias
@@ -451,10 +454,34 @@ void RTIMU::handleGyroBias()
     if (getGyroCalibrationValid()) {
         m_imuData.gyro -= m_settings->m_gyroBias;
     }
+
+    if (getGyroCalibrationCorrValid()) {
+        RTVector3 gv = m_imuData.gyro;
+
+        m_imuData.gyro.setX(gv.x() * m_settings->m_gyroCalCorr[0][0] +
+            gv.y() * m_settings->m_gyroCalCorr[0][1] +
+            gv.z() * m_settings->m_gyroCalCorr[0][2]);
+
+        m_imuData.gyro.setY(gv.x() * m_settings->m_gyroCalCorr[1][0] +
+            gv.y() * m_settings->m_gyroCalCorr[1][1] +
+            gv.z() * m_settings->m_gyroCalCorr[1][2]);
+
+        m_imuData.gyro.setZ(gv.x() * m_settings->m_gyroCalCorr[2][0] +
+            gv.y() * m_settings->m_gyroCalCorr[2][1] +
+            gv.z() * m_settings->m_gyroCalCorr[2][2]);
+    }
 }
 
 void RTIMU::calibrateAverageCompass()
 {
+    //  a stale sample repeats the last magnetometer reading so it must not reach
+    //  the min/max tracking or the running average. Hand on the previous output.
+
+    if (!m_imuData.compassNew && m_compassAverageValid) {
+        m_imuData.compass = m_compassAverage;
+        return;
+    }
+
     //  see if need to do runtime mag calibration (i.e. no stored calibration data)
 
     if ((!m_compassCalibrationMode && !m_settings->m_compassCalValid) || (m_compassRunTimeCalibrationEnable)) {
@@ -533,6 +560,10 @@ void RTIMU::calibrateAverageCompass()
                 }
                 m_settings->m_compassCalMax = m_runtimeMagCalMax;
                 m_settings->m_compassCalMin = m_runtimeMagCalMin;
+
+                //  the tracker sees the calibrated field, which has just moved
+
+                m_compassTracker.reset();
             }
         }
     }
@@ -561,25 +592,19 @@ void RTIMU::calibrateAverageCompass()
         }
     }
 
-    //  update running average
+    //  hard iron tracking on top of the calibration
 
-    m_compassAverageX->addValue(m_imuData.compass.x());
-    m_compassAverageY->addValue(m_imuData.compass.y());
-    m_compassAverageZ->addValue(m_imuData.compass.z());
-    
-    //Serial.println(m_compassAverageX->getAverage() - m_imuData.compass.x());
-    //Serial.println(m_compassAverageY->getAverage() - m_imuData.compass.y());
-    //Serial.println(m_compassAverageZ->getAverage() - m_imuData.compass.z());
+    if (m_compassTrackingEnable && !m_compassCalibrationMode) {
+        m_compassTracker.newSample(m_imuData.compass, m_imuData.timestamp);
+        if (m_compassTracker.isValid())
+            m_imuData.compass -= m_compassTracker.getOffset();
+    }
 
-    m_imuData.compass.setX(m_compassAverageX->getAverage());
-    m_imuData.compass.setY(m_compassAverageY->getAverage());
-    m_imuData.compass.setZ(m_compassAverageZ->getAverage());
-    
-    //m_compassAverage.setX(m_imuData.compass.x() * COMPASS_ALPHA + m_compassAverage.x() * (1.0 - COMPASS_ALPHA));
-    //m_compassAverage.setY(m_imuData.compass.y() * COMPASS_ALPHA + m_compassAverage.y() * (1.0 - COMPASS_ALPHA));
-    //m_compassAverage.setZ(m_imuData.compass.z() * COMPASS_ALPHA + m_compassAverage.z() * (1.0 - COMPASS_ALPHA));
-    //
-    //m_imuData.compass = m_compassAverage;
+    //  smoothing
+
+    m_imuData.compass = m_compassSmoother.update(m_imuData.compass, m_imuData.timestamp);
+    m_compassAverage = m_imuData.compass;
+    m_compassAverageValid = true;
 }
 
 void RTIMU::resetCompassRunTimeMaxMin()
@@ -596,6 +621,12 @@ void RTIMU::resetCompassRunTimeMaxMin()
     //m_runtimeMagCalValid = false;
 }
 
+void RTIMU::setCompassTrackingEnable(bool enable)
+{
+    m_compassTrackingEnable = enable;
+    m_compassTracker.reset();
+}
+
 void RTIMU::calibrateAccel()
 {
 
@@ -679,6 +710,17 @@ void RTIMU::runtimeAdjustAccelCal()
         
     }
 }
+void RTIMU::IMUProcess()
+{
+    handleGyroBias();
+    calibrateAverageCompass();
+    calibrateAccel();
+
+    //  now update the filter
+
+    updateFusion();
+}
+
 void RTIMU::updateFusion()
 {
     m_fusion->newIMUData(m_imuData, m_settings);
@@ -722,6 +764,117 @@ void RTIMU::setExtIMUData(RTFLOAT gx, RTFLOAT gy, RTFLOAT gz, RTFLOAT ax, RTFLOA
     m_imuData.compass.setX(mx);
     m_imuData.compass.setY(my);
     m_imuData.compass.setZ(mz);
+    m_imuData.compassNew = true;
     m_imuData.timestamp = timestamp;
     updateFusion();
 }
+
+bool RTIMU::IMUEnableDataReady(int pin, int depth)
+{
+    IMUDisableDataReady();
+
+    if (m_dataReadyIMU != NULL) {
+        HAL_ERROR1("Data ready interrupt already in use by %s\n", m_dataReadyIMU->IMUName());
+        return false;
+    }
+
+    m_sampleRing = new RTIMUSampleRing(depth);
+    if (m_sampleRing->depth() != depth) {
+        HAL_ERROR1("Failed to allocate %d sample ring\n", depth);
+        delete m_sampleRing;
+        m_sampleRing = NULL;
+        return false;
+    }
+
+    if (!IMUDataReadyInit()) {
+        delete m_sampleRing;
+        m_sampleRing = NULL;
+        return false;
+    }
+
+    m_dataReadyPin = pin;
+    m_dataReadyIMU = this;
+    pinMode(pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(pin), dataReadyISR, IMUDataReadyEdge());
+
+    //  the edge may already have been missed so collect anything that is waiting
+
+    noInterrupts();
+    dataReadyISR();
+    interrupts();
+
+    HAL_INFO2("%s using data ready interrupt on pin %d\n", IMUName(), pin);
+    return true;
+}
+
+void RTIMU::IMUDisableDataReady()
+{
+    if (m_dataReadyPin >= 0) {
+        detachInterrupt(digitalPinToInterrupt(m_dataReadyPin));
+        m_dataReadyPin = -1;
+        m_dataReadyIMU = NULL;
+    }
+    if (m_sampleRing != NULL) {
+        delete m_sampleRing;
+        m_sampleRing = NULL;
+    }
+}
+
+bool RTIMU::IMUDataReadyInit()
+{
+    HAL_ERROR1("%s does not support a data ready interrupt\n", IMUName());
+    return false;
+}
+
+bool RTIMU::IMUGetSample(RTIMU_DATA& data)
+{
+    RTIMU_DATA raw;
+
+    if ((m_sampleRing == NULL) || !m_sampleRing->pop(raw))
+        return false;
+
+    //  the processing state (motion, fusion) stays, the sensor readings are replaced
+
+    m_imuData.timestamp = raw.timestamp;
+    m_imuData.gyroValid = raw.gyroValid;
+    m_imuData.gyro = raw.gyro;
+    m_imuData.accelValid = raw.accelValid;
+    m_imuData.accel = raw.accel;
+    m_imuData.compassValid = raw.compassValid;
+    m_imuData.compassNew = raw.compassNew;
+    m_imuData.compass = raw.compass;
+    m_imuData.temperatureValid = raw.temperatureValid;
+    m_imuData.temperature = raw.temperature;
+
+    IMUProcess();
+    data = m_imuData;
+    return true;
+}
+
+void RTIMU::dataReadyISR()
+{
+    RTIMU *imu = m_dataReadyIMU;
+
+    if (imu == NULL)
+        return;
+
+    //  the interrupt can land while loop() is in IMUProcess() so m_imuData is put back as
+    //  it was found - the raw samples only go to the ring
+
+    RTIMU_DATA saved = imu->m_imuData;
+
+    HALInInterrupt = true;
+    imu->m_readRawOnly = true;
+
+    //  always drain everything the IMU has buffered. Samples left behind would overflow the
+    //  IMU's FIFO unseen, and an IMU without a FIFO holds its data ready output until it is
+    //  read so the next edge would never come. Samples that don't fit in the ring are
+    //  dropped there and counted.
+
+    while (imu->IMURead())
+        imu->m_sampleRing->push(imu->m_imuData);
+
+    imu->m_readRawOnly = false;
+    HALInInterrupt = false;
+    imu->m_imuData = saved;
+}
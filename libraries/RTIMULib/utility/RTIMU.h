@@ -28,7 +28,10 @@
 #include "RTFusion.h"
 #include "RTIMULibDefs.h"
 #include "RTIMUSettings.h"
-#include "RunningAverage.h"
+#include "RTCompassSmoother.h"
+#include "RTIMUSampleRing.h"
+#include "RTIMUStillDetector.h"
+#include "RTMagTracker.h"
 
 //  Axis rotation defs
 //
@@ -129,9 +132,26 @@ public:
 
     void resetCompassRunTimeMaxMin();
 
+    //  setCompassTrackingEnable() turns on background tracking of the hard iron offset (see
+    //  RTMagTracker). The tracker works on the calibrated compass so its offset is removed
+    //  after all other compass calibration. Enabling restarts the tracker.
+
+    void setCompassTrackingEnable(bool enable);
+    bool getCompassTrackingEnable() { return m_compassTrackingEnable; }
+    void setCompassTrackingRate(RTFLOAT rate) { m_compassTracker.setRate(rate); }
+    void setCompassTrackingForgettingFactor(RTFLOAT lambda) { m_compassTracker.setForgettingFactor(lambda); }
+
+    //  getCompassTrackingValid() returns true if a tracked offset is being applied
+
+    bool getCompassTrackingValid() { return m_compassTrackingEnable && !m_compassCalibrationMode && m_compassTracker.isValid(); }
+    const RTVector3& getCompassTrackingOffset() { return m_compassTracker.getOffset(); }
+
     //  getIMUData returns the standard outputs of the IMU and fusion filter
     const RTIMU_DATA& getIMUData() { return m_imuData; }
 
+    //  IMUGetSampleRate returns the configured output rate in samples per second
+    int IMUGetSampleRate() { return m_sampleRate; }
+
     //  setExtIMUData allows data from some external IMU to be injected to the fusion algorithm
     void setExtIMUData(RTFLOAT gx, RTFLOAT gy, RTFLOAT gz, RTFLOAT ax, RTFLOAT ay, RTFLOAT az,
         RTFLOAT mx, RTFLOAT my, RTFLOAT mz, uint64_t timestamp);
@@ -180,6 +200,9 @@ public:
     //  getGyroCalibrationValid() returns true if the compass min/max calibration data is being used
     bool getGyroCalibrationValid() { return !m_gyroCalibrationMode && m_settings->m_gyroBiasValid; }
 
+    //  getGyroCalibrationCorrValid() returns true if the gyro scale and misalignment correction is being used
+    bool getGyroCalibrationCorrValid() { return !m_gyroCalibrationMode && m_settings->m_gyroCalCorrValid; }
+
     bool getMotion()                 { return m_imuData.motion; }  // gets motion status
     
     const RTVector3& getGyro()       { return m_imuData.gyro; }    // gets gyro rates in radians/sec
@@ -192,9 +215,37 @@ public:
 	//  adjusts max/min accelerometer calibration to read 1g earth acceleration, only run when no motion
     void runtimeAdjustAccelCal();                           // adjusts accelerometer Max/Min so that scaler becomes 1
 
+    //  IMUEnableDataReady() switches to interrupt driven sampling. The IMU's data ready output
+    //  must be wired to pin. Each interrupt only moves raw samples from the IMU into a ring of
+    //  depth samples. loop() then empties the ring with IMUGetSample() instead of calling
+    //  IMURead(), and the bias, calibration and fusion run there, outside interrupt context.
+    //  The interrupt uses the bus, so on I2C the Wire driver must work from interrupt context
+    //  (e.g. i2c_t3 in I2C_OP_MODE_IMM) and other devices on the same bus must only be accessed
+    //  with the interrupt masked. Only one IMU can use the data ready interrupt at a time.
+    //  Each interrupt empties the IMU, so if loop() falls more than depth samples behind the
+    //  newest samples are dropped and IMUSampleOverflows() counts them.
+
+    bool IMUEnableDataReady(int pin, int depth);
+    void IMUDisableDataReady();
+    bool IMUGetSample(RTIMU_DATA& data);
+    int IMUSamplesWaiting() { return (m_sampleRing != NULL) ? m_sampleRing->count() : 0; }
+    unsigned long IMUSampleOverflows() { return (m_sampleRing != NULL) ? m_sampleRing->overflows() : 0; }
+
 protected:
+    //  These are provided by sub classes that can drive a data ready interrupt pin
+
+    virtual bool IMUDataReadyInit();                        // enable the data ready output on the IMU
+    virtual int IMUDataReadyEdge() { return RISING; }       // pin edge that signals new data
+
+    //  IMUProcess() is the second half of IMURead() - bias, calibration and fusion of the raw
+    //  sample in m_imuData. Drivers skip it while m_readRawOnly is set, then the data ready
+    //  interrupt is reading and IMUGetSample() runs it later.
+
+    virtual void IMUProcess();
+    volatile bool m_readRawOnly;
+
     void gyroBiasInit();                                    // sets up gyro bias calculation
-    void handleGyroBias();                                  // adjust gyro for bias
+    void handleGyroBias();                                  // adjust gyro for bias and scale
     void calibrateAverageCompass();                         // calibrate and smooth compass
     void calibrateAccel();                                  // calibrate the accelerometers
     void updateFusion();                                    // call when new data to update fusion state
@@ -206,6 +257,7 @@ protected:
     bool m_gyroRunTimeCalibrationEnable;                    //
     bool m_accelRunTimeCalibrationEnable;                   //
     bool m_compassRunTimeCalibrationEnable;                 //
+    bool m_compassTrackingEnable;                           // true if the hard iron tracker is running
     bool m_gyroManualCalibrationEnable;                     //
     //
     RTIMU_DATA m_imuData;                                   // the data from the IMU
@@ -223,8 +275,7 @@ protected:
     RTFLOAT m_gyroLearningAlpha;                            // gyro bias rapid learning rate
     RTFLOAT m_gyroContinuousAlpha;                          // gyro bias continuous (slow) learning rate
     
-    RTVector3 m_previousAccel;                              // previous step accel for gyro learningboo
-    RTVector3 m_previousGyro;                               // previous step gyro for motion detection
+    RTIMUStillDetector m_stillDetector;                     // motion detection for gyro learning
     RTVector3 m_gyroBiasTemp;                               // current bias that is modified in the gyro learning algorithm
     RTVector3 m_gyroBiasCandidate;                          // bias that will become active once all exclusion criteria are met
     bool m_noMotionStarted;                                 // the bias algorithm just started
@@ -234,17 +285,24 @@ protected:
     bool m_previousMotion;                                  // to figure out if imu transitioned from motion to no motion
     float m_compassCalOffset[3];
     float m_compassCalScale[3];
-    RTVector3 m_compassAverage;                             // a running average to smooth the mag outputs
+    RTVector3 m_compassAverage;                             // last averaged mag output, reused for stale samples
+    bool m_compassAverageValid;                             // true once m_compassAverage holds a real sample
 
-    RunningAverage *m_compassAverageX;                      // Average filter for Compass X
-    RunningAverage *m_compassAverageY;                      // Average filter for Compass Y
-    RunningAverage *m_compassAverageZ;                      // Average filter for Compass Z
+    RTCompassSmoother m_compassSmoother;                    // compass smoothing selected by settings
     bool m_runtimeMagCalValid;                              // true if the runtime mag calibration has valid data
 
     RTVector3 m_runtimeMagCalMax;                           // runtime max mag values seen
     RTVector3 m_runtimeMagCalMin;                           // runtime min mag values seen
+    RTMagTracker m_compassTracker;                          // background hard iron tracking
     static float m_axisRotation[RTIMU_AXIS_ROTATION_COUNT][9];    // array of rotation matrices
 
+private:
+    static void dataReadyISR();                             // the data ready interrupt handler
+
+    static RTIMU *m_dataReadyIMU;                           // the IMU serviced by dataReadyISR
+    RTIMUSampleRing *m_sampleRing;                          // samples collected by the interrupt
+    int m_dataReadyPin;                                     // the data ready pin or -1 if polling
+
  };
 
 #endif // _RTIMU_H
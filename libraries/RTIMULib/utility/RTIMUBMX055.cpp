@@ -408,6 +408,17 @@ int RTIMUBMX055::IMUGetPollInterval()
         return (400 / m_sampleRate);
 }
 
+bool RTIMUBMX055::IMUDataReadyInit()
+{
+    //  gyro data ready on INT3, push-pull active high
+
+    if (!m_settings->HALWrite(m_gyroSlaveAddr, BMX055_GYRO_INT_EN_1, 0x0d, "Failed to set BMX055 gyro int pin"))
+        return false;
+    if (!m_settings->HALWrite(m_gyroSlaveAddr, BMX055_GYRO_INT_MAP_1, 0x01, "Failed to map BMX055 gyro data ready"))
+        return false;
+    return m_settings->HALWrite(m_gyroSlaveAddr, BMX055_GYRO_INT_EN_0, 0x80, "Failed to enable BMX055 gyro data ready");
+}
+
 bool RTIMUBMX055::IMURead()
 {
     unsigned char status;
@@ -479,12 +490,6 @@ bool RTIMUBMX055::IMURead()
     m_imuData.compass.setY(-temp);
     m_imuData.compass.setZ(-m_imuData.compass.z());
 #endif
-    //  now do standard processing
-
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
     if (m_firstTime)
         m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
     else
@@ -492,9 +497,10 @@ bool RTIMUBMX055::IMURead()
 
     m_firstTime = false;
 
-    //  now update the filter
+    //  now do standard processing, unless the data ready interrupt is reading
 
-    updateFusion();
+    if (!m_readRawOnly)
+        IMUProcess();
 
     return true;
 }
@@ -39,6 +39,9 @@ public:
     virtual int IMUGetPollInterval();
     virtual bool IMURead();
 
+protected:
+    virtual bool IMUDataReadyInit();                        // route gyro data ready to an interrupt pin
+
 private:
     bool setGyroSampleRate();
     bool setGyroFSR();
@@ -1097,6 +1097,8 @@
 #define BMX055_GYRO_RATE_HBW        0x13
 #define BMX055_GYRO_SOFT_RESET      0x14
 #define BMX055_GYRO_INT_EN_0        0x15
+#define BMX055_GYRO_INT_EN_1        0x16
+#define BMX055_GYRO_INT_MAP_1       0x18
 #define BMX055_GYRO_1A              0x1a
 #define BMX055_GYRO_1B              0x1b
 #define BMX055_GYRO_SOC             0x31
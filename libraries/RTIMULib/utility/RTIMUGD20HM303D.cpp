@@ -43,7 +43,6 @@ bool RTIMUGD20HM303D::IMUInit()
     unsigned char result;
 
 #ifdef GD20HM303D_CACHE_MODE
-    m_firstTime = true;
     m_cacheIn = m_cacheOut = m_cacheCount = 0;
 #endif
     // set validity flags
@@ -134,6 +133,8 @@ bool RTIMUGD20HM303D::IMUInit()
 
     if (!m_settings->HALWrite(m_gyroSlaveAddr, L3GD20H_FIFO_CTRL, 0x3f, "Failed to set L3GD20H FIFO mode"))
         return false;
+
+    m_timestamp.reset(m_sampleRate);
 #endif
 
     if (!setGyroCTRL5())
@@ -408,6 +409,7 @@ bool RTIMUGD20HM303D::IMURead()
 
 #ifdef GD20HM303D_CACHE_MODE
     int count;
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
 
     if (!m_settings->HALRead(m_gyroSlaveAddr, L3GD20H_FIFO_SRC, 1, &status, "Failed to read L3GD20H fifo status"))
         return false;
@@ -426,38 +428,33 @@ bool RTIMUGD20HM303D::IMURead()
         if (!setGyroCTRL5())
             return false;
 
-        m_imuData.timestamp += m_sampleInterval * 32;
+        m_timestamp.resync();
         return false;
     }
 
     // get count of samples in fifo
     count = status & 0x1f;
+    m_timestamp.fifoCount(now, count);
 
     if ((m_cacheCount == 0) && (count > 0) && (count < GD20HM303D_FIFO_THRESH)) {
         // special case of a small fifo and nothing cached - just handle as simple read
 
         if (!m_settings->HALRead(m_gyroSlaveAddr, 0x80 | L3GD20H_OUT_X_L, 6, gyroData, "Failed to read L3GD20H data"))
             return false;
+        m_timestamp.samplesRead(1);
 
         if (!m_settings->HALRead(m_accelCompassSlaveAddr, 0x80 | LSM303D_OUT_X_L_A, 6, accelData, "Failed to read LSM303D accel data"))
             return false;
 
         if (!m_settings->HALRead(m_accelCompassSlaveAddr, 0x80 | LSM303D_OUT_X_L_M, 6, compassData, "Failed to read LSM303D compass data"))
             return false;
-
-        if (m_firstTime)
-            m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-        else
-            m_imuData.timestamp += m_sampleInterval;
-
-        m_firstTime = false;
     } else {
         if (count >=  GD20HM303D_FIFO_THRESH) {
             // need to create a cache block
 
             if (m_cacheCount == GD20HM303D_CACHE_BLOCK_COUNT) {
                 // all cache blocks are full - discard oldest and update timestamp to account for lost samples
-                m_imuData.timestamp += m_sampleInterval * m_cache[m_cacheOut].count;
+                m_timestamp.skip(m_cache[m_cacheOut].count);
                 if (++m_cacheOut == GD20HM303D_CACHE_BLOCK_COUNT)
                     m_cacheOut = 0;
                 m_cacheCount--;
@@ -466,6 +463,7 @@ bool RTIMUGD20HM303D::IMURead()
             if (!m_settings->HALRead(m_gyroSlaveAddr, 0x80 | L3GD20H_OUT_X_L, GD20HM303D_FIFO_CHUNK_SIZE * GD20HM303D_FIFO_THRESH,
                          m_cache[m_cacheIn].data, "Failed to read L3GD20H fifo data"))
                 return false;
+            m_timestamp.samplesRead(GD20HM303D_FIFO_THRESH);
 
             if (!m_settings->HALRead(m_accelCompassSlaveAddr, 0x80 | LSM303D_OUT_X_L_A, 6,
                          m_cache[m_cacheIn].accel, "Failed to read LSM303D accel data"))
@@ -502,13 +500,8 @@ bool RTIMUGD20HM303D::IMURead()
                 m_cacheOut = 0;
             m_cacheCount--;
         }
-        if (m_firstTime)
-            m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-        else
-            m_imuData.timestamp += m_sampleInterval;
-
-        m_firstTime = false;
     }
+    m_imuData.timestamp = m_timestamp.next();
 
 #else
     if (!m_settings->HALRead(m_gyroSlaveAddr, L3GD20H_STATUS, 1, &status, "Failed to read L3GD20H status"))
@@ -549,15 +542,10 @@ bool RTIMUGD20HM303D::IMURead()
     m_imuData.compass.setY(-m_imuData.compass.y());
     m_imuData.compass.setZ(-m_imuData.compass.z());
 
-    //  now do standard processing
-
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
+    //  now do standard processing, unless the data ready interrupt is reading
 
-    updateFusion();
+    if (!m_readRawOnly)
+        IMUProcess();
 
     return true;
 }
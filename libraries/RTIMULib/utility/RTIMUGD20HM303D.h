@@ -26,6 +26,7 @@
 #define	_RTIMUGD20HM303D_H
 
 #include "RTIMU.h"
+#include "RTIMUTimestamp.h"
 
 //  Define this symbol to use cache mode
 
@@ -63,6 +64,12 @@ public:
     virtual int IMUGetPollInterval();
     virtual bool IMURead();
 
+#ifdef GD20HM303D_CACHE_MODE
+    //  getTimestamp() gives access to the sample clock estimate and its error statistics
+
+    RTIMUTimestamp *getTimestamp() { return &m_timestamp; }
+#endif
+
 private:
     bool setGyroSampleRate();
     bool setGyroCTRL2();
@@ -82,7 +89,7 @@ private:
     RTFLOAT m_compassScale;
 
 #ifdef GD20HM303D_CACHE_MODE
-    bool m_firstTime;                                       // if first sample
+    RTIMUTimestamp m_timestamp;                             // sample clock estimate
 
     GD20HM303D_CACHE_BLOCK m_cache[GD20HM303D_CACHE_BLOCK_COUNT]; // the cache itself
     int m_cacheIn;                                          // the in index
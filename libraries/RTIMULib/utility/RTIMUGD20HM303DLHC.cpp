@@ -548,15 +548,10 @@ bool RTIMUGD20HM303DLHC::IMURead()
     m_imuData.compass.setZ(-m_imuData.compass.y());
     m_imuData.compass.setY(-temp);
 
-    //  now do standard processing
+    //  now do standard processing, unless the data ready interrupt is reading
 
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
-
-    updateFusion();
+    if (!m_readRawOnly)
+        IMUProcess();
 
     return true;
 }
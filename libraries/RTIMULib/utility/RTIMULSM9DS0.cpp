@@ -43,7 +43,6 @@ bool RTIMULSM9DS0::IMUInit()
     unsigned char result;
 
 #ifdef LSM9DS0_CACHE_MODE
-    m_firstTime = true;
     m_cacheIn = m_cacheOut = m_cacheCount = 0;
 #endif
     // set validity flags
@@ -131,6 +130,8 @@ bool RTIMULSM9DS0::IMUInit()
 
     if (!m_settings->HALWrite(m_gyroSlaveAddr, LSM9DS0_GYRO_FIFO_CTRL, 0x3f, "Failed to set LSM9DS0 FIFO mode"))
         return false;
+
+    m_timestamp.reset(m_sampleRate);
 #endif
 
     if (!setGyroCTRL5())
@@ -374,6 +375,17 @@ int RTIMULSM9DS0::IMUGetPollInterval()
     return (400 / m_sampleRate);
 }
 
+bool RTIMULSM9DS0::IMUDataReadyInit()
+{
+    //  DRDY_G is push-pull active high. In cache mode signal the FIFO watermark instead
+
+#ifdef LSM9DS0_CACHE_MODE
+    return m_settings->HALWrite(m_gyroSlaveAddr, LSM9DS0_GYRO_CTRL3, 0x04, "Failed to set LSM9DS0 gyro CTRL3");
+#else
+    return m_settings->HALWrite(m_gyroSlaveAddr, LSM9DS0_GYRO_CTRL3, 0x08, "Failed to set LSM9DS0 gyro CTRL3");
+#endif
+}
+
 bool RTIMULSM9DS0::IMURead()
 {
     unsigned char status;
@@ -384,6 +396,7 @@ bool RTIMULSM9DS0::IMURead()
 
 #ifdef LSM9DS0_CACHE_MODE
     int count;
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
 
     if (!m_settings->HALRead(m_gyroSlaveAddr, LSM9DS0_GYRO_FIFO_SRC, 1, &status, "Failed to read LSM9DS0 gyro fifo status"))
         return false;
@@ -402,38 +415,33 @@ bool RTIMULSM9DS0::IMURead()
         if (!setGyroCTRL5())
             return false;
 
-        m_imuData.timestamp += m_sampleInterval * 32;
+        m_timestamp.resync();
         return false;
     }
 
     // get count of samples in fifo
     count = status & 0x1f;
+    m_timestamp.fifoCount(now, count);
 
     if ((m_cacheCount == 0) && (count > 0) && (count < LSM9DS0_FIFO_THRESH)) {
         // special case of a small fifo and nothing cached - just handle as simple read
 
         if (!m_settings->HALRead(m_gyroSlaveAddr, 0x80 | LSM9DS0_GYRO_OUT_X_L, 6, gyroData, "Failed to read LSM9DS0 gyro data"))
             return false;
+        m_timestamp.samplesRead(1);
 
         if (!m_settings->HALRead(m_accelCompassSlaveAddr, 0x80 | LSM9DS0_OUT_X_L_A, 6, accelData, "Failed to read LSM9DS0 accel data"))
             return false;
 
         if (!m_settings->HALRead(m_accelCompassSlaveAddr, 0x80 | LSM9DS0_OUT_X_L_M, 6, compassData, "Failed to read LSM9DS0 compass data"))
             return false;
-
-        if (m_firstTime)
-            m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-        else
-            m_imuData.timestamp += m_sampleInterval;
-
-        m_firstTime = false;
    } else {
         if (count >=  LSM9DS0_FIFO_THRESH) {
             // need to create a cache block
 
             if (m_cacheCount == LSM9DS0_CACHE_BLOCK_COUNT) {
                 // all cache blocks are full - discard oldest and update timestamp to account for lost samples
-                m_imuData.timestamp += m_sampleInterval * m_cache[m_cacheOut].count;
+                m_timestamp.skip(m_cache[m_cacheOut].count);
                 if (++m_cacheOut == LSM9DS0_CACHE_BLOCK_COUNT)
                     m_cacheOut = 0;
                 m_cacheCount--;
@@ -442,6 +450,7 @@ bool RTIMULSM9DS0::IMURead()
             if (!m_settings->HALRead(m_gyroSlaveAddr, 0x80 | LSM9DS0_GYRO_OUT_X_L, LSM9DS0_FIFO_CHUNK_SIZE * LSM9DS0_FIFO_THRESH,
                          m_cache[m_cacheIn].data, "Failed to read LSM9DS0 fifo data"))
                 return false;
+            m_timestamp.samplesRead(LSM9DS0_FIFO_THRESH);
 
             if (!m_settings->HALRead(m_accelCompassSlaveAddr, 0x80 | LSM9DS0_OUT_X_L_A, 6,
                          m_cache[m_cacheIn].accel, "Failed to read LSM9DS0 accel data"))
@@ -478,13 +487,8 @@ bool RTIMULSM9DS0::IMURead()
                 m_cacheOut = 0;
             m_cacheCount--;
         }
-        if (m_firstTime)
-            m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-        else
-            m_imuData.timestamp += m_sampleInterval;
-
-        m_firstTime = false;
     }
+    m_imuData.timestamp = m_timestamp.next();
 
 #else
     if (!m_settings->HALRead(m_gyroSlaveAddr, LSM9DS0_GYRO_STATUS, 1, &status, "Failed to read LSM9DS0 status"))
@@ -524,15 +528,10 @@ bool RTIMULSM9DS0::IMURead()
 
     m_imuData.compass.setY(-m_imuData.compass.y());
 
-    //  now do standard processing
-
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
+    //  now do standard processing, unless the data ready interrupt is reading
 
-    updateFusion();
+    if (!m_readRawOnly)
+        IMUProcess();
 
     return true;
 }
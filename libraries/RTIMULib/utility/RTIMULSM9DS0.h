@@ -26,6 +26,7 @@
 #define	_RTIMULSM9DS0_H
 
 #include "RTIMU.h"
+#include "RTIMUTimestamp.h"
 
 //  Define this symbol to use cache mode
 
@@ -63,6 +64,15 @@ public:
     virtual int IMUGetPollInterval();
     virtual bool IMURead();
 
+#ifdef LSM9DS0_CACHE_MODE
+    //  getTimestamp() gives access to the sample clock estimate and its error statistics
+
+    RTIMUTimestamp *getTimestamp() { return &m_timestamp; }
+#endif
+
+protected:
+    virtual bool IMUDataReadyInit();                        // route gyro data ready to an interrupt pin
+
 private:
     bool setGyroSampleRate();
     bool setGyroCTRL2();
@@ -82,7 +92,7 @@ private:
     RTFLOAT m_compassScale;
 
 #ifdef LSM9DS0_CACHE_MODE
-    bool m_firstTime;                                       // if first sample
+    RTIMUTimestamp m_timestamp;                             // sample clock estimate
 
     LSM9DS0_CACHE_BLOCK m_cache[LSM9DS0_CACHE_BLOCK_COUNT]; // the cache itself
     int m_cacheIn;                                          // the in index
@@ -394,15 +394,10 @@ bool RTIMULSM9DS1::IMURead()
     m_imuData.compass.setX(-m_imuData.compass.x());
     m_imuData.compass.setZ(-m_imuData.compass.z());
 
-    //  now do standard processing
+    //  now do standard processing, unless the data ready interrupt is reading
 
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
-
-    updateFusion();
+    if (!m_readRawOnly)
+        IMUProcess();
 
     return true;
 }
@@ -247,6 +247,8 @@ bool RTIMUMPU9150::IMUInit()
     setGyroFsr(m_settings->m_MPU9150GyroFsr);
     setAccelFsr(m_settings->m_MPU9150AccelFsr);
 
+    m_timestamp.reset(m_sampleRate);
+
     setCalibrationData(); // adjust calibration data
 
     //  enable the I2C bus
@@ -318,6 +320,7 @@ bool RTIMUMPU9150::configureCompass()
     unsigned char id;
 
     m_compassIs5883 = false;
+    memset(m_compassLast, 0, sizeof(m_compassLast));
     m_compassDataLength = 8; // registers: status one, mx, my, mz and status two for AKA
     m_fifoChunkLength = MPU9150_FIFO_CHUNK_SIZE; // adjust FIFO chunk length, either AKA or 5883
 
@@ -479,6 +482,8 @@ bool RTIMUMPU9150::resetFifo()
     if (!m_settings->HALWrite(m_slaveAddr, MPU9150_INT_ENABLE, 1, "Writing int enable")) 
         return false; // enable FIFO interrupt (but do not enable FIFO overflow, ic2 master, motion interrupt)
 
+    m_timestamp.resync();
+
     //    TEMP, XG, YG, ZG, ACCEL, SLV2, SLV1, SLV0
     // f9 1     1   1   1   1      0     0     1
     // f8 1     1   1   1   1      0     0     0
@@ -592,10 +597,13 @@ bool RTIMUMPU9150::IMURead()
     unsigned char temperatureData[2]; // if temperature data is not coming in through FIFO
     #endif
 
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+
     if (!m_settings->HALRead(m_slaveAddr, MPU9150_FIFO_COUNT_H, 2, fifoCount, "Failed to read fifo count")) 
          return false;
 
     count = ((unsigned int)fifoCount[0] << 8) + fifoCount[1];
+    m_timestamp.fifoCount(now, count / m_fifoChunkLength);
 
     // Debug
     // printf("FIFO Count: %d, Cache Count: %d, FIFO Chunk Length: %d, Max Cache Size: %d\n",count, m_cacheCount, m_fifoChunkLength, MPU9150_CACHE_SIZE);
@@ -604,7 +612,6 @@ bool RTIMUMPU9150::IMURead()
     if (count == 1024) {
         HAL_INFO("MPU9150 fifo has overflowed");
         resetFifo();
-        m_imuData.timestamp += m_sampleInterval * (1024 / m_fifoChunkLength + 1); // try to fix timestamp
         return false;
     }
 
@@ -617,6 +624,7 @@ bool RTIMUMPU9150::IMURead()
         // special case of a small fifo and nothing cached - just handle as simple read
         if (!m_settings->HALRead(m_slaveAddr, MPU9150_FIFO_R_W, m_fifoChunkLength, fifoData, "Failed to read fifo data"))
             return false;
+        m_timestamp.samplesRead(1);
 
         #if MPU9150_FIFO_WITH_TEMP == 0 // read temp from registers
         if (!m_settings->HALRead(m_slaveAddr, MPU9150_TEMP_OUT_H, 2,
@@ -633,7 +641,7 @@ bool RTIMUMPU9150::IMURead()
         if (count >= (MPU9150_CACHE_SIZE * m_fifoChunkLength)) {
             if (m_cacheCount == MPU9150_CACHE_BLOCK_COUNT) {
                 // all cache blocks are full - discard oldest and update timestamp to account for lost samples
-                m_imuData.timestamp += m_sampleInterval * m_cache[m_cacheOut].count;
+                m_timestamp.skip(m_cache[m_cacheOut].count);
                 if (++m_cacheOut == MPU9150_CACHE_BLOCK_COUNT)
                     m_cacheOut = 0;
                 m_cacheCount--;
@@ -644,9 +652,14 @@ bool RTIMUMPU9150::IMURead()
             if (blockCount > MPU9150_CACHE_SIZE)
                 blockCount = MPU9150_CACHE_SIZE;
 
-            if (!m_settings->HALRead(m_slaveAddr, MPU9150_FIFO_R_W, m_fifoChunkLength * blockCount,
-                                m_cache[m_cacheIn].data, "Failed to read fifo data"))
+            if (!m_settings->HALReadBlock(m_slaveAddr, MPU9150_FIFO_R_W, m_fifoChunkLength * blockCount,
+                                m_cache[m_cacheIn].data, "Failed to read fifo data")) {
+                //  a part read block leaves the FIFO out of step with the sample boundaries
+
+                resetFifo();
                 return false;
+            }
+            m_timestamp.samplesRead(blockCount);
 
             #if MPU9150_FIFO_WITH_TEMP == 0 // read temp from registers
             if (!m_settings->HALRead(m_slaveAddr, MPU9150_TEMP_OUT_H, 2,
@@ -699,8 +712,9 @@ bool RTIMUMPU9150::IMURead()
         while (count >= m_fifoChunkLength * 10) {
             if (!m_settings->HALRead(m_slaveAddr, MPU9150_FIFO_R_W, m_fifoChunkLength, fifoData, "Failed to read fifo data"))
                 return false;
+            m_timestamp.samplesRead(1);
             count -= m_fifoChunkLength;
-            m_imuData.timestamp += m_sampleInterval;
+            m_timestamp.skip(1);
         }
     }
 
@@ -709,6 +723,7 @@ bool RTIMUMPU9150::IMURead()
 
     if (!m_settings->HALRead(m_slaveAddr, MPU9150_FIFO_R_W, m_fifoChunkLength, fifoData, "Failed to read fifo data"))
         return false;
+    m_timestamp.samplesRead(1);
 
     #if MPU9150_FIFO_WITH_TEMP == 0
     if (!m_settings->HALRead(m_slaveAddr, MPU9150_TEMP_OUT_H, 2, temperatureData, "Failed to read temperature data"))
@@ -785,6 +800,22 @@ bool RTIMUMPU9150::IMURead()
         #endif
     #endif
 
+    //  AK8975 ST1 DRDY is only set when the slave read picked up a fresh measurement,
+    //  ST2 HOFL marks a saturated one. The HMC5883 read has no status byte so a
+    //  stale sample shows up as unchanged data.
+
+    #if MPU9150_FIFO_WITH_COMPASS == 1
+        unsigned char *compassRaw = fifoData + (MPU9150_FIFO_WITH_TEMP == 1 ? 14 : 12);
+    #else
+        unsigned char *compassRaw = compassData;
+    #endif
+    if (m_compassIs5883) {
+        m_imuData.compassNew = memcmp(compassRaw, m_compassLast, 6) != 0;
+        memcpy(m_compassLast, compassRaw, 6);
+    } else {
+        m_imuData.compassNew = (compassRaw[0] & 0x01) && !(compassRaw[7] & 0x08);
+    }
+
     //  sort out gyro axes
 
     m_imuData.gyro.setX(m_imuData.gyro.x());
@@ -822,14 +853,20 @@ bool RTIMUMPU9150::IMURead()
         m_imuData.compass.setY(-temp);
     }
     
-    if (m_firstTime)
-        m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-    else
-        m_imuData.timestamp += m_sampleInterval;
+    m_imuData.timestamp = m_timestamp.next();
 
     m_firstTime = false;
 
-    //  now do standard processing
+    //  now do standard processing, unless the data ready interrupt is reading
+
+    if (!m_readRawOnly)
+        IMUProcess();
+
+    return true;
+}
+
+void RTIMUMPU9150::IMUProcess()
+{
     if (m_imuData.temperatureValid == true) {
         // Check if temperature changed
         if (fabs(m_imuData.temperature - m_temperature_previous) >= TEMPERATURE_DELTA) {
@@ -840,12 +877,5 @@ bool RTIMUMPU9150::IMURead()
         // Then do
         handleTempBias(); 	// temperature Correction
     }
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
-    updateFusion();
-
-    return true;
+    RTIMU::IMUProcess();
 }
@@ -26,6 +26,7 @@
 #define	_RTIMUMPU9150_H
 
 #include "RTIMU.h"
+#include "RTIMUTimestamp.h"
 
 //  Define this symbol to use cache mode
 
@@ -94,6 +95,15 @@ public:
     virtual bool IMURead();
     virtual int IMUGetPollInterval();
 
+    //  getTimestamp() gives access to the sample clock estimate and its error statistics
+
+    RTIMUTimestamp *getTimestamp() { return &m_timestamp; }
+
+protected:
+    virtual bool IMUDataReadyInit() { return true; }        // raw data ready interrupt is always enabled
+    virtual int IMUDataReadyEdge() { return FALLING; }      // INT pin is configured active low
+    virtual void IMUProcess();                              // adds the temperature bias
+
 private:
     bool configureCompass();                                // configures the compass
     bool bypassOn();                                        // talk to compass
@@ -114,10 +124,13 @@ private:
     RTFLOAT m_gyroScale;
     RTFLOAT m_accelScale;
 
+    RTIMUTimestamp m_timestamp;                             // sample clock estimate
+
     bool m_compassIs5883;                                   // if it is an MPU-6050/HMC5883 combo
     unsigned int m_fifoChunkLength;                         // depending on compass found, FIFO data length needs to be adjusted
     unsigned int m_compassDataLength;                       // 8 for MPU-9150, 6 for HMC5883
     RTFLOAT m_compassAdjust[3];                             // the compass fuse ROM values converted for use
+    unsigned char m_compassLast[6];                         // previous HMC5883 data for change detection
 
 #ifdef MPU9150_CACHE_MODE
 
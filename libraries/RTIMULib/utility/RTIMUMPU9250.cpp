@@ -275,6 +275,8 @@ bool RTIMUMPU9250::IMUInit()
     setGyroFsr(m_settings->m_MPU9250GyroFsr);
     setAccelFsr(m_settings->m_MPU9250AccelFsr);
 
+    m_timestamp.reset(m_sampleRate);
+
     setCalibrationData();
 
     //  enable the bus
@@ -365,6 +367,9 @@ bool RTIMUMPU9250::resetFifo()
     if (!m_settings->HALWrite(m_slaveAddr, MPU9250_INT_ENABLE, 1, "Writing int enable"))
         return false; // enable FIFO interrupt (but do not enable FIFO overflow, ic2 master, motion interrupt)
 
+    m_fifoPoller.reset(m_sampleRate, 512 / MPU9250_FIFO_CHUNK_SIZE);
+    m_timestamp.resync();
+
     //    TEMP, XG, YG, ZG, ACCEL, SLV2, SLV1, SLV0(compass)
     // f9 1     1   1   1   1      0     0     1
     // f8 1     1   1   1   1      0     0     0
@@ -594,6 +599,12 @@ bool RTIMUMPU9250::bypassOff()
     return true;
 }
 
+void RTIMUMPU9250::fifoSamplesRead(int count)
+{
+    m_fifoPoller.samplesRead(count);
+    m_timestamp.samplesRead(count);
+}
+
 int RTIMUMPU9250::IMUGetPollInterval()
 {
     if (m_sampleRate > 400)
@@ -609,24 +620,43 @@ bool RTIMUMPU9250::IMURead()
     unsigned char fifoData[MPU9250_FIFO_CHUNK_SIZE];
     #if MPU9250_FIFO_WITH_COMPASS == 0
     unsigned char compassData[8]; // compass data goes here if it is not coming in through FIFO
+    bool compassRead = true;      // false if compassData is a copy already used by an earlier sample
     #endif
     #if MPU9250_FIFO_WITH_TEMP == 0
     unsigned char temperatureData[2]; // if temperature data is not coming in through FIFO
     #endif
 
-    if (!m_settings->HALRead(m_slaveAddr, MPU9250_FIFO_COUNT_H, 2, fifoCount, "Failed to read fifo count"))
-         return false;
+    //  only read the fifo count when the poller can't say how many samples must be waiting
 
-    count = ((unsigned int)fifoCount[0] << 8) + fifoCount[1];
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+    int waiting = m_fifoPoller.samplesWaiting(now);
 
-    // Debug
-    // printf("FIFO Count: %d, Cache Count: %d, FIFO Chunk Length: %d, Max Cache Size: %d\n",count, m_cacheCount, MPU9250_FIFO_CHUNK_SIZE, MPU9250_CACHE_SIZE);
-	
-    if (count == 512) {
-        HAL_INFO("MPU9250 fifo has overflowed");
-        resetFifo();
-        m_imuData.timestamp += m_sampleInterval * (512 / MPU9250_FIFO_CHUNK_SIZE + 1); // try to fix timestamp
-        return false;
+    if (waiting >= 0) {
+        count = waiting * MPU9250_FIFO_CHUNK_SIZE;
+    } else {
+        if (!m_settings->HALRead(m_slaveAddr, MPU9250_FIFO_COUNT_H, 2, fifoCount, "Failed to read fifo count"))
+             return false;
+
+        count = ((unsigned int)fifoCount[0] << 8) + fifoCount[1];
+
+        // Debug
+        // printf("FIFO Count: %d, Cache Count: %d, FIFO Chunk Length: %d, Max Cache Size: %d\n",count, m_cacheCount, MPU9250_FIFO_CHUNK_SIZE, MPU9250_CACHE_SIZE);
+
+        if (count == 512) {
+            HAL_INFO("MPU9250 fifo has overflowed");
+            resetFifo();
+            return false;
+        }
+
+        m_timestamp.fifoCount(now, count / MPU9250_FIFO_CHUNK_SIZE);
+
+        if (!m_fifoPoller.countRead(now, count / MPU9250_FIFO_CHUNK_SIZE)) {
+            //  samples were read that may not have been there - the chunks could be misaligned
+
+            HAL_INFO("MPU9250 fifo prediction failed");
+            resetFifo();
+            return false;
+        }
     }
 
 #ifdef MPU9250_CACHE_MODE
@@ -638,6 +668,7 @@ bool RTIMUMPU9250::IMURead()
 
         if (!m_settings->HALRead(m_slaveAddr, MPU9250_FIFO_R_W, MPU9250_FIFO_CHUNK_SIZE, fifoData, "Failed to read fifo data"))
             return false;
+        fifoSamplesRead(1);
 
         #if MPU9250_FIFO_WITH_TEMP == 0 // read temp from registers
         if (!m_settings->HALRead(m_slaveAddr, MPU9250_TEMP_OUT_H, 2,
@@ -654,7 +685,7 @@ bool RTIMUMPU9250::IMURead()
         if (count >= (MPU9250_CACHE_SIZE * MPU9250_FIFO_CHUNK_SIZE)) {
             if (m_cacheCount == MPU9250_CACHE_BLOCK_COUNT) {
                 // all cache blocks are full - discard oldest and update timestamp to account for lost samples
-                m_imuData.timestamp += m_sampleInterval * m_cache[m_cacheOut].count;
+                m_timestamp.skip(m_cache[m_cacheOut].count);
                 if (++m_cacheOut == MPU9250_CACHE_BLOCK_COUNT)
                     m_cacheOut = 0;
                 m_cacheCount--;
@@ -665,9 +696,14 @@ bool RTIMUMPU9250::IMURead()
             if (blockCount > MPU9250_CACHE_SIZE)
                 blockCount = MPU9250_CACHE_SIZE;
 
-            if (!m_settings->HALRead(m_slaveAddr, MPU9250_FIFO_R_W, MPU9250_FIFO_CHUNK_SIZE * blockCount,
-                    m_cache[m_cacheIn].data, "Failed to read fifo data"))
+            if (!m_settings->HALReadBlock(m_slaveAddr, MPU9250_FIFO_R_W, MPU9250_FIFO_CHUNK_SIZE * blockCount,
+                    m_cache[m_cacheIn].data, "Failed to read fifo data")) {
+                //  a part read block leaves the FIFO out of step with the sample boundaries
+
+                resetFifo();
                 return false;
+            }
+            fifoSamplesRead(blockCount);
 
             #if MPU9250_FIFO_WITH_TEMP == 0 // read temp from registers
             if (!m_settings->HALRead(m_slaveAddr, MPU9250_TEMP_OUT_H, 2,
@@ -697,6 +733,7 @@ bool RTIMUMPU9250::IMURead()
         memcpy(fifoData, m_cache[m_cacheOut].data + m_cache[m_cacheOut].index, MPU9250_FIFO_CHUNK_SIZE);
         #if MPU9250_FIFO_WITH_COMPASS == 0
         memcpy(compassData, m_cache[m_cacheOut].compass, 8);
+        compassRead = m_cache[m_cacheOut].index == 0;       // one compass read serves the whole block
         #endif
         #if MPU9250_FIFO_WITH_TEMP == 0
         memcpy(temperatureData, m_cache[m_cacheOut].temperature, 2);            
@@ -720,8 +757,9 @@ bool RTIMUMPU9250::IMURead()
         while (count >= MPU9250_FIFO_CHUNK_SIZE * 10) {
             if (!m_settings->HALRead(m_slaveAddr, MPU9250_FIFO_R_W, MPU9250_FIFO_CHUNK_SIZE, fifoData, "Failed to read fifo data"))
                 return false;
+            fifoSamplesRead(1);
             count -= MPU9250_FIFO_CHUNK_SIZE;
-            m_imuData.timestamp += m_sampleInterval;
+            m_timestamp.skip(1);
         }
     }
 
@@ -730,6 +768,7 @@ bool RTIMUMPU9250::IMURead()
 
     if (!m_settings->HALRead(m_slaveAddr, MPU9250_FIFO_R_W, MPU9250_FIFO_CHUNK_SIZE, fifoData, "Failed to read fifo data"))
         return false;
+    fifoSamplesRead(1);
     #if MPU9250_FIFO_WITH_TEMP == 0
     if (!m_settings->HALRead(m_slaveAddr, MPU9250_TEMP_OUT_H, 2, temperatureData, "Failed to read temperature data"))
         return false;
@@ -773,6 +812,17 @@ bool RTIMUMPU9250::IMURead()
             RTMath::convertToVector(compassData + 1, m_imuData.compass, 0.6f, false);
         #endif
 	#endif
+
+    //  ST1 DRDY is only set when the slave read picked up a fresh magnetometer
+    //  measurement, ST2 HOFL marks a saturated one
+
+    #if MPU9250_FIFO_WITH_COMPASS == 1
+        unsigned char *compassStatus = fifoData + MPU9250_FIFO_CHUNK_SIZE - 8;
+        m_imuData.compassNew = (compassStatus[0] & 0x01) && !(compassStatus[7] & 0x08);
+    #else
+        unsigned char *compassStatus = compassData;
+        m_imuData.compassNew = compassRead && (compassStatus[0] & 0x01) && !(compassStatus[7] & 0x08);
+    #endif
  
     // FIFO contains data from register 59 up to register 96 in that order
     // (given sensor path was reset, otherwise the data order is not correct)
@@ -822,14 +872,20 @@ bool RTIMUMPU9250::IMURead()
     temp = m_imuData.compass.x();
     m_imuData.compass.setX(m_imuData.compass.y());
     m_imuData.compass.setY(-temp);
-    if (m_firstTime)
-        m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-    else
-        m_imuData.timestamp += m_sampleInterval;
+    m_imuData.timestamp = m_timestamp.next();
 
     m_firstTime = false;
 	
-    //  now do standard processing
+    //  now do standard processing, unless the data ready interrupt is reading
+
+    if (!m_readRawOnly)
+        IMUProcess();
+
+    return true;
+}
+
+void RTIMUMPU9250::IMUProcess()
+{
     if (m_imuData.temperatureValid == true) {
         // Check if temperature changed
         if (fabs(m_imuData.temperature - m_temperature_previous) >= TEMPERATURE_DELTA) {
@@ -840,12 +896,5 @@ bool RTIMUMPU9250::IMURead()
         // Then do
         handleTempBias(); 	// temperature Correction
     }
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
-    updateFusion();
-
-    return true;
+    RTIMU::IMUProcess();
 }
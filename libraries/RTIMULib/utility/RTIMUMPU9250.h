@@ -29,12 +29,16 @@
 #define	_RTIMUMPU9250_H
 
 #include "RTIMU.h"
+#include "RTIMUFifoPoller.h"
+#include "RTIMUTimestamp.h"
 
 //  Define this symbol to use cache mode
 
 #define MPU9250_CACHE_MODE
 #define MPU9250_FIFO_WITH_TEMP    1
+#ifndef MPU9250_FIFO_WITH_COMPASS
 #define MPU9250_FIFO_WITH_COMPASS 1
+#endif
 
 //  FIFO transfer size
 
@@ -92,10 +96,22 @@ public:
     virtual bool IMURead();
     virtual int IMUGetPollInterval();
 
+    //  getFifoPoller() gives access to the FIFO prediction statistics
+
+    RTIMUFifoPoller *getFifoPoller() { return &m_fifoPoller; }
+
+    //  getTimestamp() gives access to the sample clock estimate and its error statistics
+
+    RTIMUTimestamp *getTimestamp() { return &m_timestamp; }
+
 protected:
 
     RTFLOAT m_compassAdjust[3];                             // the compass fuse ROM values converted for use
 
+    virtual bool IMUDataReadyInit() { return true; }        // raw data ready interrupt is always enabled
+    virtual int IMUDataReadyEdge() { return FALLING; }      // INT pin is configured active low
+    virtual void IMUProcess();                              // adds the temperature bias
+
 private:
     bool setGyroConfig();
     bool setAccelConfig();
@@ -103,6 +119,7 @@ private:
     bool compassSetup();
     bool setCompassRate();
     bool resetFifo();
+    void fifoSamplesRead(int count);
     bool bypassOn();
     bool bypassOff();
 
@@ -120,6 +137,9 @@ private:
     RTFLOAT m_gyroScale;
     RTFLOAT m_accelScale;
 
+    RTIMUFifoPoller m_fifoPoller;                           // avoids most FIFO count reads
+    RTIMUTimestamp m_timestamp;                             // sample clock estimate
+
 #ifdef MPU9250_CACHE_MODE
 
     MPU9250_CACHE_BLOCK m_cache[MPU9250_CACHE_BLOCK_COUNT]; // the cache itself
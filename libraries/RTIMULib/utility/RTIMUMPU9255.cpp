@@ -217,6 +217,8 @@ bool RTIMUMPU9255::IMUInit()
     setGyroFsr(m_settings->m_MPU9255GyroFsr);
     setAccelFsr(m_settings->m_MPU9255AccelFsr);
 
+    m_timestamp.reset(m_sampleRate);
+
     setCalibrationData();
 
     //  enable the bus
@@ -303,6 +305,8 @@ bool RTIMUMPU9255::resetFifo()
     if (!m_settings->HALWrite(m_slaveAddr, MPU9255_INT_ENABLE, 1, "Writing int enable"))
         return false;
 
+    m_timestamp.resync();
+
 
     #if MPU9255_FIFO_WITH_TEMP == 1
         #if MPU9255_FIFO_WITH_COMPASS == 1 // compass and temp in fifo
@@ -540,18 +544,21 @@ bool RTIMUMPU9255::IMURead()
     unsigned char fifoData[MPU9255_FIFO_CHUNK_SIZE];
     #if MPU9255_FIFO_WITH_COMPASS == 0
     unsigned char compassData[8]; // compass data goes here if it is not coming in through FIFO
+    bool compassRead = true;      // false if compassData is a copy already used by an earlier sample
     #endif
     #if MPU9255_FIFO_WITH_TEMP == 0
     unsigned char temperatureData[2]; // if temperature data is not coming in through FIFO
     #endif
+    uint64_t now = RTMath::currentUSecsSinceEpoch();
+
     if (!m_settings->HALRead(m_slaveAddr, MPU9255_FIFO_COUNT_H, 2, fifoCount, "Failed to read fifo count"))
          return false;
 
     count = ((unsigned int)fifoCount[0] << 8) + fifoCount[1];
+    m_timestamp.fifoCount(now, count / MPU9255_FIFO_CHUNK_SIZE);
     if (count == 512) {
         HAL_INFO("MPU-9255 fifo has overflowed");
         resetFifo();
-        m_imuData.timestamp += m_sampleInterval * (512 / MPU9255_FIFO_CHUNK_SIZE + 1); // try to fix timestamp
         return false;
     }
 
@@ -563,6 +570,7 @@ bool RTIMUMPU9255::IMURead()
 
         if (!m_settings->HALRead(m_slaveAddr, MPU9255_FIFO_R_W, MPU9255_FIFO_CHUNK_SIZE, fifoData, "Failed to read fifo data"))
             return false;
+        m_timestamp.samplesRead(1);
 
         #if MPU9255_FIFO_WITH_TEMP == 0 // read temp from registers
         if (!m_settings->HALRead(m_slaveAddr, MPU9255_TEMP_OUT_H, 2,
@@ -578,7 +586,7 @@ bool RTIMUMPU9255::IMURead()
         if (count >= (MPU9255_CACHE_SIZE * MPU9255_FIFO_CHUNK_SIZE)) {
             if (m_cacheCount == MPU9255_CACHE_BLOCK_COUNT) {
                 // all cache blocks are full - discard oldest and update timestamp to account for lost samples
-                m_imuData.timestamp += m_sampleInterval * m_cache[m_cacheOut].count;
+                m_timestamp.skip(m_cache[m_cacheOut].count);
                 if (++m_cacheOut == MPU9255_CACHE_BLOCK_COUNT)
                     m_cacheOut = 0;
                 m_cacheCount--;
@@ -589,9 +597,14 @@ bool RTIMUMPU9255::IMURead()
             if (blockCount > MPU9255_CACHE_SIZE)
                 blockCount = MPU9255_CACHE_SIZE;
 
-            if (!m_settings->HALRead(m_slaveAddr, MPU9255_FIFO_R_W, MPU9255_FIFO_CHUNK_SIZE * blockCount,
-                    m_cache[m_cacheIn].data, "Failed to read fifo data"))
+            if (!m_settings->HALReadBlock(m_slaveAddr, MPU9255_FIFO_R_W, MPU9255_FIFO_CHUNK_SIZE * blockCount,
+                    m_cache[m_cacheIn].data, "Failed to read fifo data")) {
+                //  a part read block leaves the FIFO out of step with the sample boundaries
+
+                resetFifo();
                 return false;
+            }
+            m_timestamp.samplesRead(blockCount);
 
             #if MPU9255_FIFO_WITH_TEMP == 0 // read temp from registers
             if (!m_settings->HALRead(m_slaveAddr, MPU9255_TEMP_OUT_H, 2,
@@ -619,6 +632,7 @@ bool RTIMUMPU9255::IMURead()
         memcpy(fifoData, m_cache[m_cacheOut].data + m_cache[m_cacheOut].index, MPU9255_FIFO_CHUNK_SIZE);
         #if MPU9255_FIFO_WITH_COMPASS == 0
         memcpy(compassData, m_cache[m_cacheOut].compass, 8);
+        compassRead = m_cache[m_cacheOut].index == 0;       // one compass read serves the whole block
         #endif
         #if MPU9255_FIFO_WITH_TEMP == 0
         memcpy(temperatureData, m_cache[m_cacheOut].temperature, 2);            
@@ -642,8 +656,9 @@ bool RTIMUMPU9255::IMURead()
         while (count >= MPU9255_FIFO_CHUNK_SIZE * 10) {
             if (!m_settings->HALRead(m_slaveAddr, MPU9255_FIFO_R_W, MPU9255_FIFO_CHUNK_SIZE, fifoData, "Failed to read fifo data"))
                 return false;
+            m_timestamp.samplesRead(1);
             count -= MPU9255_FIFO_CHUNK_SIZE;
-            m_imuData.timestamp += m_sampleInterval;
+            m_timestamp.skip(1);
         }
     }
 
@@ -652,6 +667,7 @@ bool RTIMUMPU9255::IMURead()
 
     if (!m_settings->HALRead(m_slaveAddr, MPU9255_FIFO_R_W, MPU9255_FIFO_CHUNK_SIZE, fifoData, "Failed to read fifo data"))
         return false;
+    m_timestamp.samplesRead(1);
     #if MPU9255_FIFO_WITH_TEMP == 0
     if (!m_settings->HALRead(m_slaveAddr, MPU9255_TEMP_OUT_H, 2, temperatureData, "Failed to read temperature data"))
         return false;
@@ -697,6 +713,17 @@ bool RTIMUMPU9255::IMURead()
         #endif
 	#endif
 
+    //  ST1 DRDY is only set when the slave read picked up a fresh magnetometer
+    //  measurement, ST2 HOFL marks a saturated one
+
+    #if MPU9255_FIFO_WITH_COMPASS == 1
+        unsigned char *compassStatus = fifoData + MPU9255_FIFO_CHUNK_SIZE - 8;
+        m_imuData.compassNew = (compassStatus[0] & 0x01) && !(compassStatus[7] & 0x08);
+    #else
+        unsigned char *compassStatus = compassData;
+        m_imuData.compassNew = compassRead && (compassStatus[0] & 0x01) && !(compassStatus[7] & 0x08);
+    #endif
+
     //  sort out gyro axes
 
     m_imuData.gyro.setX(m_imuData.gyro.x());
@@ -721,14 +748,20 @@ bool RTIMUMPU9255::IMURead()
     m_imuData.compass.setX(m_imuData.compass.y());
     m_imuData.compass.setY(-temp);
 
-    if (m_firstTime)
-        m_imuData.timestamp = RTMath::currentUSecsSinceEpoch();
-    else
-        m_imuData.timestamp += m_sampleInterval;
+    m_imuData.timestamp = m_timestamp.next();
 
     m_firstTime = false;
 	
-    //  now do standard processing
+    //  now do standard processing, unless the data ready interrupt is reading
+
+    if (!m_readRawOnly)
+        IMUProcess();
+
+    return true;
+}
+
+void RTIMUMPU9255::IMUProcess()
+{
     if (m_imuData.temperatureValid == true) {
         // Check if temperature changed
         if (fabs(m_imuData.temperature - m_temperature_previous) >= TEMPERATURE_DELTA) {
@@ -739,13 +772,5 @@ bool RTIMUMPU9255::IMURead()
         // Then do
         handleTempBias(); 	// temperature Correction
     }
-    handleGyroBias();
-    calibrateAverageCompass();
-    calibrateAccel();
-
-    //  now update the filter
-
-    updateFusion();
-
-    return true;
+    RTIMU::IMUProcess();
 }
\ No newline at end of file
@@ -29,12 +29,15 @@
 #define	_RTIMUMPU9255_H
 
 #include "RTIMU.h"
+#include "RTIMUTimestamp.h"
 
 //  Define this symbol to use cache mode
 
 #define MPU9255_CACHE_MODE
 #define MPU9255_FIFO_WITH_TEMP    1
+#ifndef MPU9255_FIFO_WITH_COMPASS
 #define MPU9255_FIFO_WITH_COMPASS 1
+#endif
 //  FIFO transfer size
 
 #if MPU9255_FIFO_WITH_TEMP == 1
@@ -91,10 +94,18 @@ public:
     virtual bool IMURead();
     virtual int IMUGetPollInterval();
 
+    //  getTimestamp() gives access to the sample clock estimate and its error statistics
+
+    RTIMUTimestamp *getTimestamp() { return &m_timestamp; }
+
 protected:
 
     RTFLOAT m_compassAdjust[3];                             // the compass fuse ROM values converted for use
 
+    virtual bool IMUDataReadyInit() { return true; }        // raw data ready interrupt is always enabled
+    virtual int IMUDataReadyEdge() { return FALLING; }      // INT pin is configured active low
+    virtual void IMUProcess();                              // adds the temperature bias
+
 private:
     bool setGyroConfig();
     bool setAccelConfig();
@@ -119,6 +130,8 @@ private:
     RTFLOAT m_gyroScale;
     RTFLOAT m_accelScale;
 
+    RTIMUTimestamp m_timestamp;                             // sample clock estimate
+
 
 #ifdef MPU9255_CACHE_MODE
     MPU9255_CACHE_BLOCK m_cache[MPU9255_CACHE_BLOCK_COUNT]; // the cache itself
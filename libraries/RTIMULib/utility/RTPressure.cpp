@@ -33,6 +33,10 @@
 
 #define PRESSURE_AVG_HISTORY   20                     // size of moving average filter
 
+//  MS56xx/MS58xx conversion times in uS for OSR 256 to 8192 (datasheet maximums)
+
+static const int ms5611ConversionTimes[] = {600, 1170, 2280, 4540, 9040, 18080};
+
 RTPressure *RTPressure::createPressure(RTIMUSettings *settings)
 {
     switch (settings->m_pressureType) {
@@ -74,6 +78,7 @@ RTPressure::RTPressure(RTIMUSettings *settings)
 {
     m_settings = settings;
     m_pressure_avg = new RunningAverage(PRESSURE_AVG_HISTORY);
+    m_readyTime = 0;
 }
 
 RTPressure::~RTPressure()
@@ -85,3 +90,22 @@ RTFLOAT RTPressure::updateAveragePressure(RTFLOAT& pressure)
     m_pressure_avg->addValue(pressure);
     return m_pressure_avg->getAverage();
 }
+
+int RTPressure::ms5611OSRIndex(int osr, int defaultIndex, int maxIndex)
+{
+    int index = 0;
+
+    if (osr <= 0)
+        return defaultIndex;
+
+    //  round up to the next supported ratio
+
+    while ((index < maxIndex) && ((256 << index) < osr))
+        index++;
+    return index;
+}
+
+int RTPressure::ms5611ConversionTime(int index)
+{
+    return ms5611ConversionTimes[index];
+}
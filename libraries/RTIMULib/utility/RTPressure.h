@@ -51,13 +51,25 @@ public:
     virtual bool pressureRead() = 0;                        // get latest value
     virtual int  pressureGetPollInterval() = 0;             // get recommended polling interval
 
+    //  Time in uS at which the next pressureRead() call can make progress. A time in the past
+    //  means the sensor is idle or has a conversion ready.
+
+    uint64_t pressureReadyTime() { return m_readyTime; }
+
     const PRESSURE_DATA& getPressureData() { return m_pressureData; }
     const RTFLOAT& getPressureTemp() { return m_pressureData.temperature; } // gets temperature data in C
 
 protected:
+    //  MS56xx/MS58xx helpers - convert an oversampling ratio setting to an OSR index and
+    //  look up the worst case conversion time in uS for an index
+
+    static int ms5611OSRIndex(int osr, int defaultIndex, int maxIndex);
+    static int ms5611ConversionTime(int index);
+
     RTIMUSettings *m_settings;                              // the settings object pointer
     PRESSURE_DATA m_pressureData;                           // the data from the pressure sensor
     RunningAverage *m_pressure_avg;                         // Running average for pressure sensor
+    uint64_t m_readyTime;                                   // when the running conversion completes
 
 };
 
@@ -93,14 +93,14 @@ bool RTPressureBMP180::pressureRead()
 				return false;
 			} else {
 				m_state = BMP180_STATE_TEMPERATURE;
-				m_timer = RTMath::currentUSecsSinceEpoch();
+				m_readyTime = RTMath::currentUSecsSinceEpoch() + 4500;
 			}
         break;
 
         case BMP180_STATE_TEMPERATURE:
 			// Read temperature
 			// printf("State: temp\n");
-			if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 4500) // takes 4.5ms to convert temperature
+			if (RTMath::currentUSecsSinceEpoch() < m_readyTime) // takes 4.5ms to convert temperature
 					return false;
 			if (!m_settings->HALRead(m_pressureAddr, BMP180_REG_SCO, 1, data, "Failed to read BMP180 temp conv status")) {
 				m_state = BMP180_STATE_IDLE;
@@ -119,13 +119,13 @@ bool RTPressureBMP180::pressureRead()
 				return false;
 			}
 			m_state = BMP180_STATE_PRESSURE;
-			m_timer = RTMath::currentUSecsSinceEpoch();
+			m_readyTime = RTMath::currentUSecsSinceEpoch() + 4500;
         break;
 
         case BMP180_STATE_PRESSURE:
 			// read preassure
 			// printf("State: pressure\n");
-			if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 4500) // takes 4.5ms to convert pressure at ultra low power setting
+			if (RTMath::currentUSecsSinceEpoch() < m_readyTime) // takes 4.5ms to convert pressure at ultra low power setting
 					return false;
 			if (!m_settings->HALRead(m_pressureAddr, BMP180_REG_SCO, 1, data, "Failed to read BMP180 pressure conv status")) {
 				m_state = BMP180_STATE_IDLE;
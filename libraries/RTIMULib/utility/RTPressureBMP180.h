@@ -77,8 +77,6 @@ private:
     uint16_t m_rawPressure;
     uint16_t m_rawTemperature;
 
-    uint64_t m_timer;                                       // used to time coversions
-
 };
 
 #endif // _RTPRESSUREBMP180_H_
@@ -109,6 +109,21 @@
 #define MD5611_ADC_1024             0x04 //Conversion Precision
 #define MD5611_ADC_2048             0x06 //Conversion Precision
 #define MD5611_ADC_4096             0x08 //Conversion Precision
+#define MD5611_ADC_8192             0x0a //Conversion Precision, MS5637 and MS5837 only
+#define MS5611_CMD_ADC_D2           0x10 // added to a conversion command to convert D2
+
+//  Oversampling ratio indices. Index n selects OSR 256 << n, the conversion
+//  command is MS5611_CMD_ADC_CONV + 2 * n (+ MS5611_CMD_ADC_D2 for temperature)
+
+#define MS5611_OSR_256              0
+#define MS5611_OSR_512              1
+#define MS5611_OSR_1024             2
+#define MS5611_OSR_2048             3
+#define MS5611_OSR_4096             4
+#define MS5611_OSR_8192             5
+
+#define MS5611_CMD_CONV_D1_OSR(osr) (MS5611_CMD_ADC_CONV + 2 * (osr))
+#define MS5611_CMD_CONV_D2_OSR(osr) (MS5611_CMD_ADC_CONV + MS5611_CMD_ADC_D2 + 2 * (osr))
   
 //----------------------------------------------------------
 //
@@ -25,6 +25,10 @@
 
 RTPressureMS5611::RTPressureMS5611(RTIMUSettings *settings) : RTPressure(settings)
 {
+    m_osrD1 = MS5611_OSR_4096;
+    m_osrD2 = MS5611_OSR_4096;
+    m_tempDecimation = 1;
+    m_tempCountdown = 0;
 }
 
 RTPressureMS5611::~RTPressureMS5611()
@@ -33,9 +37,11 @@ RTPressureMS5611::~RTPressureMS5611()
 
 int RTPressureMS5611::pressureGetPollInterval()
 {
-    // return (400 / 122); // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 ms
-    // osr 4096 takes 8.22ms
-    return (3);
+    // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 ms
+    // poll about three times per pressure conversion
+    int interval = ms5611ConversionTime(m_osrD1) / 3000;
+
+    return interval > 0 ? interval : 1;
 }
 
 bool RTPressureMS5611::pressureInit()
@@ -45,6 +51,11 @@ bool RTPressureMS5611::pressureInit()
 
     m_pressureAddr = m_settings->m_I2CPressureAddress;
 
+    m_osrD1 = ms5611OSRIndex(m_settings->m_pressureOSR, MS5611_OSR_4096, MS5611_OSR_4096);
+    m_osrD2 = ms5611OSRIndex(m_settings->m_pressureTempOSR, MS5611_OSR_4096, MS5611_OSR_4096);
+    m_tempDecimation = m_settings->m_pressureTempDecimation > 1 ? m_settings->m_pressureTempDecimation : 1;
+    m_tempCountdown = 0;                                    // first conversion is temperature
+
     // get calibration data
 
     for (int i = 0; i < 6; i++) {
@@ -63,92 +74,107 @@ bool RTPressureMS5611::pressureInit()
 bool RTPressureMS5611::pressureRead()
 {
     uint8_t data[3];
-    bool validReadings = false;
 
     switch (m_state) {
         case MS5611_STATE_IDLE:
-        // start pressure conversion
-        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1, 0, 0, "Failed to start MS5611 pressure conversion")) {
-            return false;
-        } else {
-            m_state = MS5611_STATE_PRESSURE;
-            m_timer = RTMath::currentUSecsSinceEpoch();
-        }
+        startConversion();
         break;
 
-        case MS5611_STATE_PRESSURE:
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 9040)
+        case MS5611_STATE_TEMPERATURE:
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
             return false;                                          // not time yet
-        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 pressure")) {
-            return false;
-        }
-        m_D1 = (((uint32_t)data[0]) << 16) + (((uint32_t)data[1]) << 8) + (uint32_t)data[2];
-
-        // start temperature conversion
-
-        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2, 0, 0, "Failed to start MS5611 temperature conversion")) {
+        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 temperature")) {
             return false;
-        } else {
-            m_state = MS5611_STATE_TEMPERATURE;
-            m_timer = RTMath::currentUSecsSinceEpoch();
         }
+        m_D2 = (((uint32_t)data[0]) << 16) + (((uint32_t)data[1]) << 8) + (uint32_t)data[2];
+        calculateTemperature();
+        m_tempCountdown = m_tempDecimation;
+        startConversion();
         break;
 
-        case MS5611_STATE_TEMPERATURE:
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 9040)
+        case MS5611_STATE_PRESSURE:
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
             return false;
-        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 temperature")) {
+        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 pressure")) {
             return false;
         }
-        m_D2 = (((uint32_t)data[0]) << 16) + (((uint32_t)data[1]) << 8) + (uint32_t)data[2];
+        m_D1 = (((uint32_t)data[0]) << 16) + (((uint32_t)data[1]) << 8) + (uint32_t)data[2];
 
         //  call this function for testing only
         //  should give T = 2007 (20.07C) and pressure 100009 (1000.09hPa)
 
         // setTestData();
+        // calculateTemperature();
 
-        //  now calculate the real values
+        calculatePressure();
+        m_tempCountdown--;
 
-        int64_t deltaT = (int32_t)m_D2 - (((int32_t)m_calData[4]) << 8);
+        //  keep the sensor converting while the caller uses this result
 
-        int32_t temperature = 2000 + ((deltaT * (int64_t)m_calData[5]) >> 23); // note - this needs to be divided by 100
+        startConversion();
+        return true;
+    }
+    return false;
+}
 
-        int64_t offset = ((int64_t)m_calData[1] << 16) + (((int64_t)m_calData[3] * deltaT) >> 7);
-        int64_t sens = ((int64_t)m_calData[0] << 15) + (((int64_t)m_calData[2] * deltaT) >> 8);
+bool RTPressureMS5611::startConversion()
+{
+    if (m_tempCountdown <= 0) {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2_OSR(m_osrD2), 0, 0, "Failed to start MS5611 temperature conversion")) {
+            m_state = MS5611_STATE_IDLE;
+            return false;
+        }
+        m_state = MS5611_STATE_TEMPERATURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD2);
+    } else {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1_OSR(m_osrD1), 0, 0, "Failed to start MS5611 pressure conversion")) {
+            m_state = MS5611_STATE_IDLE;
+            return false;
+        }
+        m_state = MS5611_STATE_PRESSURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD1);
+    }
+    return true;
+}
 
-        //  do second order temperature compensation
+void RTPressureMS5611::calculateTemperature()
+{
+    int64_t deltaT = (int32_t)m_D2 - (((int32_t)m_calData[4]) << 8);
 
-        if (temperature < 2000) {
-            int64_t T2 = (deltaT * deltaT) >> 31;
-            int64_t offset2 = 5 * ((temperature - 2000) * (temperature - 2000)) / 2;
-            int64_t sens2 = offset2 / 2;
-            if (temperature < -1500) {
-                offset2 += 7 * (temperature + 1500) * (temperature + 1500);
-                sens2 += 11 * ((temperature + 1500) * (temperature + 1500)) / 2;
-            }
-            temperature -= T2;
-            offset -= offset2;
-            sens -=sens2;
-        }
+    int32_t temperature = 2000 + ((deltaT * (int64_t)m_calData[5]) >> 23); // note - this needs to be divided by 100
 
-        m_pressureData.pressure = (RTFLOAT)(((((int64_t)m_D1 * sens) >> 21) - offset) >> 15) / (RTFLOAT)100.0;
-        m_pressureData.temperature = (RTFLOAT)temperature/(RTFLOAT)100;
-        m_pressureData.pressureValid = true;
-        m_pressureData.temperatureValid = true;
-        m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
+    int64_t offset = ((int64_t)m_calData[1] << 16) + (((int64_t)m_calData[3] * deltaT) >> 7);
+    int64_t sens = ((int64_t)m_calData[0] << 15) + (((int64_t)m_calData[2] * deltaT) >> 8);
 
-        // printf("Temp: %f, pressure: %f\n", m_temperature, m_pressure);
+    //  do second order temperature compensation
 
-        validReadings = true;
-        m_state = MS5611_STATE_IDLE;
-        break;
+    if (temperature < 2000) {
+        int64_t T2 = (deltaT * deltaT) >> 31;
+        int64_t offset2 = 5 * ((temperature - 2000) * (temperature - 2000)) / 2;
+        int64_t sens2 = offset2 / 2;
+        if (temperature < -1500) {
+            offset2 += 7 * (temperature + 1500) * (temperature + 1500);
+            sens2 += 11 * ((temperature + 1500) * (temperature + 1500)) / 2;
+        }
+        temperature -= T2;
+        offset -= offset2;
+        sens -=sens2;
     }
 
-	if (validReadings) {
-      return true;
-	} else {
-      return false;
-    }
+    m_temperature = temperature;
+    m_offset = offset;
+    m_sens = sens;
+}
+
+void RTPressureMS5611::calculatePressure()
+{
+    m_pressureData.pressure = (RTFLOAT)(((((int64_t)m_D1 * m_sens) >> 21) - m_offset) >> 15) / (RTFLOAT)100.0;
+    m_pressureData.temperature = (RTFLOAT)m_temperature/(RTFLOAT)100;
+    m_pressureData.pressureValid = true;
+    m_pressureData.temperatureValid = true;
+    m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
+
+    // printf("Temp: %f, pressure: %f\n", m_temperature, m_pressure);
 }
 
 void RTPressureMS5611::setTestData()
@@ -25,6 +25,10 @@
 
 RTPressureMS5637::RTPressureMS5637(RTIMUSettings *settings) : RTPressure(settings)
 {
+    m_osrD1 = MS5611_OSR_4096;
+    m_osrD2 = MS5611_OSR_4096;
+    m_tempDecimation = 1;
+    m_tempCountdown = 0;
 }
 
 RTPressureMS5637::~RTPressureMS5637()
@@ -33,9 +37,11 @@ RTPressureMS5637::~RTPressureMS5637()
 
 int RTPressureMS5637::pressureGetPollInterval()
 {
-    // return (400 / 122); // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 /16.44 ms
-    // osr 4096 takes 8.22ms
-    return (3);
+    // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 /16.44 ms
+    // poll about three times per pressure conversion
+    int interval = ms5611ConversionTime(m_osrD1) / 3000;
+
+    return interval > 0 ? interval : 1;
 }
 
 bool RTPressureMS5637::pressureInit()
@@ -45,6 +51,11 @@ bool RTPressureMS5637::pressureInit()
 
     m_pressureAddr = m_settings->m_I2CPressureAddress;
 
+    m_osrD1 = ms5611OSRIndex(m_settings->m_pressureOSR, MS5611_OSR_4096, MS5611_OSR_8192);
+    m_osrD2 = ms5611OSRIndex(m_settings->m_pressureTempOSR, MS5611_OSR_4096, MS5611_OSR_8192);
+    m_tempDecimation = m_settings->m_pressureTempDecimation > 1 ? m_settings->m_pressureTempDecimation : 1;
+    m_tempCountdown = 0;                                    // first conversion is temperature
+
     // get calibration data
 
     for (int i = 0; i < 6; i++) {
@@ -63,83 +74,105 @@ bool RTPressureMS5637::pressureInit()
 bool RTPressureMS5637::pressureRead()
 {
     uint8_t data[3];
-    bool validReadings = false;
 
     switch (m_state) {
         case MS5637_STATE_IDLE:
-		// start pressure conversion, is set to 4096 and 8.22ms
-		if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1, 0, 0, "Failed to start MS5611 pressure conversion")) {
-			return false;
-		} else {
-			m_state = MS5637_STATE_PRESSURE;
-			m_timer = RTMath::currentUSecsSinceEpoch();
-		}
-        break;
-
-        case MS5637_STATE_PRESSURE:
-		// read pressure
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 9040)  // at OSR 4096 needs 8.22ms
-			return false;
-        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 pressure")) {
-			return false;
-        }
-        m_D1 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
-        // start temperature conversion
-        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2, 0, 0, "Failed to start MS5611 temperature conversion")) {
-			return false;
-        } else {
-            m_state = MS5637_STATE_TEMPERATURE;
-            m_timer = RTMath::currentUSecsSinceEpoch();
-        }
+        startConversion();
         break;
 
         case MS5637_STATE_TEMPERATURE:
-		// read temperature
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 9040) // at OSR 4096 need 8.22ms
-            return false;                                         // not time yet
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
+            return false;                                          // not time yet
         if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 temperature")) {
             return false;
         }
         m_D2 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
+        calculateTemperature();
+        m_tempCountdown = m_tempDecimation;
+        startConversion();
+        break;
+
+        case MS5637_STATE_PRESSURE:
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
+            return false;
+        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5611 pressure")) {
+            return false;
+        }
+        m_D1 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
+
         //  call this function for testing only
         //  should give T = 2000 (20.00C) and pressure 110002 (1100.02hPa)
-        //  setTestData();
-        //  now calculate the real values
-        int64_t deltaT = (int32_t)m_D2 - (((int32_t)m_calData[4]) << 8);
-        int32_t temperature = 2000 + ((deltaT * (int64_t)m_calData[5]) >> 23); // note - this still needs to be divided by 100
-        int64_t offset = (((int64_t)m_calData[1]) << 17) + ((m_calData[3] * deltaT) >> 6);
-        int64_t sens = (((int64_t)m_calData[0]) << 16) + ((m_calData[2] * deltaT) >> 7);
-        //  do second order temperature compensation
-        if (temperature < 2000) {
-            int64_t T2 = (3 * (deltaT * deltaT)) >> 33;
-            int64_t offset2 = 61 * ((temperature - 2000) * (temperature - 2000)) / 16;
-            int64_t sens2 = 29 * ((temperature - 2000) * (temperature - 2000)) / 16;
-            if (temperature < -1500) {
-                offset2 += 17 * (temperature + 1500) * (temperature + 1500);
-                sens2 += 9 * ((temperature + 1500) * (temperature + 1500));
-            }
-            temperature -= T2;
-            offset -= offset2;
-            sens -=sens2;
-        } else {
-            temperature -= (5 * (deltaT * deltaT)) >> 38;
+
+        // setTestData();
+        // calculateTemperature();
+
+        calculatePressure();
+        m_tempCountdown--;
+
+        //  keep the sensor converting while the caller uses this result
+
+        startConversion();
+        return true;
+    }
+    return false;
+}
+
+bool RTPressureMS5637::startConversion()
+{
+    if (m_tempCountdown <= 0) {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2_OSR(m_osrD2), 0, 0, "Failed to start MS5611 temperature conversion")) {
+            m_state = MS5637_STATE_IDLE;
+            return false;
         }
-        m_pressureData.pressure = (RTFLOAT)(((((int64_t)m_D1 * sens) >> 21) - offset) >> 15) / (RTFLOAT)100.0;
-        m_pressureData.temperature = (RTFLOAT)temperature/(RTFLOAT)100;
-        m_pressureData.temperatureValid = true;
-        m_pressureData.pressureValid =  true;
-        m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
-
-        // printf("Temp: %f, pressure: %f\n", m_temperature, m_pressure);
-        validReadings = true;
-        m_state = MS5637_STATE_IDLE;
-        break;
+        m_state = MS5637_STATE_TEMPERATURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD2);
+    } else {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1_OSR(m_osrD1), 0, 0, "Failed to start MS5611 pressure conversion")) {
+            m_state = MS5637_STATE_IDLE;
+            return false;
+        }
+        m_state = MS5637_STATE_PRESSURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD1);
     }
-	if (validReadings) {
-      return true;
-	} else {
-      return false;
+    return true;
+}
+
+void RTPressureMS5637::calculateTemperature()
+{
+    int64_t deltaT = (int32_t)m_D2 - (((int32_t)m_calData[4]) << 8);
+    int32_t temperature = 2000 + ((deltaT * (int64_t)m_calData[5]) >> 23); // note - this still needs to be divided by 100
+    int64_t offset = (((int64_t)m_calData[1]) << 17) + ((m_calData[3] * deltaT) >> 6);
+    int64_t sens = (((int64_t)m_calData[0]) << 16) + ((m_calData[2] * deltaT) >> 7);
+    //  do second order temperature compensation
+    if (temperature < 2000) {
+        int64_t T2 = (3 * (deltaT * deltaT)) >> 33;
+        int64_t offset2 = 61 * ((temperature - 2000) * (temperature - 2000)) / 16;
+        int64_t sens2 = 29 * ((temperature - 2000) * (temperature - 2000)) / 16;
+        if (temperature < -1500) {
+            offset2 += 17 * (temperature + 1500) * (temperature + 1500);
+            sens2 += 9 * ((temperature + 1500) * (temperature + 1500));
+        }
+        temperature -= T2;
+        offset -= offset2;
+        sens -=sens2;
+    } else {
+        temperature -= (5 * (deltaT * deltaT)) >> 38;
     }
+
+    m_temperature = temperature;
+    m_offset = offset;
+    m_sens = sens;
+}
+
+void RTPressureMS5637::calculatePressure()
+{
+    m_pressureData.pressure = (RTFLOAT)(((((int64_t)m_D1 * m_sens) >> 21) - m_offset) >> 15) / (RTFLOAT)100.0;
+    m_pressureData.temperature = (RTFLOAT)m_temperature/(RTFLOAT)100;
+    m_pressureData.temperatureValid = true;
+    m_pressureData.pressureValid =  true;
+    m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
+
+    // printf("Temp: %f, pressure: %f\n", m_temperature, m_pressure);
 }
 
 void RTPressureMS5637::setTestData()
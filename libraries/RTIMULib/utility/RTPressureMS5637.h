@@ -48,6 +48,10 @@ public:
 
 private:
 
+    bool startConversion();                                 // starts D1, or D2 when the temperature is due
+    void calculateTemperature();                            // compensation terms from m_D2
+    void calculatePressure();                               // pressure from m_D1 and the cached terms
+
     void setTestData();
 
     unsigned char m_pressureAddr;                           // I2C address
@@ -59,7 +63,15 @@ private:
     uint32_t m_D1;
     uint32_t m_D2;
 
-    uint64_t m_timer;                                       // used to time coversions
+    int m_osrD1;                                            // pressure OSR index
+    int m_osrD2;                                            // temperature OSR index
+    int m_tempDecimation;                                   // D1 conversions per D2 conversion
+    int m_tempCountdown;                                    // D1 conversions left before the next D2
+
+    int32_t m_temperature;                                  // compensation terms cached from the last D2
+    int64_t m_offset;
+    int64_t m_sens;
+
 };
 
 #endif // _RTPRESSUREMS5637_H_
@@ -27,6 +27,10 @@
 
 RTPressureMS5803::RTPressureMS5803(RTIMUSettings *settings) : RTPressure(settings)
 {
+    m_osrD1 = MS5611_OSR_4096;
+    m_osrD2 = MS5611_OSR_4096;
+    m_tempDecimation = 1;
+    m_tempCountdown = 0;
 }
 
 RTPressureMS5803::~RTPressureMS5803()
@@ -35,9 +39,11 @@ RTPressureMS5803::~RTPressureMS5803()
 
 int RTPressureMS5803::pressureGetPollInterval()
 {
-    // return (400 / 122); // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 ms
-    // osr 4096 takes 8.22ms
-    return (3);
+    // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 ms
+    // poll about three times per pressure conversion
+    int interval = ms5611ConversionTime(m_osrD1) / 3000;
+
+    return interval > 0 ? interval : 1;
 }
 
 bool RTPressureMS5803::reset()
@@ -59,6 +65,11 @@ bool RTPressureMS5803::pressureInit()
 
     m_pressureAddr = m_settings->m_I2CPressureAddress;
 
+    m_osrD1 = ms5611OSRIndex(m_settings->m_pressureOSR, MS5611_OSR_4096, MS5611_OSR_4096);
+    m_osrD2 = ms5611OSRIndex(m_settings->m_pressureTempOSR, MS5611_OSR_4096, MS5611_OSR_4096);
+    m_tempDecimation = m_settings->m_pressureTempDecimation > 1 ? m_settings->m_pressureTempDecimation : 1;
+    m_tempCountdown = 0;                                    // first conversion is temperature
+
     // get calibration data
     // skip first and last entry in PROM table
     // C0= 0
@@ -85,114 +96,119 @@ bool RTPressureMS5803::pressureInit()
 bool RTPressureMS5803::pressureRead()
 {
     uint8_t data[3];
-    int32_t deltaT;
-    int32_t temperature;
-    int64_t offset;
-    int64_t sens;
-    int64_t T2;
-    int64_t offset2;
-    int64_t sens2;
-    
-    bool validReadings = false;
 
     switch (m_state) {
         case MS5803_STATE_IDLE:
-        // start pressure conversion with maximum precision 4096
-        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1, 0, 0, "Failed to start MS5803 pressure conversion")) {
+        startConversion();
+        break;
+
+        case MS5803_STATE_TEMPERATURE:
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
+            return false;                                          // not time yet
+        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5803 temperature")) {
             return false;
-        } else {
-            m_state = MS5803_STATE_PRESSURE;
-            m_timer = RTMath::currentUSecsSinceEpoch();
         }
+        m_D2 = ((uint32_t)data[0] << 16) + ((uint32_t)data[1] << 8) + (uint32_t)data[2];
+        //printf("D2: %ld\n", m_D2);
+        calculateTemperature();
+        m_tempCountdown = m_tempDecimation;
+        startConversion();
         break;
 
         case MS5803_STATE_PRESSURE:
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 9040) // need to wait 10ms until conversion complete at highest precision
-            return false;  // not time yet
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
+            return false;
         if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS5803 pressure")) {
             return false;
         }
         m_D1 = ((uint32_t)data[0] << 16) + ((uint32_t)data[1] << 8) + (uint32_t)data[2];
-
         //printf("D1: %ld\n", m_D1);
 
-        // start temperature conversion
+        calculatePressure();
+        m_tempCountdown--;
 
-        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2, 0, 0, "Failed to start MS5803 temperature conversion")) {
-            return false;
-        } else {
-            m_state = MS5803_STATE_TEMPERATURE;
-            m_timer = RTMath::currentUSecsSinceEpoch();
-        }
-        break;
+        //  keep the sensor converting while the caller uses this result
 
-        case MS5803_STATE_TEMPERATURE:
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 9040) // takes 10ms until conversion at highest precision
-           return false;  // not time yet
-        if (!m_settings->HALRead(m_pressureAddr, MS5611_CMD_ADC, 3, data, "Failed to read MS58031 temperature")) {
-           return false;
-        }
-		
-        m_D2 = ((uint32_t)data[0] << 16) + ((uint32_t)data[1] << 8) + (uint32_t)data[2];
-        //printf("D2: %ld\n", m_D2);
+        startConversion();
+        return true;
+    }
+    return false;
+}
 
-        //  now calculate temperature
-        deltaT = m_D2 - ((int32_t)m_calData[5] << 8);
-        temperature = (((int64_t)deltaT * m_calData[6]) >> 23) + 2000;
-        
-        //printf("deltaT: %ld\n", deltaT);
-        //printf("temperature: %ld\n", temperature);
-
-
-        //  do second order temperature compensation
-        if (temperature < 2000) {
-            // low temperature below 20C
-            T2 = 3 * (((int64_t)deltaT * deltaT) >> 33);
-            offset2 = 3 * ((temperature - 2000) * (temperature - 2000)) / 2;
-            sens2 = 5 * ((temperature - 2000) * (temperature - 2000)) / 8;
-            if (temperature < -1500) { // below -15C
-                offset2 = offset2 + 7 * ((temperature + 1500) * (temperature + 1500));
-                sens2 =  sens2    + 4 * ((temperature + 1500) * (temperature + 1500));
-            }
-        } else { // above 20C
-            T2 = 7 * ((uint64_t)deltaT * deltaT)/pow(2,37); 
-            offset2 = (temperature - 2000) * (temperature - 2000) / 16;
-            sens2 = 0;
+bool RTPressureMS5803::startConversion()
+{
+    if (m_tempCountdown <= 0) {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2_OSR(m_osrD2), 0, 0, "Failed to start MS5803 temperature conversion")) {
+            m_state = MS5803_STATE_IDLE;
+            return false;
         }
+        m_state = MS5803_STATE_TEMPERATURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD2);
+    } else {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1_OSR(m_osrD1), 0, 0, "Failed to start MS5803 pressure conversion")) {
+            m_state = MS5803_STATE_IDLE;
+            return false;
+        }
+        m_state = MS5803_STATE_PRESSURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD1);
+    }
+    return true;
+}
 
-        // Now bring all together and apply offsets
-        offset = ((int64_t)m_calData[2] << 16) + (((m_calData[4] * (int64_t)deltaT)) >> 7);
-        sens   = ((int64_t)m_calData[1] << 15) + (((m_calData[3] * (int64_t)deltaT)) >> 8);
-
-        //printf("T2: %lld\n", T2);
-        //printf("offset2: %lld\n", offset2);
-        //printf("sens2: %lld\n", sens2);
-
-        temperature = temperature - T2;
-        offset = offset - offset2;
-        sens = sens - sens2;
+void RTPressureMS5803::calculateTemperature()
+{
+    int32_t deltaT;
+    int32_t temperature;
+    int64_t offset;
+    int64_t sens;
+    int64_t T2;
+    int64_t offset2;
+    int64_t sens2;
 
-        //printf("temperature calib: %lld\n", temperature);
-        //printf("offset calib: %lld\n", offset);
-        //printf("sens calib: %lld\n", sens);
+    //  now calculate temperature
+    deltaT = m_D2 - ((int32_t)m_calData[5] << 8);
+    temperature = (((int64_t)deltaT * m_calData[6]) >> 23) + 2000;
+
+    //printf("deltaT: %ld\n", deltaT);
+    //printf("temperature: %ld\n", temperature);
+
+    //  do second order temperature compensation
+    if (temperature < 2000) {
+        // low temperature below 20C
+        T2 = 3 * (((int64_t)deltaT * deltaT) >> 33);
+        offset2 = 3 * ((temperature - 2000) * (temperature - 2000)) / 2;
+        sens2 = 5 * ((temperature - 2000) * (temperature - 2000)) / 8;
+        if (temperature < -1500) { // below -15C
+            offset2 = offset2 + 7 * ((temperature + 1500) * (temperature + 1500));
+            sens2 =  sens2    + 4 * ((temperature + 1500) * (temperature + 1500));
+        }
+    } else { // above 20C
+        T2 = (7 * ((int64_t)deltaT * deltaT)) >> 37;
+        offset2 = (temperature - 2000) * (temperature - 2000) / 16;
+        sens2 = 0;
+    }
 
-        // now lets calculate temperature compensated pressure
-        m_pressureData.pressure = (RTFLOAT)(((m_D1 * sens)/ 2097152 - offset) / 32768) / 10.0;
-        m_pressureData.temperature = (RTFLOAT)temperature/100.0;
-        m_pressureData.temperatureValid = true;
-        m_pressureData.pressureValid =  true;
-		m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
+    // Now bring all together and apply offsets
+    offset = ((int64_t)m_calData[2] << 16) + (((m_calData[4] * (int64_t)deltaT)) >> 7);
+    sens   = ((int64_t)m_calData[1] << 15) + (((m_calData[3] * (int64_t)deltaT)) >> 8);
 
-        //printf("Temp: %f, pressure: %f\n", m_pressureData.temperature, m_pressureData.pressure);
+    //printf("T2: %lld\n", T2);
+    //printf("offset2: %lld\n", offset2);
+    //printf("sens2: %lld\n", sens2);
 
-        validReadings = true;
-        m_state = MS5803_STATE_IDLE;
-        break;
-    }
+    m_temperature = temperature - T2;
+    m_offset = offset - offset2;
+    m_sens = sens - sens2;
+}
 
-	if (validReadings) {
-      return true;
-	} else {
-      return false;
-    }
+void RTPressureMS5803::calculatePressure()
+{
+    // now lets calculate temperature compensated pressure
+    m_pressureData.pressure = (RTFLOAT)(((m_D1 * m_sens)/ 2097152 - m_offset) / 32768) / 10.0;
+    m_pressureData.temperature = (RTFLOAT)m_temperature/100.0;
+    m_pressureData.temperatureValid = true;
+    m_pressureData.pressureValid =  true;
+    m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
+
+    //printf("Temp: %f, pressure: %f\n", m_pressureData.temperature, m_pressureData.pressure);
 }
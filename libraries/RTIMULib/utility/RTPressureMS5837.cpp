@@ -25,6 +25,10 @@
 
 RTPressureMS5837::RTPressureMS5837(RTIMUSettings *settings) : RTPressure(settings)
 {
+    m_osrD1 = MS5611_OSR_8192;
+    m_osrD2 = MS5611_OSR_8192;
+    m_tempDecimation = 1;
+    m_tempCountdown = 0;
 }
 
 RTPressureMS5837::~RTPressureMS5837()
@@ -33,9 +37,11 @@ RTPressureMS5837::~RTPressureMS5837()
 
 int RTPressureMS5837::pressureGetPollInterval()
 {
-    // return (400 / 122); // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 /16.44 ms
-    // osr 8192 takes 16.44ms
-    return (7);
+    // available: 0.54 / 1.06 / 2.08 / 4.13 / 8.22 /16.44 ms
+    // poll about three times per pressure conversion
+    int interval = ms5611ConversionTime(m_osrD1) / 3000;
+
+    return interval > 0 ? interval : 1;
 }
 
 bool RTPressureMS5837::pressureReset()
@@ -55,6 +61,11 @@ bool RTPressureMS5837::pressureInit()
     unsigned char data[2];
     m_pressureAddr = m_settings->m_I2CPressureAddress;
 
+    m_osrD1 = ms5611OSRIndex(m_settings->m_pressureOSR, MS5611_OSR_8192, MS5611_OSR_8192);
+    m_osrD2 = ms5611OSRIndex(m_settings->m_pressureTempOSR, MS5611_OSR_8192, MS5611_OSR_8192);
+    m_tempDecimation = m_settings->m_pressureTempDecimation > 1 ? m_settings->m_pressureTempDecimation : 1;
+    m_tempCountdown = 0;                                    // first conversion is temperature
+
     pressureReset();
 
     // get calibration data
@@ -85,92 +96,110 @@ bool RTPressureMS5837::pressureInit()
 bool RTPressureMS5837::pressureRead()
 {
     uint8_t data[3];
-	int64_t T2;
-	int64_t offset2;
-	int64_t sens2;
-    int64_t deltaT;
-    int64_t sens;
-    int64_t offset;
-    int32_t temperature;
-    bool validReadings = false;
 
     switch (m_state) {
         case MS5837_STATE_IDLE:
-		// start pressure conversion
-		if (!m_settings->HALWrite(m_pressureAddr, MS5837_CMD_CONV_D1, 0, 0, "Failed to start MS5837 pressure conversion")) {
-			return false;
-		} else {
-			m_state = MS5837_STATE_PRESSURE;
-			m_timer = RTMath::currentUSecsSinceEpoch();
-		}
+        startConversion();
         break;
 
-        case MS5837_STATE_PRESSURE:
-		// read pressure
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 18080)  // 18.08ms
+        case MS5837_STATE_TEMPERATURE:
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
             return false;                                          // not time yet
-        if (!m_settings->HALRead(m_pressureAddr, MS5837_CMD_ADC, 3, data, "Failed to read MS5837 pressure")) {
-            return false;
-        }
-        m_D1 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
-        // start temperature conversion
-        if (!m_settings->HALWrite(m_pressureAddr, MS5837_CMD_CONV_D2, 0, 0, "Failed to start MS5837 temperature conversion")) {
+        if (!m_settings->HALRead(m_pressureAddr, MS5837_CMD_ADC, 3, data, "Failed to read MS5837 temperature")) {
             return false;
-        } else {
-            m_state = MS5837_STATE_TEMPERATURE;
-            m_timer = RTMath::currentUSecsSinceEpoch();
         }
+        m_D2 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
+        calculateTemperature();
+        m_tempCountdown = m_tempDecimation;
+        startConversion();
         break;
 
-        case MS5837_STATE_TEMPERATURE:
-		// read temperature
-        if ((RTMath::currentUSecsSinceEpoch() - m_timer) < 18080)  // 18.08
-            return false;                                          // not time yet
-        if (!m_settings->HALRead(m_pressureAddr, MS5837_CMD_ADC, 3, data, "Failed to read MS5837 temperature")) {
+        case MS5837_STATE_PRESSURE:
+        if (RTMath::currentUSecsSinceEpoch() < m_readyTime)
+            return false;
+        if (!m_settings->HALRead(m_pressureAddr, MS5837_CMD_ADC, 3, data, "Failed to read MS5837 pressure")) {
             return false;
         }
-        m_D2 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
+        m_D1 = (((uint32_t)data[0]) << 16) | (((uint32_t)data[1]) << 8) | ((uint32_t)data[2]);
+
         //  call this function for testing only
         //  should give T = 2000 (20.00C) and pressure 110002 (1100.02hPa)
-        //  setTestData();
-        //  now calculate the real values
-        deltaT = (int32_t)m_D2 - ((int32_t)m_calData[5] << 8);
-        sens   = (((int64_t)m_calData[1]) << 15) + (((int64_t)m_calData[3] * deltaT) >> 8);
-        offset = (((int64_t)m_calData[2]) << 16) + (((int64_t)m_calData[4] * deltaT) >> 7);
-        temperature = 2000L + ((deltaT * (int64_t)m_calData[6]) >> 23); // note - this still needs to be divided by 100
-        //  do second order temperature compensation
-        if (temperature < 2000) { // low temp
-            T2 = (3 * (deltaT * deltaT)) >> 33;
-            offset2 = (3 * ((temperature - 2000) * (temperature - 2000))) >> 1;
-            sens2 = (5 * ((temperature - 2000) * (temperature - 2000))) >> 3;
-            if (temperature < -1500) { // very low temp
-                offset2 += 7 * (temperature + 1500) * (temperature + 1500);
-                sens2 += 4 * ((temperature + 1500) * (temperature + 1500));
-            }
-        } else {
-            T2 = (2 * (deltaT * deltaT)) >> 37;
-			offset2 = (temperature - 2000) * (temperature - 2000) >> 4;
-			sens2 = 0;
+
+        // setTestData();
+        // calculateTemperature();
+
+        calculatePressure();
+        m_tempCountdown--;
+
+        //  keep the sensor converting while the caller uses this result
+
+        startConversion();
+        return true;
+    }
+    return false;
+}
+
+bool RTPressureMS5837::startConversion()
+{
+    if (m_tempCountdown <= 0) {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D2_OSR(m_osrD2), 0, 0, "Failed to start MS5837 temperature conversion")) {
+            m_state = MS5837_STATE_IDLE;
+            return false;
         }
-        offset -= offset2;
-        sens -=sens2;
-		temperature -= T2;
-        m_pressureData.pressure = (RTFLOAT)(((((int64_t)m_D1 * sens) >> 21) - offset) >> 13) / (RTFLOAT)10.0; // mbar
-        m_pressureData.temperature = (RTFLOAT)temperature/(RTFLOAT)100; // deg C
-        m_pressureData.temperatureValid = true;
-        m_pressureData.pressureValid =  true;
-		m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
-        // printf("Temp: %f, pressure: %f\n", m_temperature, m_pressure);
-        validReadings = true;
-        m_state = MS5837_STATE_IDLE;
-        break;
+        m_state = MS5837_STATE_TEMPERATURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD2);
+    } else {
+        if (!m_settings->HALWrite(m_pressureAddr, MS5611_CMD_CONV_D1_OSR(m_osrD1), 0, 0, "Failed to start MS5837 pressure conversion")) {
+            m_state = MS5837_STATE_IDLE;
+            return false;
+        }
+        m_state = MS5837_STATE_PRESSURE;
+        m_readyTime = RTMath::currentUSecsSinceEpoch() + ms5611ConversionTime(m_osrD1);
     }
-	
-	if (validReadings) {
-      return true;
-	} else {
-      return false;
+    return true;
+}
+
+void RTPressureMS5837::calculateTemperature()
+{
+	int64_t T2;
+	int64_t offset2;
+	int64_t sens2;
+    int64_t deltaT;
+    int64_t sens;
+    int64_t offset;
+    int32_t temperature;
+
+    deltaT = (int32_t)m_D2 - ((int32_t)m_calData[5] << 8);
+    sens   = (((int64_t)m_calData[1]) << 15) + (((int64_t)m_calData[3] * deltaT) >> 8);
+    offset = (((int64_t)m_calData[2]) << 16) + (((int64_t)m_calData[4] * deltaT) >> 7);
+    temperature = 2000L + ((deltaT * (int64_t)m_calData[6]) >> 23); // note - this still needs to be divided by 100
+    //  do second order temperature compensation
+    if (temperature < 2000) { // low temp
+        T2 = (3 * (deltaT * deltaT)) >> 33;
+        offset2 = (3 * ((temperature - 2000) * (temperature - 2000))) >> 1;
+        sens2 = (5 * ((temperature - 2000) * (temperature - 2000))) >> 3;
+        if (temperature < -1500) { // very low temp
+            offset2 += 7 * (temperature + 1500) * (temperature + 1500);
+            sens2 += 4 * ((temperature + 1500) * (temperature + 1500));
+        }
+    } else {
+        T2 = (2 * (deltaT * deltaT)) >> 37;
+		offset2 = (temperature - 2000) * (temperature - 2000) >> 4;
+		sens2 = 0;
     }
+    m_offset = offset - offset2;
+    m_sens = sens - sens2;
+    m_temperature = temperature - T2;
+}
+
+void RTPressureMS5837::calculatePressure()
+{
+    m_pressureData.pressure = (RTFLOAT)(((((int64_t)m_D1 * m_sens) >> 21) - m_offset) >> 13) / (RTFLOAT)10.0; // mbar
+    m_pressureData.temperature = (RTFLOAT)m_temperature/(RTFLOAT)100; // deg C
+    m_pressureData.temperatureValid = true;
+    m_pressureData.pressureValid =  true;
+    m_pressureData.timestamp = RTMath::currentUSecsSinceEpoch();
+    // printf("Temp: %f, pressure: %f\n", m_temperature, m_pressure);
 }
 
 void RTPressureMS5837::setTestData()